@@ -21,6 +21,15 @@
 #include <string>
 #include <type_traits>
 // aux
+#include "testing_argument_profile.hpp"
+#include "testing_code_object_loading.hpp"
+#include "testing_handle_pool.hpp"
+#include "testing_log_sampling.hpp"
+#include "testing_logging_binary.hpp"
+#include "testing_logging_device_scalars.hpp"
+#include "testing_logging_timeline.hpp"
+#include "testing_metrics.hpp"
+#include "testing_ostream_throughput.hpp"
 #include "testing_set_get_matrix.hpp"
 #include "testing_set_get_matrix_async.hpp"
 #include "testing_set_get_vector.hpp"
@@ -202,6 +211,7 @@ void run_function(const func_map& map, const Arguments& arg, const std::string&
 #include "testing_gemm_batched.hpp"
 #include "testing_gemm_batched_ex.hpp"
 #include "testing_gemm_ex.hpp"
+#include "testing_gemm_ex_dispatch_overhead.hpp"
 #include "testing_gemm_strided_batched.hpp"
 #include "testing_gemm_strided_batched_ex.hpp"
 #include "testing_trmm.hpp"
@@ -241,6 +251,7 @@ struct perf_gemm_ex<Ti,
         static const func_map map = {
             {"gemm_ex", testing_gemm_ex<Ti, To, Tc>},
             {"gemm_batched_ex", testing_gemm_batched_ex<Ti, To, Tc>},
+            {"gemm_ex_dispatch_overhead", testing_gemm_ex_dispatch_overhead<Ti, To, Tc>},
         };
         run_function(map, arg);
     }
@@ -285,7 +296,17 @@ struct perf_blas<T, U, std::enable_if_t<std::is_same<T, float>{} || std::is_same
     void operator()(const Arguments& arg)
     {
         static const func_map map
-            = { {"set_get_vector", testing_set_get_vector<T>},
+            = { {"argument_profile", testing_argument_profile},
+                {"argument_profile_timed", testing_argument_profile},
+                {"code_object_loading", testing_code_object_loading},
+                {"handle_pool", testing_handle_pool},
+                {"log_sampling", testing_log_sampling},
+                {"logging_binary", testing_logging_binary<T>},
+                {"logging_device_scalars", testing_logging_device_scalars<T>},
+                {"logging_timeline", testing_logging_timeline<T>},
+                {"metrics", testing_metrics<T>},
+                {"ostream_throughput", testing_ostream_throughput},
+                {"set_get_vector", testing_set_get_vector<T>},
                 {"set_get_vector_async", testing_set_get_vector_async<T>},
                 {"set_get_matrix", testing_set_get_matrix<T>},
                 {"set_get_matrix_async", testing_set_get_matrix_async<T>},
@@ -983,7 +1004,8 @@ int run_bench_test(Arguments& arg)
         }
     }
 
-    if(!strcmp(function, "gemm_ex") || !strcmp(function, "gemm_batched_ex"))
+    if(!strcmp(function, "gemm_ex") || !strcmp(function, "gemm_batched_ex")
+       || !strcmp(function, "gemm_ex_dispatch_overhead"))
     {
         // adjust dimension for GEMM routines
         rocblas_int min_lda = arg.transA == 'N' ? arg.M : arg.K;
@@ -0,0 +1,54 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_data.hpp"
+#include "rocblas_test.hpp"
+#include "testing_argument_profile.hpp"
+#include "type_dispatch.hpp"
+
+namespace
+{
+    template <typename...>
+    struct argument_profile_testing : rocblas_test_valid
+    {
+        void operator()(const Arguments& arg)
+        {
+            if(!strcmp(arg.function, "argument_profile")
+               || !strcmp(arg.function, "argument_profile_timed"))
+                testing_argument_profile(arg);
+            else
+                FAIL() << "Internal error: Test called with unknown function: " << arg.function;
+        }
+    };
+
+    struct argument_profile : RocBLAS_Test<argument_profile, argument_profile_testing>
+    {
+        // Filter for which types apply to this suite
+        static bool type_filter(const Arguments& arg)
+        {
+            return true;
+        }
+
+        // Filter for which functions apply to this suite
+        static bool function_filter(const Arguments& arg)
+        {
+            return !strcmp(arg.function, "argument_profile")
+                   || !strcmp(arg.function, "argument_profile_timed");
+        }
+
+        // Google Test name suffix based on parameters
+        static std::string name_suffix(const Arguments& arg)
+        {
+            return RocBLAS_TestName<argument_profile>(arg.name) << '_' << arg.M << '_' << arg.N;
+        }
+    };
+
+    TEST_P(argument_profile, auxiliary_tensile)
+    {
+        CATCH_SIGNALS_AND_EXCEPTIONS_AS_FAILURES(
+            rocblas_simple_dispatch<argument_profile_testing>(GetParam()));
+    }
+    INSTANTIATE_TEST_CATEGORIES(argument_profile);
+
+} // namespace
@@ -0,0 +1,101 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_data.hpp"
+#include "rocblas_test.hpp"
+#include "testing_arch_registry.hpp"
+#include "testing_check_numerics_records.hpp"
+#include "testing_check_numerics_sampler.hpp"
+#include "testing_device_memory_allocator.hpp"
+#include "testing_gemm_autotune.hpp"
+#include "testing_handle_pool.hpp"
+#include "testing_log_sampling.hpp"
+#include "testing_solution_warm_start.hpp"
+#include "testing_workspace_allocator.hpp"
+#include "testing_workspace_pool.hpp"
+#include "testing_workspace_profile.hpp"
+#include "testing_workspace_size.hpp"
+#include "type_dispatch.hpp"
+#include <cstring>
+
+namespace
+{
+    // Tests of the handle, its workspace and the library's host-side components, which do not
+    // depend on the types of the arguments
+    using auxiliary_test_fn = void (*)(const Arguments&);
+
+    struct auxiliary_test
+    {
+        const char*       function;
+        auxiliary_test_fn test;
+    };
+
+    constexpr auxiliary_test auxiliary_tests[] = {
+        {"arch_registry", testing_arch_registry},
+        {"check_numerics_records", testing_check_numerics_records},
+        {"check_numerics_sampler", testing_check_numerics_sampler},
+        {"device_memory_allocator", testing_device_memory_allocator},
+        {"gemm_autotune", testing_gemm_autotune},
+        {"handle_pool", testing_handle_pool},
+        {"log_sampling", testing_log_sampling},
+        {"solution_warm_start", testing_solution_warm_start},
+        {"workspace_allocator", testing_workspace_allocator},
+        {"workspace_pool", testing_workspace_pool},
+        {"workspace_profile", testing_workspace_profile},
+        {"workspace_size", testing_workspace_size},
+    };
+
+    auxiliary_test_fn find_auxiliary_test(const char* function)
+    {
+        for(auto& t : auxiliary_tests)
+            if(!strcmp(function, t.function))
+                return t.test;
+        return nullptr;
+    }
+
+    template <typename...>
+    struct auxiliary_testing : rocblas_test_valid
+    {
+        void operator()(const Arguments& arg)
+        {
+            auto test = find_auxiliary_test(arg.function);
+            if(test)
+                test(arg);
+            else
+                FAIL() << "Internal error: Test called with unknown function: " << arg.function;
+        }
+    };
+
+    struct auxiliary : RocBLAS_Test<auxiliary, auxiliary_testing>
+    {
+        // Filter for which types apply to this suite
+        static bool type_filter(const Arguments& arg)
+        {
+            return true;
+        }
+
+        // Filter for which functions apply to this suite
+        static bool function_filter(const Arguments& arg)
+        {
+            return find_auxiliary_test(arg.function) != nullptr;
+        }
+
+        // Google Test name suffix based on parameters; N is only given to some tests
+        static std::string name_suffix(const Arguments& arg)
+        {
+            RocBLAS_TestName<auxiliary> name(arg.name);
+            if(arg.N)
+                name << '_' << arg.N;
+            return std::move(name);
+        }
+    };
+
+    TEST_P(auxiliary, auxiliary_tensile)
+    {
+        CATCH_SIGNALS_AND_EXCEPTIONS_AS_FAILURES(
+            rocblas_simple_dispatch<auxiliary_testing>(GetParam()));
+    }
+    INSTANTIATE_TEST_CATEGORIES(auxiliary);
+
+} // namespace
@@ -0,0 +1,154 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_data.hpp"
+#include "rocblas_datatype2string.hpp"
+#include "rocblas_test.hpp"
+#include "testing_gemm_ex_allocations.hpp"
+#include "type_dispatch.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+/* ============================================================================================ *
+ * Replace the global operator new to count the allocations made by a thread while it counts.   *
+ * librocblas.so resolves operator new to these definitions, so allocations inside the library  *
+ * are counted. Outside of a counted region they only pass through to malloc.                   *
+ * ============================================================================================ */
+static thread_local bool   t_counting;
+static thread_local size_t t_allocations;
+
+void rocblas_test_start_counting_allocations()
+{
+    t_allocations = 0;
+    t_counting    = true;
+}
+
+size_t rocblas_test_stop_counting_allocations()
+{
+    t_counting = false;
+    return t_allocations;
+}
+
+void* operator new(size_t size)
+{
+    if(t_counting)
+        ++t_allocations;
+    void* p = malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    if(t_counting)
+        ++t_allocations;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    // By default, this test does not apply to any types.
+    template <typename Ti, typename To = Ti, typename Tc = To, typename = void>
+    struct gemm_ex_allocations_testing : rocblas_test_invalid
+    {
+    };
+
+    // The HPA types are the ones which reach Tensile in device memory size query mode
+    template <typename Ti, typename To, typename Tc>
+    struct gemm_ex_allocations_testing<
+        Ti,
+        To,
+        Tc,
+        std::enable_if_t<std::is_same<Tc, float>{}
+                         && (std::is_same<Ti, rocblas_half>{}
+                             || std::is_same<Ti, rocblas_bfloat16>{})>> : rocblas_test_valid
+    {
+        void operator()(const Arguments& arg)
+        {
+            if(!strcmp(arg.function, "gemm_ex_allocations"))
+                testing_gemm_ex_allocations<Ti, To, Tc>(arg);
+            else
+                FAIL() << "Internal error: Test called with unknown function: " << arg.function;
+        }
+    };
+
+    struct gemm_ex_allocations
+        : RocBLAS_Test<gemm_ex_allocations, gemm_ex_allocations_testing>
+    {
+        // Filter for which types apply to this suite
+        static bool type_filter(const Arguments& arg)
+        {
+            return rocblas_gemm_dispatch<type_filter_functor>(arg);
+        }
+
+        // Filter for which functions apply to this suite
+        static bool function_filter(const Arguments& arg)
+        {
+            return !strcmp(arg.function, "gemm_ex_allocations");
+        }
+
+        // Google Test name suffix based on parameters
+        static std::string name_suffix(const Arguments& arg)
+        {
+            RocBLAS_TestName<gemm_ex_allocations> name(arg.name);
+            name << rocblas_datatype2string(arg.a_type) << rocblas_datatype2string(arg.c_type)
+                 << rocblas_datatype2string(arg.compute_type) << '_'
+                 << (char)std::toupper(arg.transA) << (char)std::toupper(arg.transB) << '_'
+                 << arg.M << '_' << arg.N << '_' << arg.K;
+            return std::move(name);
+        }
+    };
+
+    TEST_P(gemm_ex_allocations, blas3_tensile)
+    {
+        CATCH_SIGNALS_AND_EXCEPTIONS_AS_FAILURES(
+            rocblas_gemm_dispatch<gemm_ex_allocations_testing>(GetParam()));
+    }
+    INSTANTIATE_TEST_CATEGORIES(gemm_ex_allocations);
+
+} // namespace
@@ -6,6 +6,9 @@
 #include "rocblas_datatype2string.hpp"
 #include "rocblas_test.hpp"
 #include "testing_logging.hpp"
+#include "testing_logging_binary.hpp"
+#include "testing_logging_device_scalars.hpp"
+#include "testing_logging_timeline.hpp"
 #include "type_dispatch.hpp"
 #include <cctype>
 #include <cstring>
@@ -31,6 +34,12 @@ namespace
         {
             if(!strcmp(arg.function, "logging"))
                 testing_logging<T>(arg);
+            else if(!strcmp(arg.function, "logging_binary"))
+                testing_logging_binary<T>(arg);
+            else if(!strcmp(arg.function, "logging_timeline"))
+                testing_logging_timeline<T>(arg);
+            else if(!strcmp(arg.function, "logging_device_scalars"))
+                testing_logging_device_scalars<T>(arg);
             else
                 FAIL() << "Internal error: Test called with unknown function: " << arg.function;
         }
@@ -47,7 +56,9 @@ namespace
         // Filter for which functions apply to this suite
         static bool function_filter(const Arguments& arg)
         {
-            return !strcmp(arg.function, "logging");
+            return !strcmp(arg.function, "logging") || !strcmp(arg.function, "logging_binary")
+                   || !strcmp(arg.function, "logging_timeline")
+                   || !strcmp(arg.function, "logging_device_scalars");
         }
 
         // Google Test name suffix based on parameters
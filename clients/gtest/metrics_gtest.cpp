@@ -0,0 +1,67 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_data.hpp"
+#include "rocblas_datatype2string.hpp"
+#include "rocblas_test.hpp"
+#include "testing_metrics.hpp"
+#include "type_dispatch.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+    // By default, this test does not apply to any types.
+    // The unnamed second parameter is used for enable_if_t below.
+    template <typename, typename = void>
+    struct metrics_testing : rocblas_test_invalid
+    {
+    };
+
+    // When the condition in the second argument is satisfied, the type combination
+    // is valid. When the condition is false, this specialization does not apply.
+    template <typename T>
+    struct metrics_testing<T,
+                           std::enable_if_t<std::is_same<T, float>{} || std::is_same<T, double>{}>>
+        : rocblas_test_valid
+    {
+        void operator()(const Arguments& arg)
+        {
+            if(!strcmp(arg.function, "metrics"))
+                testing_metrics<T>(arg);
+            else
+                FAIL() << "Internal error: Test called with unknown function: " << arg.function;
+        }
+    };
+
+    struct metrics : RocBLAS_Test<metrics, metrics_testing>
+    {
+        // Filter for which types apply to this suite
+        static bool type_filter(const Arguments& arg)
+        {
+            return rocblas_simple_dispatch<type_filter_functor>(arg);
+        }
+
+        // Filter for which functions apply to this suite
+        static bool function_filter(const Arguments& arg)
+        {
+            return !strcmp(arg.function, "metrics");
+        }
+
+        // Google Test name suffix based on parameters
+        static std::string name_suffix(const Arguments& arg)
+        {
+            return RocBLAS_TestName<metrics>(arg.name)
+                   << rocblas_datatype2string(arg.a_type) << '_' << arg.N;
+        }
+    };
+
+    TEST_P(metrics, auxiliary_tensile)
+    {
+        CATCH_SIGNALS_AND_EXCEPTIONS_AS_FAILURES(
+            rocblas_simple_dispatch<metrics_testing>(GetParam()));
+    }
+    INSTANTIATE_TEST_CATEGORIES(metrics);
+
+} // namespace
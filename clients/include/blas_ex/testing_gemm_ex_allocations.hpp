@@ -0,0 +1,115 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+
+// Count the calls to operator new made by the calling thread between start and stop, which
+// returns the count. They are defined where operator new is replaced, in
+// gemm_ex_allocations_gtest.cpp.
+void   rocblas_test_start_counting_allocations();
+size_t rocblas_test_stop_counting_allocations();
+
+/* ============================================================================================ *
+ * Check that repeated gemm_ex calls with the same problem make no heap allocations in problem  *
+ * construction and solution selection once the Tensile host is initialized, the solution is    *
+ * cached and the problem has been constructed. These calls are made in device memory size      *
+ * query mode, which goes through both without launching kernels; only the HPA types (f16_r or  *
+ * bf16_r inputs with f32_r compute) reach solution selection in this mode.                     *
+ *                                                                                              *
+ * Calls which launch kernels still allocate in Tensile's solve(), which builds the kernel      *
+ * arguments of each launch. For those, check that every call makes the same number of         *
+ * allocations, so that nothing on the launch path grows with the number of calls.              *
+ * ============================================================================================ */
+template <typename Ti, typename To, typename Tc>
+void testing_gemm_ex_allocations(const Arguments& arg)
+{
+    rocblas_local_handle handle{arg};
+    rocblas_operation    transA     = char2rocblas_operation(arg.transA);
+    rocblas_operation    transB     = char2rocblas_operation(arg.transB);
+    Tc                   h_alpha_Tc = arg.get_alpha<Tc>();
+    Tc                   h_beta_Tc  = arg.get_beta<Tc>();
+
+    size_t size_A = size_t(arg.lda) * (transA == rocblas_operation_none ? arg.K : arg.M);
+    size_t size_B = size_t(arg.ldb) * (transB == rocblas_operation_none ? arg.N : arg.K);
+    size_t size_C = size_t(arg.ldc) * arg.N;
+    size_t size_D = size_t(arg.ldd) * arg.N;
+
+    // The values of the matrices are not checked
+    device_vector<Ti> dA(size_A), dB(size_B);
+    device_vector<To> dC(size_C), dD(size_D);
+    CHECK_DEVICE_ALLOCATION(dA.memcheck());
+    CHECK_DEVICE_ALLOCATION(dB.memcheck());
+    CHECK_DEVICE_ALLOCATION(dC.memcheck());
+    CHECK_DEVICE_ALLOCATION(dD.memcheck());
+
+    CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+    CHECK_ROCBLAS_ERROR(rocblas_set_solution_cache_enabled(true));
+
+    auto gemm_ex = [&] {
+        return rocblas_gemm_ex(handle,
+                               transA,
+                               transB,
+                               arg.M,
+                               arg.N,
+                               arg.K,
+                               &h_alpha_Tc,
+                               dA,
+                               arg.a_type,
+                               arg.lda,
+                               dB,
+                               arg.b_type,
+                               arg.ldb,
+                               &h_beta_Tc,
+                               dC,
+                               arg.c_type,
+                               arg.ldc,
+                               dD,
+                               arg.d_type,
+                               arg.ldd,
+                               arg.compute_type,
+                               rocblas_gemm_algo_standard,
+                               0,
+                               rocblas_gemm_flags_none);
+    };
+
+    CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+
+    // The first call initializes the Tensile host, selects and caches the solution,
+    // and constructs the problem for this thread
+    CHECK_ROCBLAS_ERROR(gemm_ex());
+
+    rocblas_test_start_counting_allocations();
+    for(int i = 0; i < arg.iters; i++)
+        CHECK_ROCBLAS_ERROR(gemm_ex());
+    size_t allocations = rocblas_test_stop_counting_allocations();
+
+    size_t size;
+    CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &size));
+
+    EXPECT_EQ(allocations, 0) << "heap allocations in " << arg.iters << " gemm_ex calls";
+
+    // The first launch loads the code object of the kernel and allocates the workspace
+    hipStream_t stream;
+    CHECK_ROCBLAS_ERROR(rocblas_get_stream(handle, &stream));
+    CHECK_ROCBLAS_ERROR(gemm_ex());
+    CHECK_HIP_ERROR(hipStreamSynchronize(stream));
+
+    size_t first = 0;
+    for(int i = 0; i < arg.iters; i++)
+    {
+        rocblas_test_start_counting_allocations();
+        rocblas_status status = gemm_ex();
+        size_t         launch = rocblas_test_stop_counting_allocations();
+        CHECK_ROCBLAS_ERROR(status);
+        if(!i)
+            first = launch;
+        EXPECT_EQ(launch, first) << "heap allocations of launch " << i + 1 << " of gemm_ex";
+    }
+    CHECK_HIP_ERROR(hipStreamSynchronize(stream));
+}
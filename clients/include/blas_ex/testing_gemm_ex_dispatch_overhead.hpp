@@ -0,0 +1,114 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_datatype2string.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+
+/* ============================================================================================ *
+ * Measure the host-side overhead of gemm_ex solution selection, with and without the solution *
+ * cache. The calls are made in device memory size query mode, so no kernels are launched and   *
+ * only argument checking, problem construction and solution selection are timed. Only the HPA  *
+ * types (f16_r or bf16_r inputs with f32_r compute) reach solution selection in this mode.     *
+ * ============================================================================================ */
+template <typename Ti, typename To, typename Tc>
+void testing_gemm_ex_dispatch_overhead(const Arguments& arg)
+{
+    const bool HPA = arg.compute_type == rocblas_datatype_f32_r
+                     && (arg.a_type == rocblas_datatype_f16_r
+                         || arg.a_type == rocblas_datatype_bf16_r);
+    if(!HPA)
+    {
+        rocblas_cout << "rocblas-bench INFO: gemm_ex_dispatch_overhead requires f16_r or bf16_r "
+                        "inputs with f32_r compute type"
+                     << std::endl;
+        return;
+    }
+
+    rocblas_local_handle handle{arg};
+    rocblas_operation    transA     = char2rocblas_operation(arg.transA);
+    rocblas_operation    transB     = char2rocblas_operation(arg.transB);
+    Tc                   h_alpha_Tc = arg.get_alpha<Tc>();
+    Tc                   h_beta_Tc  = arg.get_beta<Tc>();
+
+    // The matrices are never accessed in size query mode; they only need to be non-null
+    device_vector<Ti> dA(1), dB(1);
+    device_vector<To> dC(1), dD(1);
+    CHECK_DEVICE_ALLOCATION(dA.memcheck());
+    CHECK_DEVICE_ALLOCATION(dB.memcheck());
+    CHECK_DEVICE_ALLOCATION(dC.memcheck());
+    CHECK_DEVICE_ALLOCATION(dD.memcheck());
+
+    CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+
+    auto gemm_ex = [&] {
+        return rocblas_gemm_ex(handle,
+                               transA,
+                               transB,
+                               arg.M,
+                               arg.N,
+                               arg.K,
+                               &h_alpha_Tc,
+                               dA,
+                               arg.a_type,
+                               arg.lda,
+                               dB,
+                               arg.b_type,
+                               arg.ldb,
+                               &h_beta_Tc,
+                               dC,
+                               arg.c_type,
+                               arg.ldc,
+                               arg.c_noalias_d ? dD : dC,
+                               arg.c_noalias_d ? arg.d_type : arg.c_type,
+                               arg.c_noalias_d ? arg.ldd : arg.ldc,
+                               arg.compute_type,
+                               rocblas_gemm_algo_standard,
+                               0,
+                               rocblas_gemm_flags_none);
+    };
+
+    // Time the average host time per call in microseconds
+    auto time_calls = [&](bool cache_enabled) {
+        CHECK_ROCBLAS_ERROR(rocblas_set_solution_cache_enabled(cache_enabled));
+        CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+
+        for(int i = 0; i < arg.cold_iters; i++)
+            gemm_ex();
+
+        double time = get_time_us_no_sync();
+        for(int i = 0; i < arg.iters; i++)
+            gemm_ex();
+        time = get_time_us_no_sync() - time;
+
+        size_t size;
+        CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &size));
+        return arg.iters > 0 ? time / arg.iters : 0.0;
+    };
+
+    size_t hits0, misses0;
+    CHECK_ROCBLAS_ERROR(rocblas_get_solution_cache_stats(&hits0, &misses0, nullptr, nullptr));
+
+    double us_uncached = time_calls(false);
+    double us_cached   = time_calls(true);
+
+    size_t hits, misses, evictions, entries;
+    CHECK_ROCBLAS_ERROR(rocblas_get_solution_cache_stats(&hits, &misses, &evictions, &entries));
+
+    rocblas_cout << "transA,transB,M,N,K,lda,ldb,ldc,ldd,a_type,c_type,compute_type,iters,"
+                    "us_per_call_uncached,us_per_call_cached,cache_hits,cache_misses,"
+                    "cache_evictions,cache_entries"
+                 << std::endl;
+    rocblas_cout << arg.transA << "," << arg.transB << "," << arg.M << "," << arg.N << ","
+                 << arg.K << "," << arg.lda << "," << arg.ldb << "," << arg.ldc << "," << arg.ldd
+                 << "," << rocblas_datatype2string(arg.a_type) << ","
+                 << rocblas_datatype2string(arg.c_type) << ","
+                 << rocblas_datatype2string(arg.compute_type) << "," << arg.iters << ","
+                 << us_uncached << "," << us_cached << "," << hits - hits0 << ","
+                 << misses - misses0 << "," << evictions << "," << entries << std::endl;
+}
@@ -0,0 +1,97 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_arch_registry.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the per-architecture state registry on a mock node mixing GPUs of three architectures;  *
+ * no GPU is used. Checks that every device gets the state of its own architecture, that        *
+ * devices of the same architecture share one state which is created once even when devices     *
+ * are initialized concurrently, and that a failed creation is retried.                         *
+ * ============================================================================================ */
+inline void testing_arch_registry(const Arguments& arg)
+{
+    const std::vector<std::string> devices = {"gfx906", "gfx908", "gfx906", "gfx90a", "gfx908"};
+    constexpr int                  NTHREAD = 8;
+
+    struct mock_state
+    {
+        std::string arch;
+    };
+
+    std::atomic<int> queried{0}, created{0};
+    auto             query = [&](int device) {
+        ++queried;
+        return devices.at(device);
+    };
+    auto create = [&](const std::string& arch) {
+        ++created;
+        return std::unique_ptr<mock_state>(new mock_state{arch});
+    };
+
+    rocblas_arch_registry<mock_state> registry(int(devices.size()), query);
+    EXPECT_EQ(registry.device_count(), int(devices.size()));
+    EXPECT_EQ(registry.find(0), nullptr);
+
+    // Threads initialize the devices concurrently, each in a different order
+    std::vector<std::thread> threads;
+    for(int t = 0; t < NTHREAD; ++t)
+        threads.emplace_back([&, t] {
+            for(size_t i = 0; i < devices.size(); ++i)
+                registry.get(int((i + t) % devices.size()), create);
+        });
+    for(auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(created, 3);
+    EXPECT_EQ(queried, int(devices.size()));
+
+    for(int device = 0; device < int(devices.size()); ++device)
+    {
+        mock_state* state = registry.find(device);
+        ASSERT_NE(state, nullptr);
+        EXPECT_EQ(state->arch, devices[device]);
+        EXPECT_EQ(registry.arch(device), devices[device]);
+        EXPECT_EQ(&registry.get(device, create), state);
+    }
+    EXPECT_EQ(registry.find(0), registry.find(2));
+    EXPECT_EQ(registry.find(1), registry.find(4));
+    EXPECT_NE(registry.find(0), registry.find(1));
+    EXPECT_NE(registry.find(0), registry.find(3));
+    EXPECT_NE(registry.find(1), registry.find(3));
+
+    int archs = 0;
+    registry.for_each([&](const std::string& arch, const mock_state& state) {
+        EXPECT_EQ(arch, state.arch);
+        ++archs;
+    });
+    EXPECT_EQ(archs, 3);
+    EXPECT_EQ(created, 3);
+
+    // A failed creation leaves the architecture uninitialized, and the next device retries it
+    rocblas_arch_registry<mock_state> retry(int(devices.size()), query);
+    bool                              fail  = true;
+    auto                              flaky = [&](const std::string& arch) {
+        if(fail)
+        {
+            fail = false;
+            throw std::runtime_error("mock library load failure");
+        }
+        return create(arch);
+    };
+    EXPECT_THROW(retry.get(0, flaky), std::runtime_error);
+    EXPECT_EQ(retry.find(0), nullptr);
+    EXPECT_EQ(retry.get(2, flaky).arch, "gfx906");
+    EXPECT_EQ(retry.find(0), nullptr);
+    EXPECT_EQ(&retry.get(0, flaky), retry.find(2));
+}
@@ -0,0 +1,129 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_argument_profile.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the argument profile used by profile logging, and with timing, measure its throughput   *
+ * with many threads. This runs on the CPU only.                                                *
+ * argument_profile_timed also records a time for each call, as timed profile logging does,     *
+ * where shape s takes s + 1 microseconds, and checks the totals and order of the shapes.       *
+ *   M           number of threads                                                              *
+ *   N           number of distinct argument tuples each thread cycles through                 *
+ *   iters       number of tuples profiled by each thread                                       *
+ * ============================================================================================ */
+inline void testing_argument_profile(const Arguments& arg)
+{
+    const int  threads = std::max(arg.M, 1);
+    const int  shapes  = std::max(arg.N, 1);
+    const int  iters   = arg.timing ? std::max(arg.iters, 1) : 10000;
+    const bool timed   = !strcmp(arg.function, "argument_profile_timed");
+
+    using tuple_t
+        = std::tuple<const char*, const char*, const char*, rocblas_int, const char*, rocblas_int>;
+
+    char path[] = "/tmp/rocblas-XXXXXX";
+    int  fd     = mkstemp(path);
+    if(fd == -1)
+    {
+#ifdef GOOGLE_TEST
+        FAIL() << "Cannot open temporary file " << path;
+#endif
+        return;
+    }
+    close(fd);
+
+    double time_us;
+    {
+        rocblas_internal_ostream  os(path);
+        argument_profile<tuple_t> profile(os);
+        std::vector<std::thread>  pool;
+
+        // Each thread profiles the shapes in turn, starting at a different shape
+        auto thread_func = [&](int t) {
+            argument_profile<tuple_t>::counter counter(profile);
+            for(int i = 0; i < iters; ++i)
+            {
+                int   shape = (t + i) % shapes;
+                auto& entry = counter(
+                    std::make_tuple("rocblas_function", "rocblas_sgemm", "M", shape, "N", 1));
+                if(timed)
+                {
+                    argument_profile_call call;
+                    call.mutex = &counter.mutex();
+                    call.entry = &entry;
+                    call.record((shape + 1) * 1000, nullptr);
+                }
+            }
+        };
+
+        time_us = get_time_us_no_sync();
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back(thread_func, t);
+        for(auto& thread : pool)
+            thread.join();
+        time_us = get_time_us_no_sync() - time_us;
+    } // The profile is dumped when it is destroyed
+
+    // Each shape is printed once, and the counts add up to the number of calls
+    std::ifstream is(path);
+    std::string   line;
+    size_t        lines = 0, calls = 0, expected_ns = 0, total_ns = 0;
+    size_t        last_total_ns = std::numeric_limits<size_t>::max();
+    bool          sorted        = true;
+    while(std::getline(is, line))
+    {
+        auto pos = line.find("call_count: ");
+        if(pos != std::string::npos)
+        {
+            ++lines;
+            size_t count = std::stoull(line.substr(pos + 12));
+            calls += count;
+
+            // Each shape takes M + 1 microseconds, and shapes are printed by decreasing total
+            pos = line.find("total_time_ns: ");
+            if(timed && pos != std::string::npos)
+            {
+                size_t shape    = std::stoull(line.substr(line.find("M: ") + 3));
+                size_t shape_ns = std::stoull(line.substr(pos + 15));
+                sorted          = sorted && shape_ns <= last_total_ns;
+                last_total_ns   = shape_ns;
+                total_ns += shape_ns;
+                expected_ns += count * (shape + 1) * 1000;
+            }
+        }
+    }
+    remove(path);
+
+#ifdef GOOGLE_TEST
+    EXPECT_EQ(lines, size_t(std::min(shapes, threads * iters)));
+    EXPECT_EQ(calls, size_t(threads) * iters);
+    if(timed)
+    {
+        EXPECT_EQ(total_ns, expected_ns);
+        EXPECT_GT(total_ns, 0u);
+        EXPECT_TRUE(sorted);
+    }
+#endif
+
+    if(arg.timing)
+    {
+        rocblas_cout << "threads,shapes,iters,us,calls_per_us" << std::endl;
+        rocblas_cout << threads << "," << shapes << "," << iters << "," << time_us << ","
+                     << threads * double(iters) / time_us << std::endl;
+    }
+}
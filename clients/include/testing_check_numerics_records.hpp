@@ -0,0 +1,191 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_check_numerics_records.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/* ============================================================================================ *
+ * Mock device operations for the check_numerics records, where streams are integers and memory *
+ * is host memory. Clears and reads are logged with their streams, and the checks reported are  *
+ * kept, so that the test can check when the ring was read and what was reported.              *
+ * ============================================================================================ */
+struct rocblas_mock_check_numerics_backend
+{
+    using stream_t = int;
+
+    struct flags_t
+    {
+        bool has_NaN;
+        bool has_zero;
+        bool has_Inf;
+    };
+
+    struct state_s
+    {
+        bool                                                fail = false;
+        std::map<void*, size_t>                             live;
+        std::vector<int>                                    clears; // streams cleared on
+        std::vector<int>                                    reads; // streams read from
+        std::vector<std::tuple<std::string, bool, flags_t>> reported;
+    };
+
+    state_s* state;
+
+    bool alloc(void** ptr, size_t size)
+    {
+        if(state->fail || !(*ptr = malloc(size)))
+            return false;
+        state->live[*ptr] = size;
+        return true;
+    }
+    void free(void* ptr)
+    {
+        state->live.erase(ptr);
+        ::free(ptr);
+    }
+    bool clear(void* ptr, size_t size, stream_t stream)
+    {
+        if(state->fail)
+            return false;
+        memset(ptr, 0, size);
+        state->clears.push_back(stream);
+        return true;
+    }
+    bool read(void* host, const void* ptr, size_t size, stream_t stream)
+    {
+        if(state->fail)
+            return false;
+        memcpy(host, ptr, size);
+        state->reads.push_back(stream);
+        return true;
+    }
+    void report(const char* function, bool is_input, const flags_t& flags)
+    {
+        state->reported.emplace_back(function, is_input, flags);
+    }
+};
+
+/* ============================================================================================ *
+ * Test the records of asynchronous check_numerics mode with mock streams; no GPU is used.      *
+ * Checks that the flags set through the records are only seen once the ring is read, that the  *
+ * ring is read when it is full or the stream changes and is cleared on the stream of the next  *
+ * check, and that the checks read are reported and aggregated by function name and role.       *
+ * ============================================================================================ */
+inline void testing_check_numerics_records(const Arguments& arg)
+{
+    using records_t = rocblas_check_numerics_records<rocblas_mock_check_numerics_backend>;
+    using state_t   = rocblas_mock_check_numerics_backend::state_s;
+
+    state_t state;
+    {
+        records_t records(rocblas_mock_check_numerics_backend{&state}, 4);
+
+        // The ring is allocated and cleared by the first check, on its stream
+        auto* x = records.record("rocblas_sscal", true, 1);
+        auto* y = records.record("rocblas_sscal", false, 1);
+        auto* z = records.record("rocblas_saxpy", true, 1);
+        ASSERT_NE(x, nullptr);
+        ASSERT_NE(y, nullptr);
+        ASSERT_NE(z, nullptr);
+        EXPECT_EQ(state.live.size(), 1);
+        EXPECT_EQ(state.clears, std::vector<int>{1});
+        EXPECT_EQ(records.pending(), 3);
+
+        // The check kernels set the flags; nothing is seen until the records are read
+        y->has_NaN  = true;
+        z->has_zero = true;
+        z->has_Inf  = true;
+        EXPECT_TRUE(records.records().empty());
+        EXPECT_TRUE(state.reads.empty());
+
+        ASSERT_TRUE(records.read());
+        EXPECT_EQ(state.reads, std::vector<int>{1});
+        EXPECT_EQ(records.pending(), 0);
+        ASSERT_EQ(state.reported.size(), 3);
+        EXPECT_EQ(std::get<0>(state.reported[2]), "rocblas_saxpy");
+        EXPECT_TRUE(std::get<2>(state.reported[1]).has_NaN);
+        EXPECT_FALSE(std::get<2>(state.reported[0]).has_NaN);
+
+        // The aggregates are in the order first seen, by function and role
+        auto& aggregates = records.records();
+        ASSERT_EQ(aggregates.size(), 3);
+        EXPECT_STREQ(aggregates[0].function, "rocblas_sscal");
+        EXPECT_EQ(aggregates[0].is_input, 1);
+        EXPECT_EQ(aggregates[1].is_input, 0);
+        EXPECT_EQ(aggregates[1].has_NaN, 1);
+        EXPECT_EQ(aggregates[2].has_zero, 1);
+        EXPECT_EQ(aggregates[2].has_Inf, 1);
+        EXPECT_EQ(aggregates[2].has_NaN, 0);
+
+        // Reading with no record pending does not wait for the stream
+        ASSERT_TRUE(records.read());
+        EXPECT_EQ(state.reads.size(), 1);
+
+        // The next check after a read clears the ring again; the fifth check of a ring of
+        // four reads the first four
+        for(int i = 0; i < 4; ++i)
+            records.record("rocblas_sscal", true, 1)->has_Inf = i % 2;
+        EXPECT_EQ(state.clears, (std::vector<int>{1, 1}));
+        EXPECT_EQ(state.reads.size(), 1);
+        records.record("rocblas_sscal", true, 1);
+        EXPECT_EQ(state.reads.size(), 2);
+        EXPECT_EQ(state.clears, (std::vector<int>{1, 1, 1}));
+        EXPECT_EQ(records.pending(), 1);
+        EXPECT_EQ(records.records()[0].checks, 5);
+        EXPECT_EQ(records.records()[0].has_Inf, 2);
+
+        // A check on another stream reads the ring on the old stream, and clears it on the new
+        records.record("rocblas_sscal", true, 2);
+        EXPECT_EQ(state.reads, (std::vector<int>{1, 1, 1}));
+        EXPECT_EQ(state.clears, (std::vector<int>{1, 1, 1, 2}));
+        EXPECT_EQ(records.records()[0].checks, 6);
+
+        // Functions are aggregated by name, not by the address of the name
+        char name_a[] = "rocblas_dgemv";
+        char name_b[] = "rocblas_dgemv";
+        records.add(name_a, false, {false, false, true});
+        records.add(name_b, false, {false, false, true});
+        EXPECT_EQ(records.records().size(), 4);
+        EXPECT_EQ(records.records()[3].checks, 2);
+        EXPECT_EQ(records.records()[3].has_Inf, 2);
+
+        // Clearing forgets the aggregates, but not the records which are pending
+        records.clear();
+        EXPECT_TRUE(records.records().empty());
+        EXPECT_EQ(records.pending(), 1);
+        ASSERT_TRUE(records.read());
+        ASSERT_EQ(records.records().size(), 1);
+        EXPECT_EQ(records.records()[0].checks, 1);
+
+        // A failed read keeps the records pending, and fails the next check
+        records.record("rocblas_sscal", true, 2);
+        state.fail = true;
+        EXPECT_FALSE(records.read());
+        EXPECT_EQ(records.pending(), 1);
+        EXPECT_EQ(records.record("rocblas_sscal", true, 3), nullptr);
+        state.fail = false;
+        ASSERT_TRUE(records.read());
+        EXPECT_EQ(records.pending(), 0);
+    }
+    EXPECT_TRUE(state.live.empty());
+
+    // A ring which cannot be allocated fails the check
+    {
+        records_t records(rocblas_mock_check_numerics_backend{&state});
+        state.fail = true;
+        EXPECT_EQ(records.record("rocblas_sscal", true, 1), nullptr);
+        state.fail = false;
+        EXPECT_EQ(records.pending(), 0);
+        EXPECT_TRUE(state.live.empty());
+    }
+}
@@ -0,0 +1,124 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_check_numerics_sampler.hpp"
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the sampling of check_numerics: on the CPU, that the first check of a call decides for  *
+ * all its checks, that every Nth call of each function is checked, and that the calls checked  *
+ * and failed are counted once each; and with scal, the counts of a handle in sampled mode.     *
+ * ============================================================================================ */
+inline void testing_check_numerics_sampler(const Arguments& arg)
+{
+    static const char gemv[] = "rocblas_sgemv";
+    static const char scal[] = "rocblas_sscal";
+
+    rocblas_check_numerics_sampler sampler;
+
+    // By default, every call is checked, and counted
+    for(int i = 0; i < 3; ++i)
+    {
+        sampler.begin_call();
+        EXPECT_TRUE(sampler.sample(gemv));
+        EXPECT_TRUE(sampler.sample(gemv));
+    }
+    EXPECT_EQ(sampler.stats().calls, 3);
+    EXPECT_EQ(sampler.stats().checked_calls, 3);
+    EXPECT_EQ(sampler.get_stride(), 1);
+
+    // Every 3rd call of each function is checked, starting with its first, and every check of
+    // a call follows the decision of its first check
+    sampler.set(3, 4);
+    EXPECT_EQ(sampler.get_every(), 3);
+    EXPECT_EQ(sampler.get_stride(), 4);
+
+    std::vector<bool> gemv_checked, scal_checked;
+    for(int i = 0; i < 7; ++i)
+    {
+        sampler.begin_call();
+        bool checked = sampler.sample(gemv);
+        EXPECT_EQ(sampler.sample(gemv), checked);
+        gemv_checked.push_back(checked);
+
+        sampler.begin_call();
+        scal_checked.push_back(sampler.sample(scal));
+    }
+    std::vector<bool> every_3rd{true, false, false, true, false, false, true};
+    EXPECT_EQ(gemv_checked, every_3rd);
+    EXPECT_EQ(scal_checked, every_3rd);
+    EXPECT_EQ(sampler.stats().calls, 3 + 14);
+    EXPECT_EQ(sampler.stats().checked_calls, 3 + 6);
+
+    // A call is counted as failed once, however many of its checks fail
+    sampler.set(1, 1);
+    sampler.begin_call();
+    sampler.sample(scal);
+    sampler.count(true);
+    sampler.count(true);
+    sampler.begin_call();
+    sampler.sample(scal);
+    sampler.count(false);
+    EXPECT_EQ(sampler.stats().failed_calls, 1);
+
+    // Setting the sampling forgets the calls seen, so the next call of a function is checked
+    sampler.set(2, 1);
+    sampler.begin_call();
+    EXPECT_TRUE(sampler.sample(gemv));
+    sampler.begin_call();
+    EXPECT_FALSE(sampler.sample(gemv));
+    sampler.set(2, 1);
+    sampler.begin_call();
+    EXPECT_TRUE(sampler.sample(gemv));
+
+    // In sampled mode, a handle checks every 2nd call of scal, each of which checks its input
+    // and output, and counts the calls in which both found a NaN as one failed call each
+    const rocblas_int    N     = std::max(arg.N, 1);
+    float                alpha = 2;
+    host_vector<float>   hx(N);
+    device_vector<float> dx(N);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    for(rocblas_int i = 0; i < N; ++i)
+        hx[i] = std::numeric_limits<float>::quiet_NaN();
+    CHECK_HIP_ERROR(dx.transfer_from(hx));
+
+    int setenv_status = setenv("ROCBLAS_CHECK_NUMERICS", "16", true)
+                        | setenv("ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY", "2", true);
+    ASSERT_EQ(setenv_status, 0);
+    rocblas_local_handle handle;
+    setenv_status = unsetenv("ROCBLAS_CHECK_NUMERICS")
+                    | unsetenv("ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY");
+    ASSERT_EQ(setenv_status, 0);
+
+    rocblas_int every, stride;
+    CHECK_ROCBLAS_ERROR(rocblas_get_check_numerics_sampling(handle, &every, &stride));
+    EXPECT_EQ(every, 2);
+    EXPECT_EQ(stride, 1);
+
+    CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+    for(int i = 0; i < 4; ++i)
+        CHECK_ROCBLAS_ERROR(rocblas_sscal(handle, N, &alpha, dx, 1));
+
+    rocblas_check_numerics_sampling_stats stats;
+    CHECK_ROCBLAS_ERROR(rocblas_get_check_numerics_sampling_stats(handle, &stats));
+    EXPECT_EQ(stats.calls, 4);
+    EXPECT_EQ(stats.checked_calls, 2);
+    EXPECT_EQ(stats.failed_calls, 2);
+
+    EXPECT_ROCBLAS_STATUS(rocblas_set_check_numerics_sampling(handle, 0, 1),
+                          rocblas_status_invalid_value);
+    EXPECT_ROCBLAS_STATUS(rocblas_set_check_numerics_sampling(handle, 1, -1),
+                          rocblas_status_invalid_value);
+    EXPECT_ROCBLAS_STATUS(rocblas_get_check_numerics_sampling_stats(handle, nullptr),
+                          rocblas_status_invalid_pointer);
+}
@@ -0,0 +1,105 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_code_object_index.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================================ *
+ * Compare eager and lazy code object loading startup time on a synthetic library directory.    *
+ *   M           number of code object files                                                    *
+ *   N           number of kernels in each code object                                          *
+ *   K           size of each code object in KiB                                                *
+ *   batch_count number of randomly chosen kernels launched after startup                       *
+ * Loading a code object is modelled by reading the whole file, which is the part of            *
+ * hipModuleLoadData that scales with the library size; no GPU is used.                         *
+ * ============================================================================================ */
+inline void testing_code_object_loading(const Arguments& arg)
+{
+    const int num_files   = std::max(arg.M, 1);
+    const int num_kernels = std::max(arg.N, 1);
+    const int file_kib    = std::max(arg.K, 1);
+    const int launched    = std::max(arg.batch_count, 1);
+    const int iters       = std::max(arg.iters, 1);
+
+    char tmpl[] = "/tmp/rocblas-code-objects-XXXXXX";
+    if(!mkdtemp(tmpl))
+    {
+        rocblas_cerr << "rocblas-bench ERROR: could not create a temporary directory" << std::endl;
+        return;
+    }
+    std::string dir = tmpl;
+
+    // Write the synthetic code objects and their index. Kernel k is in file k / N.
+    auto file_name   = [](int f) { return "TensileLibrary_" + std::to_string(f) + "_gfx000.co"; };
+    auto kernel_name = [](int k) { return "Cijk_synthetic_" + std::to_string(k); };
+    {
+        std::vector<char> contents(size_t(file_kib) * 1024, 'x');
+        std::ofstream     index(dir + "/" + ROCBLAS_CODE_OBJECT_INDEX_FILE);
+        index << ROCBLAS_CODE_OBJECT_INDEX_HEADER << "\n";
+        for(int f = 0; f < num_files; ++f)
+        {
+            std::ofstream(dir + "/" + file_name(f)).write(contents.data(), contents.size());
+            index << "@ " << file_name(f) << "\n";
+            for(int k = 0; k < num_kernels; ++k)
+                index << kernel_name(f * num_kernels + k) << "\n";
+        }
+    }
+
+    size_t bytes_read = 0;
+    auto   load       = [&](const std::string& path) {
+        std::vector<char> buf(size_t(file_kib) * 1024);
+        std::ifstream(path).read(buf.data(), buf.size());
+        bytes_read += buf.size();
+    };
+
+    // The kernels launched after startup
+    std::mt19937                       rng(0);
+    std::uniform_int_distribution<int> pick(0, num_files * num_kernels - 1);
+    std::vector<std::string>           kernels;
+    for(int i = 0; i < launched; ++i)
+        kernels.push_back(kernel_name(pick(rng)));
+
+    double eager_us = 0, lazy_us = 0;
+    size_t lazy_files = 0;
+    for(int i = 0; i < iters; ++i)
+    {
+        double t = get_time_us_no_sync();
+        for(int f = 0; f < num_files; ++f)
+            load(dir + "/" + file_name(f));
+        eager_us += get_time_us_no_sync() - t;
+
+        bytes_read = 0;
+        t          = get_time_us_no_sync();
+        rocblas_code_object_index     index;
+        rocblas_code_object_residency residency;
+        index.read(dir, "gfx000");
+        residency.reset(index.num_files());
+        for(auto& k : kernels)
+            residency.require(index, k, load);
+        lazy_us += get_time_us_no_sync() - t;
+        lazy_files = bytes_read / (size_t(file_kib) * 1024);
+    }
+
+    for(int f = 0; f < num_files; ++f)
+        remove((dir + "/" + file_name(f)).c_str());
+    remove((dir + "/" + ROCBLAS_CODE_OBJECT_INDEX_FILE).c_str());
+    rmdir(dir.c_str());
+
+    rocblas_cout << "files,kernels_per_file,KiB_per_file,launched_kernels,eager_us,lazy_us,"
+                    "files_loaded_lazily"
+                 << std::endl;
+    rocblas_cout << num_files << "," << num_kernels << "," << file_kib << "," << launched << ","
+                 << eager_us / iters << "," << lazy_us / iters << "," << lazy_files << std::endl;
+}
@@ -0,0 +1,186 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+/* ============================================================================================ *
+ * Mock device memory allocator which hands out host memory and records every call, so that the *
+ * sequence of allocations and frees made by a handle can be checked. Workspace memory is only  *
+ * borrowed through rocblas_device_malloc_alloc(), and never used by a kernel.                  *
+ * ============================================================================================ */
+struct rocblas_mock_device_allocator
+{
+    struct event
+    {
+        bool   alloc;
+        size_t size;
+    };
+
+    std::vector<event>      events;
+    std::map<void*, size_t> live;
+    bool                    fail      = false;
+    size_t                  bad_frees = 0;
+
+    static rocblas_status alloc(void* context, void** ptr, size_t size, hipStream_t)
+    {
+        auto& mock = *static_cast<rocblas_mock_device_allocator*>(context);
+        mock.events.push_back({true, size});
+        if(mock.fail || !(*ptr = malloc(size)))
+            return rocblas_status_memory_error;
+        mock.live[*ptr] = size;
+        return rocblas_status_success;
+    }
+
+    static rocblas_status free(void* context, void* ptr, size_t size, hipStream_t)
+    {
+        auto& mock = *static_cast<rocblas_mock_device_allocator*>(context);
+        mock.events.push_back({false, size});
+        auto it = mock.live.find(ptr);
+        if(it == mock.live.end() || it->second != size)
+        {
+            ++mock.bad_frees;
+            return rocblas_status_internal_error;
+        }
+        mock.live.erase(it);
+        ::free(ptr);
+        return rocblas_status_success;
+    }
+
+    // The events recorded since the last call
+    std::vector<event> take()
+    {
+        auto e = std::move(events);
+        events.clear();
+        return e;
+    }
+};
+
+inline bool operator==(const rocblas_mock_device_allocator::event& a,
+                       const rocblas_mock_device_allocator::event& b)
+{
+    return a.alloc == b.alloc && a.size == b.size;
+}
+
+inline void testing_device_memory_allocator(const Arguments& arg)
+{
+    using event = rocblas_mock_device_allocator::event;
+    rocblas_mock_device_allocator mock;
+    rocblas_local_handle          handle{arg};
+
+    // Borrow size bytes of workspace from the handle, and return it
+    auto borrow = [&](size_t size) {
+        rocblas_device_malloc_base* mem    = nullptr;
+        rocblas_status              status = rocblas_device_malloc_alloc(handle, &mem, 1, size);
+        if(mem)
+        {
+            EXPECT_EQ(rocblas_device_malloc_free(mem), rocblas_status_success);
+        }
+        return status;
+    };
+
+    EXPECT_ROCBLAS_STATUS(rocblas_set_device_memory_allocator(handle, mock.alloc, nullptr, &mock),
+                          rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_set_device_memory_allocator(nullptr, mock.alloc, mock.free, &mock),
+        rocblas_status_invalid_handle);
+
+    // The handle's memory is freed with hipFree, and is allocated on demand by the mock
+    CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_allocator(handle, mock.alloc, mock.free, &mock));
+    EXPECT_TRUE(rocblas_is_managing_device_memory(handle));
+    size_t size;
+    CHECK_ROCBLAS_ERROR(rocblas_get_device_memory_size(handle, &size));
+    EXPECT_EQ(size, 0);
+    EXPECT_TRUE(mock.take().empty());
+
+    // Growth allocates the rounded up size, and smaller requests reuse the memory
+    CHECK_ROCBLAS_ERROR(borrow(1000));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{true, 1024}}));
+    CHECK_ROCBLAS_ERROR(borrow(512));
+    CHECK_ROCBLAS_ERROR(borrow(1024));
+    EXPECT_TRUE(mock.take().empty());
+
+    // Further growth frees the smaller memory before allocating the larger
+    CHECK_ROCBLAS_ERROR(borrow(4096));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{false, 1024}, {true, 4096}}));
+
+    // Workspace blocks may be freed in any order, and the statistics report the free blocks
+    rocblas_device_malloc_base *first = nullptr, *second = nullptr;
+    size_t                      in_use, peak_in_use, largest_free, free_blocks;
+    auto                        stats = [&] {
+        return rocblas_get_device_memory_stats(
+            handle, &in_use, &peak_in_use, &largest_free, &free_blocks);
+    };
+    CHECK_ROCBLAS_ERROR(rocblas_device_malloc_alloc(handle, &first, 1, size_t(1024)));
+    CHECK_ROCBLAS_ERROR(rocblas_device_malloc_alloc(handle, &second, 1, size_t(1024)));
+    CHECK_ROCBLAS_ERROR(rocblas_device_malloc_free(first));
+    CHECK_ROCBLAS_ERROR(stats());
+    EXPECT_EQ(in_use, 1024);
+    EXPECT_EQ(peak_in_use, 4096);
+    EXPECT_EQ(largest_free, 2048);
+    EXPECT_EQ(free_blocks, 2);
+    CHECK_ROCBLAS_ERROR(rocblas_device_malloc_free(second));
+    CHECK_ROCBLAS_ERROR(stats());
+    EXPECT_EQ(in_use, 0);
+    EXPECT_EQ(largest_free, 4096);
+    EXPECT_EQ(free_blocks, 1);
+    EXPECT_TRUE(mock.take().empty());
+
+    // Like the other getters, a null handle is checked before the outputs, which must all be set
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_get_device_memory_stats(nullptr, nullptr, nullptr, nullptr, nullptr),
+        rocblas_status_invalid_handle);
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_get_device_memory_stats(handle, nullptr, &peak_in_use, &largest_free, &free_blocks),
+        rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_get_device_memory_stats(handle, &in_use, nullptr, &largest_free, &free_blocks),
+        rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_get_device_memory_stats(handle, &in_use, &peak_in_use, nullptr, &free_blocks),
+        rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_get_device_memory_stats(handle, &in_use, &peak_in_use, &largest_free, nullptr),
+        rocblas_status_invalid_pointer);
+
+    // An explicit size is allocated by the mock, and is not grown on demand
+    CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_size(handle, 100));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{false, 4096}, {true, 128}}));
+    EXPECT_ROCBLAS_STATUS(borrow(1000), rocblas_status_memory_error);
+    EXPECT_TRUE(mock.take().empty());
+
+    // A failed allocation is reported, and the next request tries again
+    CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_size(handle, 0));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{false, 128}}));
+    mock.fail = true;
+    EXPECT_ROCBLAS_STATUS(borrow(64), rocblas_status_memory_error);
+    mock.fail = false;
+    CHECK_ROCBLAS_ERROR(borrow(64));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{true, 64}, {true, 64}}));
+
+    // Restoring hipMalloc and hipFree releases the memory to the mock
+    CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_allocator(handle, nullptr, nullptr, nullptr));
+    EXPECT_EQ(mock.take(), (std::vector<event>{{false, 64}}));
+    EXPECT_TRUE(mock.live.empty());
+
+    // Destroying the handle releases its memory to the mock
+    {
+        rocblas_handle h;
+        CHECK_ROCBLAS_ERROR(rocblas_create_handle(&h));
+        CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_allocator(h, mock.alloc, mock.free, &mock));
+        rocblas_device_malloc_base* mem = nullptr;
+        CHECK_ROCBLAS_ERROR(rocblas_device_malloc_alloc(h, &mem, 1, size_t(256)));
+        CHECK_ROCBLAS_ERROR(rocblas_device_malloc_free(mem));
+        CHECK_ROCBLAS_ERROR(rocblas_destroy_handle(h));
+    }
+    EXPECT_EQ(mock.take(), (std::vector<event>{{true, 256}, {false, 256}}));
+    EXPECT_TRUE(mock.live.empty());
+    EXPECT_EQ(mock.bad_frees, 0);
+}
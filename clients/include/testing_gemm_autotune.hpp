@@ -0,0 +1,138 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_gemm_autotune.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <cstdio>
+#include <map>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the gemm autotuner with mock solutions and a mock timer; no GPU is used. Checks that    *
+ * the candidates are timed for the configured number of trials, that the fastest candidate     *
+ * wins, that failed candidates are never selected, that winners are published for lookups      *
+ * without the lock, that the limits are honoured, and that exported results can be read back   *
+ * as a solution override table.                                                                *
+ * ============================================================================================ */
+inline void testing_gemm_autotune(const Arguments& arg)
+{
+    struct mock_solution
+    {
+        int index;
+    };
+    using tuner_t = rocblas_gemm_autotuner<mock_solution, 2>;
+
+    mock_solution solutions[] = {{10}, {11}, {12}, {13}};
+    std::vector<mock_solution*> all;
+    for(auto& s : solutions)
+        all.push_back(&s);
+
+    // Each signature differs only in M
+    auto problem = [](int64_t M) {
+        return rocblas_override_problem{
+            "f32_r", "f32_r", "f32_r", 'N', 'T', M, 64, 64, 1, M, 64, M, M, 0, 0, 0, 0};
+    };
+
+    // Mock timer: time of each solution index, where a negative time is a failure
+    std::map<int, double> times;
+    size_t                timed = 0, enumerated = 0;
+    auto                  time  = [&](mock_solution* s) {
+        ++timed;
+        return times[s->index];
+    };
+    auto select = [&](tuner_t& tuner, uint64_t M, const std::vector<mock_solution*>& candidates) {
+        return tuner.select(
+            {{M, 0}},
+            [&] {
+                ++enumerated;
+                return candidates;
+            },
+            [&] { return rocblas_override_row(problem(M)); },
+            time);
+    };
+
+    tuner_t tuner({3, 2, 3});
+
+    // The first trials calls time the 3 best candidates; afterwards the fastest is used
+    times = {{10, 3.0}, {11, 1.0}, {12, 2.0}, {13, 0.5}};
+    for(size_t trial = 0; trial < 2; ++trial)
+    {
+        auto selection = select(tuner, 100, all);
+        EXPECT_TRUE(selection.launched);
+        EXPECT_EQ(selection.solution, &solutions[2]);
+    }
+    EXPECT_EQ(enumerated, 1);
+    EXPECT_EQ(timed, 6);
+
+    EXPECT_EQ(tuner.winner({{100, 0}}), &solutions[1]);
+    auto selection = select(tuner, 100, all);
+    EXPECT_FALSE(selection.launched);
+    EXPECT_EQ(selection.solution, &solutions[1]);
+    EXPECT_EQ(timed, 6);
+
+    // A candidate which fails in any trial is never selected
+    times = {{10, 3.0}, {11, -1.0}, {12, 2.0}};
+    select(tuner, 200, all);
+    times[11] = 0.1;
+    select(tuner, 200, all);
+    EXPECT_EQ(select(tuner, 200, all).solution, &solutions[2]);
+
+    // A signature without candidates is enumerated once and never tuned
+    enumerated = 0;
+    EXPECT_EQ(select(tuner, 300, {}).solution, nullptr);
+    EXPECT_EQ(select(tuner, 300, {}).solution, nullptr);
+    EXPECT_EQ(enumerated, 1);
+    EXPECT_EQ(tuner.winner({{300, 0}}), nullptr);
+
+    // Signatures beyond max_signatures are not tuned
+    enumerated = timed = 0;
+    selection          = select(tuner, 400, all);
+    EXPECT_EQ(selection.solution, nullptr);
+    EXPECT_FALSE(selection.launched);
+    EXPECT_EQ(enumerated + timed, 0);
+
+    size_t signatures, tuned;
+    tuner.get_counts(signatures, tuned);
+    EXPECT_EQ(signatures, 3);
+    EXPECT_EQ(tuned, 2);
+
+    // The exported results are an override table pinning each winner to its signature
+    char path[] = "/tmp/rocblas-gemm-autotune-XXXXXX";
+    int  fd     = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    EXPECT_TRUE(tuner.export_results(path));
+
+    rocblas_solution_override_table table;
+    std::string                     error;
+    EXPECT_TRUE(table.read(path, error)) << error;
+    remove(path);
+
+    int row = table.match(problem(100));
+    ASSERT_GE(row, 0);
+    EXPECT_EQ(table.row(row).solution_index, 11);
+    row = table.match(problem(200));
+    ASSERT_GE(row, 0);
+    EXPECT_EQ(table.row(row).solution_index, 12);
+    EXPECT_EQ(table.match(problem(300)), -1);
+
+    // New limits apply to signatures seen after clear(), which also forgets the winners
+    tuner.clear();
+    EXPECT_EQ(tuner.winner({{100, 0}}), nullptr);
+    tuner.set_limits({1, 1, 1});
+    EXPECT_EQ(tuner.get_limits().candidates, 1);
+    timed     = 0;
+    selection = select(tuner, 100, all);
+    EXPECT_TRUE(selection.launched);
+    EXPECT_EQ(selection.solution, &solutions[0]);
+    EXPECT_EQ(timed, 1);
+    EXPECT_EQ(select(tuner, 100, all).solution, &solutions[0]);
+    EXPECT_EQ(select(tuner, 200, all).solution, nullptr);
+}
@@ -0,0 +1,210 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+/* ============================================================================================ *
+ * Test the handle pool, and with timing, compare the latency of rocblas_create_handle and      *
+ * rocblas_destroy_handle with rocblas_acquire_handle and rocblas_release_handle.               *
+ *   M           bytes of workspace borrowed by each request, or 0 for none                     *
+ *   iters       number of requests timed                                                       *
+ * ============================================================================================ */
+inline void testing_handle_pool(const Arguments& arg)
+{
+    int device;
+    CHECK_HIP_ERROR(hipGetDevice(&device));
+    hipStream_t stream;
+    CHECK_HIP_ERROR(hipStreamCreate(&stream));
+
+    // Start with an empty pool
+    CHECK_ROCBLAS_ERROR(rocblas_trim_handle_pool(device));
+    size_t idle, created, reused;
+    CHECK_ROCBLAS_ERROR(rocblas_get_handle_pool_stats(device, &idle, &created, &reused));
+
+#ifdef GOOGLE_TEST
+    rocblas_handle handle = nullptr, again = nullptr;
+    hipStream_t    bound;
+
+    EXPECT_ROCBLAS_STATUS(rocblas_acquire_handle(nullptr, stream), rocblas_status_invalid_handle);
+    EXPECT_ROCBLAS_STATUS(rocblas_release_handle(nullptr), rocblas_status_invalid_handle);
+    EXPECT_ROCBLAS_STATUS(rocblas_trim_handle_pool(-1), rocblas_status_invalid_value);
+    EXPECT_ROCBLAS_STATUS(rocblas_get_handle_pool_stats(device, &idle, nullptr, &reused),
+                          rocblas_status_invalid_pointer);
+    EXPECT_EQ(idle, 0);
+
+    // Borrow size bytes of workspace from the handle, and return it
+    auto borrow = [](rocblas_handle h, size_t size) {
+        rocblas_device_malloc_base* mem = nullptr;
+        CHECK_ROCBLAS_ERROR(rocblas_device_malloc_alloc(h, &mem, 1, size));
+        CHECK_ROCBLAS_ERROR(rocblas_device_malloc_free(mem));
+    };
+
+    // The largest free block of the handle's workspace
+    auto largest_free = [](rocblas_handle h) {
+        size_t in_use, peak_in_use, largest = 0, free_blocks;
+        EXPECT_EQ(
+            rocblas_get_device_memory_stats(h, &in_use, &peak_in_use, &largest, &free_blocks),
+            rocblas_status_success);
+        return largest;
+    };
+
+    // A handle is created when none is idle, and allocates its workspace when first needed
+    size_t created_before = created, reused_before = reused;
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&handle, stream));
+    CHECK_ROCBLAS_ERROR(rocblas_get_stream(handle, &bound));
+    EXPECT_EQ(bound, stream);
+    EXPECT_EQ(largest_free(handle), 0);
+    borrow(handle, 1024);
+    size_t workspace = largest_free(handle);
+    EXPECT_GE(workspace, 1024);
+
+    // Settings changed by a user are restored on release, and the workspace is kept
+    CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_device));
+    CHECK_ROCBLAS_ERROR(rocblas_set_atomics_mode(handle, rocblas_atomics_not_allowed));
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(handle));
+    CHECK_ROCBLAS_ERROR(rocblas_get_handle_pool_stats(device, &idle, &created, &reused));
+    EXPECT_EQ(idle, 1);
+    EXPECT_EQ(created, created_before + 1);
+
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&again, 0));
+    EXPECT_EQ(again, handle);
+    CHECK_ROCBLAS_ERROR(rocblas_get_stream(again, &bound));
+    EXPECT_EQ(bound, hipStream_t(0));
+    rocblas_pointer_mode pointer_mode;
+    rocblas_atomics_mode atomics_mode;
+    CHECK_ROCBLAS_ERROR(rocblas_get_pointer_mode(again, &pointer_mode));
+    CHECK_ROCBLAS_ERROR(rocblas_get_atomics_mode(again, &atomics_mode));
+    EXPECT_EQ(pointer_mode, rocblas_pointer_mode_host);
+    EXPECT_EQ(atomics_mode, rocblas_atomics_allowed);
+    EXPECT_EQ(largest_free(again), workspace);
+    CHECK_ROCBLAS_ERROR(rocblas_get_handle_pool_stats(device, &idle, &created, &reused));
+    EXPECT_EQ(idle, 0);
+    EXPECT_EQ(reused, reused_before + 1);
+
+    // A handle whose device memory was reconfigured is destroyed instead of pooled
+    CHECK_ROCBLAS_ERROR(rocblas_set_device_memory_size(again, 4096));
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(again));
+    CHECK_ROCBLAS_ERROR(rocblas_get_handle_pool_stats(device, &idle, &created, &reused));
+    EXPECT_EQ(idle, 0);
+
+    // A handle from rocblas_create_handle can be pooled, and trimming destroys idle handles
+    CHECK_ROCBLAS_ERROR(rocblas_create_handle(&handle));
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(handle));
+    CHECK_ROCBLAS_ERROR(rocblas_trim_handle_pool(device));
+    CHECK_ROCBLAS_ERROR(rocblas_get_handle_pool_stats(device, &idle, &created, &reused));
+    EXPECT_EQ(idle, 0);
+
+    // The checks of asynchronous check_numerics mode are read when the handle is released, and
+    // the next user of the handle does not get their aggregates
+    const rocblas_int    N     = 16;
+    float                alpha = 2;
+    host_vector<float>   hx(N);
+    device_vector<float> dx(N);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    for(rocblas_int i = 0; i < N; ++i)
+        hx[i] = std::numeric_limits<float>::quiet_NaN();
+    CHECK_HIP_ERROR(dx.transfer_from(hx));
+
+    ASSERT_EQ(setenv("ROCBLAS_CHECK_NUMERICS", "8", true), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&handle, stream));
+    ASSERT_EQ(unsetenv("ROCBLAS_CHECK_NUMERICS"), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_sscal(handle, N, &alpha, dx, 1));
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(handle));
+
+    size_t records = 0;
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&again, stream));
+    EXPECT_EQ(again, handle);
+    CHECK_ROCBLAS_ERROR(rocblas_get_check_numerics_records(again, &records, nullptr));
+    EXPECT_EQ(records, 0);
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(again));
+    CHECK_ROCBLAS_ERROR(rocblas_trim_handle_pool(device));
+
+    // The check_numerics sampling set by a user is restored on release, and the next user
+    // starts counting the calls checked from 0
+    ASSERT_EQ(setenv("ROCBLAS_CHECK_NUMERICS", "16", true), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&handle, stream));
+    ASSERT_EQ(unsetenv("ROCBLAS_CHECK_NUMERICS"), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_set_check_numerics_sampling(handle, 3, 2));
+    CHECK_ROCBLAS_ERROR(rocblas_sscal(handle, N, &alpha, dx, 1));
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(handle));
+
+    rocblas_int                           every, stride;
+    rocblas_check_numerics_sampling_stats stats;
+    CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&again, stream));
+    EXPECT_EQ(again, handle);
+    CHECK_ROCBLAS_ERROR(rocblas_get_check_numerics_sampling(again, &every, &stride));
+    CHECK_ROCBLAS_ERROR(rocblas_get_check_numerics_sampling_stats(again, &stats));
+    EXPECT_EQ(every, 100); // the default N of sampled mode
+    EXPECT_EQ(stride, 1);
+    EXPECT_EQ(stats.calls, 0);
+    EXPECT_EQ(stats.checked_calls, 0);
+    EXPECT_EQ(stats.failed_calls, 0);
+    CHECK_ROCBLAS_ERROR(rocblas_release_handle(again));
+    CHECK_ROCBLAS_ERROR(rocblas_trim_handle_pool(device));
+
+    // They are also read before a handle is destroyed
+    ASSERT_EQ(setenv("ROCBLAS_CHECK_NUMERICS", "8", true), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_create_handle(&handle));
+    ASSERT_EQ(unsetenv("ROCBLAS_CHECK_NUMERICS"), 0);
+    CHECK_ROCBLAS_ERROR(rocblas_sscal(handle, N, &alpha, dx, 1));
+    CHECK_ROCBLAS_ERROR(rocblas_destroy_handle(handle));
+#endif
+
+    if(arg.timing)
+    {
+        const int    iters = std::max(arg.iters, 1);
+        const size_t bytes = std::max(arg.M, 0);
+
+        // A request binds a handle to the stream and borrows workspace
+        auto request = [&](rocblas_handle h) {
+            rocblas_device_malloc_base* mem = nullptr;
+            if(bytes)
+            {
+                CHECK_ROCBLAS_ERROR(rocblas_device_malloc_alloc(h, &mem, 1, bytes));
+                CHECK_ROCBLAS_ERROR(rocblas_device_malloc_free(mem));
+            }
+        };
+
+        double create_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+        {
+            rocblas_handle h;
+            CHECK_ROCBLAS_ERROR(rocblas_create_handle(&h));
+            CHECK_ROCBLAS_ERROR(rocblas_set_stream(h, stream));
+            request(h);
+            CHECK_ROCBLAS_ERROR(rocblas_destroy_handle(h));
+        }
+        create_us = get_time_us_no_sync() - create_us;
+
+        // The first acquire creates the pooled handle, as a warm-up
+        rocblas_handle h;
+        CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&h, stream));
+        request(h);
+        CHECK_ROCBLAS_ERROR(rocblas_release_handle(h));
+
+        double acquire_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+        {
+            CHECK_ROCBLAS_ERROR(rocblas_acquire_handle(&h, stream));
+            request(h);
+            CHECK_ROCBLAS_ERROR(rocblas_release_handle(h));
+        }
+        acquire_us = get_time_us_no_sync() - acquire_us;
+        CHECK_ROCBLAS_ERROR(rocblas_trim_handle_pool(device));
+
+        rocblas_cout << "workspace_bytes,iters,create_destroy_us,acquire_release_us" << std::endl;
+        rocblas_cout << bytes << "," << iters << "," << create_us / iters << ","
+                     << acquire_us / iters << std::endl;
+    }
+
+    CHECK_HIP_ERROR(hipStreamDestroy(stream));
+}
@@ -0,0 +1,140 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_log_sampling.hpp"
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+
+/* ============================================================================================ *
+ * Test the sampling of the calls written to the trace and bench logs, and with timing, measure *
+ * the cost of each sampling decision on the CPU, compared with a hash table lookup. The calls  *
+ * have the arguments of a trace logged gemm.                                                   *
+ *   N           number of distinct sets of arguments the calls cycle through                  *
+ *   iters       number of calls decided in each mode                                           *
+ * ============================================================================================ */
+inline void testing_log_sampling(const Arguments& arg)
+{
+    const int shapes = std::max(arg.N, 1);
+    const int iters  = arg.timing ? std::max(arg.iters, 1) : 10000;
+
+    static constexpr char name[] = "rocblas_sgemm";
+    static const float    A[1]   = {};
+    const float           alpha = 1, beta = 0;
+
+    // Count the calls logged in a mode, and the nanoseconds per decision
+    auto run = [&](rocblas_log_sampling_mode mode, rocblas_int value, double& ns) {
+        rocblas_log_sampler sample;
+        sample.set(mode, value);
+        size_t logged = 0;
+        auto   start  = std::chrono::steady_clock::now();
+        for(int i = 0; i < iters; ++i)
+        {
+            rocblas_int m = i % shapes;
+            logged += sample(name, 'N', 'T', m, 64, 64, alpha, A, 64, A, 64, beta, A, 64);
+        }
+        ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                 .count()
+             / iters;
+        return logged;
+    };
+
+    double off_ns, nth_ns, first_ns, rate_ns;
+    size_t off      = run(rocblas_log_sampling_off, 0, off_ns);
+    size_t nth      = run(rocblas_log_sampling_every_nth, 7, nth_ns);
+    size_t first    = run(rocblas_log_sampling_first_k, 3, first_ns);
+    auto   rate_beg = std::chrono::steady_clock::now();
+    size_t rate     = run(rocblas_log_sampling_rate_limit, 1000, rate_ns);
+    double seconds  = std::chrono::duration<double>(std::chrono::steady_clock::now() - rate_beg)
+                         .count();
+
+    // Baseline: a hash table lookup of the gemm size, as a cache of solutions would do
+    std::unordered_map<uint64_t, int> table;
+    for(int m = 0; m < shapes; ++m)
+        table[(uint64_t(m) << 32) | 64] = m;
+    size_t found = 0;
+    auto   start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iters; ++i)
+        found += table.count((uint64_t(i % shapes) << 32) | 64);
+    double lookup_ns
+        = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+          / iters;
+
+#ifdef GOOGLE_TEST
+    // Each shape is logged the first 3 times it is seen
+    size_t first_expected = 0;
+    for(int m = 0; m < shapes; ++m)
+        first_expected += std::min(3, iters / shapes + (m < iters % shapes));
+
+    EXPECT_EQ(off, size_t(iters));
+    EXPECT_EQ(nth, size_t((iters + 6) / 7));
+    EXPECT_EQ(first, first_expected);
+    EXPECT_EQ(found, size_t(iters));
+
+    // The burst is logged at once, and afterwards at most the rate
+    EXPECT_GE(rate, size_t(std::min(iters, 1000)));
+    EXPECT_LE(rate, size_t(1000 + 1000 * seconds + 1));
+
+    // A bucket which was full while idle has no more than the rate to spend on the next burst
+    {
+        rocblas_log_sampler sample;
+        sample.set(rocblas_log_sampling_rate_limit, 100);
+        EXPECT_TRUE(sample(name, 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        size_t burst = 0;
+        for(int i = 0; i < 1000; ++i)
+            burst += sample(name, 1);
+        EXPECT_GE(burst, 99);
+        EXPECT_LE(burst, 100);
+    }
+
+    // Scalars which may be in device memory are hashed by their value only if it is on the
+    // host, so that the sampler never reads device memory
+    {
+        struct scalar_arg
+        {
+            const float* value;
+            const float* host_value() const
+            {
+                return value;
+            }
+        };
+        const float         one = 1, two = 2;
+        rocblas_log_sampler sample;
+        sample.set(rocblas_log_sampling_first_k, 1);
+        EXPECT_TRUE(sample(name, scalar_arg{&one}));
+        EXPECT_TRUE(sample(name, scalar_arg{&two}));
+        EXPECT_FALSE(sample(name, scalar_arg{&one}));
+        EXPECT_TRUE(sample(name, scalar_arg{nullptr}));
+        EXPECT_FALSE(sample(name, scalar_arg{nullptr}));
+    }
+
+    // The handle API sets both samplers, and rejects values which are not positive
+    rocblas_local_handle      handle;
+    rocblas_log_sampling_mode mode;
+    rocblas_int               value;
+    EXPECT_ROCBLAS_STATUS(rocblas_set_log_sampling(handle, rocblas_log_sampling_first_k, 0),
+                          rocblas_status_invalid_value);
+    CHECK_ROCBLAS_ERROR(rocblas_set_log_sampling(handle, rocblas_log_sampling_first_k, 5));
+    CHECK_ROCBLAS_ERROR(rocblas_get_log_sampling(handle, &mode, &value));
+    EXPECT_EQ(mode, rocblas_log_sampling_first_k);
+    EXPECT_EQ(value, 5);
+    CHECK_ROCBLAS_ERROR(rocblas_set_log_sampling(handle, rocblas_log_sampling_off, 0));
+#endif
+
+    if(arg.timing)
+    {
+        rocblas_cout << "shapes,iters,off_ns,every_nth_ns,first_k_ns,rate_limit_ns,lookup_ns"
+                     << std::endl;
+        rocblas_cout << shapes << "," << iters << "," << off_ns << "," << nth_ns << ","
+                     << first_ns << "," << rate_ns << "," << lookup_ns << std::endl;
+    }
+}
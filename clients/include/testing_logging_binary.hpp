@@ -0,0 +1,90 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+/* ============================================================================================ *
+ * Test binary logging, and with timing, compare the per-call cost of trace and bench logging   *
+ * as text and as binary records. The calls are scal with n = 0, which logs its arguments and   *
+ * returns without launching a kernel.                                                          *
+ *   iters       number of calls timed in each mode                                             *
+ * ============================================================================================ */
+template <typename T>
+void testing_logging_binary(const Arguments& arg)
+{
+    static std::string exe_dir = rocblas_exepath();
+
+    // The binary log is opened by the first handle which enables it, and is shared by all
+    // handles in the process, so its path does not depend on the precision
+    std::string binary_path = exe_dir + "binary_log.bin";
+    std::string trace_path  = exe_dir + "binary_log_trace.csv";
+    std::string bench_path  = exe_dir + "binary_log_bench.txt";
+
+    int setenv_status = setenv("ROCBLAS_LOG_BINARY_PATH", binary_path.c_str(), true)
+                        | setenv("ROCBLAS_LOG_TRACE_PATH", trace_path.c_str(), true)
+                        | setenv("ROCBLAS_LOG_BENCH_PATH", bench_path.c_str(), true);
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+
+    device_vector<T> dx(1);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    T alpha = 1;
+
+    // Time calls with ROCBLAS_LAYER set to layer, returning the time per call
+    auto time_calls = [&](const char* layer, int iters) {
+        setenv("ROCBLAS_LAYER", layer, true);
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+
+        // Warm up, which sends the strings of binary records
+        CHECK_ROCBLAS_ERROR(rocblas_scal<T>(handle, 0, &alpha, dx, 1));
+
+        double time_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+            rocblas_scal<T>(handle, 0, &alpha, dx, 1);
+        return (get_time_us_no_sync() - time_us) / iters;
+    };
+
+    // Binary trace, bench and profile logging
+    time_calls("15", 1);
+
+    // The binary log starts with its magic, which is written when it is opened
+    std::ifstream binary_ifs(binary_path, std::ios::binary);
+    char          magic[8] = {};
+    binary_ifs.read(magic, sizeof(magic));
+
+#ifdef GOOGLE_TEST
+    EXPECT_EQ(std::memcmp(magic, "RBBINLOG", sizeof(magic)), 0);
+#endif
+
+    if(arg.timing)
+    {
+        const int iters = std::max(arg.iters, 1);
+
+        double none_us   = time_calls("0", iters);
+        double text_us   = time_calls("3", iters);
+        double binary_us = time_calls("11", iters);
+
+        rocblas_cout << "iters,no_logging_us,text_logging_us,binary_logging_us" << std::endl;
+        rocblas_cout << iters << "," << none_us << "," << text_us << "," << binary_us
+                     << std::endl;
+    }
+
+    setenv_status = setenv("ROCBLAS_LAYER", "0", true);
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+}
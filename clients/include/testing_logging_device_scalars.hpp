@@ -0,0 +1,149 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/* ============================================================================================ *
+ * Test the logging of scalars in device memory with ROCBLAS_LOG_DEVICE_SCALARS, also deferred  *
+ * with sampling of the first calls, and with timing, compare the host time per call of scal in *
+ * device pointer mode with trace and bench logging, when alpha is copied to the host, deferred *
+ * and logged by its address.                                                                   *
+ *   N           number of elements of the vector                                               *
+ *   iters       number of calls timed in each mode                                             *
+ * ============================================================================================ */
+template <typename T>
+void testing_logging_device_scalars(const Arguments& arg)
+{
+    static std::string exe_dir = rocblas_exepath();
+
+    const rocblas_int N          = std::max(arg.N, 1);
+    const std::string name       = std::is_same<T, float>{} ? "rocblas_sscal" : "rocblas_dscal";
+    const std::string trace_path = exe_dir + name + "_device_scalars_trace.csv";
+    const std::string bench_path = exe_dir + name + "_device_scalars_bench.txt";
+
+    int setenv_status = setenv("ROCBLAS_LOG_TRACE_PATH", trace_path.c_str(), true)
+                        | setenv("ROCBLAS_LOG_BENCH_PATH", bench_path.c_str(), true)
+                        | setenv("ROCBLAS_LAYER", "3", true);
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+
+    T                alpha = 2;
+    device_vector<T> dx(N);
+    device_vector<T> d_alpha(1);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    CHECK_DEVICE_ALLOCATION(d_alpha.memcheck());
+    CHECK_HIP_ERROR(hipMemcpy(d_alpha, &alpha, sizeof(T), hipMemcpyHostToDevice));
+
+    // Call scal iters times with ROCBLAS_LOG_DEVICE_SCALARS set to mode, returning the host
+    // time per call; the handle's destructor waits for the deferred lines to be written
+    auto time_calls = [&](const char* mode, int iters) {
+        setenv("ROCBLAS_LOG_DEVICE_SCALARS", mode, true);
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_device));
+
+        double time_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+            rocblas_scal<T>(handle, N, d_alpha, dx, 1);
+        return (get_time_us_no_sync() - time_us) / iters;
+    };
+
+#ifdef GOOGLE_TEST
+    // The lines are written by the logs' worker threads, so wait for the line of scal
+    auto find_line = [](const std::string& path, const std::string& text) {
+        for(int tries = 0; tries < 100; ++tries)
+        {
+            std::ifstream      ifs(path);
+            std::ostringstream contents;
+            contents << ifs.rdbuf();
+            if(contents.str().find(text) != std::string::npos)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+
+    rocblas_internal_ostream trace_value, bench_value, address;
+    trace_value << name << "," << N << "," << alpha << "," << (void*)dx << ",";
+    bench_value << "--alpha " << alpha << " ";
+    address << "device:" << (void*)d_alpha;
+
+    // Deferred lines hold the value of alpha, once the stream reaches the call
+    time_calls("1", 1);
+    EXPECT_TRUE(find_line(trace_path, trace_value.str())) << trace_value.str();
+    EXPECT_TRUE(find_line(bench_path, bench_value.str())) << bench_value.str();
+
+    // Sampling the first call of each set of arguments logs one deferred line for the calls of
+    // scal with y: the placeholders of alpha, which name different slots, are not hashed, and
+    // the calls not logged capture no slots, so that more calls than there are slots leave
+    // alpha to be captured for the next call logged
+    device_vector<T> dy(N);
+    CHECK_DEVICE_ALLOCATION(dy.memcheck());
+    {
+        setenv("ROCBLAS_LOG_DEVICE_SCALARS", "1", true);
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_device));
+        CHECK_ROCBLAS_ERROR(rocblas_set_log_sampling(handle, rocblas_log_sampling_first_k, 1));
+        for(int i = 0; i < 300; ++i)
+            CHECK_ROCBLAS_ERROR(rocblas_scal<T>(handle, N, d_alpha, dy, 1));
+        CHECK_ROCBLAS_ERROR(rocblas_scal<T>(handle, N, d_alpha, dy, 2));
+    }
+
+    rocblas_internal_ostream sampled_value, last_value;
+    sampled_value << name << "," << N << "," << alpha << "," << (void*)dy << ",1,";
+    last_value << name << "," << N << "," << alpha << "," << (void*)dy << ",2,";
+    EXPECT_TRUE(find_line(trace_path, last_value.str())) << last_value.str();
+    {
+        std::ifstream ifs(trace_path);
+        std::string   line;
+        int           sampled = 0;
+        while(std::getline(ifs, line))
+            sampled += line.find(sampled_value.str()) != std::string::npos;
+        EXPECT_EQ(sampled, 1);
+    }
+
+    // The address of alpha is logged in its place
+    time_calls("2", 1);
+    EXPECT_TRUE(find_line(trace_path, name + "," + std::to_string(N) + "," + address.str()));
+    EXPECT_TRUE(find_line(bench_path, "--alpha " + address.str()));
+
+    // By default, alpha is copied to the host
+    time_calls("0", 1);
+    EXPECT_TRUE(find_line(trace_path, trace_value.str())) << trace_value.str();
+    EXPECT_TRUE(find_line(bench_path, bench_value.str())) << bench_value.str();
+#endif
+
+    if(arg.timing)
+    {
+        const int iters = std::max(arg.iters, 1);
+
+        double copy_us     = time_calls("0", iters);
+        double deferred_us = time_calls("1", iters);
+        double pointer_us  = time_calls("2", iters);
+
+        rocblas_cout << "N,iters,copy_us,deferred_us,pointer_us" << std::endl;
+        rocblas_cout << N << "," << iters << "," << copy_us << "," << deferred_us << ","
+                     << pointer_us << std::endl;
+    }
+
+    setenv_status = setenv("ROCBLAS_LAYER", "0", true) | unsetenv("ROCBLAS_LOG_DEVICE_SCALARS");
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+}
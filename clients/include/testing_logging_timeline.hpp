@@ -0,0 +1,111 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/* ============================================================================================ *
+ * Test timeline logging, and with timing, compare the per-call cost of trace logging as text   *
+ * and as timeline events. The calls are scal with n = 0, which logs its arguments and returns  *
+ * without launching a kernel.                                                                  *
+ *   iters       number of calls timed in each mode                                             *
+ * ============================================================================================ */
+template <typename T>
+void testing_logging_timeline(const Arguments& arg)
+{
+    static std::string exe_dir = rocblas_exepath();
+
+    // The timeline log is opened by the first handle which enables it, and is shared by all
+    // handles in the process, so its path does not depend on the precision
+    std::string timeline_path = exe_dir + "timeline_log.json";
+    std::string trace_path    = exe_dir + "timeline_log_trace.csv";
+
+    int setenv_status = setenv("ROCBLAS_LOG_TIMELINE_PATH", timeline_path.c_str(), true)
+                        | setenv("ROCBLAS_LOG_TRACE_PATH", trace_path.c_str(), true);
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+
+    device_vector<T> dx(1);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    T alpha = 1;
+
+    // Time calls with ROCBLAS_LAYER set to layer, returning the time per call
+    auto time_calls = [&](const char* layer, int iters) {
+        setenv("ROCBLAS_LAYER", layer, true);
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+
+        double time_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+            rocblas_scal<T>(handle, 0, &alpha, dx, 1);
+        return (get_time_us_no_sync() - time_us) / iters;
+    };
+
+    // Trace logging written to the timeline
+    time_calls("33", 1);
+
+#ifdef GOOGLE_TEST
+    // The events are written by the log's worker thread, so wait for the scal event
+    const std::string name  = std::is_same<T, float>{} ? "rocblas_sscal" : "rocblas_dscal";
+    const std::string begin = "{\"name\":\"" + name + "\"";
+    std::string       log, event;
+    for(int tries = 0; tries < 100 && event.empty(); ++tries)
+    {
+        std::ifstream      timeline_ifs(timeline_path);
+        std::ostringstream contents;
+        contents << timeline_ifs.rdbuf();
+        log = contents.str();
+
+        // Each event is written whole, followed by the separator of the next event, if any
+        auto pos = log.find(begin);
+        if(pos != std::string::npos)
+            event = log.substr(pos, log.find('\n', pos) - pos);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // The log is a JSON array, and scal is a complete event with its trace arguments,
+    // while rocblas_set_pointer_mode, which is not timed, is an instant event
+    EXPECT_EQ(log.compare(0, 2, "[{"), 0);
+    EXPECT_NE(event.find("\"ph\":\"X\""), std::string::npos) << event;
+    EXPECT_NE(event.find("\"dur\":"), std::string::npos) << event;
+    EXPECT_NE(event.find("\"tid\":"), std::string::npos) << event;
+    EXPECT_NE(event.find("\"handle\":\"0x"), std::string::npos) << event;
+    EXPECT_NE(event.find("\"arguments\":\"0,"), std::string::npos) << event;
+    EXPECT_NE(log.find("{\"name\":\"rocblas_set_pointer_mode\""), std::string::npos);
+#endif
+
+    if(arg.timing)
+    {
+        const int iters = std::max(arg.iters, 1);
+
+        double none_us     = time_calls("0", iters);
+        double text_us     = time_calls("1", iters);
+        double timeline_us = time_calls("33", iters);
+
+        rocblas_cout << "iters,no_logging_us,trace_logging_us,timeline_logging_us" << std::endl;
+        rocblas_cout << iters << "," << none_us << "," << text_us << "," << timeline_us
+                     << std::endl;
+    }
+
+    setenv_status = setenv("ROCBLAS_LAYER", "0", true);
+
+#ifdef GOOGLE_TEST
+    ASSERT_EQ(setenv_status, 0);
+#endif
+}
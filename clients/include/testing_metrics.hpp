@@ -0,0 +1,169 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.hpp"
+#include "rocblas_test.hpp"
+#include "rocblas_vector.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the metrics counted for every call, and with timing, measure the cost per call of scal  *
+ * with n = 0, which counts the call and returns without launching a kernel.                    *
+ *   N           number of elements of the vector of the counted calls                         *
+ *   iters       number of calls timed                                                          *
+ * ============================================================================================ */
+template <typename T>
+void testing_metrics(const Arguments& arg)
+{
+    const rocblas_int N         = std::max(arg.N, 1);
+    const rocblas_int calls     = 10;
+    const char*       function  = std::is_same<T, float>{} ? "rocblas_sscal" : "rocblas_dscal";
+    const auto        precision = std::is_same<T, float>{} ? rocblas_datatype_f32_r
+                                                           : rocblas_datatype_f64_r;
+
+    // Metrics of the scal calls, summed over the entries of its name and precision
+    auto scal_metrics = [&] {
+        rocblas_function_metrics total{};
+        size_t                   count = 0;
+        CHECK_ROCBLAS_ERROR(rocblas_get_function_metrics(&count, nullptr));
+        std::vector<rocblas_function_metrics> metrics(count);
+        CHECK_ROCBLAS_ERROR(rocblas_get_function_metrics(&count, metrics.data()));
+        for(size_t i = 0; i < std::min(count, metrics.size()); ++i)
+            if(!strcmp(metrics[i].function, function) && metrics[i].precision == precision)
+            {
+                total.calls += metrics[i].calls;
+                total.size_sum += metrics[i].size_sum;
+                for(int b = 0; b < ROCBLAS_METRICS_SIZE_BUCKETS; ++b)
+                    total.size_buckets[b] += metrics[i].size_buckets[b];
+            }
+        return total;
+    };
+
+    device_vector<T> dx(N);
+    CHECK_DEVICE_ALLOCATION(dx.memcheck());
+    T alpha = 1;
+
+    auto before = scal_metrics();
+
+    // Calls of a thread which exits are counted, as are the calls of a live thread
+    auto scal_calls = [&] {
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+        for(int i = 0; i < calls; ++i)
+            CHECK_ROCBLAS_ERROR(rocblas_scal<T>(handle, N, &alpha, dx, 1));
+    };
+    std::thread(scal_calls).join();
+    scal_calls();
+
+    // Device memory size queries are not counted
+    {
+        rocblas_local_handle handle;
+        size_t               size;
+        CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+        rocblas_scal<T>(handle, N, &alpha, dx, 1);
+        CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &size));
+    }
+
+    // Calls with a null handle return rocblas_status_invalid_handle, and are not counted
+    T result;
+    EXPECT_ROCBLAS_STATUS(rocblas_scal<T>(nullptr, N, &alpha, dx, 1),
+                          rocblas_status_invalid_handle);
+    EXPECT_ROCBLAS_STATUS(rocblas_dot<T>(nullptr, N, dx, 1, dx, 1, &result),
+                          rocblas_status_invalid_handle);
+
+    auto after = scal_metrics();
+
+#ifdef GOOGLE_TEST
+    // The size of each call is N, in the bucket of the sizes up to the first power of 4 >= N
+    int bucket = 0;
+    while(bucket < ROCBLAS_METRICS_SIZE_BUCKETS - 1 && (uint64_t(1) << (2 * bucket)) < uint64_t(N))
+        ++bucket;
+
+    EXPECT_EQ(after.calls - before.calls, size_t(2 * calls));
+    EXPECT_EQ(after.size_buckets[bucket] - before.size_buckets[bucket], size_t(2 * calls));
+    EXPECT_EQ(after.size_sum - before.size_sum, 2.0 * calls * N);
+
+    // The count returned is the number of entries, whether or not they fit
+    size_t all = 0, count = 1;
+    CHECK_ROCBLAS_ERROR(rocblas_get_function_metrics(&all, nullptr));
+    rocblas_function_metrics one;
+    CHECK_ROCBLAS_ERROR(rocblas_get_function_metrics(&count, &one));
+    EXPECT_EQ(count, all);
+    EXPECT_ROCBLAS_STATUS(rocblas_get_function_metrics(nullptr, nullptr),
+                          rocblas_status_invalid_pointer);
+
+    // A NaN found by check_numerics is counted
+    size_t failures_before, failures_after;
+    CHECK_ROCBLAS_ERROR(rocblas_get_metrics(nullptr, nullptr, &failures_before));
+    {
+        setenv("ROCBLAS_CHECK_NUMERICS", "4", true); // rocblas_check_numerics_mode_fail
+        rocblas_local_handle handle;
+        unsetenv("ROCBLAS_CHECK_NUMERICS");
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+
+        host_vector<T> hx(N);
+        for(rocblas_int i = 0; i < N; ++i)
+            hx[i] = std::numeric_limits<T>::quiet_NaN();
+        CHECK_HIP_ERROR(dx.transfer_from(hx));
+        EXPECT_ROCBLAS_STATUS(rocblas_scal<T>(handle, N, &alpha, dx, 1),
+                              rocblas_status_check_numerics_fail);
+    }
+    CHECK_ROCBLAS_ERROR(rocblas_get_metrics(nullptr, nullptr, &failures_after));
+    EXPECT_GE(failures_after - failures_before, size_t(1));
+
+    // The export is in the Prometheus text format
+    char path[] = "/tmp/rocblas-metrics-XXXXXX";
+    int  fd     = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    CHECK_ROCBLAS_ERROR(rocblas_export_metrics(path));
+    std::ifstream      ifs(path);
+    std::ostringstream contents;
+    contents << ifs.rdbuf();
+    std::string exported = contents.str();
+    remove(path);
+
+    std::string labels = std::string("{function=\"") + function + "\",precision=\""
+                         + (std::is_same<T, float>{} ? "f32_r" : "f64_r") + "\"";
+    EXPECT_NE(exported.find("rocblas_calls_total" + labels + "} "), std::string::npos);
+    EXPECT_NE(exported.find("rocblas_call_size_bucket" + labels + ",le=\"+Inf\"} "),
+              std::string::npos);
+    EXPECT_NE(exported.find("rocblas_call_size_count" + labels + "} "), std::string::npos);
+    EXPECT_NE(exported.find("\nrocblas_workspace_reallocations_total "), std::string::npos);
+    EXPECT_NE(exported.find("\nrocblas_solutions_not_found_total "), std::string::npos);
+    EXPECT_NE(exported.find("\nrocblas_check_numerics_failures_total "), std::string::npos);
+    EXPECT_ROCBLAS_STATUS(rocblas_export_metrics(nullptr), rocblas_status_invalid_pointer);
+#endif
+
+    if(arg.timing)
+    {
+        const int            iters = std::max(arg.iters, 1);
+        rocblas_local_handle handle;
+        CHECK_ROCBLAS_ERROR(rocblas_set_pointer_mode(handle, rocblas_pointer_mode_host));
+
+        double time_us = get_time_us_no_sync();
+        for(int i = 0; i < iters; ++i)
+            rocblas_scal<T>(handle, 0, &alpha, dx, 1);
+        time_us = (get_time_us_no_sync() - time_us) / iters;
+
+        rocblas_cout << "N,iters,counted_calls,us_per_call" << std::endl;
+        rocblas_cout << N << "," << iters << "," << after.calls - before.calls << "," << time_us
+                     << std::endl;
+    }
+}
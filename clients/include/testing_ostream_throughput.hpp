@@ -0,0 +1,115 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test that the log lines written by many threads to one file are all written whole and in     *
+ * order, and with timing, measure the throughput of the lines written, when each line waits    *
+ * for its write, when it does not wait, and when the worker writes at an interval. This runs   *
+ * on the CPU only.                                                                             *
+ *   M           number of threads                                                              *
+ *   N           number of characters in each line                                              *
+ *   iters       number of lines written by each thread                                         *
+ * ============================================================================================ */
+inline void testing_ostream_throughput(const Arguments& arg)
+{
+    const int threads = std::max(arg.M, 1);
+    const int length  = std::max(arg.N, 32);
+    const int iters   = arg.timing ? std::max(arg.iters, 1) : 10000;
+
+    // Write the lines of all threads, returning the time, after checking the file
+    auto run = [&](const char* mode) {
+        char path[] = "/tmp/rocblas-XXXXXX";
+        int  fd     = mkstemp(path);
+        if(fd == -1)
+        {
+#ifdef GOOGLE_TEST
+            ADD_FAILURE() << "Cannot open temporary file " << path;
+#endif
+            return 0.0;
+        }
+
+        // Each file has its own worker, which reads the interval when it is created
+        bool interval = !strcmp(mode, "interval");
+        setenv("ROCBLAS_LOG_FLUSH_INTERVAL_MS", interval ? "5" : "0", true);
+        rocblas_internal_ostream os(fd);
+        close(fd);
+        unsetenv("ROCBLAS_LOG_FLUSH_INTERVAL_MS");
+
+        // Each line is the thread and line numbers, padded to the line length
+        auto thread_func = [&](int t) {
+            auto        thread_os = os.dup();
+            std::string padding(length - 24, 'x');
+            bool        async = !strcmp(mode, "async");
+            for(int i = 0; i < iters; ++i)
+            {
+                char numbers[25];
+                snprintf(numbers, sizeof(numbers), "%11d %11d ", t, i);
+                thread_os << numbers << padding << '\n';
+                if(async)
+                    thread_os.flush_async();
+                else
+                    thread_os.flush();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        double                   time_us = get_time_us_no_sync();
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back(thread_func, t);
+        for(auto& thread : pool)
+            thread.join();
+        os.fence();
+        time_us = get_time_us_no_sync() - time_us;
+
+        // Each line is whole, and the lines of each thread are in order
+        std::ifstream    is(path);
+        std::string      line;
+        std::vector<int> next(threads);
+        size_t           lines = 0;
+        bool             whole = true;
+        while(std::getline(is, line))
+        {
+            int t, i;
+            ++lines;
+            if(line.size() != size_t(length) || sscanf(line.c_str(), "%d %d", &t, &i) != 2
+               || t < 0 || t >= threads || i != next[t]++)
+                whole = false;
+        }
+        remove(path);
+
+#ifdef GOOGLE_TEST
+        EXPECT_EQ(lines, size_t(threads) * iters) << mode;
+        EXPECT_TRUE(whole) << mode;
+#endif
+        return time_us;
+    };
+
+    double sync_us     = run("sync");
+    double async_us    = run("async");
+    double interval_us = run("interval");
+
+    if(arg.timing)
+    {
+        double lines = double(threads) * iters;
+        rocblas_cout << "threads,length,iters,sync_lines_per_us,async_lines_per_us,"
+                        "interval_lines_per_us"
+                     << std::endl;
+        rocblas_cout << threads << "," << length << "," << iters << "," << lines / sync_us << ","
+                     << lines / async_us << "," << lines / interval_us << std::endl;
+    }
+}
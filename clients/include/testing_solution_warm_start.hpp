@@ -0,0 +1,96 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_solution_warm_start.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the warm start file of Tensile solution selections; no GPU is used. Checks that the     *
+ * library file is identified by its metadata, that a file survives a write and read, that a    *
+ * write merges with the entries already in the file, and that a file written for another      *
+ * library or architecture is ignored and replaced.                                             *
+ * ============================================================================================ */
+inline void testing_solution_warm_start(const Arguments& arg)
+{
+    using key_t     = std::array<uint64_t, 2>;
+    using entries_t = std::vector<std::pair<key_t, int64_t>>;
+
+    char dir[] = "/tmp/rocblas-warm-start-XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    const std::string library = std::string(dir) + "/TensileLibrary.dat";
+    const std::string path    = std::string(dir) + "/warm_start";
+
+    auto write_library = [&](const char* contents) {
+        FILE* fp = fopen(library.c_str(), "w");
+        ASSERT_NE(fp, nullptr);
+        fputs(contents, fp);
+        fclose(fp);
+    };
+    auto read = [&](const std::string& arch, uint64_t library_id) {
+        std::map<key_t, int64_t> entries;
+        int64_t                  count = rocblas_warm_start_read<2>(
+            path.c_str(), arch, library_id, [&](const key_t& key, int64_t index) {
+                entries[key] = index;
+            });
+        return std::make_pair(count, entries);
+    };
+
+    // The library is identified without reading it, and a rewrite of another size changes it
+    EXPECT_EQ(rocblas_warm_start_file_id(library.c_str()), 0);
+    write_library("solutions");
+    uint64_t id = rocblas_warm_start_file_id(library.c_str());
+    EXPECT_NE(id, 0);
+    EXPECT_EQ(rocblas_warm_start_file_id(library.c_str()), id);
+    write_library("more solutions");
+    uint64_t new_id = rocblas_warm_start_file_id(library.c_str());
+    EXPECT_NE(new_id, 0);
+    EXPECT_NE(new_id, id);
+
+    // A missing file is not read
+    EXPECT_EQ(read("gfx908", id).first, -1);
+
+    // A file survives a write and read
+    EXPECT_TRUE((rocblas_warm_start_write<2>(
+        path.c_str(), "gfx908", id, entries_t{{{1, 1}, 10}, {{2, 2}, 20}})));
+    auto first = read("gfx908", id);
+    EXPECT_EQ(first.first, 2);
+    EXPECT_EQ(first.second, (std::map<key_t, int64_t>{{{1, 1}, 10}, {{2, 2}, 20}}));
+
+    // A write keeps the entries already in the file, and the new selections take precedence
+    EXPECT_TRUE((rocblas_warm_start_write<2>(
+        path.c_str(), "gfx908", id, entries_t{{{2, 2}, 25}, {{3, 3}, 30}})));
+    auto merged = read("gfx908", id);
+    EXPECT_EQ(merged.first, 3);
+    EXPECT_EQ(merged.second,
+              (std::map<key_t, int64_t>{{{1, 1}, 10}, {{2, 2}, 25}, {{3, 3}, 30}}));
+
+    // A file of another architecture or library is ignored, and replaced by the next write
+    EXPECT_EQ(read("gfx90a", id).first, -1);
+    EXPECT_EQ(read("gfx908", new_id).first, -1);
+    EXPECT_TRUE(
+        (rocblas_warm_start_write<2>(path.c_str(), "gfx908", new_id, entries_t{{{4, 4}, 40}})));
+    auto replaced = read("gfx908", new_id);
+    EXPECT_EQ(replaced.first, 1);
+    EXPECT_EQ(replaced.second, (std::map<key_t, int64_t>{{{4, 4}, 40}}));
+    EXPECT_EQ(read("gfx908", id).first, -1);
+
+    // No temporary file is left behind
+    EXPECT_EQ(access((path + ".tmp." + std::to_string(getpid())).c_str(), F_OK), -1);
+
+    remove(path.c_str());
+    remove(library.c_str());
+    rmdir(dir);
+}
@@ -0,0 +1,153 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_workspace_allocator.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <vector>
+
+/* ============================================================================================ *
+ * Test the workspace sub-allocator over a host buffer; no GPU is used. Every allocated block   *
+ * is filled with its own pattern, to check that live blocks never overlap. Checks that blocks  *
+ * can be released in any order, that released neighbours are coalesced, that a released block  *
+ * is reused by an allocation of its size class, and that fragmentation is reported.            *
+ * ============================================================================================ */
+inline void testing_workspace_allocator(const Arguments& arg)
+{
+    constexpr size_t G        = rocblas_workspace_allocator::GRANULARITY;
+    constexpr size_t CAPACITY = 64 * G;
+
+    struct block_s
+    {
+        int           id;
+        size_t        offset, size;
+        unsigned char pattern;
+    };
+
+    std::vector<unsigned char>  buffer(CAPACITY);
+    rocblas_workspace_allocator workspace(CAPACITY + G / 2);
+    unsigned char               next_pattern = 0;
+
+    EXPECT_EQ(workspace.capacity(), CAPACITY);
+    EXPECT_EQ(workspace.largest_free(), CAPACITY);
+
+    // Allocate a block and fill it with a new pattern
+    auto allocate = [&](size_t size) {
+        block_s b{-1, 0, size, ++next_pattern};
+        b.id = workspace.allocate(size, b.offset);
+        if(b.id >= 0)
+        {
+            EXPECT_EQ(b.offset % G, 0);
+            EXPECT_LE(b.offset + size, CAPACITY);
+            std::fill_n(&buffer[b.offset], size, b.pattern);
+        }
+        return b;
+    };
+
+    // Check that a live block still holds its pattern, and release it
+    auto release = [&](const block_s& b) {
+        for(size_t i = 0; i < b.size; ++i)
+            if(buffer[b.offset + i] != b.pattern)
+            {
+                EXPECT_EQ(buffer[b.offset + i], b.pattern) << "at offset " << b.offset + i;
+                break;
+            }
+        workspace.release(b.id);
+    };
+
+    // Blocks released in the same order they were allocated
+    std::vector<block_s> blocks;
+    for(size_t size : {G, 3 * G, size_t(100), 8 * G, 2 * G})
+    {
+        blocks.push_back(allocate(size));
+        ASSERT_GE(blocks.back().id, 0);
+    }
+    EXPECT_EQ(workspace.in_use(), (1 + 3 + 2 + 8 + 2) * G);
+    for(auto& b : blocks)
+        release(b);
+    EXPECT_EQ(workspace.in_use(), 0);
+
+    // Coalescing leaves a single free block
+    auto stats = workspace.stats();
+    EXPECT_EQ(stats.free_blocks, 1);
+    EXPECT_EQ(stats.largest_free, CAPACITY);
+    EXPECT_EQ(stats.peak_in_use, 16 * G);
+    EXPECT_EQ(stats.fragmentation(), 0.0);
+
+    // Releasing every other block fragments the free memory
+    blocks.clear();
+    for(int i = 0; i < 8; ++i)
+    {
+        blocks.push_back(allocate(4 * G));
+        ASSERT_GE(blocks.back().id, 0);
+    }
+    for(int i = 0; i < 8; i += 2)
+        release(blocks[i]);
+
+    stats = workspace.stats();
+    EXPECT_EQ(stats.in_use, 16 * G);
+    EXPECT_EQ(stats.allocated_blocks, 4);
+    EXPECT_EQ(stats.free_blocks, 5);
+    EXPECT_EQ(stats.largest_free, CAPACITY - 32 * G);
+    EXPECT_GT(stats.fragmentation(), 0.0);
+
+    // A block of the size of a hole reuses the hole rather than splitting the largest block
+    block_s reused = allocate(4 * G);
+    ASSERT_GE(reused.id, 0);
+    EXPECT_LT(reused.offset, 32 * G);
+    EXPECT_EQ(workspace.largest_free(), CAPACITY - 32 * G);
+
+    // An allocation larger than the largest free block fails and changes nothing
+    size_t offset;
+    EXPECT_EQ(workspace.allocate(CAPACITY - 32 * G + 1, offset), -1);
+    EXPECT_EQ(workspace.stats().in_use, 20 * G);
+    block_s rest = allocate(CAPACITY - 32 * G);
+    ASSERT_GE(rest.id, 0);
+    EXPECT_EQ(rest.offset, 32 * G);
+    EXPECT_EQ(workspace.largest_free(), 4 * G);
+
+    // Releasing the remaining blocks in reverse and shuffled order coalesces everything
+    release(rest);
+    release(reused);
+    for(int i : {5, 1, 7, 3})
+        release(blocks[i]);
+
+    stats = workspace.stats();
+    EXPECT_EQ(stats.in_use, 0);
+    EXPECT_EQ(stats.allocated_blocks, 0);
+    EXPECT_EQ(stats.free_blocks, 1);
+    EXPECT_EQ(stats.largest_free, CAPACITY);
+
+    // Interleaved allocations and out-of-order releases never hand out overlapping blocks
+    blocks.clear();
+    unsigned seed = 1;
+    for(int step = 0; step < 2000; ++step)
+    {
+        seed = seed * 1103515245 + 12345;
+        if(blocks.size() < 16 && (seed >> 16) % 3)
+        {
+            block_s b = allocate(1 + (seed >> 8) % (6 * G));
+            if(b.id >= 0)
+                blocks.push_back(b);
+        }
+        else if(!blocks.empty())
+        {
+            size_t i = (seed >> 16) % blocks.size();
+            release(blocks[i]);
+            blocks.erase(blocks.begin() + i);
+        }
+    }
+    for(auto& b : blocks)
+        release(b);
+    EXPECT_EQ(workspace.stats().free_blocks, 1);
+    EXPECT_EQ(workspace.largest_free(), CAPACITY);
+
+    // Reset manages a new region; an empty region fails every allocation
+    workspace.reset(0);
+    EXPECT_EQ(workspace.allocate(G, offset), -1);
+    EXPECT_EQ(workspace.stats().fragmentation(), 0.0);
+}
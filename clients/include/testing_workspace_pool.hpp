@@ -0,0 +1,218 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_workspace_pool.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <vector>
+
+/* ============================================================================================ *
+ * Mock device operations for the shared workspace pool, where streams, events and allocators   *
+ * are integers and memory is host memory. Events record the stream they were last recorded on, *
+ * and waits are logged, so that the test can check which stream waited for which. The          *
+ * allocator of each live slab is kept, and frees are logged with their allocator and stream.   *
+ * ============================================================================================ */
+struct rocblas_mock_workspace_backend
+{
+    using stream_t    = int;
+    using event_t     = int;
+    using allocator_t = int;
+
+    struct state_s
+    {
+        bool                             fail = false;
+        std::map<void*, size_t>          live;
+        std::map<void*, int>             allocators; // ptr -> allocator
+        std::map<int, int>               recorded; // event -> stream
+        std::vector<std::pair<int, int>> waits; // (waiting stream, stream waited for)
+        std::vector<std::pair<int, int>> frees; // (allocator, stream)
+        int                              events = 0;
+    };
+
+    state_s* state;
+
+    bool alloc(void** ptr, size_t size, allocator_t allocator, stream_t stream)
+    {
+        if(state->fail || !(*ptr = malloc(size)))
+            return false;
+        state->live[*ptr]       = size;
+        state->allocators[*ptr] = allocator;
+        return true;
+    }
+    void free(void* ptr, size_t size, allocator_t allocator, stream_t stream)
+    {
+        EXPECT_EQ(state->live[ptr], size);
+        EXPECT_EQ(state->allocators[ptr], allocator);
+        state->live.erase(ptr);
+        state->allocators.erase(ptr);
+        state->frees.push_back({allocator, stream});
+        ::free(ptr);
+    }
+    event_t create_event()
+    {
+        return ++state->events;
+    }
+    void destroy_event(event_t event)
+    {
+        state->recorded.erase(event);
+    }
+    void record(event_t event, stream_t stream)
+    {
+        state->recorded[event] = stream;
+    }
+    void wait(stream_t stream, event_t event)
+    {
+        state->waits.push_back({stream, state->recorded.at(event)});
+    }
+};
+
+/* ============================================================================================ *
+ * Test the shared workspace pool with mock streams; no GPU is used. Checks that concurrent     *
+ * leases never alias, that a stream reuses its own memory without waiting, that reusing memory *
+ * returned on another stream waits for that stream, that slabs grow and are trimmed, that      *
+ * slabs are only leased and freed with the allocator which allocated them, and that the        *
+ * high-water mark and statistics are kept, also with many threads leasing at once.             *
+ * ============================================================================================ */
+inline void testing_workspace_pool(const Arguments& arg)
+{
+    using pool_t  = rocblas_workspace_pool<rocblas_mock_workspace_backend>;
+    using state_t = rocblas_mock_workspace_backend::state_s;
+    constexpr size_t MIN = pool_t::MIN_SLAB_SIZE;
+
+    state_t state;
+    {
+        pool_t pool(rocblas_mock_workspace_backend{&state});
+
+        // Concurrent leases get different slabs, rounded up to the slab size
+        auto a = pool.lease(1000, 1);
+        auto b = pool.lease(MIN + 1, 2);
+        ASSERT_GE(a.slab, 0);
+        ASSERT_GE(b.slab, 0);
+        EXPECT_NE(a.ptr, b.ptr);
+        EXPECT_EQ(a.size, MIN);
+        EXPECT_EQ(b.size, 2 * MIN);
+        EXPECT_TRUE(state.waits.empty());
+
+        auto stats = pool.stats();
+        EXPECT_EQ(stats.pool_bytes, 3 * MIN);
+        EXPECT_EQ(stats.leased_bytes, 3 * MIN);
+        EXPECT_EQ(stats.peak_leased_bytes, 3 * MIN);
+
+        // A stream gets back the memory it returned, without waiting
+        pool.release(a, 1);
+        pool.release(b, 2);
+        EXPECT_EQ(pool.stats().leased_bytes, 0);
+        auto again = pool.lease(100, 2);
+        EXPECT_EQ(again.ptr, b.ptr);
+        EXPECT_TRUE(state.waits.empty());
+
+        // Memory returned on another stream is reused after waiting for that stream
+        auto other = pool.lease(100, 3);
+        EXPECT_EQ(other.ptr, a.ptr);
+        EXPECT_EQ(state.waits, (std::vector<std::pair<int, int>>{{3, 1}}));
+        EXPECT_EQ(pool.stats().stream_waits, 1);
+        pool.release(again, 2);
+        pool.release(other, 3);
+
+        // A request larger than every free slab replaces the largest free slab
+        auto big = pool.lease(3 * MIN, 1);
+        ASSERT_GE(big.slab, 0);
+        EXPECT_EQ(big.size, 4 * MIN);
+        stats = pool.stats();
+        EXPECT_EQ(stats.pool_bytes, 5 * MIN);
+        EXPECT_EQ(stats.peak_leased_bytes, 4 * MIN);
+        EXPECT_EQ(state.live.size(), 2);
+
+        // A failed allocation fails the lease and leaves the statistics unchanged
+        state.fail  = true;
+        auto failed = pool.lease(8 * MIN, 1);
+        state.fail  = false;
+        EXPECT_EQ(failed.slab, -1);
+        EXPECT_EQ(failed.ptr, nullptr);
+        EXPECT_EQ(pool.stats().leases, stats.leases);
+
+        // Trimming frees only the slabs which are not leased
+        pool.trim();
+        EXPECT_EQ(pool.stats().pool_bytes, 4 * MIN);
+        EXPECT_EQ(state.live.size(), 1);
+        pool.release(big, 1);
+        pool.trim();
+        EXPECT_EQ(pool.stats().pool_bytes, 0);
+        EXPECT_TRUE(state.live.empty());
+    }
+
+    // Slabs of one allocator are not leased with another, and are freed with their allocator
+    {
+        pool_t pool(rocblas_mock_workspace_backend{&state});
+        state.frees.clear();
+
+        auto mine = pool.lease(1000, 1, 7);
+        ASSERT_GE(mine.slab, 0);
+        EXPECT_EQ(state.allocators[mine.ptr], 7);
+        pool.release(mine, 2);
+
+        auto other = pool.lease(1000, 2);
+        ASSERT_GE(other.slab, 0);
+        EXPECT_NE(other.ptr, mine.ptr);
+        EXPECT_EQ(state.allocators[other.ptr], 0);
+        pool.release(other, 2);
+
+        auto again = pool.lease(1000, 2, 7);
+        EXPECT_EQ(again.ptr, mine.ptr);
+        pool.release(again, 3);
+
+        // Trimming an allocator for a stream frees only its own slabs, on that stream once it
+        // waited for the stream which released them
+        state.waits.clear();
+        pool.trim(7, 4);
+        EXPECT_EQ(state.frees, (std::vector<std::pair<int, int>>{{7, 4}}));
+        EXPECT_EQ(state.waits, (std::vector<std::pair<int, int>>{{4, 3}}));
+        EXPECT_EQ(state.live.size(), 1);
+        EXPECT_EQ(pool.stats().pool_bytes, MIN);
+    }
+    EXPECT_EQ(state.frees.back(), (std::pair<int, int>{0, 2}));
+    EXPECT_TRUE(state.live.empty());
+
+    // Threads on their own streams lease, fill and check memory concurrently
+    {
+        constexpr int    NTHREAD = 8, ITERS = 500;
+        pool_t           pool(rocblas_mock_workspace_backend{&state});
+        std::atomic<int> aliased{0};
+
+        std::vector<std::thread> threads;
+        for(int t = 0; t < NTHREAD; ++t)
+            threads.emplace_back([&, t] {
+                for(int i = 0; i < ITERS; ++i)
+                {
+                    size_t size  = 1000 + (i * 7919 + t * 104729) % (3 * MIN);
+                    auto   lease = pool.lease(size, t);
+                    if(lease.slab < 0)
+                        continue;
+                    memset(lease.ptr, t, size);
+                    std::this_thread::yield();
+                    auto p = static_cast<unsigned char*>(lease.ptr);
+                    if(p[0] != t || p[size / 2] != t || p[size - 1] != t)
+                        ++aliased;
+                    pool.release(lease, t);
+                }
+            });
+        for(auto& t : threads)
+            t.join();
+
+        auto stats = pool.stats();
+        EXPECT_EQ(aliased, 0);
+        EXPECT_EQ(stats.leases, size_t(NTHREAD * ITERS));
+        EXPECT_EQ(stats.leased_bytes, 0);
+        EXPECT_LE(stats.peak_leased_bytes, NTHREAD * 4 * MIN);
+        EXPECT_LE(stats.pool_bytes, NTHREAD * 4 * MIN);
+    }
+    EXPECT_TRUE(state.live.empty());
+}
@@ -0,0 +1,103 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_workspace_profile.hpp"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+/* ============================================================================================ *
+ * Test the workspace profile, which records the peak workspace of each function; no GPU is     *
+ * used. Checks that only new peaks are reported, that a function is found by the address or    *
+ * the contents of its name, that a profile survives a write and read, that merging keeps the   *
+ * larger peak, and that a malformed profile is rejected without changing the recorded peaks.   *
+ * ============================================================================================ */
+inline void testing_workspace_profile(const Arguments& arg)
+{
+    rocblas_workspace_profile profile;
+    EXPECT_EQ(profile.peak_bytes(), 0);
+
+    // Only a larger number of bytes is a new peak
+    static const char gemv[] = "rocblas_gemv_template";
+    static const char trsm[] = "rocblas_internal_trsm_template_mem<128, false, float, float>";
+    EXPECT_TRUE(profile.record(gemv, 1024));
+    EXPECT_FALSE(profile.record(gemv, 512));
+    EXPECT_FALSE(profile.record(gemv, 1024));
+    EXPECT_TRUE(profile.record(gemv, 4096));
+    EXPECT_TRUE(profile.record(trsm, 1 << 20));
+    ASSERT_GE(profile.entries().size(), 2);
+    EXPECT_EQ(profile.entries().size(), 2);
+    EXPECT_EQ(profile.entries()[0].peak_bytes, 4096);
+    EXPECT_EQ(profile.entries()[0].key, gemv);
+    EXPECT_EQ(profile.peak_bytes(), 1 << 20);
+
+    // The same name at another address, as from another translation unit, is the same function
+    static const char gemv_copy[] = "rocblas_gemv_template";
+    EXPECT_TRUE(profile.record(gemv_copy, 8192));
+    EXPECT_EQ(profile.entries().size(), 2);
+    EXPECT_EQ(profile.entries()[0].peak_bytes, 8192);
+    EXPECT_EQ(profile.entries()[0].key, gemv_copy);
+
+    // Write the profile to a temporary file, and read it back
+    char path[] = "/tmp/rocblas_workspace_profile_XXXXXX";
+    int  fd     = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    EXPECT_TRUE(profile.write(path));
+
+    rocblas_workspace_profile read;
+    std::string               error;
+    EXPECT_TRUE(read.record(gemv, 1 << 16));
+    EXPECT_TRUE(read.read(path, error)) << error;
+    ASSERT_GE(read.entries().size(), 2);
+    EXPECT_EQ(read.entries().size(), 2);
+    EXPECT_EQ(read.entries()[0].name, gemv);
+    EXPECT_EQ(read.entries()[0].peak_bytes, 1 << 16); // the larger peak is kept
+    EXPECT_EQ(read.entries()[1].name, trsm);
+    EXPECT_EQ(read.entries()[1].peak_bytes, 1 << 20);
+    EXPECT_EQ(read.entries()[1].key, nullptr);
+
+    // Merging keeps the larger peak of each function
+    profile.merge(read);
+    EXPECT_EQ(profile.entries()[0].peak_bytes, 1 << 16);
+    EXPECT_EQ(profile.entries()[0].key, gemv_copy);
+    EXPECT_EQ(profile.peak_bytes(), 1 << 20);
+
+    // Blank lines and comments are ignored
+    auto write_file = [&](const char* contents) { std::ofstream(path) << contents; };
+    write_file("# rocBLAS workspace profile v1\n\n  # comment\n rocblas_scal  256 \r\n");
+    rocblas_workspace_profile commented;
+    EXPECT_TRUE(commented.read(path, error)) << error;
+    ASSERT_GE(commented.entries().size(), 1);
+    EXPECT_EQ(commented.entries()[0].name, "rocblas_scal");
+    EXPECT_EQ(commented.entries()[0].peak_bytes, 256);
+
+    // A malformed profile is rejected, and the recorded peaks are unchanged
+    for(const char* bad : {"rocblas_scal 256\n",
+                           "# rocBLAS workspace profile v1\nrocblas_dot 64\nrocblas_scal\n",
+                           "# rocBLAS workspace profile v1\nrocblas_scal -256\n",
+                           "# rocBLAS workspace profile v1\nrocblas_scal 256 bytes\n"})
+    {
+        write_file(bad);
+        error.clear();
+        EXPECT_FALSE(commented.read(path, error)) << bad;
+        EXPECT_FALSE(error.empty());
+        EXPECT_EQ(commented.entries().size(), 1);
+        EXPECT_EQ(commented.entries()[0].peak_bytes, 256);
+    }
+
+    // A missing profile is an error
+    unlink(path);
+    EXPECT_FALSE(commented.read(path, error));
+    EXPECT_EQ(commented.entries().size(), 1);
+
+    profile.clear();
+    EXPECT_TRUE(profile.entries().empty());
+    EXPECT_EQ(profile.peak_bytes(), 0);
+}
@@ -0,0 +1,250 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "../../library/src/include/rocblas_workspace_size.hpp"
+#include "rocblas.h"
+#include "rocblas_test.hpp"
+#include "utility.hpp"
+
+/* ============================================================================================ *
+ * Test the workspace sizes which functions request, which are computed on the host, and their  *
+ * planning with rocblas_plan_device_memory_size. Checks the sizes of reductions, gemv, trsv,   *
+ * trsm, trtri and gemm_ex against hand-computed values, that a plan returns the per-call and   *
+ * largest sizes, also of a sequence mixing gemm with trsm and of level 2 and 3 functions, that *
+ * it rejects calls it cannot plan, and that it agrees with a device memory size query.         *
+ * ============================================================================================ */
+inline void testing_workspace_size(const Arguments& arg)
+{
+    // Sizes are rounded up to multiples of 64 bytes, and a total rounds up each size
+    EXPECT_EQ(roundup_device_memory_size(0), 0);
+    EXPECT_EQ(roundup_device_memory_size(1), 64);
+    EXPECT_EQ(roundup_device_memory_size(64), 64);
+    EXPECT_EQ(rocblas_total_device_memory_size({1, 0, 65}), 192);
+
+    // Reductions need one partial result per block, plus one, for each problem
+    EXPECT_EQ(rocblas_reduction_workspace_size(1000, 1, 512, 4), 4 * 3);
+    EXPECT_EQ(rocblas_reduction_workspace_size(1025, 3, 512, 8), 8 * 4 * 3);
+    EXPECT_EQ(rocblas_reduction_workspace_size(0, 0, 512, 4), 4 * 2);
+    EXPECT_EQ(rocblas_dot_WIN(2), 8);
+    EXPECT_EQ(rocblas_dot_WIN(4), 4);
+    EXPECT_EQ(rocblas_dot_WIN(8), 2);
+    EXPECT_EQ(rocblas_dot_WIN(16), 2);
+
+    // gemv needs workspace only for transposed skinny matrices, with n below a crossover
+    const rocblas_operation N = rocblas_operation_none, T = rocblas_operation_transpose;
+    const rocblas_int       M = 1 << 20; // 1024 blocks of gemvt_sn
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f32_r, 4, N, M, 8, 1), 0);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f32_r, 4, T, M, 8, 2),
+              4 * 1024 * 8 * 2);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f32_r, 4, T, 2048 * 8 - 1, 8, 1),
+              0);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f64_r, 8, T, M, 128, 1), 0);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f64_r, 8, T, M, 127, 1),
+              8 * 1024 * 127);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f64_c, 16, T, M, 16, 1), 0);
+    EXPECT_EQ(rocblas_gemv_kernel_workspace_size(rocblas_datatype_f64_c, 16, T, M, 15, 1),
+              16 * 1024 * 15);
+
+    // trsv inverts diagonal blocks into invA, with a temporary shared by trtri and the solution
+    EXPECT_EQ((rocblas_trsv_workspace_size<128, false>(4, 256, 1, false).total()),
+              4 * 128 * 256 + 2 * 4 * 64 * 64);
+    EXPECT_EQ((rocblas_trsv_workspace_size<128, false>(4, 100, 1, false).total()),
+              4 * 128 * 100 + 4 * 16 * 128 * 2);
+    EXPECT_EQ((rocblas_trsv_workspace_size<128, true>(4, 256, 2, false).total()),
+              (4 * 128 * 256 + 2 * 4 * 64 * 64) * 2 + 2 * 64);
+    EXPECT_EQ((rocblas_trsv_workspace_size<128, false>(4, 256, 1, true).total()), 4 * 128);
+
+    // trsm solves for a chunk of B at a time when the order of A is a multiple of the block size,
+    // and for all of B otherwise; small problems are solved by substitution
+    auto left = rocblas_trsm_workspace_size<128, false>(8, rocblas_side_left, 256, 100, 1, false);
+    EXPECT_EQ(left.invA_bytes, 128 * 256 * 8);
+    EXPECT_EQ(left.x_c_temp_bytes, 128 * 100 * 8);
+    EXPECT_EQ(left.total(), 364544);
+    auto chunked
+        = rocblas_trsm_workspace_size<128, false>(8, rocblas_side_left, 256, 100, 1, false, true);
+    EXPECT_EQ(chunked.x_c_temp_bytes, 2 * 64 * 64 * 8);
+    EXPECT_LT(chunked.total(), left.total());
+    auto right
+        = rocblas_trsm_workspace_size<128, false>(8, rocblas_side_right, 256, 100, 1, false);
+    EXPECT_EQ(right.invA_bytes, 128 * 100 * 8);
+    EXPECT_EQ(right.x_c_temp_bytes, 256 * 100 * 8);
+    EXPECT_TRUE(rocblas_trsm_is_small(64, 64));
+    EXPECT_FALSE(rocblas_trsm_is_small(65, 64));
+
+    // A plan returns the workspace of each call and the largest
+    auto call = [](const char*       function,
+                   rocblas_datatype  type,
+                   rocblas_int       m,
+                   rocblas_int       n,
+                   rocblas_int       batch_count = 1,
+                   rocblas_operation trans       = rocblas_operation_none,
+                   rocblas_side      side        = rocblas_side_left) {
+        return rocblas_workspace_call{function, type, trans, side, m, n, batch_count};
+    };
+    const rocblas_workspace_call calls[] = {
+        call("dot", rocblas_datatype_f32_r, 0, 100000),
+        call("dot_batched", rocblas_datatype_bf16_r, 0, 100000, 4),
+        call("iamax_strided_batched", rocblas_datatype_f64_c, 0, 5000, 2),
+        call("nrm2", rocblas_datatype_f32_c, 0, 1000),
+        call("gemv_batched", rocblas_datatype_f32_r, M, 8, 2, T),
+        call("trsm", rocblas_datatype_f64_r, 256, 100),
+        call("trsm_batched", rocblas_datatype_f64_r, 256, 100, 2),
+        call("trsv_strided_batched", rocblas_datatype_f32_r, 100, 0, 1),
+        call("dot", rocblas_datatype_f32_r, 0, 0),
+    };
+    const size_t expected[] = {256, 448, 192, 64, 65536, 364544, 729216, 67584, 0};
+    constexpr size_t count  = sizeof(calls) / sizeof(*calls);
+
+    size_t sizes[count], max_size = 0;
+    CHECK_ROCBLAS_ERROR(rocblas_plan_device_memory_size(count, calls, sizes, &max_size));
+    for(size_t i = 0; i < count; ++i)
+        EXPECT_EQ(sizes[i], expected[i]) << calls[i].function;
+    EXPECT_EQ(max_size, 729216);
+    CHECK_ROCBLAS_ERROR(rocblas_plan_device_memory_size(count, calls, nullptr, &max_size));
+    EXPECT_EQ(max_size, 729216);
+    CHECK_ROCBLAS_ERROR(rocblas_plan_device_memory_size(0, nullptr, nullptr, &max_size));
+    EXPECT_EQ(max_size, 0);
+
+    // Calls which cannot be planned are rejected, leaving max_size unchanged
+    auto plan_one = [&](const rocblas_workspace_call& c) {
+        return rocblas_plan_device_memory_size(1, &c, nullptr, &max_size);
+    };
+    max_size = 1;
+    EXPECT_ROCBLAS_STATUS(rocblas_plan_device_memory_size(1, calls, sizes, nullptr),
+                          rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(rocblas_plan_device_memory_size(1, nullptr, sizes, &max_size),
+                          rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(plan_one(call(nullptr, rocblas_datatype_f32_r, 0, 1)),
+                          rocblas_status_invalid_pointer);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("gemm_ext2", rocblas_datatype_f32_r, 64, 64)),
+                          rocblas_status_not_implemented);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("_batched", rocblas_datatype_f32_r, 0, 1)),
+                          rocblas_status_not_implemented);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("dotc", rocblas_datatype_f32_r, 0, 1)),
+                          rocblas_status_invalid_value);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("trsm", rocblas_datatype_f16_r, 256, 256)),
+                          rocblas_status_invalid_value);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("trsm", rocblas_datatype_f32_r, -1, 256)),
+                          rocblas_status_invalid_size);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("gemv_batched", rocblas_datatype_f32_r, 64, 64, -1)),
+                          rocblas_status_invalid_size);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("gemm", rocblas_datatype_f32_r, 64, -1)),
+                          rocblas_status_invalid_size);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("trtri", rocblas_datatype_f32_r, 0, -1)),
+                          rocblas_status_invalid_size);
+    EXPECT_ROCBLAS_STATUS(plan_one(call("trmv", rocblas_datatype_f16_r, 100, 0)),
+                          rocblas_status_invalid_value);
+    EXPECT_EQ(max_size, 1);
+
+    // A sequence mixing gemm and level 1 functions, which use no workspace, with trsm needs the
+    // workspace of trsm; gemm_ex needs none unless it computes f16 or bf16 matrices in f32
+    auto gemm_ex = [&](const char* function, rocblas_datatype input_type) {
+        auto c       = call(function, rocblas_datatype_f32_r, 256, 256, 2);
+        c.input_type = input_type;
+        return c;
+    };
+    const rocblas_workspace_call sequence[] = {
+        call("gemm", rocblas_datatype_f64_r, 256, 100),
+        call("trsm", rocblas_datatype_f64_r, 256, 100),
+        call("gemm_strided_batched", rocblas_datatype_f16_r, 256, 100, 4),
+        call("axpy", rocblas_datatype_f32_r, 0, 1000),
+        call("rot_batched_ex", rocblas_datatype_f32_r, 0, 1000, 2),
+        gemm_ex("gemm_ex", rocblas_datatype_f32_r),
+        gemm_ex("gemm_batched_ex", rocblas_datatype(0)),
+        call("trsm_batched", rocblas_datatype_f64_r, 256, 100, 2),
+    };
+    const size_t     sequence_expected[] = {0, 364544, 0, 0, 0, 0, 0, 729216};
+    constexpr size_t sequence_count      = sizeof(sequence) / sizeof(*sequence);
+    size_t           sequence_sizes[sequence_count];
+    CHECK_ROCBLAS_ERROR(
+        rocblas_plan_device_memory_size(sequence_count, sequence, sequence_sizes, &max_size));
+    for(size_t i = 0; i < sequence_count; ++i)
+        EXPECT_EQ(sequence_sizes[i], sequence_expected[i]) << sequence[i].function;
+    EXPECT_EQ(max_size, 729216);
+
+    // gemm_ex of f16 or bf16 matrices in f32 is planned with a bound of the workspace of its
+    // solutions, 480 bytes per element of D rounded up to 256 bytes
+    EXPECT_EQ(rocblas_gemm_ex_hpa_workspace_bound(3, 3, 1), 4352);
+    EXPECT_EQ(rocblas_gemm_ex_hpa_workspace_bound(0, 3, 1), 0);
+    CHECK_ROCBLAS_ERROR(plan_one(gemm_ex("gemm_ex", rocblas_datatype_f16_r)));
+    EXPECT_EQ(max_size, 256 * 256 * 480);
+    CHECK_ROCBLAS_ERROR(plan_one(gemm_ex("gemm_strided_batched_ex", rocblas_datatype_bf16_r)));
+    EXPECT_EQ(max_size, 2 * 256 * 256 * 480);
+
+    // trmv, tpmv and tbmv copy x, and trtri needs temporary matrices once n exceeds twice its
+    // block size; their batched variants also need arrays of pointers
+    EXPECT_EQ(rocblas_trtri_temp_elements(ROCBLAS_TRTRI_NB, 32, 1), 0);
+    EXPECT_EQ(rocblas_trtri_temp_elements(ROCBLAS_TRTRI_NB, 100, 1), 2048);
+    EXPECT_EQ(rocblas_trtri_temp_elements(ROCBLAS_TRTRI_NB, 33, 2), 64);
+    const rocblas_workspace_call others[] = {
+        call("trmv", rocblas_datatype_f32_r, 100, 0),
+        call("tbmv_batched", rocblas_datatype_f64_r, 100, 0, 3),
+        call("tpmv_strided_batched", rocblas_datatype_f64_c, 100, 0, 3),
+        call("trtri", rocblas_datatype_f32_r, 0, 100),
+        call("trtri_batched", rocblas_datatype_f32_r, 0, 20, 2),
+        call("trtri_strided_batched", rocblas_datatype_f32_r, 0, 20, 2),
+        call("symv", rocblas_datatype_f32_r, 0, 100),
+        call("trmm_batched", rocblas_datatype_f64_r, 256, 256, 2),
+    };
+    const size_t     others_expected[] = {448, 2496, 4800, 8192, 64, 0, 0, 0};
+    constexpr size_t others_count      = sizeof(others) / sizeof(*others);
+    size_t           others_sizes[others_count];
+    CHECK_ROCBLAS_ERROR(
+        rocblas_plan_device_memory_size(others_count, others, others_sizes, &max_size));
+    for(size_t i = 0; i < others_count; ++i)
+        EXPECT_EQ(others_sizes[i], others_expected[i]) << others[i].function;
+    EXPECT_EQ(max_size, 8192);
+
+    // A plan agrees with a device memory size query of the same calls on a handle
+    rocblas_local_handle handle;
+    size_t               queried;
+    CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+    EXPECT_ROCBLAS_STATUS(rocblas_sdot(handle, 100000, nullptr, 1, nullptr, 1, nullptr),
+                          rocblas_status_size_increased);
+    CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &queried));
+    EXPECT_EQ(queried, expected[0]);
+
+    const float* A[1] = {nullptr};
+    float*       y[1] = {nullptr};
+    CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+    EXPECT_ROCBLAS_STATUS(
+        rocblas_sgemv_batched(handle, T, M, 8, nullptr, A, M, A, 1, nullptr, y, 1, 2),
+        rocblas_status_size_increased);
+    CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &queried));
+    EXPECT_EQ(queried, expected[4]);
+
+    CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+    EXPECT_ROCBLAS_STATUS(rocblas_strtri(handle,
+                                         rocblas_fill_upper,
+                                         rocblas_diagonal_non_unit,
+                                         100,
+                                         nullptr,
+                                         100,
+                                         nullptr,
+                                         100),
+                          rocblas_status_size_increased);
+    CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &queried));
+    EXPECT_EQ(queried, others_expected[3]);
+
+    CHECK_ROCBLAS_ERROR(rocblas_start_device_memory_size_query(handle));
+    EXPECT_ROCBLAS_STATUS(rocblas_dgemm(handle,
+                                        rocblas_operation_none,
+                                        rocblas_operation_none,
+                                        256,
+                                        100,
+                                        256,
+                                        nullptr,
+                                        nullptr,
+                                        256,
+                                        nullptr,
+                                        256,
+                                        nullptr,
+                                        nullptr,
+                                        256),
+                          rocblas_status_size_unchanged);
+    CHECK_ROCBLAS_ERROR(rocblas_stop_device_memory_size_query(handle, &queried));
+    EXPECT_EQ(queried, sequence_expected[0]);
+}
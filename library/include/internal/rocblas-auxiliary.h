@@ -20,9 +20,68 @@ extern "C" {
 ROCBLAS_EXPORT rocblas_status rocblas_create_handle(rocblas_handle* handle);
 
 /*! \brief destroy handle
+    \details
+    In asynchronous check_numerics mode, the checks which were not read yet are read and
+    reported first, waiting for the handle's stream. The handle is destroyed even if they
+    cannot be read, in which case rocblas_status_internal_error is returned.
  */
 ROCBLAS_EXPORT rocblas_status rocblas_destroy_handle(rocblas_handle handle);
 
+/*! \brief acquire a handle from the handle pool
+    \details
+    Returns an idle handle of the current device from a pool shared by the process, or a new
+    handle if none is idle, bound to stream. A pooled handle keeps its workspace and logging
+    streams, so acquiring it is much cheaper than rocblas_create_handle(). If the handle was last
+    used on another stream, stream waits for the work enqueued before it was released, without
+    blocking the host. Acquired handles have the settings of a new handle.
+    @param[out]
+    handle          pointer to the acquired handle
+    @param[in]
+    stream          [hipStream_t]
+                    the stream to bind the handle to
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_acquire_handle(rocblas_handle* handle, hipStream_t stream);
+
+/*! \brief release a handle to the handle pool
+    \details
+    Returns a handle acquired with rocblas_acquire_handle() or created with
+    rocblas_create_handle() to the pool of its device, for reuse by rocblas_acquire_handle().
+    The handle must not be used afterwards. A handle whose device memory was changed with
+    rocblas_set_device_memory_size(), rocblas_set_workspace(),
+    rocblas_set_device_memory_allocator() or rocblas_set_workspace_mode() is destroyed instead.
+    In asynchronous check_numerics mode, the checks which were not read yet are read and
+    reported, waiting for the handle's stream, and the aggregates of the checks are cleared.
+    Returns rocblas_status_internal_error, without releasing the handle, if they cannot be read.
+    The check_numerics sampling is restored to its default, and its counts are reset.
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle to release
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_release_handle(rocblas_handle handle);
+
+/*! \brief destroy the idle handles in the handle pool of a device
+    @param[in]
+    device          [int]
+                    the device whose idle handles are destroyed
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_trim_handle_pool(int device);
+
+/*! \brief get statistics of the handle pool of a device
+    @param[in]
+    device          [int]
+                    the device of the pool
+    @param[out]
+    idle            number of idle handles in the pool
+    @param[out]
+    created         number of handles created by rocblas_acquire_handle()
+    @param[out]
+    reused          number of handles acquired from the pool
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_handle_pool_stats(int     device,
+                                                            size_t* idle,
+                                                            size_t* created,
+                                                            size_t* reused);
+
 /*! \brief set stream for handle
  */
 ROCBLAS_EXPORT rocblas_status rocblas_set_stream(rocblas_handle handle, hipStream_t stream);
@@ -51,6 +110,118 @@ ROCBLAS_EXPORT rocblas_status rocblas_set_atomics_mode(rocblas_handle       hand
 ROCBLAS_EXPORT rocblas_status rocblas_get_atomics_mode(rocblas_handle        handle,
                                                        rocblas_atomics_mode* atomics_mode);
 
+/*! \brief set rocblas_gemm_autotune_mode
+     \details
+    When autotuning is on, the first times a gemm signature is seen by a handle with autotuning
+    on, the best candidate solutions are run and timed on the handle's stream, and afterwards the
+    fastest candidate is used for that signature. Timing synchronizes the stream. Calls are only
+    tuned if running a candidate more than once does not change their result, i.e. when beta is
+    zero or C and D are different matrices. Batched calls, whose matrices are given by arrays of
+    pointers in device memory, are only tuned when beta is zero, because whether their C and D
+    matrices are the same is not known on the host. Results are shared by all handles in the
+    process. Tuned solutions can be exported with rocblas_export_gemm_autotune_results().
+    Turning autotuning off destroys the events which rocBLAS created for timing.
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle of device
+    @param[in]
+    mode            [rocblas_gemm_autotune_mode]
+                    rocblas_gemm_autotune_off (default) or rocblas_gemm_autotune_on
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_gemm_autotune_mode(rocblas_handle             handle,
+                                                             rocblas_gemm_autotune_mode mode);
+
+/*! \brief get rocblas_gemm_autotune_mode
+ */
+ROCBLAS_EXPORT rocblas_status rocblas_get_gemm_autotune_mode(rocblas_handle              handle,
+                                                             rocblas_gemm_autotune_mode* mode);
+
+/*! \brief set rocblas_log_sampling_mode
+     \details
+    Selects which calls made with the handle are written to the trace and bench logs, to get
+    representative logs at a fraction of the cost of logging every call. Profile logging counts
+    every call regardless. The trace and bench logs are sampled separately, and setting the mode
+    forgets the calls seen so far. The default mode is set by the environment variables
+    ROCBLAS_LOG_SAMPLE_EVERY, ROCBLAS_LOG_SAMPLE_FIRST or ROCBLAS_LOG_RATE_LIMIT when the handle
+    is created, or is rocblas_log_sampling_off.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_value if
+    mode is invalid, or value is not positive and mode is not rocblas_log_sampling_off;
+    rocblas_status_success otherwise
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle of device
+    @param[in]
+    mode            [rocblas_log_sampling_mode]
+                    rocblas_log_sampling_off, rocblas_log_sampling_every_nth,
+                    rocblas_log_sampling_first_k or rocblas_log_sampling_rate_limit
+    @param[in]
+    value           [rocblas_int]
+                    N, K, or calls per second of each function, for the respective modes
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_log_sampling(rocblas_handle            handle,
+                                                       rocblas_log_sampling_mode mode,
+                                                       rocblas_int               value);
+
+/*! \brief get rocblas_log_sampling_mode and its value
+ */
+ROCBLAS_EXPORT rocblas_status rocblas_get_log_sampling(rocblas_handle             handle,
+                                                       rocblas_log_sampling_mode* mode,
+                                                       rocblas_int*               value);
+
+/*! \brief set the sampling of the calls and elements checked by check_numerics
+     \details
+    Selects which calls made with the handle are checked when its check_numerics mode, set by
+    the ROCBLAS_CHECK_NUMERICS environment variable when the handle is created, is not
+    rocblas_check_numerics_mode_no_check, to keep checking on at a bounded cost. Every Nth call
+    of each function is checked, starting with the first, and each check checks every Sth
+    element of a vector and every Sth column of a matrix. Setting the sampling forgets the
+    calls seen so far. The default is set by ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY, or 100, and
+    ROCBLAS_CHECK_NUMERICS_SAMPLE_STRIDE, or 1, when the mode includes
+    rocblas_check_numerics_mode_sampled, and is every call and element otherwise.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_value if
+    every or stride is not positive; rocblas_status_success otherwise
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle of device
+    @param[in]
+    every           [rocblas_int]
+                    N, the interval between the calls of each function which are checked
+    @param[in]
+    stride          [rocblas_int]
+                    S, the interval between the elements or columns which are checked
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_check_numerics_sampling(rocblas_handle handle,
+                                                                  rocblas_int    every,
+                                                                  rocblas_int    stride);
+
+/*! \brief get the sampling of the calls and elements checked by check_numerics
+ */
+ROCBLAS_EXPORT rocblas_status rocblas_get_check_numerics_sampling(rocblas_handle handle,
+                                                                  rocblas_int*   every,
+                                                                  rocblas_int*   stride);
+
+/*! \brief get the counts of the calls checked by check_numerics
+     \details
+    Returns the number of calls made with the handle which have checks, how many of them were
+    sampled and checked, and in how many a check found a NaN or an Inf. In asynchronous
+    check_numerics mode, the checks have not finished when a function returns, so the calls
+    in which a check failed are not counted; rocblas_get_check_numerics_records() returns the
+    failures.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_pointer
+    if stats is nullptr; rocblas_status_success otherwise
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle of device
+    @param[out]
+    stats           [rocblas_check_numerics_sampling_stats*]
+                    counts of the calls
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_check_numerics_sampling_stats(
+    rocblas_handle handle, rocblas_check_numerics_sampling_stats* stats);
+
 /*! \brief query the preferable supported int8 input layout for gemm
      \details
     Indicates the supported int8 input layout for gemm according to the device.
@@ -281,6 +452,206 @@ ROCBLAS_EXPORT rocblas_status rocblas_set_performance_metric(rocblas_handle
 ROCBLAS_EXPORT rocblas_status rocblas_get_performance_metric(rocblas_handle              handle,
                                                              rocblas_performance_metric* metric);
 
+/*! \brief returns the counters of the gemm solution selection cache
+     \details
+    rocBLAS caches the solution selected for each gemm problem signature, so that repeated
+    calls with the same sizes, strides, types, flags and performance metric skip solution
+    selection. The cache is shared by all handles in the process. Its capacity is set with the
+    ROCBLAS_TENSILE_SOLUTION_CACHE_SIZE environment variable (0 disables the cache).
+    Any of the output pointers may be nullptr.
+    @param[out]
+    hits        [size_t*]
+                number of lookups which found a cached solution
+    @param[out]
+    misses      [size_t*]
+                number of lookups which required solution selection
+    @param[out]
+    evictions   [size_t*]
+                number of entries replaced because the cache was full
+    @param[out]
+    entries     [size_t*]
+                number of entries currently in the cache
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_solution_cache_stats(size_t* hits,
+                                                               size_t* misses,
+                                                               size_t* evictions,
+                                                               size_t* entries);
+
+/*! \brief enables or disables the gemm solution selection cache
+     \details
+    Enabling has no effect if the cache was created with zero capacity.
+    @param[in]
+    enabled     [bool]
+                whether lookups and inserts use the cache
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_solution_cache_enabled(bool enabled);
+
+/*! \brief removes all entries from the gemm solution selection cache
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_clear_solution_cache(void);
+
+/*! \brief returns statistics of loading the Tensile library
+     \details
+    The library is read with ordinary file I/O, and is not memory-mapped, because Tensile
+    deserializes it from a private copy on the heap. One library is loaded for each GPU
+    architecture in use, and the statistics are summed over the libraries loaded. All outputs
+    are zero until a library is loaded.
+    Any of the output pointers may be nullptr.
+    @param[out]
+    load_us         [double*]
+                    time taken to read and deserialize the library, in microseconds
+    @param[out]
+    resident_bytes  [size_t*]
+                    growth of the process resident set size while loading the library
+    @param[out]
+    file_bytes      [size_t*]
+                    size of the library files
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_tensile_library_load_info(double* load_us,
+                                                                   size_t* resident_bytes,
+                                                                   size_t* file_bytes);
+
+/*! \brief sets the exploration limits of gemm autotuning
+     \details
+    The limits apply to gemm signatures seen for the first time after they are set. The defaults
+    are 4 candidates, 3 trials and 256 signatures.
+    @param[in]
+    candidates      [size_t]
+                    number of best candidate solutions timed for each signature
+    @param[in]
+    trials          [size_t]
+                    number of calls with a signature for which the candidates are timed
+    @param[in]
+    max_signatures  [size_t]
+                    signatures seen after this many signatures are not tuned
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_gemm_autotune_limits(size_t candidates,
+                                                               size_t trials,
+                                                               size_t max_signatures);
+
+/*! \brief returns the exploration limits of gemm autotuning
+     \details
+    Any of the output pointers may be nullptr.
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_gemm_autotune_limits(size_t* candidates,
+                                                               size_t* trials,
+                                                               size_t* max_signatures);
+
+/*! \brief writes the results of gemm autotuning to a file
+     \details
+    The file is a solution override table, which can be named by the
+    ROCBLAS_TENSILE_SOLUTION_OVERRIDES environment variable to use the tuned solutions without
+    tuning. The limits and the mean time of every candidate are written as comments. The results
+    are also written at exit to the file named by the ROCBLAS_GEMM_AUTOTUNE_EXPORT environment
+    variable, if it is set.
+    @param[in]
+    path            [const char*]
+                    name of the file to write
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_export_gemm_autotune_results(const char* path);
+
+/*! \brief returns the event counters of the rocBLAS metrics
+     \details
+    rocBLAS always counts its calls and a few events of interest, at the cost of a few
+    uncontended memory accesses per call, without any logging enabled. The counters are
+    kept by each thread and summed when they are read, and cover all handles and threads of
+    the process, including threads which have exited. Device memory size queries are not
+    counted.
+    Any of the output pointers may be nullptr.
+    @param[out]
+    workspace_reallocations [size_t*]
+                            number of times the device memory workspace of a handle was
+                            reallocated to make room for a function
+    @param[out]
+    solutions_not_found     [size_t*]
+                            number of gemm problems for which no Tensile solution was found
+    @param[out]
+    check_numerics_failures [size_t*]
+                            number of vectors or matrices in which check_numerics found a NaN
+                            or an Inf
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_metrics(size_t* workspace_reallocations,
+                                                  size_t* solutions_not_found,
+                                                  size_t* check_numerics_failures);
+
+/*! \brief returns the call counters of the rocBLAS metrics
+     \details
+    For each function and precision called, the number of calls, and a histogram of their
+    sizes, the product of their dimensions and batch count. The precision of _ex functions is
+    their execution or compute type.
+
+    On input, count is the number of elements of metrics, and on output, it is the number of
+    functions and precisions called. If metrics is nullptr, only the number is returned. The
+    functions are sorted by name and precision, and their names are valid while the library is
+    loaded.
+
+    Returns rocblas_status_invalid_pointer if count is nullptr; rocblas_status_success otherwise
+    @param[inout]
+    count           [size_t*]
+                    number of elements of metrics, and number of functions and precisions
+    @param[out]
+    metrics         [rocblas_function_metrics*]
+                    metrics of each function and precision
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_function_metrics(size_t*                   count,
+                                                           rocblas_function_metrics* metrics);
+
+/*! \brief writes the rocBLAS metrics to a file in the Prometheus text format
+     \details
+    The file is written under a temporary name and renamed, so that a reader such as the
+    textfile collector of the Prometheus node exporter never sees a partial file. The metrics
+    are also written at exit to the file named by the ROCBLAS_METRICS_EXPORT environment
+    variable, if it is set.
+
+    Returns rocblas_status_invalid_pointer if path is nullptr; rocblas_status_internal_error if
+    the file cannot be written; rocblas_status_success otherwise
+    @param[in]
+    path            [const char*]
+                    name of the file to write
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_export_metrics(const char* path);
+
+/*! \brief returns the aggregates of the checks of asynchronous check_numerics mode
+     \details
+    When the check_numerics mode of the handle, set by the ROCBLAS_CHECK_NUMERICS environment
+    variable when the handle is created, includes rocblas_check_numerics_mode_async, the checks
+    of the inputs and outputs of functions are recorded on the device without waiting for them.
+    This waits for the checks enqueued on the handle's stream so far, and returns the checks
+    since the aggregates were last cleared, aggregated by function and by inputs or outputs,
+    in the order in which they were first seen. The checks are also printed as they are read,
+    as the info and warn modes select. Functions do not return rocblas_status_check_numerics_fail
+    in this mode.
+
+    On input, count is the number of elements of records, and on output, it is the number of
+    aggregates. If records is nullptr, only the number is returned. The number is 0 if the
+    handle is not in asynchronous check_numerics mode.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_pointer
+    if count is nullptr; rocblas_status_internal_error if the checks cannot be read;
+    rocblas_status_success otherwise
+    @param[in]
+    handle          [rocblas_handle]
+                    the handle of device
+    @param[inout]
+    count           [size_t*]
+                    number of elements of records, and number of aggregates
+    @param[out]
+    records         [rocblas_check_numerics_record*]
+                    aggregates of the checks
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_check_numerics_records(
+    rocblas_handle handle, size_t* count, rocblas_check_numerics_record* records);
+
+/*! \brief clears the aggregates of the checks of asynchronous check_numerics mode
+     \details
+    The checks enqueued on the handle's stream so far are read, waiting for them, and
+    discarded with the aggregates.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_internal_error
+    if the checks cannot be read; rocblas_status_success otherwise
+     ********************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_clear_check_numerics_records(rocblas_handle handle);
+
 #ifdef __cplusplus
 }
 #endif
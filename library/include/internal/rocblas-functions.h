@@ -17060,6 +17060,30 @@ ROCBLAS_EXPORT const char* rocblas_status_to_string(rocblas_status status);
 
 ROCBLAS_EXPORT void rocblas_initialize(void);
 
+/*! \brief Start initializing rocBLAS on all HIP devices on a small pool of background threads.
+    \details
+    The Tensile library is loaded, and each device is initialized, on background threads, so that
+    an application can overlap rocBLAS startup with other work. rocBLAS functions called in the
+    meantime only wait for the parts of the initialization which they need.
+    Calling rocblas_initialize_async() more than once has no further effect.
+*/
+ROCBLAS_EXPORT rocblas_status rocblas_initialize_async(void);
+
+/*! \brief Wait for the initialization started by rocblas_initialize_async() to finish.
+    \details
+    Returns immediately if rocblas_initialize_async() has not been called.
+    Returns rocblas_status_internal_error if any part of the initialization failed.
+*/
+ROCBLAS_EXPORT rocblas_status rocblas_initialize_wait(void);
+
+/*! \brief Query whether the initialization started by rocblas_initialize_async() has finished.
+    \details
+    @param[out]
+    complete  [bool*]
+              true if rocblas_initialize_async() was called and all of its work has finished
+*/
+ROCBLAS_EXPORT rocblas_status rocblas_initialize_query(bool* complete);
+
 /*
  * ===========================================================================
  *    build information
@@ -17179,6 +17203,222 @@ ROCBLAS_EXPORT rocblas_status rocblas_set_workspace(rocblas_handle handle, void*
  ******************************************************************************/
 ROCBLAS_EXPORT bool rocblas_is_managing_device_memory(rocblas_handle handle);
 
+/*! \brief
+    \details
+    Sets the functions which allocate and free the device memory managed by the handle, instead of
+    hipMalloc and hipFree, so that the workspace can come from an application's memory pool.
+
+    Any previously allocated device memory managed by the handle is freed with the previous
+    functions, and the handle lets rocBLAS manage device memory in the future, allocating it with
+    alloc_fn when it is needed. Memory is allocated and freed on the handle's stream, and freed
+    memory may still be in use by work enqueued on the stream, so free_fn must not let it be
+    reused before that work completes. If both alloc_fn and free_fn are nullptr, hipMalloc and
+    hipFree are used again. In shared workspace mode, the memory of the pool which was allocated
+    with the previous functions and is not leased is freed, as it is when the handle is destroyed.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_pointer if
+    exactly one of alloc_fn and free_fn is nullptr; rocblas_status_success otherwise
+    @param[in]
+    handle          rocblas handle
+    @param[in]
+    alloc_fn        function which allocates device memory
+    @param[in]
+    free_fn         function which frees memory allocated by alloc_fn
+    @param[in]
+    context         pointer passed to alloc_fn and free_fn
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_device_memory_allocator(rocblas_handle           handle,
+                                                                  rocblas_device_malloc_fn alloc_fn,
+                                                                  rocblas_device_free_fn   free_fn,
+                                                                  void*                    context);
+
+/*! \brief
+    \details
+    Gets statistics of the device memory workspace of the handle, which rocBLAS functions split
+    into blocks that may be released in any order. The free memory may be fragmented into several
+    blocks, so that the largest allocation which can succeed without reallocating the workspace is
+    largest_free rather than the total free memory. The peak is reset when the workspace changes.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_pointer if
+    any of the other arguments is nullptr; rocblas_status_success otherwise
+    @param[in]
+    handle          rocblas handle
+    @param[out]
+    in_use          bytes of the workspace in use
+    @param[out]
+    peak_in_use     highest number of bytes of the workspace in use at once
+    @param[out]
+    largest_free    size in bytes of the largest free block of the workspace
+    @param[out]
+    free_blocks     number of free blocks of the workspace
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_device_memory_stats(rocblas_handle handle,
+                                                              size_t*        in_use,
+                                                              size_t*        peak_in_use,
+                                                              size_t*        largest_free,
+                                                              size_t*        free_blocks);
+
+/*! \brief
+    \details
+    Sets whether the handle keeps its own device memory workspace, or leases workspace from a pool
+    shared by all handles on its device in shared mode. A shared workspace is leased when a
+    rocBLAS function first needs device memory, and is returned to the pool when the function no
+    longer uses it, so that idle handles hold no device memory. A lease is never shared by two
+    handles at once, and memory returned by a handle on another stream is only reused after the
+    work enqueued on that stream before its return has completed.
+
+    Any device memory allocated by the handle is freed, and the handle lets rocBLAS manage device
+    memory in the future. The pool allocates memory with the functions set with
+    rocblas_set_device_memory_allocator for the handle which leases it, or hipMalloc, and memory
+    allocated with some functions is only leased to handles with the same functions and context.
+    Shared mode only applies while rocBLAS manages the device memory of the handle, so
+    rocblas_set_device_memory_size and rocblas_set_workspace take precedence over it. The default
+    mode is private, unless the environment variable ROCBLAS_SHARED_WORKSPACE is set to 1 when the
+    handle is created.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_value if
+    mode is invalid; rocblas_status_success otherwise
+    @param[in]
+    handle          rocblas handle
+    @param[in]
+    mode            rocblas_workspace_private or rocblas_workspace_shared
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_set_workspace_mode(rocblas_handle         handle,
+                                                         rocblas_workspace_mode mode);
+
+/*! \brief
+    \details
+    Gets whether the handle keeps its own device memory workspace, or leases it from a shared pool
+    @param[in]
+    handle          rocblas handle
+    @param[out]
+    mode            rocblas_workspace_private or rocblas_workspace_shared
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_workspace_mode(rocblas_handle          handle,
+                                                         rocblas_workspace_mode* mode);
+
+/*! \brief
+    \details
+    Gets statistics of the shared workspace pool of a device, which holds the device memory leased
+    by handles in rocblas_workspace_shared mode. A contention is a lease or return which waited for
+    another thread using the pool, and a stream wait is a lease which reuses memory last used on
+    another stream, so that the leasing stream waits for that stream's work before using it.
+
+    Returns rocblas_status_invalid_value if device is not a valid device;
+    rocblas_status_invalid_pointer if any of the other arguments is nullptr; rocblas_status_success
+    otherwise
+    @param[in]
+    device          device ID
+    @param[out]
+    pool_bytes      bytes of device memory held by the pool
+    @param[out]
+    peak_leased_bytes highest number of bytes leased at once
+    @param[out]
+    leases          number of leases
+    @param[out]
+    contentions     number of leases and returns which waited for another thread
+    @param[out]
+    stream_waits    number of leases which waited for work on another stream
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_shared_workspace_stats(int     device,
+                                                                 size_t* pool_bytes,
+                                                                 size_t* peak_leased_bytes,
+                                                                 size_t* leases,
+                                                                 size_t* contentions,
+                                                                 size_t* stream_waits);
+
+/*! \brief
+    \details
+    Frees the device memory of the shared workspace pool of a device which is not leased
+
+    Returns rocblas_status_invalid_value if device is not a valid device; rocblas_status_success
+    otherwise
+    @param[in]
+    device          device ID
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_trim_shared_workspace(int device);
+
+/*! \brief
+    \details
+    Gets the workspace profile of the handle: for each internal rocBLAS function which requested
+    device memory workspace from the handle, the peak number of bytes of workspace in use, including
+    the request, when it did. A workspace of at least the largest peak lets those functions run
+    without reallocating it.
+
+    On input, count is the number of elements of functions and peak_bytes, and on output, it is the
+    number of functions in the profile. If functions or peak_bytes is nullptr, only the number of
+    functions is returned. The function names are valid while the handle exists.
+
+    Returns rocblas_status_invalid_handle if handle is nullptr; rocblas_status_invalid_pointer if
+    count is nullptr; rocblas_status_success otherwise
+    @param[in]
+    handle          rocblas handle
+    @param[inout]
+    count           number of elements of functions and peak_bytes, and number of functions
+    @param[out]
+    functions       names of the functions
+    @param[out]
+    peak_bytes      peak bytes of workspace in use when each function requested workspace
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_get_workspace_profile(rocblas_handle handle,
+                                                            size_t*        count,
+                                                            const char**   functions,
+                                                            size_t*        peak_bytes);
+
+/*! \brief
+    \details
+    Writes the workspace profile of all handles in the process to a file, which can be named by
+    the environment variable ROCBLAS_WORKSPACE_PROFILE in later runs. When it is set, the profile
+    in the file is merged with the peaks seen in the process, new handles whose device memory is
+    managed by rocBLAS are created with a workspace large enough for the largest peak, and the
+    profile is written back to the file at exit.
+
+    Returns rocblas_status_invalid_pointer if path is nullptr; rocblas_status_internal_error if the
+    file cannot be written; rocblas_status_success otherwise
+    @param[in]
+    path            path of the file to write
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status rocblas_export_workspace_profile(const char* path);
+
+/*! \brief
+    \details
+    Plans the device memory workspace of a list of calls, without a handle or a device. For each
+    call, the size is the workspace the call requests, which is the size a device memory size query
+    of the call alone reports, or a bound of it, and max_size is the largest of them, which is a workspace size with
+    which all of the calls run without reallocating it. The workspace of a call depends only on
+    its function, type and dimensions, and not on the device.
+
+    Functions supported are dot, dotc, asum, nrm2, iamax, iamin, dot_ex, dotc_ex, nrm2_ex, gemv,
+    trsv, trsm, trmv, tpmv, tbmv, trtri and gemm_ex, and the other functions which use no
+    workspace: axpy, copy, scal, swap, rot, rotg, rotm, rotmg, axpy_ex, scal_ex, rot_ex, gbmv,
+    ger, gerc, geru, hbmv, hemv, her, her2, hpmv, hpr, hpr2, sbmv, spmv, spr, spr2, symv, syr,
+    syr2, tbsv, tpsv, dgmm, geam, gemm, hemm, her2k, herk, herkx, symm, syr2k, syrk, syrkx and
+    trmm, each with its _batched and _strided_batched variants. trsv and trsm are planned without
+    a supplied invA. gemm_ex of f16 or bf16 matrices with f32 execution uses workspace which
+    depends on the Tensile solution selected on the device, so it is planned with a bound of the
+    workspace of all of its solutions, which is larger than the size a query reports.
+
+    Returns rocblas_status_invalid_pointer if max_size or a function is nullptr, or if calls is
+    nullptr and count is not 0; rocblas_status_not_implemented if a function is unknown;
+    rocblas_status_invalid_value if a type is not supported by its function;
+    rocblas_status_invalid_size if m, n or batch_count of a function which is not a level 1
+    function is negative; rocblas_status_success otherwise. On error, the sizes of the calls
+    before the first call in error are set, and max_size is unchanged.
+    @param[in]
+    count           number of calls
+    @param[in]
+    calls           array of count calls
+    @param[out]
+    sizes           array of count sizes of workspace in bytes, or nullptr
+    @param[out]
+    max_size        largest size of workspace in bytes
+ ******************************************************************************/
+ROCBLAS_EXPORT rocblas_status
+    rocblas_plan_device_memory_size(size_t                        count,
+                                    const rocblas_workspace_call* calls,
+                                    size_t*                       sizes,
+                                    size_t*                       max_size);
+
 /*! \brief
     \details
     Abort function which safely flushes all IO
@@ -226,6 +226,39 @@ typedef enum rocblas_performance_metric_
     rocblas_cu_efficiency_performance_metric = 2
 } rocblas_performance_metric;
 
+/*! \brief Indicates whether gemm solutions are selected by timing candidate solutions online. */
+typedef enum rocblas_gemm_autotune_mode_
+{
+    /*! \brief Use the solution which Tensile selects */
+    rocblas_gemm_autotune_off = 0,
+    /*! \brief The first times a gemm signature is seen, time the best candidate solutions, and
+     * afterwards use the fastest */
+    rocblas_gemm_autotune_on = 1,
+} rocblas_gemm_autotune_mode;
+
+/*! \brief Indicates whether a handle keeps its own device memory workspace. */
+typedef enum rocblas_workspace_mode_
+{
+    /*! \brief The handle keeps its own workspace */
+    rocblas_workspace_private = 0,
+    /*! \brief The handle leases workspace from a pool shared by the handles on its device
+     * while a function uses it, and returns it afterwards */
+    rocblas_workspace_shared = 1,
+} rocblas_workspace_mode;
+
+/*! \brief Selects which calls are written to the trace and bench logs. */
+typedef enum rocblas_log_sampling_mode_
+{
+    /*! \brief Every call is logged */
+    rocblas_log_sampling_off = 0,
+    /*! \brief Every Nth call is logged */
+    rocblas_log_sampling_every_nth = 1,
+    /*! \brief The first K calls with each set of arguments are logged */
+    rocblas_log_sampling_first_k = 2,
+    /*! \brief At most R calls of each function are logged per second, in bursts of up to R */
+    rocblas_log_sampling_rate_limit = 3,
+} rocblas_log_sampling_mode;
+
 /*! \brief Indicates if layer is active with bitmask*/
 typedef enum rocblas_layer_mode_
 {
@@ -237,6 +270,12 @@ typedef enum rocblas_layer_mode_
     rocblas_layer_mode_log_bench = 0x2,
     /*! \brief Outputs a YAML description of each rocBLAS function called, along with its arguments and number of times it was called. */
     rocblas_layer_mode_log_profile = 0x4,
+    /*! \brief Writes the trace, bench and profile logs which are enabled as records in a binary file, which is decoded offline into the same logs. */
+    rocblas_layer_mode_log_binary = 0x8,
+    /*! \brief Adds a histogram of the host time, and of the device time when the handle has start and stop events, of each set of arguments to profile logging. */
+    rocblas_layer_mode_log_profile_timed = 0x10,
+    /*! \brief Writes trace logging as a Chrome trace JSON timeline, with an event spanning the host enter and exit times of each rocBLAS function call. */
+    rocblas_layer_mode_log_timeline = 0x20,
 } rocblas_layer_mode;
 
 /*! \brief Indicates if layer is active with bitmask*/
@@ -287,6 +326,104 @@ typedef enum rocblas_check_numerics_mode_
     //Return 'rocblas_status_check_numeric_fail' status if there is NaN or Inf
     rocblas_check_numerics_mode_fail = 0x4,
 
+    //Record the results of the checks on the device without waiting for them, to be read with
+    //rocblas_get_check_numerics_records; 'rocblas_status_check_numeric_fail' is not returned
+    rocblas_check_numerics_mode_async = 0x8,
+
+    //Check only every Nth call of each function, and every Sth element, as set by
+    //ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY and ROCBLAS_CHECK_NUMERICS_SAMPLE_STRIDE
+    rocblas_check_numerics_mode_sampled = 0x10,
+
 } rocblas_check_numerics_mode;
 
+/*! \brief Allocates size bytes of device memory for a handle's workspace, returning it in *ptr.
+ * context is the pointer passed to rocblas_set_device_memory_allocator(), and stream is the
+ * handle's stream. Returns rocblas_status_success, or rocblas_status_memory_error on failure. */
+typedef rocblas_status (*rocblas_device_malloc_fn)(void*       context,
+                                                   void**      ptr,
+                                                   size_t      size,
+                                                   hipStream_t stream);
+
+/*! \brief Frees device memory of size bytes returned by the matching rocblas_device_malloc_fn.
+ * Work enqueued on stream before the call may still use the memory. */
+typedef rocblas_status (*rocblas_device_free_fn)(void*       context,
+                                                 void*       ptr,
+                                                 size_t      size,
+                                                 hipStream_t stream);
+
+/*! \brief Describes a call of a rocBLAS function for rocblas_plan_device_memory_size(). Fields
+ * which the function does not take are ignored. */
+typedef struct rocblas_workspace_call_
+{
+    /*! \brief Name of the function as given to rocblas-bench -f, such as "trsm_batched" */
+    const char* function;
+    /*! \brief Type of the vectors and matrices, or the execution type of _ex functions */
+    rocblas_datatype type;
+    /*! \brief Operation on A, of gemv */
+    rocblas_operation trans;
+    /*! \brief Side of A, of trsm */
+    rocblas_side side;
+    /*! \brief Number of rows of A, or of B for trsm, or order of A for trsv, trmv, tpmv and
+     * tbmv */
+    rocblas_int m;
+    /*! \brief Number of columns of A, or of B for trsm, or order of A for trtri, or number of
+     * elements of vectors */
+    rocblas_int n;
+    /*! \brief Number of problems, of batched and strided batched functions */
+    rocblas_int batch_count;
+    /*! \brief Type of the matrices of gemm_ex, or 0 if it is type */
+    rocblas_datatype input_type;
+} rocblas_workspace_call;
+
+/*! \brief Number of buckets of the size histogram of rocblas_function_metrics */
+#define ROCBLAS_METRICS_SIZE_BUCKETS 17
+
+/*! \brief Metrics of the calls of a rocBLAS function with one precision, returned by
+ * rocblas_get_function_metrics(). The size of a call is the product of its dimensions and
+ * batch count. */
+typedef struct rocblas_function_metrics_
+{
+    /*! \brief Name of the function, such as "rocblas_sgemm" */
+    const char* function;
+    /*! \brief Precision of the function, or the execution or compute type of _ex functions */
+    rocblas_datatype precision;
+    /*! \brief Number of calls */
+    size_t calls;
+    /*! \brief Sum of the sizes of the calls */
+    double size_sum;
+    /*! \brief Number of calls of size at most 4^i in bucket i, except for the last bucket,
+     * which counts the larger calls; the counts are not cumulative */
+    size_t size_buckets[ROCBLAS_METRICS_SIZE_BUCKETS];
+} rocblas_function_metrics;
+
+/*! \brief Aggregate of the checks of the inputs or the outputs of a rocBLAS function in
+ * asynchronous check_numerics mode, returned by rocblas_get_check_numerics_records() */
+typedef struct rocblas_check_numerics_record_
+{
+    /*! \brief Name of the function, such as "rocblas_sgemm" */
+    const char* function;
+    /*! \brief 1 for the checks of the inputs of the function, 0 for its outputs */
+    int is_input;
+    /*! \brief Number of vectors and matrices checked */
+    size_t checks;
+    /*! \brief Number of them which had a NaN */
+    size_t has_NaN;
+    /*! \brief Number of them which had a zero */
+    size_t has_zero;
+    /*! \brief Number of them which had an Inf */
+    size_t has_Inf;
+} rocblas_check_numerics_record;
+
+/*! \brief Counts of the calls made with a handle whose vectors and matrices check_numerics
+ * checks, returned by rocblas_get_check_numerics_sampling_stats() */
+typedef struct rocblas_check_numerics_sampling_stats_
+{
+    /*! \brief Number of calls with checks, whether or not they were sampled */
+    size_t calls;
+    /*! \brief Number of calls which were sampled and checked */
+    size_t checked_calls;
+    /*! \brief Number of calls checked in which a check found a NaN or an Inf */
+    size_t failed_calls;
+} rocblas_check_numerics_sampling_stats;
+
 #endif
@@ -6,6 +6,7 @@
 
 #include "handle.hpp"
 #include "rocblas.h"
+#include "rocblas_workspace_size.hpp"
 #include "utility.hpp"
 #include <type_traits>
 #include <utility>
@@ -151,13 +152,6 @@ struct rocblas_default_value
     }
 };
 
-inline size_t rocblas_reduction_kernel_block_count(rocblas_int n, rocblas_int NB)
-{
-    if(n <= 0)
-        n = 1; // avoid sign loss issues
-    return size_t(n - 1) / NB + 1;
-}
-
 /*! \brief rocblas_reduction_batched_kernel_workspace_size
     Work area for reduction must be at lease sizeof(To) * (blocks + 1) * batch_count
 
@@ -171,12 +165,7 @@ inline size_t rocblas_reduction_kernel_block_count(rocblas_int n, rocblas_int NB
 template <rocblas_int NB, typename To>
 size_t rocblas_reduction_kernel_workspace_size(rocblas_int n, rocblas_int batch_count = 1)
 {
-    if(n <= 0)
-        n = 1; // allow for return value of empty set
-    if(batch_count <= 0)
-        batch_count = 1;
-    auto blocks = rocblas_reduction_kernel_block_count(n, NB);
-    return sizeof(To) * (blocks + 1) * batch_count;
+    return rocblas_reduction_workspace_size(n, batch_count, NB, sizeof(To));
 }
 
 /*! \brief rocblas_reduction_batched_kernel_workspace_size
@@ -58,7 +58,7 @@ extern "C" {
         rocblas_handle handle, rocblas_int n, const typei_* x, rocblas_int incx, typeo_* results) \
     try                                                                                           \
     {                                                                                             \
-        constexpr rocblas_int NB = 512;                                                           \
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;                                          \
         return rocblas_asum_impl<NB>(handle, n, x, incx, results);                                \
     }                                                                                             \
     catch(...)                                                                                    \
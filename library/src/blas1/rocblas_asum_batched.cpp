@@ -70,7 +70,7 @@ extern "C" {
                          typeo_*             result)                                   \
     try                                                                                \
     {                                                                                  \
-        constexpr rocblas_int NB = 512;                                                \
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;                               \
         return rocblas_asum_batched_impl<NB>(handle, n, x, incx, batch_count, result); \
     }                                                                                  \
     catch(...)                                                                         \
@@ -76,7 +76,7 @@ extern "C" {
                          typeo_*        results)                \
     try                                                         \
     {                                                           \
-        constexpr rocblas_int NB = 512;                         \
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;        \
         return rocblas_asum_strided_batched_impl<NB>(           \
             handle, n, x, incx, stridex, batch_count, results); \
     }                                                           \
@@ -299,26 +299,7 @@ size_t rocblas_dot_kernel_workspace_size(rocblas_int n, rocblas_int batch_count
 template <typename T>
 constexpr int rocblas_dot_WIN()
 {
-    size_t nb = sizeof(T);
-
-    int n = 8;
-    if(nb >= 8)
-        n = 2;
-    else if(nb >= 4)
-        n = 4;
-
-    return n;
-}
-
-constexpr int rocblas_dot_WIN(size_t nb)
-{
-    int n = 8;
-    if(nb >= 8)
-        n = 2;
-    else if(nb >= 4)
-        n = 4;
-
-    return n;
+    return rocblas_dot_WIN(sizeof(T));
 }
 
 // assume workspace has already been allocated, recommened for repeated calling of dot_strided_batched product
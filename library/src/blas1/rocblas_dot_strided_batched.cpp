@@ -12,7 +12,7 @@ namespace
 
     // HIP support up to 1024 threads/work itemes per thread block/work group
     // setting to 512 for gfx803.
-    constexpr int NB = 512;
+    constexpr int NB = ROCBLAS_REDUCTION_NB;
 
     template <bool, typename>
     constexpr char rocblas_dot_strided_batched_name[] = "unknown";
@@ -58,6 +58,13 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle,
+                    rocblas_dot_strided_batched_name<CONJ, T>,
+                    rocblas_datatype_from_type<T>,
+                    n,
+                    batch_count);
+
         size_t dev_bytes = rocblas_reduction_kernel_workspace_size<NB * WIN, T2>(n, batch_count);
         if(handle->is_device_memory_size_query())
         {
@@ -68,7 +75,7 @@ namespace
         }
 
         auto layer_mode     = handle->layer_mode;
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(layer_mode & rocblas_layer_mode_log_trace)
             log_trace(handle,
                       rocblas_dot_strided_batched_name<CONJ, T>,
@@ -32,9 +32,11 @@ namespace
                                                       rocblas_int*   result)
     {
         static constexpr bool        isbatched = true;
-        static constexpr int         NB        = 1024;
+        static constexpr int         NB        = ROCBLAS_IAMAX_IAMIN_NB;
         static constexpr rocblas_int shiftx_0  = 0;
 
+        rocblas_profile_timer profile_timer(handle);
+
         size_t         dev_bytes = 0;
         rocblas_status checks_status
             = rocblas_reduction_setup<NB, isbatched, rocblas_index_value_t<S>>(
@@ -53,7 +55,7 @@ namespace
             return checks_status;
         }
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input              = true;
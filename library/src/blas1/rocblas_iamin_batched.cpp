@@ -31,7 +31,9 @@ namespace
         static constexpr bool           isbatched = true;
         static constexpr rocblas_int    shiftx_0  = 0;
         static constexpr rocblas_stride stridex_0 = 0;
-        static constexpr int            NB        = 1024;
+        static constexpr int            NB        = ROCBLAS_IAMAX_IAMIN_NB;
+
+        rocblas_profile_timer profile_timer(handle);
 
         size_t         dev_bytes = 0;
         rocblas_status checks_status
@@ -51,7 +53,7 @@ namespace
             return checks_status;
         }
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input = true;
@@ -32,6 +32,8 @@ namespace
         static constexpr rocblas_int    batch_count_1 = 1;
         static constexpr rocblas_int    shiftx_0      = 0;
 
+        rocblas_profile_timer profile_timer(handle);
+
         size_t         dev_bytes = 0;
         rocblas_status checks_status
             = rocblas_reduction_setup<NB, isbatched, To>(handle,
@@ -49,7 +51,7 @@ namespace
             return checks_status;
         }
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input = true;
@@ -119,7 +121,7 @@ extern "C" {
         rocblas_handle handle, rocblas_int n, const typei_* x, rocblas_int incx, typeo_* results) \
     try                                                                                           \
     {                                                                                             \
-        constexpr rocblas_int NB = 512;                                                           \
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;                                          \
         return rocblas_nrm2_impl<NB>(handle, n, x, incx, results);                                \
     }                                                                                             \
     catch(...)                                                                                    \
@@ -33,6 +33,8 @@ namespace
         static constexpr rocblas_int    shiftx_0  = 0;
         static constexpr rocblas_stride stridex_0 = 0;
 
+        rocblas_profile_timer profile_timer(handle);
+
         size_t         dev_bytes = 0;
         rocblas_status checks_status
             = rocblas_reduction_setup<NB, isbatched, To>(handle,
@@ -50,7 +52,7 @@ namespace
             return checks_status;
         }
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input = true;
@@ -120,7 +122,7 @@ extern "C" {
                          typeo_*             result)                                   \
     try                                                                                \
     {                                                                                  \
-        constexpr rocblas_int NB = 512;                                                \
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;                               \
         return rocblas_nrm2_batched_impl<NB>(handle, n, x, incx, batch_count, result); \
     }                                                                                  \
     catch(...)                                                                         \
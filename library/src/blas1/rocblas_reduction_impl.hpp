@@ -138,6 +138,33 @@ void reduction_log_trace(rocblas_handle   handle,
     log_trace(handle, name, n, x, incx, batch_count);
 }
 
+template <bool ISBATCHED, typename Ti>
+void reduction_log_metrics(rocblas_handle handle,
+                           rocblas_int    n,
+                           const Ti*      x,
+                           rocblas_int    batch_count,
+                           const char*    name)
+{
+    if(ISBATCHED)
+    {
+        log_metrics(handle, name, rocblas_datatype_from_type<Ti>, n, batch_count);
+    }
+    else
+    {
+        log_metrics(handle, name, rocblas_datatype_from_type<Ti>, n);
+    }
+}
+
+template <bool ISBATCHED, typename Ti>
+void reduction_log_metrics(rocblas_handle   handle,
+                           rocblas_int      n,
+                           const Ti* const* x,
+                           rocblas_int      batch_count,
+                           const char*      name)
+{
+    log_metrics(handle, name, rocblas_datatype_from_type<Ti>, n, batch_count);
+}
+
 template <rocblas_int NB, bool ISBATCHED, typename Tw, typename U, typename Tr>
 inline rocblas_status rocblas_reduction_setup(rocblas_handle handle,
                                               rocblas_int    n,
@@ -169,6 +196,8 @@ inline rocblas_status rocblas_reduction_setup(rocblas_handle handle,
         }
     }
 
+    reduction_log_metrics<ISBATCHED>(handle, n, x, batch_count, name);
+
     auto layer_mode = handle->layer_mode;
     if(layer_mode & rocblas_layer_mode_log_trace)
     {
@@ -238,6 +267,8 @@ rocblas_status rocblas_reduction_impl(rocblas_handle handle,
                                       const char*    name,
                                       const char*    name_bench)
 {
+    rocblas_profile_timer profile_timer(handle);
+
     size_t         dev_bytes     = 0;
     rocblas_status checks_status = rocblas_reduction_setup<NB, ISBATCHED, Tw>(
         handle, n, x, incx, stridex, batch_count, results, name, name_bench, dev_bytes);
@@ -246,7 +277,7 @@ rocblas_status rocblas_reduction_impl(rocblas_handle handle,
         return checks_status;
     }
 
-    auto check_numerics = handle->check_numerics;
+    auto check_numerics = handle->begin_check_numerics();
 
     if(check_numerics)
     {
@@ -39,10 +39,13 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_rot_name<T, V>, rocblas_datatype_from_type<T>, n);
+
         RETURN_ZERO_DEVICE_MEMORY_SIZE_IF_QUERIED(handle);
 
         auto layer_mode     = handle->layer_mode;
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(layer_mode & rocblas_layer_mode_log_trace)
             log_trace(handle, rocblas_rot_name<T, V>, n, x, incx, y, incy, c, s);
         if(layer_mode & rocblas_layer_mode_log_bench)
@@ -192,6 +192,11 @@ rocblas_status rocblas_rotg_check_numerics_template(const char*    function_name
     if(!batch_count)
         return rocblas_status_success;
 
+    //In sampled mode, the checks of a call are skipped unless the call is sampled
+    auto& sampler = handle->check_numerics_sampler;
+    if(!sampler.sample(function_name))
+        return rocblas_status_success;
+
     //Creating structure host object
     rocblas_check_numerics_t h_abnormal;
 
@@ -250,6 +255,7 @@ rocblas_status rocblas_rotg_check_numerics_template(const char*    function_name
                 h_abnormal.has_Inf = true;
         }
     }
+    sampler.count(h_abnormal.has_NaN || h_abnormal.has_Inf);
     return rocblas_check_numerics_abnormal_struct(
         function_name, check_numerics, is_input, &h_abnormal);
 }
@@ -9,55 +9,12 @@
 #include "gemv_device.hpp"
 #include "handle.hpp"
 #include "rocblas_gemv_threshold.hpp"
-
-// gemvt_sn is skinny n matrix optimizations
-constexpr int rocblas_gemvt_sn_WIN()
-{
-    return 4;
-}
-
-constexpr int rocblas_gemvt_sn_NB()
-{
-    return 256;
-}
-inline size_t rocblas_gemvt_sn_kernel_block_count(rocblas_int m)
-{
-    if(m <= 0)
-        m = 1; // avoid sign loss issues
-    return size_t(m - 1) / (rocblas_gemvt_sn_NB() * rocblas_gemvt_sn_WIN()) + 1;
-}
-
-// gemvt_sn_crossover is n threshold to crossover back to normal (non-skinny) algorithm
-template <typename T>
-inline size_t rocblas_gemvt_sn_crossover()
-{
-    return 256;
-}
-template <>
-inline size_t rocblas_gemvt_sn_crossover<rocblas_double>()
-{
-    return 128;
-}
-template <>
-inline size_t rocblas_gemvt_sn_crossover<rocblas_float_complex>()
-{
-    return 64;
-}
-template <>
-inline size_t rocblas_gemvt_sn_crossover<rocblas_double_complex>()
-{
-    return 16;
-}
+#include "rocblas_workspace_size.hpp"
 
 template <typename T>
 inline bool rocblas_gemvt_skinny_n(rocblas_operation transA, rocblas_int m, rocblas_int n)
 {
-    size_t    cross_over_n    = rocblas_gemvt_sn_crossover<T>();
-    const int skinny_constant = 2048;
-    if(transA != rocblas_operation_none && n < cross_over_n && m >= skinny_constant * n)
-        return true;
-    else
-        return false;
+    return rocblas_gemvt_skinny_n(rocblas_datatype_from_type<T>, transA, m, n);
 }
 
 /*! \brief rocblas_internal_gemv_kernel_workspace_size
@@ -81,14 +38,8 @@ template <typename To>
 ROCBLAS_INTERNAL_EXPORT_NOINLINE size_t rocblas_internal_gemv_kernel_workspace_size(
     rocblas_operation transA, rocblas_int m, rocblas_int n, rocblas_int batch_count = 1)
 {
-    if(m <= 0 || n <= 0 || batch_count <= 0)
-        return 0;
-
-    if(!rocblas_gemvt_skinny_n<To>(transA, m, n))
-        return 0; // workspace only used for skinny n kernel transpose/conj. transpose
-
-    auto blocks = rocblas_gemvt_sn_kernel_block_count(m);
-    return sizeof(To) * blocks * n * batch_count;
+    return rocblas_gemv_kernel_workspace_size(
+        rocblas_datatype_from_type<To>, sizeof(To), transA, m, n, batch_count);
 }
 
 template <typename T, typename U, typename V, typename W>
@@ -41,13 +41,16 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_gemv_name<T>, rocblas_datatype_from_type<T>, m, n, batch_count);
+
         size_t dev_bytes
             = rocblas_internal_gemv_kernel_workspace_size<T>(transA, m, n, batch_count);
         if(handle->is_device_memory_size_query())
             return handle->set_optimal_device_memory_size(dev_bytes);
 
         auto layer_mode     = handle->layer_mode;
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(layer_mode
            & (rocblas_layer_mode_log_trace | rocblas_layer_mode_log_bench
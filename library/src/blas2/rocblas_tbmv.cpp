@@ -32,6 +32,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_tbmv_name<T>, rocblas_datatype_from_type<T>, m, k);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -107,7 +110,7 @@ namespace
         if(!mem)
             return rocblas_status_memory_error;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input = true;
@@ -33,6 +33,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_tbmv_name<T>, rocblas_datatype_from_type<T>, m, k, batch_count);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -126,7 +129,7 @@ namespace
         setup_batched_array<256>(
             handle->get_stream(), (T*)mem_x_copy, m, (T**)mem_x_copy_arr, batch_count);
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(check_numerics)
         {
             bool           is_input = true;
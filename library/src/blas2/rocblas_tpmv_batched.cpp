@@ -34,6 +34,10 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(
+            handle, rocblas_tpmv_batched_name<T>, rocblas_datatype_from_type<T>, m, batch_count);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -123,7 +127,7 @@ namespace
         if(!mem)
             return rocblas_status_memory_error;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(check_numerics)
         {
@@ -39,7 +39,14 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
-        auto check_numerics = handle->check_numerics;
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle,
+                    rocblas_tpmv_strided_batched_name<T>,
+                    rocblas_datatype_from_type<T>,
+                    m,
+                    batch_count);
+
+        auto check_numerics = handle->begin_check_numerics();
 
         if(!handle->is_device_memory_size_query())
         {
@@ -34,6 +34,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_trmv_name<T>, rocblas_datatype_from_type<T>, m);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -115,7 +118,7 @@ namespace
         if(!mem)
             return rocblas_status_memory_error;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(check_numerics)
         {
@@ -35,6 +35,10 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(
+            handle, rocblas_trmv_batched_name<T>, rocblas_datatype_from_type<T>, m, batch_count);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -131,7 +135,7 @@ namespace
 
         rocblas_stride stridew = m;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(check_numerics)
         {
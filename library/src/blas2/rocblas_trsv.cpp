@@ -10,8 +10,8 @@
 
 namespace
 {
-    constexpr rocblas_int STRSV_BLOCK = 128;
-    constexpr rocblas_int DTRSV_BLOCK = 128;
+    constexpr rocblas_int STRSV_BLOCK = ROCBLAS_TRSV_BLOCK;
+    constexpr rocblas_int DTRSV_BLOCK = ROCBLAS_TRSV_BLOCK;
 
     template <typename>
     constexpr char rocblas_trsv_name[] = "unknown";
@@ -40,6 +40,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_trsv_name<T>, rocblas_datatype_from_type<T>, m);
+
         auto layer_mode = handle->layer_mode;
         if(layer_mode & rocblas_layer_mode_log_trace)
             log_trace(handle, rocblas_trsv_name<T>, uplo, transA, diag, m, A, lda, B, incx);
@@ -128,7 +131,7 @@ namespace
         if(perf_status != rocblas_status_success && perf_status != rocblas_status_perf_degraded)
             return perf_status;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(check_numerics)
         {
@@ -677,15 +677,9 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
                                        const U*       supplied_invA      = nullptr,
                                        rocblas_int    supplied_invA_size = 0)
 {
-    // Whether size is an exact multiple of blocksize
-    const bool exact_blocks = (m % BLOCK) == 0;
-
     // perf_status indicates whether optimal performance is obtainable with available memory
     rocblas_status perf_status = rocblas_status_success;
 
-    size_t invA_bytes   = 0;
-    size_t c_temp_bytes = 0;
-
     // For user-supplied invA, check to make sure size is large enough
     // If not large enough, indicate degraded performance and ignore supplied invA
     if(supplied_invA && supplied_invA_size / BLOCK < m)
@@ -701,42 +695,17 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
         }
     }
 
-    if(!supplied_invA)
-    {
-        // Only allocate bytes for invA if supplied_invA == nullptr or supplied_invA_size is too small
-        invA_bytes = sizeof(T) * BLOCK * m * batch_count;
-
-        // When m < BLOCK, C is unnecessary for trtri
-        c_temp_bytes = (m / BLOCK) * (sizeof(T) * (BLOCK / 2) * (BLOCK / 2)) * batch_count;
-
-        // For the TRTRI last diagonal block we need remainder space if m % BLOCK != 0
-        if(!exact_blocks)
-        {
-            // TODO: Make this more accurate -- right now it's much larger than necessary
-            size_t remainder_bytes = sizeof(T) * ROCBLAS_TRTRI_NB * BLOCK * 2 * batch_count;
-
-            // C is the maximum of the temporary space needed for TRTRI
-            c_temp_bytes = std::max(c_temp_bytes, remainder_bytes);
-        }
-    }
-
-    // Temporary solution vector
-    // If the special solver can be used, then only BLOCK words are needed instead of m words
-    size_t x_temp_bytes
-        = exact_blocks ? sizeof(T) * BLOCK * batch_count : sizeof(T) * m * batch_count;
-
-    // X and C temporaries can share space, so the maximum size is allocated
-    size_t x_c_temp_bytes = std::max(x_temp_bytes, c_temp_bytes);
-    size_t arrBytes       = BATCHED ? sizeof(T*) * batch_count : 0;
-    size_t xarrBytes      = BATCHED ? sizeof(T*) * batch_count : 0;
+    // Only allocate bytes for invA if supplied_invA == nullptr or supplied_invA_size is too small
+    auto w = rocblas_trsv_workspace_size<BLOCK, BATCHED>(
+        sizeof(T), m, batch_count, supplied_invA != nullptr);
 
     // If this is a device memory size query, set optimal size and return changed status
     if(handle->is_device_memory_size_query())
         return handle->set_optimal_device_memory_size(
-            x_c_temp_bytes, xarrBytes, invA_bytes, arrBytes);
+            w.x_c_temp_bytes, w.xarr_bytes, w.invA_bytes, w.arr_bytes);
 
     // Attempt to allocate optimal memory size, returning error if failure
-    mem = handle->device_malloc(x_c_temp_bytes, xarrBytes, invA_bytes, arrBytes);
+    mem = handle->device_malloc(w.x_c_temp_bytes, w.xarr_bytes, w.invA_bytes, w.arr_bytes);
     if(!mem)
         return rocblas_status_memory_error;
 
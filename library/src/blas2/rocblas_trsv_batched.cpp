@@ -10,8 +10,8 @@
 
 namespace
 {
-    constexpr rocblas_int STRSV_BLOCK = 128;
-    constexpr rocblas_int DTRSV_BLOCK = 128;
+    constexpr rocblas_int STRSV_BLOCK = ROCBLAS_TRSV_BLOCK;
+    constexpr rocblas_int DTRSV_BLOCK = ROCBLAS_TRSV_BLOCK;
 
     template <typename>
     constexpr char rocblas_trsv_batched_name[] = "unknown";
@@ -41,6 +41,10 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(
+            handle, rocblas_trsv_batched_name<T>, rocblas_datatype_from_type<T>, m, batch_count);
+
         if(!handle->is_device_memory_size_query())
         {
             auto layer_mode = handle->layer_mode;
@@ -143,7 +147,7 @@ namespace
         if(perf_status != rocblas_status_success && perf_status != rocblas_status_perf_degraded)
             return perf_status;
 
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
 
         if(check_numerics)
         {
@@ -42,6 +42,10 @@ namespace
     {
         if(!handle)
             return rocblas_status_invalid_handle;
+
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(
+            handle, rocblas_gemm_batched_name<T>, rocblas_datatype_from_type<T>, m, n, k, b_c);
         RETURN_ZERO_DEVICE_MEMORY_SIZE_IF_QUERIED(handle);
 
         // Copy alpha and beta to host if on device
@@ -52,7 +56,7 @@ namespace
 
         // Perform logging
         auto layer_mode     = handle->layer_mode;
-        auto check_numerics = handle->check_numerics;
+        auto check_numerics = handle->begin_check_numerics();
         if(layer_mode
            & (rocblas_layer_mode_log_trace | rocblas_layer_mode_log_bench
               | rocblas_layer_mode_log_profile))
@@ -1339,7 +1339,7 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
     rocblas_int    k           = side == rocblas_side_left ? m : n;
 
     // bool is_small = k <= 64;
-    bool is_small = (m <= 64 && n <= 64);
+    bool is_small = rocblas_trsm_is_small(m, n);
     if(SUBSTITUTION_ENABLED && is_small)
     {
         if(handle->is_device_memory_size_query())
@@ -1350,11 +1350,6 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
     // Whether size is an exact multiple of blocksize
     const bool exact_blocks = (k % BLOCK) == 0;
 
-    size_t invA_bytes   = 0;
-    size_t invA_els     = 0;
-    size_t c_temp_bytes = 0;
-    size_t c_temp_els   = 0;
-
     // For user-supplied invA, check to make sure size is large enough
     // If not large enough, ignore supplied invA
     if(supplied_invA && supplied_invA_size / BLOCK < k)
@@ -1373,75 +1368,27 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
         }
     }
 
-    if(!supplied_invA)
-    {
-        // Only allocate bytes for invA if supplied_invA == nullptr or supplied_invA_size is too small
-        invA_els   = BLOCK * k;
-        invA_bytes = invA_els * sizeof(T) * batch_count;
-
-        // When k < BLOCK, C is unnecessary for trtri
-        c_temp_els   = (k / BLOCK) * ((BLOCK / 2) * (BLOCK / 2));
-        c_temp_bytes = c_temp_els * sizeof(T);
-
-        // For the TRTRI last diagonal block we need remainder space if k % BLOCK != 0
-        if(!exact_blocks)
-        {
-            // TODO: Make this more accurate -- right now it's much larger than necessary
-            size_t remainder_els   = ROCBLAS_TRTRI_NB * BLOCK * 2;
-            size_t remainder_bytes = sizeof(T) * remainder_els;
-
-            // C is the maximum of the temporary space needed for TRTRI
-            c_temp_els   = std::max(c_temp_els, remainder_els);
-            c_temp_bytes = c_temp_els * sizeof(T);
-        }
-    }
-
-    // Chunk size for special algorithm
-    size_t B_chunk_size = 0;
-
-    // Temporary solution matrix
-    size_t x_temp_els;
-    size_t x_temp_bytes;
-
-    if(exact_blocks)
-    {
-        // Optimal B_chunk_size is the orthogonal dimension to k
-        B_chunk_size = size_t(m) + size_t(n) - size_t(k);
-
-        // When k % BLOCK == 0, we only need BLOCK * B_chunk_size space
-        x_temp_els   = BLOCK * B_chunk_size;
-        x_temp_bytes = x_temp_els * sizeof(T) * batch_count;
-    }
-    else
-    {
-        // When k % BLOCK != 0, we need m * n space
-        x_temp_els   = size_t(m) * n;
-        x_temp_bytes = x_temp_els * sizeof(T) * batch_count;
-    }
-
-    // X and C temporaries can share space, so the maximum size is allocated
-    size_t x_c_temp_bytes = std::max(x_temp_bytes, c_temp_bytes);
-    size_t arrBytes       = BATCHED ? sizeof(T*) * batch_count : 0;
-    size_t xarrBytes      = BATCHED ? sizeof(T*) * batch_count : 0;
+    // Only allocate bytes for invA if supplied_invA == nullptr or supplied_invA_size is too small
+    auto w = rocblas_trsm_workspace_size<BLOCK, BATCHED>(
+        sizeof(T), side, m, n, batch_count, supplied_invA != nullptr);
 
     // If this is a device memory size query, set optimal size and return changed status
     if(handle->is_device_memory_size_query())
         return handle->set_optimal_device_memory_size(
-            x_c_temp_bytes, xarrBytes, invA_bytes, arrBytes);
+            w.x_c_temp_bytes, w.xarr_bytes, w.invA_bytes, w.arr_bytes);
 
     // Attempt to allocate optimal memory size
-    mem = handle->device_malloc(x_c_temp_bytes, xarrBytes, invA_bytes, arrBytes);
+    mem = handle->device_malloc(w.x_c_temp_bytes, w.xarr_bytes, w.invA_bytes, w.arr_bytes);
 
     if(!mem)
     {
         if(exact_blocks)
         {
-            B_chunk_size   = 1; // Fall back on chunk size of 1 (like TRSV)
-            x_temp_els     = BLOCK;
-            x_temp_bytes   = x_temp_els * sizeof(T) * batch_count;
-            x_c_temp_bytes = std::max(x_temp_bytes, c_temp_bytes);
+            // Fall back on solving one column of B at a time (like TRSV)
+            w = rocblas_trsm_workspace_size<BLOCK, BATCHED>(
+                sizeof(T), side, m, n, batch_count, supplied_invA != nullptr, true);
 
-            mem = handle->device_malloc(x_c_temp_bytes, xarrBytes, invA_bytes, arrBytes);
+            mem = handle->device_malloc(w.x_c_temp_bytes, w.xarr_bytes, w.invA_bytes, w.arr_bytes);
         }
 
         if(!mem)
@@ -2181,7 +2128,7 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
     rocblas_int k = side == rocblas_side_left ? m : n;
 
     // bool is_small = k <= 64;
-    bool is_small = (m <= 64 && n <= 64);
+    bool is_small = rocblas_trsm_is_small(m, n);
     if(SUBSTITUTION_ENABLED && is_small)
     {
         if(k <= 2)
@@ -12,8 +12,8 @@
 
 // Shared memory usuage is (128/2)^2 * sizeof(float) = 32K. LDS is 64K per CU. Theoretically
 // you can use all 64K, but in practice no.
-constexpr rocblas_int STRSM_BLOCK = 128;
-constexpr rocblas_int DTRSM_BLOCK = 128;
+constexpr rocblas_int STRSM_BLOCK = ROCBLAS_TRSM_BLOCK;
+constexpr rocblas_int DTRSM_BLOCK = ROCBLAS_TRSM_BLOCK;
 
 namespace
 {
@@ -53,6 +53,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_trsm_name<T>, rocblas_datatype_from_type<T>, m, n, batch_count);
+
         /////////////
         // LOGGING //
         /////////////
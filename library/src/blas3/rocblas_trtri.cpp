@@ -32,6 +32,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_trtri_name<T>, rocblas_datatype_from_type<T>, n);
+
         size_t size = rocblas_internal_trtri_temp_size<NB>(n, 1) * sizeof(T);
         if(handle->is_device_memory_size_query())
         {
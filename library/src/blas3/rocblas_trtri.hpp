@@ -1003,42 +1003,7 @@ template <rocblas_int NB>
 ROCBLAS_INTERNAL_EXPORT_NOINLINE size_t rocblas_internal_trtri_temp_size(rocblas_int n,
                                                                          rocblas_int batch_count)
 {
-    rocblas_int IB   = NB * 2;
-    size_t      size = 0;
-    if(n > IB && batch_count > 0)
-    {
-        rocblas_int current_n = IB;
-        while(current_n * 2 <= n)
-            current_n *= 2;
-        rocblas_int remainder = (n / IB) * IB - current_n;
-        if(!rocblas_is_po2(remainder))
-            remainder = rocblas_previous_po2(remainder);
-        rocblas_int oddRemainder = n - current_n - remainder;
-
-        size_t sizeRemainder = remainder ? remainder * current_n : 0;
-        size_t sizeOdd       = 0;
-
-        while(oddRemainder)
-        {
-            current_n         = n - oddRemainder;
-            size_t curSizeOdd = oddRemainder * (n - oddRemainder);
-            sizeOdd           = sizeOdd > curSizeOdd ? sizeOdd : curSizeOdd;
-
-            if(!rocblas_is_po2(oddRemainder) && oddRemainder > IB)
-            {
-                oddRemainder = rocblas_previous_po2(oddRemainder);
-                oddRemainder = n - current_n - oddRemainder;
-            }
-            else
-            {
-                oddRemainder = 0;
-            }
-        }
-
-        if(sizeRemainder || sizeOdd)
-            size = (sizeRemainder > sizeOdd ? sizeRemainder : sizeOdd) * batch_count;
-    }
-    return size;
+    return rocblas_trtri_temp_elements(NB, n, batch_count);
 }
 
 template <rocblas_int NB, bool BATCHED, bool STRIDED, typename T, typename U, typename V>
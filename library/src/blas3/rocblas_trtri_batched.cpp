@@ -34,6 +34,9 @@ namespace
         if(!handle)
             return rocblas_status_invalid_handle;
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, rocblas_trtri_name<T>, rocblas_datatype_from_type<T>, n, batch_count);
+
         // Compute the optimal size for temporary device memory
         size_t els   = rocblas_internal_trtri_temp_size<NB>(n, 1);
         size_t size  = els * batch_count * sizeof(T);
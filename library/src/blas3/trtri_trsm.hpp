@@ -7,8 +7,7 @@
 
 #include "gemm.hpp"
 #include "rocblas_trtri.hpp"
-
-static constexpr rocblas_int ROCBLAS_TRTRI_NB = 16;
+#include "rocblas_workspace_size.hpp"
 
 /*
     Invert the IB by IB diagonal blocks of A of size n by n, where n is divisible by IB
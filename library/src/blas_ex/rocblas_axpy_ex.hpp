@@ -24,7 +24,7 @@ rocblas_status axpy_ex_typecasting(const char*    name,
                                    rocblas_stride stride_y,
                                    rocblas_int    batch_count)
 {
-    auto check_numerics = handle->check_numerics;
+    auto check_numerics = handle->begin_check_numerics();
 
     const Ta* alphat = (const Ta*)alpha;
     if(handle->pointer_mode == rocblas_pointer_mode_host)
@@ -29,6 +29,9 @@ namespace
             return rocblas_status_invalid_handle;
         }
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, name, execution_type, n, batch_count);
+
         RETURN_ZERO_DEVICE_MEMORY_SIZE_IF_QUERIED(handle);
 
         auto layer_mode = handle->layer_mode;
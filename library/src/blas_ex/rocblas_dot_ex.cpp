@@ -8,7 +8,7 @@ namespace
 {
     // HIP support up to 1024 threads/work itemes per thread block/work group
     // setting to 512 for gfx803.
-    constexpr int NB = 512;
+    constexpr int NB = ROCBLAS_REDUCTION_NB;
 
     template <bool CONJ>
     rocblas_status rocblas_dot_ex_impl(rocblas_handle   handle,
@@ -30,6 +30,9 @@ namespace
             return rocblas_status_invalid_handle;
         }
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, name, execution_type, n);
+
         size_t dev_bytes = rocblas_reduction_kernel_workspace_size<NB>(n, 1, execution_type);
         if(handle->is_device_memory_size_query())
         {
@@ -41,6 +41,9 @@ try
     if(!handle)
         return rocblas_status_invalid_handle;
 
+    rocblas_profile_timer profile_timer(handle);
+    log_metrics(handle, "rocblas_gemm_strided_batched_ex", compute_type, m, n, k, batch_count);
+
     const bool HPA = compute_type == rocblas_datatype_f32_r
                      && (a_type == rocblas_datatype_f16_r || a_type == rocblas_datatype_bf16_r);
 
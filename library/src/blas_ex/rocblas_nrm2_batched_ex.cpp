@@ -24,6 +24,9 @@ namespace
             return rocblas_status_invalid_handle;
         }
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, "rocblas_nrm2_batched_ex", execution_type, n, batch_count);
+
         size_t dev_bytes
             = rocblas_reduction_kernel_workspace_size<NB>(n, batch_count, execution_type);
 
@@ -164,7 +167,7 @@ rocblas_status rocblas_nrm2_batched_ex(rocblas_handle   handle,
 {
     try
     {
-        constexpr rocblas_int NB = 512;
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;
         return rocblas_nrm2_batched_ex_impl<NB>(
             handle, n, x, x_type, incx, batch_count, results, result_type, execution_type);
     }
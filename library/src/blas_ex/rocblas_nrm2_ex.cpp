@@ -23,6 +23,9 @@ namespace
             return rocblas_status_invalid_handle;
         }
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, "rocblas_nrm2_ex", execution_type, n);
+
         size_t dev_bytes = rocblas_reduction_kernel_workspace_size<NB>(n, 1, execution_type);
 
         if(handle->is_device_memory_size_query())
@@ -148,7 +151,7 @@ rocblas_status rocblas_nrm2_ex(rocblas_handle   handle,
 {
     try
     {
-        constexpr rocblas_int NB = 512;
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;
         return rocblas_nrm2_ex_impl<NB>(
             handle, n, x, x_type, incx, results, result_type, execution_type);
     }
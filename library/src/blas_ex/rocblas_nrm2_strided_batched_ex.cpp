@@ -25,6 +25,9 @@ namespace
             return rocblas_status_invalid_handle;
         }
 
+        rocblas_profile_timer profile_timer(handle);
+        log_metrics(handle, "rocblas_nrm2_strided_batched_ex", execution_type, n, batch_count);
+
         size_t dev_bytes
             = rocblas_reduction_kernel_workspace_size<NB>(n, batch_count, execution_type);
 
@@ -170,7 +173,7 @@ rocblas_status rocblas_nrm2_strided_batched_ex(rocblas_handle   handle,
 {
     try
     {
-        constexpr rocblas_int NB = 512;
+        constexpr rocblas_int NB = ROCBLAS_REDUCTION_NB;
         return rocblas_nrm2_strided_batched_ex_impl<NB>(handle,
                                                         n,
                                                         x,
@@ -48,41 +48,75 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
     if(!m || !n || !batch_count || !A)
         return rocblas_status_success;
 
-    //Creating structure host object
-    rocblas_check_numerics_t h_abnormal;
-
-    //Allocating memory for device structure
-    auto d_abnormal = handle->device_malloc(sizeof(rocblas_check_numerics_t));
-
-    //Transferring the rocblas_check_numerics_t structure from host to the device
-    RETURN_IF_HIP_ERROR(hipMemcpy((rocblas_check_numerics_t*)d_abnormal,
-                                  &h_abnormal,
-                                  sizeof(rocblas_check_numerics_t),
-                                  hipMemcpyHostToDevice));
-
     //Checking trans_a to transpose a matrix 'A'
     rocblas_int num_rows_a = trans_a == rocblas_operation_none ? m : n;
     rocblas_int num_cols_a = trans_a == rocblas_operation_none ? n : m;
 
+    //In sampled mode, the checks of a call are skipped unless the call is sampled, and only every
+    //Sth column of the matrix is checked
+    auto& sampler = handle->check_numerics_sampler;
+    if(!sampler.sample(function_name))
+        return rocblas_status_success;
+
+    rocblas_int sample_stride = sampler.get_stride();
+    rocblas_int cols_checked  = (num_cols_a - 1) / sample_stride + 1;
+    ptrdiff_t   lda_checked   = ptrdiff_t(lda) * sample_stride;
+
     hipStream_t          rocblas_stream = handle->get_stream();
     static constexpr int DIM_X          = 16;
     static constexpr int DIM_Y          = 16;
     rocblas_int          blocks_X       = (num_rows_a - 1) / DIM_X + 1;
-    rocblas_int          blocks_Y       = (num_cols_a - 1) / DIM_Y + 1;
+    rocblas_int          blocks_Y       = (cols_checked - 1) / DIM_Y + 1;
 
     dim3 blocks(blocks_X, blocks_Y, batch_count);
     dim3 threads(DIM_X, DIM_Y);
 
+    //In asynchronous mode, the kernel sets the flags of the next record of the handle, which
+    //are read when the records are queried, without waiting for the kernel here
+    if((check_numerics & rocblas_check_numerics_mode_async) && handle->check_numerics_records)
+    {
+        rocblas_check_numerics_t* d_record
+            = handle->check_numerics_records->record(function_name, is_input, rocblas_stream);
+        if(!d_record)
+            return rocblas_status_memory_error;
+
+        hipLaunchKernelGGL(rocblas_check_numerics_ge_matrix_kernel,
+                           blocks,
+                           threads,
+                           0,
+                           rocblas_stream,
+                           num_rows_a,
+                           cols_checked,
+                           A,
+                           offset_a,
+                           lda_checked,
+                           stride_a,
+                           d_record);
+        return rocblas_status_success;
+    }
+
+    //Creating structure host object
+    rocblas_check_numerics_t h_abnormal;
+
+    //Allocating memory for device structure
+    auto d_abnormal = handle->device_malloc(sizeof(rocblas_check_numerics_t));
+
+    //Transferring the rocblas_check_numerics_t structure from host to the device
+    RETURN_IF_HIP_ERROR(hipMemcpy((rocblas_check_numerics_t*)d_abnormal,
+                                  &h_abnormal,
+                                  sizeof(rocblas_check_numerics_t),
+                                  hipMemcpyHostToDevice));
+
     hipLaunchKernelGGL(rocblas_check_numerics_ge_matrix_kernel,
                        blocks,
                        threads,
                        0,
                        rocblas_stream,
                        num_rows_a,
-                       num_cols_a,
+                       cols_checked,
                        A,
                        offset_a,
-                       lda,
+                       lda_checked,
                        stride_a,
                        (rocblas_check_numerics_t*)d_abnormal);
 
@@ -92,6 +126,7 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
                                   sizeof(rocblas_check_numerics_t),
                                   hipMemcpyDeviceToHost));
 
+    sampler.count(h_abnormal.has_NaN || h_abnormal.has_Inf);
     return rocblas_check_numerics_abnormal_struct(
         function_name, check_numerics, is_input, &h_abnormal);
 }
@@ -1,4 +1,5 @@
 #include "check_numerics_vector.hpp"
+#include "rocblas_metrics.hpp"
 #include "utility.hpp"
 
 /**
@@ -50,11 +51,39 @@ rocblas_status rocblas_check_numerics_abnormal_struct(const char*
     if(is_abnormal)
     { //If 'check_numerics ==rocblas_check_numerics_mode_fail' then the 'rocblas_status_check_numerics_fail' status
         //is returned which signifies that the vector has a NaN/Inf
+        rocblas_metrics::record_event(rocblas_metrics::check_numerics_failure);
         if((check_numerics & rocblas_check_numerics_mode_fail) != 0)
             return rocblas_status_check_numerics_fail;
     }
     return rocblas_status_success;
 }
+
+/**
+  *
+  * rocblas_hip_check_numerics_backend::report(function_name, is_input, flags)
+  *
+  * Info about rocblas_hip_check_numerics_backend::report function:
+  *
+  *    It is the host function which reports a check read from the records of a handle in asynchronous check_numerics mode,
+  *    printing it and counting it as in synchronous mode. The failure status cannot be returned to the function checked.
+  *
+  * Parameters   : function_name         : Name of the rocBLAS math function
+  *                is_input              : To check if the vector or matrix checked was an Input or an Output
+  *                flags                 : Structure holding the boolean NaN/zero/Inf set by the check
+  *
+**/
+
+void rocblas_hip_check_numerics_backend::report(const char*                     function_name,
+                                                bool                            is_input,
+                                                const rocblas_check_numerics_t& flags)
+{
+    rocblas_check_numerics_t h_abnormal = flags;
+    rocblas_check_numerics_abnormal_struct(function_name,
+                                           check_numerics & ~rocblas_check_numerics_mode_fail,
+                                           is_input,
+                                           &h_abnormal);
+}
+
 /**
   *
   * rocblas_internal_check_numerics_vector_template(function_name, handle, n, x, offset_x, inc_x, stride_x, batch_count, check_numerics, is_input)
@@ -100,6 +129,44 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
         return rocblas_status_success;
     }
 
+    //In sampled mode, the checks of a call are skipped unless the call is sampled, and only every
+    //Sth element of the vector is checked
+    auto& sampler = handle->check_numerics_sampler;
+    if(!sampler.sample(function_name))
+        return rocblas_status_success;
+
+    rocblas_int sample_stride = sampler.get_stride();
+    rocblas_int n_checked     = (n - 1) / sample_stride + 1;
+    ptrdiff_t   inc_checked   = ptrdiff_t(inc_x) * sample_stride;
+
+    hipStream_t           rocblas_stream = handle->get_stream();
+    constexpr rocblas_int NB             = 256;
+    dim3                  blocks((n_checked - 1) / NB + 1, batch_count);
+    dim3                  threads(NB);
+
+    //In asynchronous mode, the kernel sets the flags of the next record of the handle, which
+    //are read when the records are queried, without waiting for the kernel here
+    if((check_numerics & rocblas_check_numerics_mode_async) && handle->check_numerics_records)
+    {
+        rocblas_check_numerics_t* d_record
+            = handle->check_numerics_records->record(function_name, is_input, rocblas_stream);
+        if(!d_record)
+            return rocblas_status_memory_error;
+
+        hipLaunchKernelGGL(rocblas_check_numerics_vector_kernel,
+                           blocks,
+                           threads,
+                           0,
+                           rocblas_stream,
+                           n_checked,
+                           x,
+                           offset_x,
+                           inc_checked,
+                           stride_x,
+                           d_record);
+        return rocblas_status_success;
+    }
+
     //Creating structure host object
     rocblas_check_numerics_t h_abnormal;
 
@@ -112,20 +179,15 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
                                   sizeof(rocblas_check_numerics_t),
                                   hipMemcpyHostToDevice));
 
-    hipStream_t           rocblas_stream = handle->get_stream();
-    constexpr rocblas_int NB             = 256;
-    dim3                  blocks((n - 1) / NB + 1, batch_count);
-    dim3                  threads(NB);
-
     hipLaunchKernelGGL(rocblas_check_numerics_vector_kernel,
                        blocks,
                        threads,
                        0,
                        rocblas_stream,
-                       n,
+                       n_checked,
                        x,
                        offset_x,
-                       inc_x,
+                       inc_checked,
                        stride_x,
                        (rocblas_check_numerics_t*)d_abnormal);
 
@@ -135,6 +197,7 @@ ROCBLAS_INTERNAL_EXPORT_NOINLINE rocblas_status
                                   sizeof(rocblas_check_numerics_t),
                                   hipMemcpyDeviceToHost));
 
+    sampler.count(h_abnormal.has_NaN || h_abnormal.has_Inf);
     return rocblas_check_numerics_abnormal_struct(
         function_name, check_numerics, is_input, &h_abnormal);
 }
@@ -2,8 +2,18 @@
  * Copyright 2016-2021 Advanced Micro Devices, Inc.
  * ************************************************************************ */
 #include "handle.hpp"
+#include "rocblas_binary_log.hpp"
+#include "rocblas_metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <cstdarg>
+#include <cstdio>
+#include <cstring>
 #include <limits>
+#include <mutex>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #if BUILD_WITH_TENSILE
 #ifndef USE_TENSILE_HOST
@@ -13,6 +23,77 @@
 // see TensileHost.cpp for normal rocblas_initialize definition
 // it isn't compiled if not BUILD_WITH_TENSILE so defining here
 extern "C" void rocblas_initialize() {}
+
+extern "C" rocblas_status rocblas_initialize_async()
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_initialize_wait()
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_initialize_query(bool* complete)
+{
+    if(!complete)
+        return rocblas_status_invalid_pointer;
+    *complete = true;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_get_solution_cache_stats(size_t* hits,
+                                                           size_t* misses,
+                                                           size_t* evictions,
+                                                           size_t* entries)
+{
+    for(auto* p : {hits, misses, evictions, entries})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_get_tensile_library_load_info(double* load_us,
+                                                               size_t* resident_bytes,
+                                                               size_t* file_bytes)
+{
+    if(load_us)
+        *load_us = 0;
+    for(auto* p : {resident_bytes, file_bytes})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_set_solution_cache_enabled(bool enabled)
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_clear_solution_cache()
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status
+    rocblas_set_gemm_autotune_limits(size_t candidates, size_t trials, size_t max_signatures)
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status
+    rocblas_get_gemm_autotune_limits(size_t* candidates, size_t* trials, size_t* max_signatures)
+{
+    for(auto* p : {candidates, trials, max_signatures})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_export_gemm_autotune_results(const char* path)
+{
+    return rocblas_status_not_implemented;
+}
 #endif
 
 // This variable can be set in hipBLAS or other libraries to change the default
@@ -24,6 +105,84 @@ extern "C" void rocblas_device_malloc_set_default_memory_size(size_t size)
     t_rocblas_device_malloc_default_memory_size = size;
 }
 
+/*******************************************************************************
+ * shared workspace pool of each device, created on first use. The pools are
+ * intentionally never destroyed, so that handles destroyed during static
+ * destruction can still return their leases.
+ ******************************************************************************/
+static rocblas_shared_workspace_pool* shared_workspace_pool(int device)
+{
+    static auto* pools = [] {
+        int count = 0;
+        if(hipGetDeviceCount(&count) != hipSuccess)
+            count = 0;
+        return new std::vector<rocblas_shared_workspace_pool>(count);
+    }();
+    return device >= 0 && size_t(device) < pools->size() ? &(*pools)[device] : nullptr;
+}
+
+/*******************************************************************************
+ * peak workspace of each function over all handles in the process. If
+ * ROCBLAS_WORKSPACE_PROFILE names a file, the profile is read from it when the
+ * first handle is created, new handles are created with a workspace large
+ * enough for every function, and the profile is written back to it at exit.
+ ******************************************************************************/
+class rocblas_process_workspace_profile
+{
+    std::mutex                m_mutex;
+    rocblas_workspace_profile m_profile;
+    const char*               m_path;
+
+public:
+    rocblas_process_workspace_profile()
+        : m_path(getenv("ROCBLAS_WORKSPACE_PROFILE"))
+    {
+        if(!m_path || !*m_path)
+            m_path = nullptr;
+        else if(access(m_path, F_OK) == 0)
+        {
+            std::string error;
+            if(!m_profile.read(m_path, error))
+                rocblas_cerr << "rocBLAS warning: Ignoring workspace profile: " << error
+                             << std::endl;
+        }
+    }
+
+    ~rocblas_process_workspace_profile()
+    {
+        // rocblas_cerr may already have been destroyed at exit
+        if(m_path && !write(m_path))
+            fprintf(stderr, "\nrocBLAS warning: Could not write %s\n", m_path);
+    }
+
+    void record(const char* function, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_profile.record(function, bytes);
+    }
+
+    // Workspace size for new handles, or 0 if no profile file is used
+    size_t presize_bytes()
+    {
+        if(!m_path)
+            return 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return roundup_device_memory_size(m_profile.peak_bytes());
+    }
+
+    bool write(const char* path)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_profile.write(path);
+    }
+};
+
+static rocblas_process_workspace_profile& process_workspace_profile()
+{
+    static rocblas_process_workspace_profile profile;
+    return profile;
+}
+
 static inline int getActiveDevice()
 {
     int device;
@@ -65,7 +224,16 @@ _rocblas_handle::_rocblas_handle()
     {
         device_memory_owner = rocblas_device_memory_ownership::rocblas_managed;
 
-        if(!env)
+        // In shared workspace mode, no device memory is allocated until it is needed
+        const char* shared = getenv("ROCBLAS_SHARED_WORKSPACE");
+        if(shared && strtol(shared, nullptr, 0) == 1)
+            workspace_mode = rocblas_workspace_shared;
+
+        if(workspace_mode == rocblas_workspace_shared)
+        {
+            device_memory_size = 0;
+        }
+        else if(!env)
         {
             if(t_rocblas_device_malloc_default_memory_size)
             {
@@ -76,15 +244,21 @@ _rocblas_handle::_rocblas_handle()
             {
                 device_memory_size = DEFAULT_DEVICE_MEMORY_SIZE;
             }
+
+            // Presize the workspace from the workspace profile, so that it is never reallocated
+            size_t presize = process_workspace_profile().presize_bytes();
+            if(device_memory_size < presize)
+                device_memory_size = presize;
         }
     }
 
-    // Allocate device memory
-    if(device_memory_size)
-        THROW_IF_HIP_ERROR((hipMalloc)(&device_memory, device_memory_size));
+    // Defer allocating device memory until it is first needed
+    deferred_device_memory_size = device_memory_size;
+    device_memory_size          = 0;
 
     // Initialize logging
     init_logging();
+    init_log_sampling();
 
     // Initialize numerical checking
     init_check_numerics();
@@ -95,7 +269,7 @@ _rocblas_handle::_rocblas_handle()
  ******************************************************************************/
 _rocblas_handle::~_rocblas_handle()
 {
-    if(device_memory_in_use)
+    if(workspace.in_use())
     {
         rocblas_cerr
             << "rocBLAS internal error: Handle object destroyed while device memory still in use."
@@ -103,53 +277,212 @@ _rocblas_handle::~_rocblas_handle()
         rocblas_abort();
     }
 
+    // Report the checks of asynchronous check_numerics mode which were not read yet, while the
+    // ring holding them still exists
+    if(check_numerics_records && !check_numerics_records->read())
+        rocblas_cerr << "rocBLAS error reading check_numerics records in handle destructor"
+                     << std::endl;
+
     // Free device memory unless it's user-owned
     if(device_memory_owner != rocblas_device_memory_ownership::user_owned)
     {
-        auto hipStatus = (hipFree)(device_memory);
-        if(hipStatus != hipSuccess)
+        auto status = free_device_memory(device_memory, device_memory_size);
+        if(status != rocblas_status_success)
         {
-            rocblas_cerr << "rocBLAS error during hipFree in handle destructor: "
-                         << rocblas_status_to_string(get_rocblas_status_for_hip_status(hipStatus))
-                         << std::endl;
+            rocblas_cerr << "rocBLAS error freeing device memory in handle destructor: "
+                         << rocblas_status_to_string(status) << std::endl;
             rocblas_abort();
         };
     }
+    trim_shared_workspace();
+
+    destroy_start_stop_events();
+    if(pool_release_event)
+        (hipEventDestroy)(pool_release_event);
+}
+
+/*******************************************************************************
+ * destroy the start/stop events if they were created by rocBLAS
+ ******************************************************************************/
+void _rocblas_handle::destroy_start_stop_events()
+{
+    if(owns_start_stop_events)
+    {
+        (hipEventDestroy)(startEvent);
+        (hipEventDestroy)(stopEvent);
+        startEvent             = nullptr;
+        stopEvent              = nullptr;
+        owns_start_stop_events = false;
+    }
+}
+
+/*******************************************************************************
+ * allocate and free device memory with the user's functions, or hipMalloc and
+ * hipFree if none were set
+ ******************************************************************************/
+rocblas_status _rocblas_handle::allocate_device_memory(void** ptr, size_t size)
+{
+    return device_memory_functions.allocate(ptr, size, stream);
+}
+
+rocblas_status _rocblas_handle::free_device_memory(void* ptr, size_t size)
+{
+    return device_memory_functions.free(ptr, size, stream);
+}
+
+/*******************************************************************************
+ * allocate a block of device memory from the handle's workspace, reallocating
+ * the workspace if it is rocBLAS-managed and too small
+ ******************************************************************************/
+bool _rocblas_handle::workspace_allocate(size_t      size,
+                                         int&        block,
+                                         void*&      addr,
+                                         const char* function)
+{
+    block = -1;
+    addr  = device_memory;
+    if(!size)
+        return true;
+
+    if(function)
+        record_workspace_peak(function, workspace.in_use() + size);
+
+    if(deferred_device_memory_size && !allocate_deferred_device_memory(size))
+        return false;
+
+    size_t offset;
+    block = workspace.allocate(size, offset);
+#if ROCBLAS_REALLOC_ON_DEMAND
+    if(block < 0 && device_allocator(size))
+        block = workspace.allocate(size, offset);
+#endif
+    if(block < 0)
+        return false;
+
+    addr = static_cast<char*>(device_memory) + offset;
+    return true;
+}
+
+/*******************************************************************************
+ * allocate the workspace whose allocation was deferred from handle creation.
+ * rocBLAS-managed memory is made large enough for the first request, rather
+ * than allocated and then grown.
+ ******************************************************************************/
+bool _rocblas_handle::allocate_deferred_device_memory(size_t size)
+{
+    size_t deferred = deferred_device_memory_size;
+#if ROCBLAS_REALLOC_ON_DEMAND
+    if(device_memory_owner == rocblas_device_memory_ownership::rocblas_managed && deferred < size)
+        deferred = roundup_device_memory_size(size);
+#endif
+
+    // Temporarily change the thread's default device ID to the handle's device ID
+    auto  saved_device_id = push_device_id();
+    void* memory          = nullptr;
+    if(allocate_device_memory(&memory, deferred) != rocblas_status_success)
+        return false;
+    set_device_memory(memory, deferred);
+    return true;
 }
 
 /*******************************************************************************
- * helper for allocating device memory
+ * record the workspace in use when a function requested workspace, sharing new
+ * peaks with the process-wide profile
+ ******************************************************************************/
+void _rocblas_handle::record_workspace_peak(const char* function, size_t bytes)
+{
+    if(workspace_profile.record(function, bytes))
+        process_workspace_profile().record(function, bytes);
+}
+
+/*******************************************************************************
+ * helper for reallocating device memory
  ******************************************************************************/
 #if ROCBLAS_REALLOC_ON_DEMAND
 bool _rocblas_handle::device_allocator(size_t size)
 {
-    bool success = size <= device_memory_size - device_memory_in_use;
-    if(!success && device_memory_owner == rocblas_device_memory_ownership::rocblas_managed)
+    if(device_memory_owner != rocblas_device_memory_ownership::rocblas_managed)
+        return false;
+
+    if(workspace.in_use())
     {
-        if(device_memory_in_use)
+        rocblas_cerr << "rocBLAS internal error: Cannot reallocate device memory while it is "
+                        "already in use.";
+        rocblas_abort();
+    }
+
+    // Temporarily change the thread's default device ID to the handle's device ID
+    auto saved_device_id = push_device_id();
+
+    // In shared workspace mode, lease the memory from the device's pool
+    if(workspace_mode == rocblas_workspace_shared)
+    {
+        auto* pool = shared_workspace_pool(device);
+        if(!pool)
+            return false;
+        if(workspace_lease.slab >= 0)
+            pool->release(workspace_lease, stream);
+        // Lease at least the default size, so that a function which allocates several blocks
+        // in turn finds room for them, as it would in a private workspace
+        workspace_lease
+            = pool->lease(size < DEFAULT_DEVICE_MEMORY_SIZE ? DEFAULT_DEVICE_MEMORY_SIZE : size,
+                          stream,
+                          device_memory_functions);
+        if(workspace_lease.slab < 0)
         {
-            rocblas_cerr << "rocBLAS internal error: Cannot reallocate device memory while it is "
-                            "already in use.";
-            rocblas_abort();
+            set_device_memory(nullptr, 0);
+            return false;
         }
+        set_device_memory(workspace_lease.ptr, workspace_lease.size);
+        return true;
+    }
 
-        // Temporarily change the thread's default device ID to the handle's device ID
-        auto saved_device_id = push_device_id();
-
-        device_memory_size = 0;
-        if(!device_memory || (hipFree)(device_memory) == hipSuccess)
+    bool   success  = false;
+    void*  memory   = device_memory;
+    size_t old_size = device_memory_size;
+    set_device_memory(nullptr, 0);
+    if(!memory || free_device_memory(memory, old_size) == rocblas_status_success)
+    {
+        success = allocate_device_memory(&memory, size) == rocblas_status_success;
+        if(success)
         {
-            success = (hipMalloc)(&device_memory, size) == hipSuccess;
-            if(success)
-                device_memory_size = size;
-            else
-                device_memory = nullptr;
+            set_device_memory(memory, size);
+            rocblas_metrics::record_event(rocblas_metrics::workspace_reallocation);
         }
     }
     return success;
 }
 #endif
 
+/*******************************************************************************
+ * free the slabs of the device's shared pool which were allocated with the
+ * handle's functions, if they are not rocBLAS's own, before the functions are
+ * changed or the handle is destroyed, after which they may no longer be valid
+ ******************************************************************************/
+void _rocblas_handle::trim_shared_workspace()
+{
+    if(!device_memory_functions.malloc_fn)
+        return;
+    auto* pool = shared_workspace_pool(device);
+    if(pool)
+    {
+        auto saved_device_id = push_device_id();
+        pool->trim(device_memory_functions, stream);
+    }
+}
+
+/*******************************************************************************
+ * return the leased workspace to the device's shared pool after the work using
+ * it has been enqueued on the handle's stream
+ ******************************************************************************/
+void _rocblas_handle::return_workspace_lease()
+{
+    auto saved_device_id = push_device_id();
+    shared_workspace_pool(device)->release(workspace_lease, stream);
+    workspace_lease = {};
+    set_device_memory(nullptr, 0);
+}
+
 /*******************************************************************************
  * start device memory size queries
  ******************************************************************************/
@@ -200,7 +533,8 @@ try
         return rocblas_status_invalid_handle;
     if(!size)
         return rocblas_status_invalid_pointer;
-    *size = handle->device_memory_size;
+    *size = handle->deferred_device_memory_size ? handle->deferred_device_memory_size
+                                                : handle->device_memory_size;
     return rocblas_status_success;
 }
 catch(...)
@@ -217,17 +551,22 @@ static rocblas_status free_existing_device_memory(rocblas_handle handle)
     // Cannot change memory allocation when a device_malloc object is alive and
     // using device memory. This should never happen unless this function is
     // called from inside library code which borrows allocated device memory.
-    if(handle->device_memory_in_use)
+    if(handle->workspace.in_use())
         return rocblas_status_internal_error;
 
     // Free existing device memory in handle, unless owned by user
     if(handle->device_memory_owner != rocblas_device_memory_ownership::user_owned)
-        RETURN_IF_HIP_ERROR((hipFree)(handle->device_memory));
+    {
+        rocblas_status status
+            = handle->free_device_memory(handle->device_memory, handle->device_memory_size);
+        if(status != rocblas_status_success)
+            return status;
+    }
 
     // Clear the memory size and address, and set the memory to be rocBLAS-managed
-    handle->device_memory_size  = 0;
-    handle->device_memory       = nullptr;
-    handle->device_memory_owner = rocblas_device_memory_ownership::rocblas_managed;
+    handle->set_device_memory(nullptr, 0);
+    handle->device_memory_owner        = rocblas_device_memory_ownership::rocblas_managed;
+    handle->device_memory_reconfigured = true;
 
     return rocblas_status_success;
 }
@@ -255,20 +594,20 @@ try
         return rocblas_status_success;
 
     // Allocate size rounded up to MIN_CHUNK_SIZE
-    size           = roundup_device_memory_size(size);
-    auto hipStatus = (hipMalloc)(&handle->device_memory, size);
+    size         = roundup_device_memory_size(size);
+    void* memory = nullptr;
+    status       = handle->allocate_device_memory(&memory, size);
 
-    if(hipStatus != hipSuccess)
+    if(status != rocblas_status_success)
     {
-        // If allocation fails, nullify device memory address and return error
+        // If allocation fails, leave the device memory address nullptr and return error
         // Leave the memory under rocBLAS management for future calls
-        handle->device_memory = nullptr;
-        return get_rocblas_status_for_hip_status(hipStatus);
+        return status;
     }
     else
     {
         // If allocation succeeds, set size, mark it under user-management, and return success
-        handle->device_memory_size  = size;
+        handle->set_device_memory(memory, size);
         handle->device_memory_owner = rocblas_device_memory_ownership::user_managed;
         return rocblas_status_success;
     }
@@ -301,8 +640,7 @@ try
     if(size && addr)
     {
         handle->device_memory_owner = rocblas_device_memory_ownership::user_owned;
-        handle->device_memory_size  = size;
-        handle->device_memory       = addr;
+        handle->set_device_memory(addr, size);
     }
 
     return rocblas_status_success;
@@ -312,6 +650,411 @@ catch(...)
     return exception_to_rocblas_status();
 }
 
+/*******************************************************************************
+ * Set the functions which allocate and free device memory
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_set_device_memory_allocator(rocblas_handle           handle,
+                                                              rocblas_device_malloc_fn alloc_fn,
+                                                              rocblas_device_free_fn   free_fn,
+                                                              void*                    context)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!alloc_fn != !free_fn)
+        return rocblas_status_invalid_pointer;
+
+    // Temporarily change the thread's default device ID to the handle's device ID
+    auto saved_device_id = handle->push_device_id();
+
+    // Free any allocated memory with the previous functions unless owned by user, and
+    // set device memory to be rocBLAS-managed, allocated with the new functions on demand
+    rocblas_status status = free_existing_device_memory(handle);
+    if(status != rocblas_status_success)
+        return status;
+
+    handle->trim_shared_workspace();
+    handle->device_memory_functions = {alloc_fn, free_fn, context};
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Get statistics of the device memory workspace
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_device_memory_stats(rocblas_handle handle,
+                                                          size_t*        in_use,
+                                                          size_t*        peak_in_use,
+                                                          size_t*        largest_free,
+                                                          size_t*        free_blocks)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!in_use || !peak_in_use || !largest_free || !free_blocks)
+        return rocblas_status_invalid_pointer;
+
+    auto stats    = handle->workspace.stats();
+    *in_use       = stats.in_use;
+    *peak_in_use  = stats.peak_in_use;
+    *largest_free = stats.largest_free;
+    *free_blocks  = stats.free_blocks;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Set whether the handle leases its workspace from the device's shared pool
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_set_workspace_mode(rocblas_handle         handle,
+                                                     rocblas_workspace_mode mode)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(mode != rocblas_workspace_private && mode != rocblas_workspace_shared)
+        return rocblas_status_invalid_value;
+
+    // Temporarily change the thread's default device ID to the handle's device ID
+    auto saved_device_id = handle->push_device_id();
+
+    // Free any allocated memory unless owned by user, and set device memory to be
+    // rocBLAS-managed, allocated or leased on demand
+    rocblas_status status = free_existing_device_memory(handle);
+    if(status != rocblas_status_success)
+        return status;
+
+    handle->workspace_mode = mode;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Get whether the handle leases its workspace from the device's shared pool
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_workspace_mode(rocblas_handle          handle,
+                                                     rocblas_workspace_mode* mode)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!mode)
+        return rocblas_status_invalid_pointer;
+    *mode = handle->workspace_mode;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Get statistics of the shared workspace pool of a device
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_shared_workspace_stats(int     device,
+                                                             size_t* pool_bytes,
+                                                             size_t* peak_leased_bytes,
+                                                             size_t* leases,
+                                                             size_t* contentions,
+                                                             size_t* stream_waits)
+try
+{
+    auto* pool = shared_workspace_pool(device);
+    if(!pool)
+        return rocblas_status_invalid_value;
+    if(!pool_bytes || !peak_leased_bytes || !leases || !contentions || !stream_waits)
+        return rocblas_status_invalid_pointer;
+
+    auto stats         = pool->stats();
+    *pool_bytes        = stats.pool_bytes;
+    *peak_leased_bytes = stats.peak_leased_bytes;
+    *leases            = stats.leases;
+    *contentions       = stats.contentions;
+    *stream_waits      = stats.stream_waits;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Free the memory of the shared workspace pool of a device which is not leased
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_trim_shared_workspace(int device)
+try
+{
+    auto* pool = shared_workspace_pool(device);
+    if(!pool)
+        return rocblas_status_invalid_value;
+
+    // Temporarily change the thread's default device ID to the device
+    int saved_device;
+    THROW_IF_HIP_ERROR(hipGetDevice(&saved_device));
+    if(saved_device != device)
+        THROW_IF_HIP_ERROR(hipSetDevice(device));
+    pool->trim();
+    if(saved_device != device)
+        THROW_IF_HIP_ERROR(hipSetDevice(saved_device));
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Get the peak workspace in use when each function requested workspace
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_workspace_profile(rocblas_handle handle,
+                                                        size_t*        count,
+                                                        const char**   functions,
+                                                        size_t*        peak_bytes)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!count)
+        return rocblas_status_invalid_pointer;
+
+    auto& entries = handle->workspace_profile.entries();
+    if(functions && peak_bytes)
+        for(size_t i = 0; i < *count && i < entries.size(); ++i)
+        {
+            functions[i]  = entries[i].key;
+            peak_bytes[i] = entries[i].peak_bytes;
+        }
+    *count = entries.size();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Write the peak workspace of each function over all handles to a file
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_export_workspace_profile(const char* path)
+try
+{
+    if(!path)
+        return rocblas_status_invalid_pointer;
+    return process_workspace_profile().write(path) ? rocblas_status_success
+                                                   : rocblas_status_internal_error;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Plan the workspace of one call, with the size functions which the call uses
+ ******************************************************************************/
+static rocblas_status plan_workspace_call(const rocblas_workspace_call& call, size_t& size)
+{
+    // Split the function into its name and variant, keeping the _ex suffix of the name
+    std::string name            = call.function;
+    bool        batched         = false;
+    bool        strided_batched = false;
+    auto        strip           = [&](const std::string& suffix) {
+        if(name.size() <= suffix.size()
+           || name.compare(name.size() - suffix.size(), suffix.size(), suffix))
+            return false;
+        name.resize(name.size() - suffix.size());
+        return true;
+    };
+    bool ex = strip("_ex");
+    if(!(strided_batched = strip("_strided_batched")))
+        batched = strip("_batched");
+    if(ex)
+        name += "_ex";
+    rocblas_int batch_count = batched || strided_batched ? call.batch_count : 1;
+
+    rocblas_datatype type       = call.type;
+    size_t           type_bytes = rocblas_sizeof_datatype(type);
+    bool is_complex = type == rocblas_datatype_f32_c || type == rocblas_datatype_f64_c;
+    bool is_blas_type
+        = is_complex || type == rocblas_datatype_f32_r || type == rocblas_datatype_f64_r;
+    bool is_reduction_type
+        = is_blas_type || type == rocblas_datatype_f16_r || type == rocblas_datatype_bf16_r;
+
+    size = 0;
+    if(name == "dot" || name == "dotc" || name == "asum" || name == "nrm2" || name == "iamax"
+       || name == "iamin" || name == "dot_ex" || name == "dotc_ex" || name == "nrm2_ex")
+    {
+        rocblas_int NB         = ROCBLAS_REDUCTION_NB;
+        size_t      work_bytes = type_bytes;
+        if(name == "dot")
+        {
+            if(!is_reduction_type)
+                return rocblas_status_invalid_value;
+            NB *= rocblas_dot_WIN(type_bytes);
+            if(type == rocblas_datatype_bf16_r)
+                work_bytes = sizeof(float);
+        }
+        else if(name == "dotc")
+        {
+            if(!is_complex)
+                return rocblas_status_invalid_value;
+            NB *= rocblas_dot_WIN(type_bytes);
+        }
+        else if(name == "asum" || name == "nrm2")
+        {
+            if(!is_blas_type)
+                return rocblas_status_invalid_value;
+            if(is_complex)
+                work_bytes /= 2;
+        }
+        else if(name == "iamax" || name == "iamin")
+        {
+            if(!is_blas_type)
+                return rocblas_status_invalid_value;
+            NB         = ROCBLAS_IAMAX_IAMIN_NB;
+            work_bytes = type == rocblas_datatype_f32_r || type == rocblas_datatype_f32_c
+                             ? sizeof(rocblas_index_value_t<float>)
+                             : sizeof(rocblas_index_value_t<double>);
+        }
+        else if(!is_reduction_type)
+            return rocblas_status_invalid_value;
+
+        // Empty reductions return without workspace
+        if(call.n > 0 && batch_count > 0)
+            size = roundup_device_memory_size(
+                rocblas_reduction_workspace_size(call.n, batch_count, NB, work_bytes));
+        return rocblas_status_success;
+    }
+
+    // Level 1 functions other than reductions use no workspace
+    if(name == "axpy" || name == "copy" || name == "scal" || name == "swap" || name == "rot"
+       || name == "rotg" || name == "rotm" || name == "rotmg" || name == "axpy_ex"
+       || name == "scal_ex" || name == "rot_ex")
+        return rocblas_status_success;
+
+    // trsv, trmv, tpmv and tbmv have no n, and trtri has no m
+    bool has_m = name != "trtri";
+    bool has_n = name != "trsv" && name != "trmv" && name != "tpmv" && name != "tbmv";
+    if((has_m && call.m < 0) || (has_n && call.n < 0) || batch_count < 0)
+        return rocblas_status_invalid_size;
+
+    // Neither do the level 2 and 3 functions below, nor gemm, nor gemm_ex unless it computes
+    // f16 or bf16 matrices in f32, whose workspace is bounded by the largest of its solutions
+    if(name == "gbmv" || name == "ger" || name == "gerc" || name == "geru" || name == "hbmv"
+       || name == "hemv" || name == "her" || name == "her2" || name == "hpmv" || name == "hpr"
+       || name == "hpr2" || name == "sbmv" || name == "spmv" || name == "spr" || name == "spr2"
+       || name == "symv" || name == "syr" || name == "syr2" || name == "tbsv" || name == "tpsv"
+       || name == "dgmm" || name == "geam" || name == "hemm" || name == "her2k" || name == "herk"
+       || name == "herkx" || name == "symm" || name == "syr2k" || name == "syrk"
+       || name == "syrkx" || name == "trmm" || name == "gemm")
+        return rocblas_status_success;
+    if(name == "gemm_ex")
+    {
+        if(type == rocblas_datatype_f32_r
+           && (call.input_type == rocblas_datatype_f16_r
+               || call.input_type == rocblas_datatype_bf16_r))
+            size = roundup_device_memory_size(
+                rocblas_gemm_ex_hpa_workspace_bound(call.m, call.n, batch_count));
+        return rocblas_status_success;
+    }
+
+    if(name != "gemv" && name != "trsv" && name != "trsm" && name != "trmv" && name != "tpmv"
+       && name != "tbmv" && name != "trtri")
+        return rocblas_status_not_implemented;
+    if(!is_blas_type)
+        return rocblas_status_invalid_value;
+
+    if(name == "gemv")
+        size = roundup_device_memory_size(rocblas_gemv_kernel_workspace_size(
+            type, type_bytes, call.trans, call.m, call.n, batch_count));
+    else if(name == "trsv")
+    {
+        if(call.m && batch_count)
+            size = batched ? rocblas_trsv_workspace_size<ROCBLAS_TRSV_BLOCK, true>(
+                                 type_bytes, call.m, batch_count, false)
+                                 .total()
+                           : rocblas_trsv_workspace_size<ROCBLAS_TRSV_BLOCK, false>(
+                                 type_bytes, call.m, batch_count, false)
+                                 .total();
+    }
+    else if(name == "trsm")
+    {
+        if(call.m && call.n && batch_count && !rocblas_trsm_is_small(call.m, call.n))
+            size = batched ? rocblas_trsm_workspace_size<ROCBLAS_TRSM_BLOCK, true>(
+                                 type_bytes, call.side, call.m, call.n, batch_count, false)
+                                 .total()
+                           : rocblas_trsm_workspace_size<ROCBLAS_TRSM_BLOCK, false>(
+                                 type_bytes, call.side, call.m, call.n, batch_count, false)
+                                 .total();
+    }
+    else if(name == "trtri")
+    {
+        // trtri inverts A of order n; the batched variant also needs an array of pointers, even
+        // when its matrices are too small for temporary ones
+        constexpr rocblas_int NB = ROCBLAS_TRTRI_NB;
+        if(batched)
+        {
+            if(call.n > NB && batch_count)
+                size = rocblas_total_device_memory_size(
+                    {type_bytes * rocblas_trtri_temp_elements(NB, call.n, 1) * batch_count,
+                     sizeof(void*) * batch_count});
+        }
+        else
+            size = roundup_device_memory_size(
+                type_bytes * rocblas_trtri_temp_elements(NB, call.n, batch_count));
+    }
+    else if(call.m && batch_count)
+    {
+        // trmv, tpmv and tbmv copy x of m elements; batched tbmv also needs an array of pointers
+        size_t x_bytes = type_bytes * call.m * batch_count;
+        size           = batched && name == "tbmv"
+                   ? rocblas_total_device_memory_size({x_bytes, sizeof(void*) * batch_count})
+                   : roundup_device_memory_size(x_bytes);
+    }
+    return rocblas_status_success;
+}
+
+/*******************************************************************************
+ * Plan the workspace of a list of calls, without a handle or a device
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_plan_device_memory_size(size_t                        count,
+                                                          const rocblas_workspace_call* calls,
+                                                          size_t*                       sizes,
+                                                          size_t*                       max_size)
+try
+{
+    if(!max_size || (count && !calls))
+        return rocblas_status_invalid_pointer;
+
+    size_t max = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(!calls[i].function)
+            return rocblas_status_invalid_pointer;
+        size_t         size;
+        rocblas_status status = plan_workspace_call(calls[i], size);
+        if(status != rocblas_status_success)
+            return status;
+        if(sizes)
+            sizes[i] = size;
+        max = std::max(max, size);
+    }
+    *max_size = max;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
 /*******************************************************************************
  * Returns whether device memory is rocblas-managed
  ******************************************************************************/
@@ -530,6 +1273,39 @@ static auto open_log_stream(const char* environment_variable_name)
                : std::make_unique<rocblas_internal_ostream>(STDERR_FILENO);
 }
 
+/*******************************************************************************
+ * The timeline log is a Chrome trace JSON array of events, which opens in
+ * Perfetto and chrome://tracing. It is opened once per process, so that it is
+ * not truncated by each handle created, from ROCBLAS_LOG_TIMELINE_PATH or else
+ * rocblas_timeline.json, and each handle writes to a duplicate of it. The array
+ * is closed when the process exits; without its closing bracket, as after a
+ * crash, the log still opens in both viewers.
+ ******************************************************************************/
+static const rocblas_internal_ostream& timeline_log_stream()
+{
+    static struct timeline_log
+    {
+        rocblas_internal_ostream os;
+
+        explicit timeline_log(const char* logfile)
+            : os(logfile)
+        {
+            // Each event is written after a separator, so the array starts with a label
+            os << "[{\"name\":\"process_labels\",\"ph\":\"M\",\"pid\":" << getpid()
+               << ",\"args\":{\"labels\":\"rocBLAS\"}}";
+            os.flush();
+        }
+
+        ~timeline_log()
+        {
+            os << "\n]\n";
+            os.flush();
+        }
+    } log(getenv("ROCBLAS_LOG_TIMELINE_PATH") ? getenv("ROCBLAS_LOG_TIMELINE_PATH")
+                                               : "rocblas_timeline.json");
+    return log.os;
+}
+
 /*******************************************************************************
  * Logging initialization
  ******************************************************************************/
@@ -541,20 +1317,208 @@ void _rocblas_handle::init_logging()
     {
         layer_mode = static_cast<rocblas_layer_mode>(strtol(str_layer_mode, 0, 0));
 
-        // open log_trace file
-        if(layer_mode & rocblas_layer_mode_log_trace)
+        // open binary log file, falling back to text logging if it cannot be opened
+        if(layer_mode & rocblas_layer_mode_log_binary)
+        {
+            const char* logfile = getenv("ROCBLAS_LOG_BINARY_PATH");
+            if(!logfile)
+                logfile = getenv("ROCBLAS_LOG_PATH");
+            if(rocblas_binary_log::start(logfile ? logfile : "rocblas_log.bin"))
+            {
+                // binary profile records are not timed, and binary trace records
+                // are not written to the timeline
+                layer_mode = static_cast<rocblas_layer_mode>(
+                    layer_mode
+                    & ~(rocblas_layer_mode_log_profile_timed | rocblas_layer_mode_log_timeline));
+                return;
+            }
+            layer_mode
+                = static_cast<rocblas_layer_mode>(layer_mode & ~rocblas_layer_mode_log_binary);
+        }
+
+        // open log_trace file, or in timeline mode, the timeline log instead
+        if(!(layer_mode & rocblas_layer_mode_log_trace))
+            layer_mode
+                = static_cast<rocblas_layer_mode>(layer_mode & ~rocblas_layer_mode_log_timeline);
+        else if(layer_mode & rocblas_layer_mode_log_timeline)
+            log_timeline_os
+                = std::make_unique<rocblas_internal_ostream>(timeline_log_stream().dup());
+        else
             log_trace_os = open_log_stream("ROCBLAS_LOG_TRACE_PATH");
 
         // open log_bench file
         if(layer_mode & rocblas_layer_mode_log_bench)
             log_bench_os = open_log_stream("ROCBLAS_LOG_BENCH_PATH");
 
-        // open log_profile file
+        // log scalars in device memory by their addresses, or in lines deferred until
+        // the stream reaches the call, instead of waiting for the stream to copy them
+        const char* str_device_scalars = getenv("ROCBLAS_LOG_DEVICE_SCALARS");
+        switch(str_device_scalars ? strtol(str_device_scalars, 0, 0) : 0)
+        {
+        case 1:
+            log_device_scalars = rocblas_log_device_scalars_mode::deferred;
+            if(log_trace_os || log_bench_os)
+                log_scalars = std::make_unique<rocblas_deferred_log_scalars>();
+            break;
+        case 2:
+            log_device_scalars = rocblas_log_device_scalars_mode::pointer;
+            break;
+        }
+
+        // open log_profile file; calls are only timed when profile logging is text
         if(layer_mode & rocblas_layer_mode_log_profile)
             log_profile_os = open_log_stream("ROCBLAS_LOG_PROFILE_PATH");
+        else
+            layer_mode = static_cast<rocblas_layer_mode>(layer_mode
+                                                         & ~rocblas_layer_mode_log_profile_timed);
     }
 }
 
+/*******************************************************************************
+ * Log sampling initialization
+ *
+ * The first of ROCBLAS_LOG_SAMPLE_EVERY, ROCBLAS_LOG_SAMPLE_FIRST and
+ * ROCBLAS_LOG_RATE_LIMIT which is set to a positive value selects the sampling
+ ******************************************************************************/
+void _rocblas_handle::init_log_sampling()
+{
+    static const auto sampling = [] {
+        static constexpr std::pair<const char*, rocblas_log_sampling_mode> vars[] = {
+            {"ROCBLAS_LOG_SAMPLE_EVERY", rocblas_log_sampling_every_nth},
+            {"ROCBLAS_LOG_SAMPLE_FIRST", rocblas_log_sampling_first_k},
+            {"ROCBLAS_LOG_RATE_LIMIT", rocblas_log_sampling_rate_limit},
+        };
+        for(const auto& var : vars)
+        {
+            const char* env   = getenv(var.first);
+            long        value = env ? strtol(env, nullptr, 0) : 0;
+            if(value > 0)
+                return std::make_pair(var.second, rocblas_int(std::min(value, long(INT32_MAX))));
+        }
+        return std::make_pair(rocblas_log_sampling_off, rocblas_int(0));
+    }();
+
+    log_trace_sampler.set(sampling.first, sampling.second);
+    log_bench_sampler.set(sampling.first, sampling.second);
+}
+
+/*******************************************************************************
+ * Timed profile logging
+ *
+ * Device time is measured with the handle's start and stop events, recorded on
+ * the handle's stream before and after the call. Waiting for the stop event makes
+ * each timed call synchronous. Tensile kernel launches also record these events,
+ * so for gemm the device time starts at the Tensile kernel launch.
+ ******************************************************************************/
+void _rocblas_handle::start_profile_call(std::mutex& mutex, argument_profile_entry& entry)
+{
+    profile_call.mutex  = &mutex;
+    profile_call.entry  = &entry;
+    profile_call.device = startEvent && stopEvent
+                          && hipEventRecord(startEvent, get_stream()) == hipSuccess;
+    profile_call.start  = std::chrono::steady_clock::now();
+}
+
+void _rocblas_handle::finish_profile_call()
+{
+    auto host_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - profile_call.start)
+                       .count();
+
+    float ms     = 0;
+    bool  device = profile_call.device && hipEventRecord(stopEvent, get_stream()) == hipSuccess
+                  && hipEventSynchronize(stopEvent) == hipSuccess
+                  && hipEventElapsedTime(&ms, startEvent, stopEvent) == hipSuccess;
+    uint64_t device_ns = uint64_t(ms * 1e6);
+
+    profile_call.record(host_ns, device ? &device_ns : nullptr);
+    profile_call = {};
+}
+
+/*******************************************************************************
+ * Timeline logging
+ *
+ * Each call is a complete event, whose timestamp is the host time it was entered,
+ * and whose duration lasts until it returned, in microseconds. Timestamps are
+ * taken from the system clock, which most profilers use for their JSON traces,
+ * so that the log lines up with them. Events are written without waiting for
+ * the log's worker thread, so a call never waits on the file.
+ ******************************************************************************/
+static void append_json_string(std::string& json, const char* str, size_t len)
+{
+    for(; len--; ++str)
+    {
+        unsigned char c = *str;
+        if(c == '"' || c == '\\')
+        {
+            json += '\\';
+            json += c;
+        }
+        else if(c < 0x20)
+        {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            json += escape;
+        }
+        else
+            json += c;
+    }
+}
+
+void _rocblas_handle::start_timeline_call(const char* function, const std::string& arguments)
+{
+    static const pid_t      pid = getpid();
+    thread_local const long tid = syscall(SYS_gettid);
+
+    auto ts = std::chrono::duration<double, std::micro>(
+                  std::chrono::system_clock::now().time_since_epoch())
+                  .count();
+
+    char fields[192];
+    snprintf(fields,
+             sizeof(fields),
+             "\",\"cat\":\"rocblas\",\"pid\":%d,\"tid\":%ld,\"ts\":%.3f,"
+             "\"args\":{\"handle\":\"0x%" PRIxPTR "\",\"stream\":\"0x%" PRIxPTR "\","
+             "\"arguments\":\"",
+             int(pid),
+             tid,
+             ts,
+             uintptr_t(this),
+             uintptr_t(get_stream()));
+
+    std::string event = ",\n{\"name\":\"";
+    append_json_string(event, function, strlen(function));
+    event += fields;
+    append_json_string(event, arguments.data(), arguments.size());
+    event += "\"}";
+
+    // A call logged inside of a timed function is finished by its timer, and
+    // any other call is an instant event
+    if(timeline_call.scoped && timeline_call.event.empty())
+    {
+        timeline_call.event = std::move(event);
+        timeline_call.start = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        *log_timeline_os << event << ",\"ph\":\"i\",\"s\":\"t\"}";
+        log_timeline_os->flush_async();
+    }
+}
+
+void _rocblas_handle::finish_timeline_call()
+{
+    auto dur = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()
+                                                         - timeline_call.start)
+                   .count();
+
+    char phase[48];
+    snprintf(phase, sizeof(phase), ",\"ph\":\"X\",\"dur\":%.3f}", dur);
+    *log_timeline_os << timeline_call.event << phase;
+    log_timeline_os->flush_async();
+    timeline_call.event.clear();
+}
+
 /*******************************************************************************
  * Solution fitness query, for internal testing only
  ******************************************************************************/
@@ -607,4 +1571,87 @@ void _rocblas_handle::init_check_numerics()
         check_numerics
             = static_cast<rocblas_check_numerics_mode>(strtol(str_check_numerics_mode, 0, 0));
     }
+
+    // the ring of records in device memory is allocated by the first check
+    if(check_numerics & rocblas_check_numerics_mode_async)
+        check_numerics_records = std::make_unique<rocblas_device_check_numerics_records>(
+            rocblas_hip_check_numerics_backend{check_numerics});
+
+    init_check_numerics_sampling();
+}
+
+/*******************************************************************************
+ * Check_numerics sampling initialization, which also resets the counts
+ ******************************************************************************/
+void _rocblas_handle::init_check_numerics_sampling()
+{
+    check_numerics_sampler = rocblas_check_numerics_sampler();
+
+    // in sampled mode, every Nth call of each function and every Sth element are checked, with
+    // N and S set by ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY and ROCBLAS_CHECK_NUMERICS_SAMPLE_STRIDE
+    if(check_numerics & rocblas_check_numerics_mode_sampled)
+    {
+        auto positive = [](const char* var, long fallback) {
+            const char* env   = getenv(var);
+            long        value = env ? strtol(env, nullptr, 0) : 0;
+            return rocblas_int(std::min(value > 0 ? value : fallback, long(INT32_MAX)));
+        };
+        check_numerics_sampler.set(positive("ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY",
+                                            rocblas_check_numerics_sampler::DEFAULT_EVERY),
+                                   positive("ROCBLAS_CHECK_NUMERICS_SAMPLE_STRIDE", 1));
+    }
+}
+
+/*******************************************************************************
+ * Get the aggregates of the checks of asynchronous check_numerics mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_check_numerics_records(rocblas_handle                 handle,
+                                                             size_t*                        count,
+                                                             rocblas_check_numerics_record* records)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!count)
+        return rocblas_status_invalid_pointer;
+    if(!handle->check_numerics_records)
+    {
+        *count = 0;
+        return rocblas_status_success;
+    }
+
+    // Wait for the checks enqueued so far
+    if(!handle->check_numerics_records->read())
+        return rocblas_status_internal_error;
+
+    auto& aggregates = handle->check_numerics_records->records();
+    if(records)
+        std::copy_n(aggregates.begin(), std::min(*count, aggregates.size()), records);
+    *count = aggregates.size();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Clear the aggregates of the checks of asynchronous check_numerics mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_clear_check_numerics_records(rocblas_handle handle)
+try
+{
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(handle->check_numerics_records)
+    {
+        if(!handle->check_numerics_records->read())
+            return rocblas_status_internal_error;
+        handle->check_numerics_records->clear();
+    }
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
 }
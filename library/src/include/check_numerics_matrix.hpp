@@ -34,7 +34,7 @@ __global__ void rocblas_check_numerics_ge_matrix_kernel(rocblas_int
                                                         rocblas_int               n,
                                                         T                         Aa,
                                                         ptrdiff_t                 offset_a,
-                                                        rocblas_int               lda,
+                                                        ptrdiff_t                 lda,
                                                         rocblas_stride            stride_a,
                                                         rocblas_check_numerics_t* abnormal)
 {
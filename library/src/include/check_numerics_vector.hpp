@@ -30,7 +30,7 @@ template <typename T>
 __global__ void rocblas_check_numerics_vector_kernel(rocblas_int               n,
                                                      T                         xa,
                                                      ptrdiff_t                 offset_x,
-                                                     rocblas_int               inc_x,
+                                                     ptrdiff_t                 inc_x,
                                                      rocblas_stride            stride_x,
                                                      rocblas_check_numerics_t* abnormal)
 {
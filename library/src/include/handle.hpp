@@ -5,7 +5,16 @@
 #pragma once
 
 #include "rocblas.h"
+#include "rocblas_check_numerics_records.hpp"
+#include "rocblas_check_numerics_sampler.hpp"
+#include "rocblas_log_device_scalars.hpp"
+#include "rocblas_log_sampling.hpp"
 #include "rocblas_ostream.hpp"
+#include "rocblas_profile_timing.hpp"
+#include "rocblas_workspace_allocator.hpp"
+#include "rocblas_workspace_pool.hpp"
+#include "rocblas_workspace_profile.hpp"
+#include "rocblas_workspace_size.hpp"
 #include "utility.hpp"
 #include <array>
 #include <cstddef>
@@ -16,18 +25,138 @@
 #include <unistd.h>
 #include <utility>
 
-// Whether rocBLAS can reallocate device memory on demand, at the cost of only
-// allowing one allocation at a time, and at the cost of potential synchronization.
-// If this is 0, then stack-like allocation is allowed, but reallocation on demand
-// does not occur.
+// Whether rocBLAS can reallocate device memory on demand, at the cost of potential
+// synchronization. Reallocation only occurs while no device memory is in use.
+// If this is 0, then reallocation on demand does not occur.
 #define ROCBLAS_REALLOC_ON_DEMAND 1
 
-// Round up size to the nearest MIN_CHUNK_SIZE
-constexpr size_t roundup_device_memory_size(size_t size)
+// Functions which allocate and free device memory, or nullptr for hipMalloc and hipFree
+struct rocblas_device_memory_functions
 {
-    size_t MIN_CHUNK_SIZE = 64;
-    return ((size + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE) * MIN_CHUNK_SIZE;
-}
+    rocblas_device_malloc_fn malloc_fn = nullptr;
+    rocblas_device_free_fn   free_fn   = nullptr;
+    void*                    context   = nullptr;
+
+    bool operator==(const rocblas_device_memory_functions& rhs) const
+    {
+        return malloc_fn == rhs.malloc_fn && free_fn == rhs.free_fn && context == rhs.context;
+    }
+
+    rocblas_status allocate(void** ptr, size_t size, hipStream_t stream) const
+    {
+        if(!malloc_fn)
+            return get_rocblas_status_for_hip_status((hipMalloc)(ptr, size));
+
+        *ptr        = nullptr;
+        auto status = malloc_fn(context, ptr, size, stream);
+        if(status == rocblas_status_success && !*ptr)
+            status = rocblas_status_memory_error;
+        return status;
+    }
+
+    rocblas_status free(void* ptr, size_t size, hipStream_t stream) const
+    {
+        if(!free_fn)
+            return get_rocblas_status_for_hip_status((hipFree)(ptr));
+        return ptr ? free_fn(context, ptr, size, stream) : rocblas_status_success;
+    }
+};
+
+// Device operations of the shared workspace pool of a device, whose slabs are allocated with
+// the device memory functions of the handle which leased them
+struct rocblas_hip_workspace_backend
+{
+    using stream_t    = hipStream_t;
+    using event_t     = hipEvent_t;
+    using allocator_t = rocblas_device_memory_functions;
+
+    // hipFree synchronizes the device, so a replaced slab is no longer in use when it is freed;
+    // other free functions are given a stream which waited for the last use of the slab
+    bool alloc(void** ptr, size_t size, const allocator_t& allocator, stream_t stream)
+    {
+        return allocator.allocate(ptr, size, stream) == rocblas_status_success;
+    }
+    void free(void* ptr, size_t size, const allocator_t& allocator, stream_t stream)
+    {
+        allocator.free(ptr, size, stream);
+    }
+    event_t create_event()
+    {
+        hipEvent_t event = nullptr;
+        hipEventCreateWithFlags(&event, hipEventDisableTiming);
+        return event;
+    }
+    void destroy_event(event_t event)
+    {
+        hipEventDestroy(event);
+    }
+    void record(event_t event, stream_t stream)
+    {
+        hipEventRecord(event, stream);
+    }
+    void wait(stream_t stream, event_t event)
+    {
+        hipStreamWaitEvent(stream, event, 0);
+    }
+};
+
+using rocblas_shared_workspace_pool = rocblas_workspace_pool<rocblas_hip_workspace_backend>;
+
+// Device operations of the records of asynchronous check_numerics mode
+struct rocblas_hip_check_numerics_backend
+{
+    using stream_t = hipStream_t;
+    using flags_t  = rocblas_check_numerics_t;
+
+    // check_numerics mode of the handle, which selects the checks which are printed
+    int check_numerics = 0;
+
+    bool alloc(void** ptr, size_t size)
+    {
+        return (hipMalloc)(ptr, size) == hipSuccess;
+    }
+    void free(void* ptr)
+    {
+        (hipFree)(ptr);
+    }
+    bool clear(void* ptr, size_t size, stream_t stream)
+    {
+        return hipMemsetAsync(ptr, 0, size, stream) == hipSuccess;
+    }
+    bool read(void* host, const void* ptr, size_t size, stream_t stream)
+    {
+        return hipMemcpyAsync(host, ptr, size, hipMemcpyDeviceToHost, stream) == hipSuccess
+               && hipStreamSynchronize(stream) == hipSuccess;
+    }
+
+    // Print and count a check as rocblas_check_numerics_abnormal_struct does, beside which
+    // it is defined
+    void report(const char* function, bool is_input, const flags_t& flags);
+};
+
+using rocblas_device_check_numerics_records
+    = rocblas_check_numerics_records<rocblas_hip_check_numerics_backend>;
+
+// Name of the function calling the function whose default argument this is
+#if defined(__GNUC__) || defined(__clang__)
+#define ROCBLAS_CALLER_FUNCTION __builtin_FUNCTION()
+#else
+#define ROCBLAS_CALLER_FUNCTION "unknown"
+#endif
+
+// A size of device memory, converted implicitly from size_t at the call site, which
+// remembers the function requesting it for the workspace profile
+struct rocblas_workspace_request
+{
+    size_t      size;
+    const char* function;
+
+    rocblas_workspace_request(size_t size, const char* function = ROCBLAS_CALLER_FUNCTION)
+        : size(size)
+        , function(function)
+    {
+    }
+};
 
 // Empty base class for device memory allocation
 struct rocblas_device_malloc_base
@@ -174,6 +303,12 @@ public:
     hipEvent_t startEvent = nullptr;
     hipEvent_t stopEvent  = nullptr;
 
+    // whether startEvent and stopEvent were created by rocBLAS for gemm autotuning
+    bool owns_start_stop_events = false;
+
+    // destroy startEvent and stopEvent if they were created by rocBLAS
+    void destroy_start_stop_events();
+
     // default pointer_mode is on host
     rocblas_pointer_mode pointer_mode = rocblas_pointer_mode_host;
 
@@ -183,18 +318,60 @@ public:
     // default atomics mode allows atomic operations
     rocblas_atomics_mode atomics_mode = rocblas_atomics_allowed;
 
+    // default gemm autotune mode uses the solution selected by Tensile
+    rocblas_gemm_autotune_mode gemm_autotune = rocblas_gemm_autotune_off;
+
     // Selects the benchmark library to be used for solution selection
     rocblas_performance_metric performance_metric = rocblas_default_performance_metric;
 
     // default check_numerics_mode is no numeric_check
     rocblas_check_numerics_mode check_numerics = rocblas_check_numerics_mode_no_check;
+    void                        init_check_numerics();
+
+    // records of the checks in asynchronous check_numerics mode
+    std::unique_ptr<rocblas_device_check_numerics_records> check_numerics_records;
+
+    // sampling of the calls and elements checked, and counts of the calls checked
+    rocblas_check_numerics_sampler check_numerics_sampler;
+    void                           init_check_numerics_sampling();
+
+    // check_numerics mode of a call, which begins the call for the sampling of its checks
+    rocblas_check_numerics_mode begin_check_numerics()
+    {
+        if(check_numerics)
+            check_numerics_sampler.begin_call();
+        return check_numerics;
+    }
 
     // logging streams
     std::unique_ptr<rocblas_internal_ostream> log_trace_os;
     std::unique_ptr<rocblas_internal_ostream> log_bench_os;
     std::unique_ptr<rocblas_internal_ostream> log_profile_os;
     void                                      init_logging();
-    void                                      init_check_numerics();
+
+    // sampling of the calls written to the trace and bench logs
+    rocblas_log_sampler log_trace_sampler;
+    rocblas_log_sampler log_bench_sampler;
+    void                init_log_sampling();
+
+    // logging of scalars in device memory, such as alpha and beta in device pointer mode
+    rocblas_log_device_scalars_mode log_device_scalars = rocblas_log_device_scalars_mode::copy;
+
+    // lines of deferred logging of device scalars, waiting for the values of their scalars
+    std::unique_ptr<rocblas_deferred_log_scalars> log_scalars;
+
+    // call being timed by timed profile logging, which is started by log_profile and
+    // finished by the rocblas_profile_timer of the function
+    argument_profile_call profile_call;
+    void                  start_profile_call(std::mutex& mutex, argument_profile_entry& entry);
+    void                  finish_profile_call();
+
+    // timeline logging, which writes trace logging as Chrome trace JSON events that
+    // start in log_trace and are finished by the rocblas_profile_timer of the function
+    std::unique_ptr<rocblas_internal_ostream> log_timeline_os;
+    rocblas_timeline_call                     timeline_call;
+    void start_timeline_call(const char* function, const std::string& arguments);
+    void finish_timeline_call();
 
     // C interfaces for manipulating device memory
     friend rocblas_status(::rocblas_start_device_memory_size_query)(_rocblas_handle*);
@@ -203,8 +380,20 @@ public:
     friend rocblas_status(::rocblas_set_device_memory_size)(_rocblas_handle*, size_t);
     friend rocblas_status(::free_existing_device_memory)(rocblas_handle);
     friend rocblas_status(::rocblas_set_workspace)(_rocblas_handle*, void*, size_t);
+    friend rocblas_status(::rocblas_set_device_memory_allocator)(_rocblas_handle*,
+                                                                 rocblas_device_malloc_fn,
+                                                                 rocblas_device_free_fn,
+                                                                 void*);
+    friend rocblas_status(::rocblas_get_device_memory_stats)(
+        _rocblas_handle*, size_t*, size_t*, size_t*, size_t*);
+    friend rocblas_status(::rocblas_set_workspace_mode)(_rocblas_handle*, rocblas_workspace_mode);
+    friend rocblas_status(::rocblas_get_workspace_mode)(_rocblas_handle*, rocblas_workspace_mode*);
+    friend rocblas_status(::rocblas_get_workspace_profile)(
+        _rocblas_handle*, size_t*, const char**, size_t*);
     friend bool(::rocblas_is_managing_device_memory)(_rocblas_handle*);
     friend rocblas_status(::rocblas_set_stream)(_rocblas_handle*, hipStream_t);
+    friend rocblas_status(::rocblas_acquire_handle)(_rocblas_handle**, hipStream_t);
+    friend rocblas_status(::rocblas_release_handle)(_rocblas_handle*);
 
     // C interfaces that interact with the solution selection process
     friend rocblas_status(::rocblas_set_solution_fitness_query)(_rocblas_handle*, double*);
@@ -236,13 +425,8 @@ public:
         if(!device_memory_size_query)
             return rocblas_status_size_query_mismatch;
 
-#if __cplusplus >= 201703L
         // Compute the total size, rounding up each size to multiples of MIN_CHUNK_SIZE
-        size_t total = (roundup_device_memory_size(sizes) + ...);
-#else
-        size_t total = 0;
-        auto   dummy = {total += roundup_device_memory_size(sizes)...};
-#endif
+        size_t total = rocblas_total_device_memory_size({size_t(sizes)...});
 
         return total > device_memory_query_size ? device_memory_query_size = total,
                                                   rocblas_status_size_increased
@@ -277,11 +461,77 @@ private:
     // Variables holding state of device memory allocation
     void*                           device_memory            = nullptr;
     size_t                          device_memory_size       = 0;
-    size_t                          device_memory_in_use     = 0;
     bool                            device_memory_size_query = false;
     rocblas_device_memory_ownership device_memory_owner;
     size_t                          device_memory_query_size;
 
+    // Size of the workspace to allocate when it is first needed, which is deferred from handle
+    // creation so that creating a handle does not allocate device memory
+    size_t deferred_device_memory_size = 0;
+    bool   allocate_deferred_device_memory(size_t size);
+
+    // Functions which allocate and free device memory, also of the slabs leased in shared
+    // workspace mode
+    rocblas_device_memory_functions device_memory_functions;
+
+    // Allocate and free device memory with the handle's functions
+    rocblas_status allocate_device_memory(void** ptr, size_t size);
+    rocblas_status free_device_memory(void* ptr, size_t size);
+
+    // Sub-allocator of device_memory, whose blocks may be released in any order
+    rocblas_workspace_allocator workspace;
+
+    // Set device_memory and device_memory_size, and reset the sub-allocator to them
+    void set_device_memory(void* memory, size_t size)
+    {
+        device_memory               = memory;
+        device_memory_size          = size;
+        deferred_device_memory_size = 0;
+        workspace.reset(size);
+    }
+
+    // Allocate a block of workspace for function, returning its sub-allocator id and address,
+    // or false. If function is not nullptr, the workspace then in use is recorded in its profile.
+    bool workspace_allocate(size_t size, int& block, void*& addr, const char* function);
+
+    // Peak workspace in use when each function requested workspace, and recording a peak
+    rocblas_workspace_profile workspace_profile;
+    void                      record_workspace_peak(const char* function, size_t bytes);
+
+    // In shared workspace mode, device_memory is leased from the device's shared pool while
+    // any of it is in use
+    rocblas_workspace_mode                 workspace_mode = rocblas_workspace_private;
+    rocblas_shared_workspace_pool::lease_t workspace_lease;
+
+    // Release a block of workspace, and return any lease once no workspace is in use
+    void workspace_release(int block)
+    {
+        workspace.release(block);
+        if(workspace_lease.slab >= 0 && !workspace.in_use())
+            return_workspace_lease();
+    }
+
+    void return_workspace_lease();
+
+    // Free the shared workspace allocated with the handle's device memory functions
+    void trim_shared_workspace();
+
+    // Size of the GSU workspace to request: the largest free block, the deferred workspace if
+    // it is not allocated yet, or in shared workspace mode without a lease, a default lease
+    size_t gsu_workspace_request() const
+    {
+        return workspace_mode == rocblas_workspace_shared && workspace_lease.slab < 0
+                       && device_memory_owner == rocblas_device_memory_ownership::rocblas_managed
+                   ? DEFAULT_DEVICE_MEMORY_SIZE
+                   : deferred_device_memory_size ? deferred_device_memory_size
+                                                 : workspace.largest_free();
+    }
+
+    // A handle released to the handle pool is destroyed instead if its device memory setup was
+    // changed. The event recorded on release orders reuse of its workspace on another stream.
+    bool       device_memory_reconfigured = false;
+    hipEvent_t pool_release_event         = nullptr;
+
     // Solution fitness query (used for internal testing)
     double* solution_fitness_query = nullptr;
 
@@ -289,7 +539,7 @@ private:
     hipStream_t stream = 0;
 
 #if ROCBLAS_REALLOC_ON_DEMAND
-    // Helper for device memory allocator
+    // Helper for growing device memory which is not in use to size bytes
     bool device_allocator(size_t size);
 #endif
 
@@ -300,15 +550,17 @@ private:
     const int arch;
 
     // Opaque smart allocator class to perform device memory allocations
+    // Objects may be destroyed in any order
     // clang-format off
     class [[nodiscard]] _device_malloc : public rocblas_device_malloc_base
     {
     protected:
         // Order is important:
         rocblas_handle handle;
-        size_t         prev_device_memory_in_use;
         size_t         size;
         bool           success;
+        int            block; // sub-allocator block, or -1 if none
+        const char*    function; // function requesting the memory, or nullptr
 
     private:
         std::vector<void*> pointers; // Important: must come last
@@ -324,79 +576,72 @@ private:
             size_t old;
             size_t offsets[] = {(old = size, size += roundup_device_memory_size(sizes), old)...};
 
-#if ROCBLAS_REALLOC_ON_DEMAND
-            success = handle->device_allocator(size);
-#else
-            success = size <= handle->device_memory_size - handle->device_memory_in_use;
-#endif
+            // We allocate the total amount needed, taking it from the available device memory.
+            void* base;
+            success = handle->workspace_allocate(size, block, base, function);
 
             // If allocation failed, return an array of nullptr's
             // If total size is 0, return an array of nullptr's, but leave it marked as successful
             if(!success || !size)
                 return decltype(pointers)(sizeof...(sizes));
 
-            // We allocate the total amount needed, taking it from the available device memory.
-            char* addr = static_cast<char*>(handle->device_memory) + handle->device_memory_in_use;
-            handle->device_memory_in_use += size;
-
             // An array of pointers to all of the allocated arrays is formed.
             // If a size is 0, the corresponding pointer is nullptr
-            size_t i = 0;
+            char*  addr = static_cast<char*>(base);
+            size_t i    = 0;
             return {!sizes ? i++, nullptr : addr + offsets[i++]...};
         }
 
+        // Allocate count pointers to the same buffer
+        decltype(pointers) allocate_count(size_t count)
+        {
+            void* base;
+            success = handle->workspace_allocate(size, block, base, function);
+            return decltype(pointers)(count, success ? base : nullptr);
+        }
+
     public:
         // Constructor
         template <typename... Ss>
-        explicit _device_malloc(rocblas_handle handle, Ss... sizes)
+        explicit _device_malloc(rocblas_handle handle, const char* function, Ss... sizes)
             : handle(handle)
-            , prev_device_memory_in_use(handle->device_memory_in_use)
             , size(0)
             , success(false)
+            , block(-1)
+            , function(function)
             , pointers(allocate_pointers(size_t(sizes)...))
         {
         }
 
         // Constructor for allocating count pointers of a certain total size
-        explicit _device_malloc(rocblas_handle handle, std::nullptr_t, size_t count, size_t total)
+        explicit _device_malloc(rocblas_handle handle,
+                                const char*    function,
+                                std::nullptr_t,
+                                size_t count,
+                                size_t total)
             : handle(handle)
-            , prev_device_memory_in_use(handle->device_memory_in_use)
             , size(roundup_device_memory_size(total))
-            , success(
-                    #if ROCBLAS_REALLOC_ON_DEMAND
-                        handle->device_allocator(size)
-                    #else
-                        size <= handle->device_memory_size - handle->device_memory_in_use
-                    #endif
-                     )
-            , pointers(count,
-                       success ? static_cast<char*>(handle->device_memory)
-                                     + handle->device_memory_in_use
-                               : nullptr)
+            , success(false)
+            , block(-1)
+            , function(function)
+            , pointers(allocate_count(count))
         {
-            if(success)
-                handle->device_memory_in_use += size;
         }
 
         // Move constructor
-        // Warning: This should only be used to move temporary expressions,
-        // such as the return values of functions and initialization with
-        // rvalues. If std::move() is used to move a _device_malloc object
-        // from a variable, then there must not be any alive allocations made
-        // between the initialization of the variable and the object that it
-        // moves to, or the LIFO ordering will be violated and flagged.
         _device_malloc(_device_malloc&& other) noexcept
             : handle(other.handle)
-            , prev_device_memory_in_use(other.prev_device_memory_in_use)
             , size(other.size)
             , success(other.success)
+            , block(other.block)
+            , function(other.function)
             , pointers(std::move(other.pointers))
         {
             other.success = false;
+            other.block   = -1;
         }
 
-        // Move assignment is allowed as long as the object being assigned to
-        // is 0-sized or an unsuccessful previous allocation.
+        // Move assignment releases the memory of the object being assigned to
         _device_malloc& operator=(_device_malloc&& other) & noexcept
         {
             this->~_device_malloc();
@@ -407,28 +652,12 @@ private:
         _device_malloc(const _device_malloc&) = delete;
         _device_malloc& operator=(const _device_malloc&) = delete;
 
-        // The destructor marks the device memory as no longer in use
+        // The destructor returns the block to the handle's sub-allocator
         ~_device_malloc()
         {
-            // If success == false or size == 0, the destructor is a no-op
-            if(success && size)
-            {
-                // Subtract size from the handle's device_memory_in_use, making sure
-                // it matches the device_memory_in_use when this object was created.
-                if((handle->device_memory_in_use -= size) != prev_device_memory_in_use)
-                {
-                    rocblas_cerr
-                        << "rocBLAS internal error: device_malloc() RAII object not "
-                           "destroyed in LIFO order.\n"
-                           "Objects returned by device_malloc() must be 0-sized, "
-                           "unsuccessfully allocated,\n"
-                           "or destroyed in the reverse order that they are created.\n"
-                           "device_malloc() objects cannot be assigned to unless they are 0-sized\n"
-                           "or they were unsuccessfully allocated previously."
-                        << std::endl;
-                    rocblas_abort();
-                }
-            }
+            // If success == false or size == 0, there is no block and the destructor is a no-op
+            if(block >= 0)
+                handle->workspace_release(block);
         }
 
         // In the following functions, the trailing & prevents the functions from
@@ -458,13 +687,14 @@ private:
     };
     // clang-format on
 
-    // For HPA kernel calls, all available device memory is allocated and passed to Tensile
+    // For HPA kernel calls, the largest free block of device memory is allocated and passed to
+    // Tensile, or in shared workspace mode, a default lease if no workspace is leased
     // clang-format off
     class [[nodiscard]] _gsu_malloc final : _device_malloc
     {
     public:
         explicit _gsu_malloc(rocblas_handle handle)
-            : _device_malloc(handle, handle->device_memory_size - handle->device_memory_in_use)
+            : _device_malloc(handle, nullptr, handle->gsu_workspace_request())
         {
             handle->gsu_workspace_size = success ? size : 0;
             handle->gsu_workspace      = static_cast<void*>(*this);
@@ -485,19 +715,20 @@ private:
     // clang-format on
 
 public:
-    // Allocate one or more sizes
+    // Allocate one or more sizes, recording the calling function in the workspace profile
     template <typename... Ss,
-              std::enable_if_t<sizeof...(Ss) && conjunction<std::is_convertible<Ss, size_t>...>{},
-                               int> = 0>
-    auto device_malloc(Ss... sizes)
+              std::enable_if_t<conjunction<std::is_convertible<Ss, size_t>...>{}, int> = 0>
+    auto device_malloc(rocblas_workspace_request first, Ss... sizes)
     {
-        return _device_malloc(this, size_t(sizes)...);
+        return _device_malloc(this, first.function, first.size, size_t(sizes)...);
     }
 
     // Allocate count pointers, reserving "size" total bytes
-    auto device_malloc_count(size_t count, size_t size)
+    auto device_malloc_count(size_t      count,
+                             size_t      size,
+                             const char* function = ROCBLAS_CALLER_FUNCTION)
     {
-        return _device_malloc(this, nullptr, count, size);
+        return _device_malloc(this, function, nullptr, count, size);
     }
 
     // Variables holding state of GSU device memory allocation
@@ -5,6 +5,9 @@
 #pragma once
 
 #include "handle.hpp"
+#include "rocblas_argument_profile.hpp"
+#include "rocblas_binary_log.hpp"
+#include "rocblas_metrics.hpp"
 #include "rocblas_ostream.hpp"
 #include "tuple_helper.hpp"
 #include <cmath>
@@ -15,7 +18,6 @@
 #include <map>
 #include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -23,103 +25,161 @@
 #include <utility>
 
 /************************************************************************************
- * Profile kernel arguments
+ * Binary logging of arguments, instead of text, when
+ * (handle->layer_mode & rocblas_layer_mode_log_binary) != 0
+ *
+ * Each argument is recorded as the value which the text logs would format, so that
+ * the decoder can format it the same way: enumerations which print as strings or
+ * letters are recorded as those, and other types which have no fixed layout are
+ * recorded as their formatted text.
  ************************************************************************************/
-template <typename TUP>
-class argument_profile
+template <typename T, std::enable_if_t<std::is_arithmetic<T>{}, int> = 0>
+inline void log_binary_argument(rocblas_binary_log_ring& ring, T x)
 {
-    // Output stream
-    mutable rocblas_internal_ostream os;
+    ring.put(x);
+}
 
-    // Mutex for multithreaded access to table
-    mutable std::shared_timed_mutex mutex;
+template <typename T, std::enable_if_t<std::is_enum<T>{}, int> = 0>
+inline void log_binary_argument(rocblas_binary_log_ring& ring, T x)
+{
+    ring.put(std::underlying_type_t<T>(x));
+}
 
-    // Table mapping argument tuples into counts
-    // size_t is used for the map target type since atomic types are not movable, and
-    // the map elements will only be moved when we hold an exclusive lock to the map.
-    std::unordered_map<TUP,
-                       size_t,
-                       typename tuple_helper::hash_t<TUP>,
-                       typename tuple_helper::equal_t<TUP>>
-        map;
+template <typename T>
+inline void log_binary_argument(rocblas_binary_log_ring& ring, T* p)
+{
+    ring.put_pointer(p);
+}
 
-public:
-    // A tuple of arguments is looked up in an unordered map.
-    // A count of the number of calls with these arguments is kept.
-    // arg is assumed to be an rvalue for efficiency
-    void operator()(TUP&& arg)
-    {
-        { // Acquire a shared lock for reading map
-            std::shared_lock<std::shared_timed_mutex> lock(mutex);
-
-            // Look up the tuple in the map
-            auto p = map.find(arg);
-
-            // If tuple already exists, atomically increment count and return
-            if(p != map.end())
-            {
-                __atomic_fetch_add(&p->second, 1, __ATOMIC_SEQ_CST);
-                return;
-            }
-        } // Release shared lock
-
-        { // Acquire an exclusive lock for modifying map
-            std::lock_guard<std::shared_timed_mutex> lock(mutex);
-
-            // If doesn't already exist, insert tuple by moving arg and initializing count to 0.
-            // Increment the count after searching for tuple and returning old or new match.
-            // We hold a lock to the map, so we don't have to increment the count atomically.
-            map.emplace(std::move(arg), 0).first->second++;
-        } // Release exclusive lock
-    }
+inline void log_binary_argument(rocblas_binary_log_ring& ring, const char* s)
+{
+    ring.put_string(s);
+}
 
-    // Constructor
-    // We must duplicate the rocblas_internal_ostream to avoid dependence on static destruction order
-    explicit argument_profile(rocblas_internal_ostream& os)
-        : os(os.dup())
-    {
-    }
+inline void log_binary_argument(rocblas_binary_log_ring& ring, char* s)
+{
+    ring.put_string(s);
+}
 
-    // Dump the current profile
-    void dump() const
-    {
-        // Acquire an exclusive lock to use map
-        std::lock_guard<std::shared_timed_mutex> lock(mutex);
+inline void log_binary_argument(rocblas_binary_log_ring& ring, const std::string& s)
+{
+    ring.put_text(s.data(), s.size());
+}
 
-        // Clear the output buffer
-        os.clear();
+inline void log_binary_argument(rocblas_binary_log_ring& ring, const rocblas_internal_ostream& os)
+{
+    log_binary_argument(ring, os.str());
+}
 
-        // Print all of the tuples in the map
-        for(const auto& p : map)
-        {
-            os << "- ";
-            tuple_helper::print_tuple_pairs(
-                os, std::tuple_cat(p.first, std::make_tuple("call_count", p.second)));
-        }
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_half x)
+{
+    ring.put(float(x));
+}
 
-        // Flush out the dump
-        os.flush();
-    }
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_bfloat16 x)
+{
+    ring.put(float(x));
+}
 
-    // Cleanup handler which dumps profile at destruction
-    ~argument_profile()
-    try
-    {
-        dump();
-    }
-    catch(...)
-    {
-        return;
-    }
-};
+template <typename T>
+inline void log_binary_argument(rocblas_binary_log_ring& ring, const rocblas_complex_num<T>& x)
+{
+    ring.put_complex(std::real(x), std::imag(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_datatype x)
+{
+    ring.put_string(rocblas_datatype_string(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_operation x)
+{
+    ring.put(rocblas_transpose_letter(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_fill x)
+{
+    ring.put(rocblas_fill_letter(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_diagonal x)
+{
+    ring.put(rocblas_diag_letter(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_side x)
+{
+    ring.put(rocblas_side_letter(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_status x)
+{
+    ring.put_string(rocblas_status_to_string(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_atomics_mode x)
+{
+    ring.put_string(rocblas_atomics_mode_to_string(x));
+}
+
+inline void log_binary_argument(rocblas_binary_log_ring& ring, rocblas_gemm_flags x)
+{
+    ring.put_string(rocblas_gemm_flags_to_string(x));
+}
+
+// Any other type is formatted as text, as YAML in profile records
+template <typename T,
+          std::enable_if_t<!std::is_arithmetic<T>{} && !std::is_enum<T>{} && !std::is_pointer<T>{}
+                               && !std::is_array<T>{},
+                           int> = 0>
+void log_binary_argument(rocblas_binary_log_ring& ring, const T& x)
+{
+    rocblas_internal_ostream os;
+    if(ring.kind() == rocblas_binary_log_profile)
+        os << rocblas_internal_ostream::yaml_on;
+    os << x;
+    auto str = os.str();
+    ring.put_text(str.data(), str.size(), true);
+}
+
+// Record the arguments of a call in the ring of the calling thread
+template <typename... Ts>
+void log_binary(rocblas_binary_log_kind kind, Ts&&... xs)
+{
+    auto& ring = rocblas_binary_log::ring();
+    ring.begin(kind);
+    (void)(int[]){0, (log_binary_argument(ring, std::forward<Ts>(xs)), 0)...};
+    ring.commit();
+}
+
+// log_metrics counts a call in the metrics, which are always on, under its function and
+// precision, and its size, the product of its dimensions and batch count. Device memory
+// size queries are not counted.
+template <typename... Ts>
+void log_metrics(rocblas_handle handle, const char* func, rocblas_datatype precision, Ts... dims)
+{
+    if(!handle->is_device_memory_size_query())
+        rocblas_metrics::record_call(func, precision, rocblas_metrics::call_size(dims...));
+}
 
 // if profile logging is turned on with
 // (handle->layer_mode & rocblas_layer_mode_log_profile) != 0
 // log_profile will call argument_profile to profile actual arguments,
-// keeping count of the number of times each set of arguments is used
+// keeping count of the number of times each set of arguments is used,
+// and with (handle->layer_mode & rocblas_layer_mode_log_profile_timed) != 0,
+// the time of the calls, which the caller must finish with a rocblas_profile_timer
 template <typename... Ts>
 void log_profile(rocblas_handle handle, const char* func, Ts&&... xs)
 {
+    // Binary profile records are counted by the decoder
+    if(handle->layer_mode & rocblas_layer_mode_log_binary)
+        return log_binary(rocblas_binary_log_profile,
+                          "rocblas_function",
+                          func,
+                          "atomics_mode",
+                          handle->atomics_mode,
+                          std::forward<Ts>(xs)...);
+
     // Make a tuple with the arguments
     auto tup = std::make_tuple(
         "rocblas_function", func, "atomics_mode", handle->atomics_mode, std::forward<Ts>(xs)...);
@@ -130,10 +190,64 @@ void log_profile(rocblas_handle handle, const char* func, Ts&&... xs)
     // Add at_quick_exit handler in case the program exits early
     static int aqe = at_quick_exit([] { profile.~argument_profile(); });
 
-    // Profile the tuple
-    profile(std::move(tup));
+    // Set up the counter of this thread
+    thread_local typename argument_profile<decltype(tup)>::counter counter(profile);
+
+    // Profile the tuple, and in timed profile mode, start timing the call
+    auto& entry = counter(std::move(tup));
+    if(handle->layer_mode & rocblas_layer_mode_log_profile_timed)
+        handle->start_profile_call(counter.mutex(), entry);
 }
 
+/************************************************************************************
+ * Timer of the calls profiled in timed profile logging, and written to the timeline
+ *
+ * It is declared at the start of each function which calls log_profile, and it
+ * finishes timing the call which log_profile started, and the timeline event which
+ * log_trace started, when it goes out of scope. A call made with the same handle
+ * inside of the function is timed on its own.
+ ************************************************************************************/
+class rocblas_profile_timer
+{
+    rocblas_handle        handle;
+    argument_profile_call outer; // call of the enclosing function, if any
+    rocblas_timeline_call outer_timeline;
+
+public:
+    explicit rocblas_profile_timer(rocblas_handle handle)
+        : handle(handle
+                         && (handle->layer_mode
+                             & (rocblas_layer_mode_log_profile_timed
+                                | rocblas_layer_mode_log_timeline))
+                     ? handle
+                     : nullptr)
+    {
+        if(this->handle)
+        {
+            std::swap(outer, handle->profile_call);
+            std::swap(outer_timeline, handle->timeline_call);
+            handle->timeline_call.scoped = true;
+        }
+    }
+
+    ~rocblas_profile_timer()
+    {
+        if(handle)
+        {
+            // The timeline event ends before timed profiling waits for the device
+            if(!handle->timeline_call.event.empty())
+                handle->finish_timeline_call();
+            if(handle->profile_call.entry)
+                handle->finish_profile_call();
+            handle->profile_call  = outer;
+            handle->timeline_call = std::move(outer_timeline);
+        }
+    }
+
+    rocblas_profile_timer(const rocblas_profile_timer&) = delete;
+    rocblas_profile_timer& operator=(const rocblas_profile_timer&) = delete;
+};
+
 /********************************************
  * Log values (for log_trace and log_bench) *
  ********************************************/
@@ -147,28 +261,135 @@ void log_arguments(rocblas_internal_ostream& os, const char* sep, H&& head, Ts&&
     os << std::endl;
 }
 
+// log_deferred formats a line holding scalars captured by deferred logging of device
+// scalars, which is written to os once the handle's stream reaches the call
+template <typename... Ts>
+void log_deferred(rocblas_handle handle, rocblas_internal_ostream& os, const char* sep, Ts&&... xs)
+{
+    rocblas_internal_ostream line;
+    log_arguments(line, sep, std::forward<Ts>(xs)...);
+    handle->log_scalars->write(handle->get_stream(), os, line.str());
+}
+
+// log_timeline starts the timeline event of a call, with the function's arguments
+// after its name joined by commas, as trace logging writes them
+template <typename... Ts>
+void log_timeline(rocblas_handle handle, const char* func, Ts&&... xs)
+{
+    rocblas_internal_ostream args;
+    const char*              sep = "";
+    (void)(int[]){0, (args << sep << std::forward<Ts>(xs), sep = ",", 0)...};
+    handle->start_timeline_call(func, args.str());
+}
+
+/************************************************************************************
+ * A scalar argument of log_trace or log_bench, which may be in device memory, from
+ * LOG_TRACE_SCALAR_VALUE or LOG_BENCH_SCALAR_VALUE. It is only formatted, which may
+ * copy it to the host, once the handle's log sampling selects the call. Sampling
+ * the first K calls hashes its value in host pointer mode, and ignores it otherwise.
+ ************************************************************************************/
+template <typename T>
+struct rocblas_log_scalar_arg
+{
+    rocblas_handle handle;
+    const T*       value;
+    const char*    name; // name of the bench argument, or nullptr for trace logging
+
+    const T* host_value() const
+    {
+        return handle->pointer_mode == rocblas_pointer_mode_host ? value : nullptr;
+    }
+};
+
+template <typename T>
+std::string log_scalar_argument(const rocblas_log_scalar_arg<T>& x);
+
+template <typename T>
+std::string log_scalar_argument(rocblas_log_scalar_arg<T>& x)
+{
+    return log_scalar_argument(static_cast<const rocblas_log_scalar_arg<T>&>(x));
+}
+
+template <typename T>
+std::string log_scalar_argument(rocblas_log_scalar_arg<T>&& x)
+{
+    return log_scalar_argument(static_cast<const rocblas_log_scalar_arg<T>&>(x));
+}
+
+// Other arguments are logged as they are
+template <typename T>
+T&& log_scalar_argument(T&& x)
+{
+    return std::forward<T>(x);
+}
+
 // if trace logging is turned on with
 // (handle->layer_mode & rocblas_layer_mode_log_trace) != 0
-// log_function will call log_arguments to log arguments with a comma separator
+// log_function will call log_arguments to log arguments with a comma separator,
+// for the calls selected by the handle's log sampling, and with
+// (handle->layer_mode & rocblas_layer_mode_log_timeline) != 0
+// it will call log_timeline to write the call as a timeline event instead
+template <typename... Ts>
+void log_trace_sampled(rocblas_handle handle, Ts&&... xs)
+{
+    if(handle->layer_mode & rocblas_layer_mode_log_binary)
+        log_binary(rocblas_binary_log_trace, std::forward<Ts>(xs)..., handle->atomics_mode);
+    else if(handle->layer_mode & rocblas_layer_mode_log_timeline)
+        log_timeline(handle, std::forward<Ts>(xs)..., handle->atomics_mode);
+    else if(handle->log_scalars && handle->log_scalars->pending())
+        log_deferred(
+            handle, *handle->log_trace_os, ",", std::forward<Ts>(xs)..., handle->atomics_mode);
+    else
+        log_arguments(*handle->log_trace_os, ",", std::forward<Ts>(xs)..., handle->atomics_mode);
+}
+
+// Scalars are formatted, and captured by deferred logging, only for the calls sampled
 template <typename... Ts>
 void log_trace(rocblas_handle handle, Ts&&... xs)
 {
-    log_arguments(*handle->log_trace_os, ",", std::forward<Ts>(xs)..., handle->atomics_mode);
+    if(handle->log_trace_sampler(xs...))
+        log_trace_sampled(handle, log_scalar_argument(std::forward<Ts>(xs))...);
 }
 
 // if bench logging is turned on with
 // (handle->layer_mode & rocblas_layer_mode_log_bench) != 0
 // log_bench will call log_arguments to log a string that
-// can be input to the executable rocblas-bench.
+// can be input to the executable rocblas-bench, for the calls
+// selected by the handle's log sampling.
 template <typename... Ts>
-void log_bench(rocblas_handle handle, Ts&&... xs)
+void log_bench_sampled(rocblas_handle handle, Ts&&... xs)
 {
-    if(handle->atomics_mode == rocblas_atomics_not_allowed)
+    if(handle->layer_mode & rocblas_layer_mode_log_binary)
+    {
+        if(handle->atomics_mode == rocblas_atomics_not_allowed)
+            log_binary(rocblas_binary_log_bench, std::forward<Ts>(xs)..., "--atomics_not_allowed");
+        else
+            log_binary(rocblas_binary_log_bench, std::forward<Ts>(xs)...);
+    }
+    else if(handle->log_scalars && handle->log_scalars->pending())
+    {
+        if(handle->atomics_mode == rocblas_atomics_not_allowed)
+            log_deferred(handle,
+                         *handle->log_bench_os,
+                         " ",
+                         std::forward<Ts>(xs)...,
+                         "--atomics_not_allowed");
+        else
+            log_deferred(handle, *handle->log_bench_os, " ", std::forward<Ts>(xs)...);
+    }
+    else if(handle->atomics_mode == rocblas_atomics_not_allowed)
         log_arguments(*handle->log_bench_os, " ", std::forward<Ts>(xs)..., "--atomics_not_allowed");
     else
         log_arguments(*handle->log_bench_os, " ", std::forward<Ts>(xs)...);
 }
 
+template <typename... Ts>
+void log_bench(rocblas_handle handle, Ts&&... xs)
+{
+    if(handle->log_bench_sampler(xs...))
+        log_bench_sampled(handle, log_scalar_argument(std::forward<Ts>(xs))...);
+}
+
 /*************************************************
  * Trace log scalar values pointed to by pointer *
  *************************************************/
@@ -191,6 +412,25 @@ inline T log_trace_scalar_value(const T* value)
                      std::numeric_limits<typename T::value_type>::quiet_NaN()};
 }
 
+// Format a scalar captured by deferred logging of device scalars
+template <typename T>
+std::string log_trace_scalar_format(const void* value, const char*)
+{
+    rocblas_internal_ostream os;
+    os << log_trace_scalar_value(static_cast<const T*>(value));
+    return os.str();
+}
+
+// Log a scalar in device memory by its address
+inline std::string log_device_scalar_address(const void* value)
+{
+    rocblas_internal_ostream os;
+    os << "device:" << value;
+    return os.str();
+}
+
+// A scalar in device memory is copied to the host, or with ROCBLAS_LOG_DEVICE_SCALARS,
+// captured for a deferred line when the line is written as text, or logged by its address
 template <typename T>
 std::string log_trace_scalar_value(rocblas_handle handle, const T* value)
 {
@@ -198,6 +438,14 @@ std::string log_trace_scalar_value(rocblas_handle handle, const T* value)
     T                        host;
     if(value && handle->pointer_mode == rocblas_pointer_mode_device)
     {
+        if(handle->log_device_scalars != rocblas_log_device_scalars_mode::copy)
+        {
+            std::string captured;
+            if(handle->log_scalars && !(handle->layer_mode & rocblas_layer_mode_log_timeline))
+                captured = handle->log_scalars->capture(
+                    handle->get_stream(), value, sizeof(T), log_trace_scalar_format<T>, nullptr);
+            return captured.empty() ? log_device_scalar_address(value) : captured;
+        }
         hipMemcpy(&host, value, sizeof(host), hipMemcpyDeviceToHost);
         value = &host;
     }
@@ -205,7 +453,7 @@ std::string log_trace_scalar_value(rocblas_handle handle, const T* value)
     return os.str();
 }
 
-#define LOG_TRACE_SCALAR_VALUE(handle, value) log_trace_scalar_value(handle, value)
+#define LOG_TRACE_SCALAR_VALUE(handle, value) make_log_scalar_arg(handle, value, nullptr)
 
 /*************************************************
  * Bench log scalar values pointed to by pointer *
@@ -236,19 +484,50 @@ std::string log_bench_scalar_value(const char* name, const T* value)
     return ss.str();
 }
 
+// Format a scalar captured by deferred logging of device scalars
+template <typename T>
+std::string log_bench_scalar_format(const void* value, const char* name)
+{
+    return log_bench_scalar_value(name, static_cast<const T*>(value));
+}
+
 template <typename T>
 std::string log_bench_scalar_value(rocblas_handle handle, const char* name, const T* value)
 {
     T host;
     if(value && handle->pointer_mode == rocblas_pointer_mode_device)
     {
+        if(handle->log_device_scalars != rocblas_log_device_scalars_mode::copy)
+        {
+            std::string captured;
+            if(handle->log_scalars)
+                captured = handle->log_scalars->capture(
+                    handle->get_stream(), value, sizeof(T), log_bench_scalar_format<T>, name);
+            return captured.empty()
+                       ? std::string("--") + name + " " + log_device_scalar_address(value)
+                       : captured;
+        }
         hipMemcpy(&host, value, sizeof(host), hipMemcpyDeviceToHost);
         value = &host;
     }
     return log_bench_scalar_value(name, value);
 }
 
-#define LOG_BENCH_SCALAR_VALUE(handle, name) log_bench_scalar_value(handle, #name, name)
+#define LOG_BENCH_SCALAR_VALUE(handle, name) make_log_scalar_arg(handle, name, #name)
+
+template <typename T>
+rocblas_log_scalar_arg<T>
+    make_log_scalar_arg(rocblas_handle handle, const T* value, const char* name)
+{
+    return {handle, value, name};
+}
+
+template <typename T>
+std::string log_scalar_argument(const rocblas_log_scalar_arg<T>& x)
+{
+    return x.name ? log_bench_scalar_value(x.handle, x.name, x.value)
+                  : log_trace_scalar_value(x.handle, x.value);
+}
 
 /******************************************************
  * Bench log precision for mixed precision scal calls *
@@ -0,0 +1,127 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+ * rocblas_arch_registry holds state which is shared by all devices of the   *
+ * same architecture, e.g. the Tensile library and its code object index. A  *
+ * node may mix GPUs of several architectures, so each device is mapped to   *
+ * the state of its own architecture, which is created by the first device   *
+ * of that architecture to need it. States of different architectures are    *
+ * created concurrently, and live until the registry is destroyed.           *
+ *                                                                           *
+ * The architecture of each device is found by a query function, so that     *
+ * the registry does not depend on HIP and can be tested with mock devices.  *
+ *****************************************************************************/
+template <typename STATE>
+class rocblas_arch_registry
+{
+public:
+    // Returns the architecture name of a device, e.g. "gfx908"
+    using query_t = std::function<std::string(int device)>;
+
+    rocblas_arch_registry(int device_count, query_t query)
+        : m_devices(device_count)
+        , m_query(std::move(query))
+    {
+    }
+
+    rocblas_arch_registry(const rocblas_arch_registry&) = delete;
+    rocblas_arch_registry& operator=(const rocblas_arch_registry&) = delete;
+
+    int device_count() const
+    {
+        return int(m_devices.size());
+    }
+
+    // The architecture name of a device
+    const std::string& arch(int device)
+    {
+        auto& d = m_devices.at(device);
+        std::call_once(d.queried, [&] { d.arch = m_query(device); });
+        return d.arch;
+    }
+
+    /*************************************************************************
+     * Return the state of a device's architecture. If it does not exist     *
+     * yet, create(arch) returns a std::unique_ptr<STATE> for it, while      *
+     * other devices of the same architecture wait. If create() throws, the  *
+     * exception is propagated, and the next call tries again.               *
+     *************************************************************************/
+    template <typename CREATE>
+    STATE& get(int device, CREATE&& create)
+    {
+        auto& d     = m_devices.at(device);
+        auto* state = d.state.load(std::memory_order_acquire);
+        if(state)
+            return *state;
+
+        const std::string& name = arch(device);
+        arch_s*            a;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto&                       entry = m_archs[name];
+            if(!entry)
+                entry.reset(new arch_s);
+            a = entry.get();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(a->mutex);
+            if(!a->state)
+                a->state = create(name);
+            state = a->state.get();
+        }
+
+        d.state.store(state, std::memory_order_release);
+        return *state;
+    }
+
+    // The state of a device's architecture, or nullptr if it was not created yet
+    STATE* find(int device) const
+    {
+        return m_devices.at(device).state.load(std::memory_order_acquire);
+    }
+
+    // Call func(arch, state) for each architecture whose state was created
+    template <typename FUNC>
+    void for_each(FUNC&& func) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto& a : m_archs)
+        {
+            std::lock_guard<std::mutex> arch_lock(a.second->mutex);
+            if(a.second->state)
+                func(a.first, *a.second->state);
+        }
+    }
+
+private:
+    struct device_s
+    {
+        std::once_flag      queried;
+        std::string         arch;
+        std::atomic<STATE*> state{nullptr};
+    };
+
+    struct arch_s
+    {
+        std::mutex             mutex;
+        std::unique_ptr<STATE> state;
+    };
+
+    std::vector<device_s>                          m_devices;
+    query_t                                        m_query;
+    mutable std::mutex                             m_mutex;
+    std::map<std::string, std::unique_ptr<arch_s>> m_archs;
+};
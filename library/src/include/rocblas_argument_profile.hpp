@@ -0,0 +1,217 @@
+/* ************************************************************************
+ * Copyright 2016-2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas_ostream.hpp"
+#include "rocblas_profile_timing.hpp"
+#include "tuple_helper.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/************************************************************************************
+ * Profile kernel arguments
+ *
+ * Each thread counts the argument tuples it profiles in its own table, which only
+ * it and dump() lock, so that threads profiling the same or different arguments
+ * do not contend. dump() merges the tables of all threads, and the tables of
+ * threads which have exited are merged when they exit.
+ ************************************************************************************/
+template <typename TUP>
+class argument_profile
+{
+    // Table mapping argument tuples into counts and times
+    using map_t = std::unordered_map<TUP,
+                                     argument_profile_entry,
+                                     typename tuple_helper::hash_t<TUP>,
+                                     typename tuple_helper::equal_t<TUP>>;
+
+    // The counts of one thread
+    struct thread_counts
+    {
+        std::mutex mutex;
+        map_t      map;
+    };
+
+    // The counts of all threads, which are shared with the threads so that they can be
+    // merged when a thread exits, even after the profile has been destroyed
+    struct shared_counts
+    {
+        std::mutex                                  mutex;
+        std::vector<std::shared_ptr<thread_counts>> threads;
+        map_t                                       exited;
+    };
+
+    // Output stream
+    mutable rocblas_internal_ostream os;
+
+    std::shared_ptr<shared_counts> counts = std::make_shared<shared_counts>();
+
+    // Add the counts in from to the table to
+    static void merge(map_t& to, const map_t& from)
+    {
+        for(const auto& p : from)
+            to[p.first].merge(p.second);
+    }
+
+    // Append the times of a histogram to a tuple, under the given names
+    template <typename TUP2>
+    static auto time_pairs(const TUP2&                      tup,
+                           const rocblas_latency_histogram& time,
+                           const char* const (&names)[6])
+    {
+        return std::tuple_cat(tup,
+                              std::make_tuple(names[0],
+                                              time.total_ns(),
+                                              names[1],
+                                              time.min_ns(),
+                                              names[2],
+                                              time.max_ns(),
+                                              names[3],
+                                              time.percentile_ns(0.50),
+                                              names[4],
+                                              time.percentile_ns(0.90),
+                                              names[5],
+                                              time.percentile_ns(0.99)));
+    }
+
+public:
+    /*************************************************************************
+     * The counter of the calling thread, which is declared thread_local by *
+     * the caller of the profile, once for each profile.                    *
+     *************************************************************************/
+    class counter
+    {
+        std::shared_ptr<shared_counts> shared;
+        std::shared_ptr<thread_counts> counts = std::make_shared<thread_counts>();
+
+    public:
+        explicit counter(const argument_profile& profile)
+            : shared(profile.counts)
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            shared->threads.push_back(counts);
+        }
+
+        // A tuple of arguments is looked up in the table of this thread.
+        // A count of the number of calls with these arguments is kept.
+        // arg is assumed to be an rvalue for efficiency
+        // The entry returned stays valid while this thread lives, and is locked with mutex()
+        argument_profile_entry& operator()(TUP&& arg)
+        {
+            std::lock_guard<std::mutex> lock(counts->mutex);
+            auto&                       entry = counts->map[std::move(arg)];
+            entry.call_count++;
+            return entry;
+        }
+
+        std::mutex& mutex()
+        {
+            return counts->mutex;
+        }
+
+        // Merge the counts of an exiting thread into the profile
+        ~counter()
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            {
+                std::lock_guard<std::mutex> lock(counts->mutex);
+                merge(shared->exited, counts->map);
+            }
+            auto& threads = shared->threads;
+            threads.erase(std::find(threads.begin(), threads.end(), counts));
+        }
+
+        counter(const counter&) = delete;
+        counter& operator=(const counter&) = delete;
+    };
+
+    // Constructor
+    // We must duplicate the rocblas_internal_ostream to avoid dependence on static destruction order
+    explicit argument_profile(rocblas_internal_ostream& os)
+        : os(os.dup())
+    {
+    }
+
+    // Dump the current profile
+    void dump() const
+    {
+        // Merge the counts of all threads
+        map_t map;
+        {
+            std::lock_guard<std::mutex> lock(counts->mutex);
+            map = counts->exited;
+            for(const auto& thread : counts->threads)
+            {
+                std::lock_guard<std::mutex> lock(thread->mutex);
+                merge(map, thread->map);
+            }
+        }
+
+        // Clear the output buffer
+        os.clear();
+
+        // Timed tuples are printed with the most total host time first, so that they can be
+        // prioritized for tuning
+        std::vector<const typename map_t::value_type*> entries;
+        bool                                           timed = false;
+        for(const auto& p : map)
+        {
+            entries.push_back(&p);
+            timed = timed || p.second.host_time.count();
+        }
+        if(timed)
+            std::stable_sort(entries.begin(), entries.end(), [](auto a, auto b) {
+                return a->second.host_time.total_ns() > b->second.host_time.total_ns();
+            });
+
+        // Print all of the tuples in the map
+        static constexpr const char* host_names[] = {"total_time_ns",
+                                                     "min_time_ns",
+                                                     "max_time_ns",
+                                                     "p50_time_ns",
+                                                     "p90_time_ns",
+                                                     "p99_time_ns"};
+        static constexpr const char* device_names[] = {"device_total_time_ns",
+                                                       "device_min_time_ns",
+                                                       "device_max_time_ns",
+                                                       "device_p50_time_ns",
+                                                       "device_p90_time_ns",
+                                                       "device_p99_time_ns"};
+        for(const auto* p : entries)
+        {
+            const auto& entry = p->second;
+            auto tup = std::tuple_cat(p->first, std::make_tuple("call_count", entry.call_count));
+            os << "- ";
+            if(!entry.host_time.count())
+                tuple_helper::print_tuple_pairs(os, tup);
+            else if(!entry.device_time.count())
+                tuple_helper::print_tuple_pairs(os, time_pairs(tup, entry.host_time, host_names));
+            else
+                tuple_helper::print_tuple_pairs(
+                    os,
+                    time_pairs(time_pairs(tup, entry.host_time, host_names),
+                               entry.device_time,
+                               device_names));
+        }
+
+        // Flush out the dump
+        os.flush();
+    }
+
+    // Cleanup handler which dumps profile at destruction
+    ~argument_profile()
+    try
+    {
+        dump();
+    }
+    catch(...)
+    {
+        return;
+    }
+};
@@ -0,0 +1,351 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*****************************************************************************
+ * Binary logging records each logged call as a fixed-layout record instead  *
+ * of formatting it as text, so that the calling thread only copies its      *
+ * arguments. Each thread appends records to its own lock-free ring buffer,  *
+ * and a background thread writes the rings to the log file, which is        *
+ * decoded offline by scripts/utilities/decode-binary-log.py into the trace, *
+ * bench and profile logs. All fields are little-endian.                     *
+ *                                                                           *
+ * The file starts with the 8 byte magic "RBBINLOG", a 32-bit version and a  *
+ * 32-bit zero, followed by chunks of records written from one thread:       *
+ *                                                                           *
+ *   chunk:    u32 thread, u32 bytes, records                                *
+ *   record:   u32 size, u8 kind, u8 count, u16 0, u64 time (ns), arguments  *
+ *   argument: u8 tag, value                                                 *
+ *                                                                           *
+ * size includes the 16 byte header and padding to a multiple of 8 bytes.    *
+ * Strings are sent once per thread, in a define record holding a u32 id and *
+ * the characters, and are then referred to by id, so that a function name   *
+ * costs 4 bytes. Padding records (kind 0) are skipped.                      *
+ *****************************************************************************/
+constexpr char     ROCBLAS_BINARY_LOG_MAGIC[8]     = {'R', 'B', 'B', 'I', 'N', 'L', 'O', 'G'};
+constexpr uint32_t ROCBLAS_BINARY_LOG_VERSION      = 1;
+constexpr size_t   ROCBLAS_BINARY_LOG_HEADER_BYTES = 16;
+constexpr size_t   ROCBLAS_BINARY_LOG_RING_BYTES   = 1 << 20;
+
+// Kinds of records
+enum rocblas_binary_log_kind : uint8_t
+{
+    rocblas_binary_log_padding = 0,
+    rocblas_binary_log_trace   = 1,
+    rocblas_binary_log_bench   = 2,
+    rocblas_binary_log_profile = 3,
+    rocblas_binary_log_define  = 4, // u32 id, u32 length, characters
+};
+
+// Tags of arguments, each followed by its value
+enum rocblas_binary_log_tag : uint8_t
+{
+    rocblas_binary_log_i32       = 1,
+    rocblas_binary_log_u32       = 2,
+    rocblas_binary_log_i64       = 3,
+    rocblas_binary_log_u64       = 4,
+    rocblas_binary_log_f32       = 5,
+    rocblas_binary_log_f64       = 6,
+    rocblas_binary_log_c32       = 7, // real and imaginary f32
+    rocblas_binary_log_c64       = 8, // real and imaginary f64
+    rocblas_binary_log_bool      = 9, // u8
+    rocblas_binary_log_char      = 10, // u8
+    rocblas_binary_log_pointer   = 11, // u64
+    rocblas_binary_log_string    = 12, // u32 id of a defined string
+    rocblas_binary_log_text      = 13, // u32 length, characters, printed like a string
+    rocblas_binary_log_formatted = 14, // u32 length, characters, printed as they are
+};
+
+/*****************************************************************************
+ * A ring buffer of records with one producer, the thread which logs, and    *
+ * one consumer, the writer. Positions only increase, and the producer only  *
+ * waits when the ring is full, until the writer has drained it.             *
+ *****************************************************************************/
+class rocblas_binary_log_ring
+{
+public:
+    rocblas_binary_log_ring(uint32_t thread, size_t capacity = ROCBLAS_BINARY_LOG_RING_BYTES)
+        : m_thread(thread)
+        , m_capacity(capacity)
+        , m_buffer(new char[capacity])
+    {
+    }
+
+    uint32_t thread() const
+    {
+        return m_thread;
+    }
+
+    // Records which were too large for the ring, and were dropped
+    size_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    /*************************************************************************
+     * Producer: begin() a record, put() its arguments, and commit() it      *
+     *************************************************************************/
+    void begin(rocblas_binary_log_kind kind)
+    {
+        m_kind  = kind;
+        m_count = 0;
+        m_record.resize(ROCBLAS_BINARY_LOG_HEADER_BYTES);
+    }
+
+    rocblas_binary_log_kind kind() const
+    {
+        return m_kind;
+    }
+
+    void put(bool x)
+    {
+        put_value(rocblas_binary_log_bool, uint8_t(x));
+    }
+    void put(char x)
+    {
+        put_value(rocblas_binary_log_char, x);
+    }
+    void put(int32_t x)
+    {
+        put_value(rocblas_binary_log_i32, x);
+    }
+    void put(uint32_t x)
+    {
+        put_value(rocblas_binary_log_u32, x);
+    }
+    void put(int64_t x)
+    {
+        put_value(rocblas_binary_log_i64, x);
+    }
+    void put(uint64_t x)
+    {
+        put_value(rocblas_binary_log_u64, x);
+    }
+    void put(float x)
+    {
+        put_value(rocblas_binary_log_f32, x);
+    }
+    void put(double x)
+    {
+        put_value(rocblas_binary_log_f64, x);
+    }
+
+    // Other integer and floating-point types are widened
+    template <typename T, std::enable_if_t<std::is_arithmetic<T>{}, int> = 0>
+    void put(T x)
+    {
+        using W = std::conditional_t<std::is_floating_point<T>{},
+                                     double,
+                                     std::conditional_t<std::is_signed<T>{}, int64_t, uint64_t>>;
+        put(W(x));
+    }
+
+    void put_complex(float re, float im)
+    {
+        put_tag(rocblas_binary_log_c32);
+        append(&re, sizeof(re));
+        append(&im, sizeof(im));
+    }
+
+    void put_complex(double re, double im)
+    {
+        put_tag(rocblas_binary_log_c64);
+        append(&re, sizeof(re));
+        append(&im, sizeof(im));
+    }
+
+    void put_pointer(const void* p)
+    {
+        put_value(rocblas_binary_log_pointer, uint64_t(uintptr_t(p)));
+    }
+
+    // A string, which is sent once and then referred to by the id of its address
+    void put_string(const char* s)
+    {
+        put_value(rocblas_binary_log_string, define(s));
+    }
+
+    // Characters which are copied into the record, printed like a string or as they are
+    void put_text(const char* s, size_t length, bool formatted = false)
+    {
+        put_tag(formatted ? rocblas_binary_log_formatted : rocblas_binary_log_text);
+        uint32_t n = uint32_t(length);
+        append(&n, sizeof(n));
+        append(s, n);
+    }
+
+    // Finish the record, and push it into the ring
+    void commit()
+    {
+        finish(m_record, m_kind, m_count);
+        push(m_record.data(), m_record.size());
+    }
+
+    /*************************************************************************
+     * Consumer: pass the committed records to write(const char*, size_t),   *
+     * in at most two contiguous pieces, and free their space. Returns the   *
+     * number of bytes drained.                                              *
+     *************************************************************************/
+    template <typename F>
+    size_t drain(F&& write)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        if(head == tail)
+            return 0;
+
+        size_t start = tail % m_capacity;
+        size_t bytes = head - tail;
+        size_t first = std::min(bytes, m_capacity - start);
+        write(m_buffer.get() + start, first);
+        if(bytes > first)
+            write(m_buffer.get(), bytes - first);
+
+        m_tail.store(head, std::memory_order_release);
+        return bytes;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    // Whether the thread which owns the ring has exited
+    std::atomic<bool> retired{false};
+
+private:
+    const uint32_t          m_thread;
+    const size_t            m_capacity;
+    std::unique_ptr<char[]> m_buffer;
+    alignas(64) std::atomic<uint64_t> m_head{0}; // written by the producer
+    alignas(64) std::atomic<uint64_t> m_tail{0}; // written by the consumer
+
+    // Producer state: the record being built, and the define record of a new string
+    alignas(64) std::vector<char> m_record;
+    std::vector<char>             m_define;
+    rocblas_binary_log_kind       m_kind    = rocblas_binary_log_padding;
+    uint8_t                       m_count   = 0;
+    size_t                        m_dropped = 0;
+
+    // The id and characters of each string which has been sent, by address
+    std::unordered_map<const char*, std::pair<uint32_t, std::string>> m_strings;
+    uint32_t                                                          m_strings_sent = 0;
+
+    void append(const void* p, size_t n)
+    {
+        auto& r    = m_record;
+        auto  size = r.size();
+        r.resize(size + n);
+        memcpy(r.data() + size, p, n);
+    }
+
+    void put_tag(rocblas_binary_log_tag tag)
+    {
+        append(&tag, sizeof(tag));
+        ++m_count;
+    }
+
+    template <typename T>
+    void put_value(rocblas_binary_log_tag tag, T x)
+    {
+        put_tag(tag);
+        append(&x, sizeof(x));
+    }
+
+    // Pad a record to a multiple of 8 bytes, and fill in its header
+    static void finish(std::vector<char>& r, rocblas_binary_log_kind kind, uint8_t count)
+    {
+        r.resize((r.size() + 7) & ~size_t(7));
+        uint32_t size = uint32_t(r.size());
+        uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+        char* h = r.data();
+        memcpy(h, &size, 4);
+        h[4] = char(kind);
+        h[5] = char(count);
+        h[6] = h[7] = 0;
+        memcpy(h + 8, &time, 8);
+    }
+
+    // The id of the string s, sending it first if this thread has not sent it before. The
+    // characters are compared as well as the address, in case the address has been reused.
+    uint32_t define(const char* s)
+    {
+        auto p = m_strings.find(s);
+        if(p != m_strings.end() && p->second.second == s)
+            return p->second.first;
+
+        uint32_t id     = m_strings_sent++;
+        uint32_t length = uint32_t(strlen(s));
+        m_strings[s]    = {id, s};
+
+        m_define.resize(ROCBLAS_BINARY_LOG_HEADER_BYTES + 8 + length);
+        memcpy(m_define.data() + ROCBLAS_BINARY_LOG_HEADER_BYTES, &id, 4);
+        memcpy(m_define.data() + ROCBLAS_BINARY_LOG_HEADER_BYTES + 4, &length, 4);
+        memcpy(m_define.data() + ROCBLAS_BINARY_LOG_HEADER_BYTES + 8, s, length);
+        finish(m_define, rocblas_binary_log_define, 0);
+        push(m_define.data(), m_define.size());
+        return id;
+    }
+
+    // Copy a record into the ring, padding to the end of the ring if it does not fit there
+    void push(const char* record, size_t size)
+    {
+        if(size > m_capacity / 2)
+        {
+            if(!m_dropped++)
+                fprintf(stderr, "rocBLAS binary log: dropping records too large for the ring\n");
+            return;
+        }
+
+        uint64_t head    = m_head.load(std::memory_order_relaxed);
+        size_t   start   = head % m_capacity;
+        size_t   padding = start + size > m_capacity ? m_capacity - start : 0;
+        while(head + padding + size - m_tail.load(std::memory_order_acquire) > m_capacity)
+            std::this_thread::yield();
+
+        if(padding)
+        {
+            uint32_t pad = uint32_t(padding);
+            memset(m_buffer.get() + start, 0, padding);
+            memcpy(m_buffer.get() + start, &pad, 4);
+            start = 0;
+        }
+        memcpy(m_buffer.get() + start, record, size);
+        m_head.store(head + padding + size, std::memory_order_release);
+    }
+};
+
+/*****************************************************************************
+ * The binary log of the process, which is opened by the first handle which  *
+ * enables it, and written by a background thread until the process exits.  *
+ *****************************************************************************/
+class rocblas_binary_log
+{
+public:
+    // Start logging to the file at path, if not already started. Returns false on failure.
+    static bool start(const char* path);
+
+    // The ring of the calling thread, which is created on first use
+    static rocblas_binary_log_ring& ring();
+
+    // Write all committed records to the file, if logging was started. Called by rocblas_abort
+    // and at quick_exit, since the writer thread does not drain the rings at either.
+    static void flush();
+};
@@ -0,0 +1,162 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*****************************************************************************
+ * rocblas_check_numerics_records holds the checks of a handle in            *
+ * asynchronous check_numerics mode. Instead of copying the flags of each    *
+ * check to the host and waiting for the stream, each check kernel sets the  *
+ * flags of the next record of a ring in device memory, and the host only    *
+ * remembers the function and role of the record.                            *
+ *                                                                           *
+ * The records are read when the user asks for them, when the ring is full,  *
+ * when the handle's stream changes, and when the handle is released or      *
+ * destroyed, waiting for the stream once per ring. Each record read is      *
+ * reported, as synchronous mode reports a check, and aggregated by function *
+ * and role, in the order in which they were first seen, until the           *
+ * aggregates are cleared.                                                   *
+ *                                                                           *
+ * Device operations go through BACKEND, so that the records can be tested   *
+ * without a GPU. BACKEND provides the types stream_t and flags_t, which has *
+ * the bool members has_NaN, has_zero and has_Inf, and:                      *
+ *   bool alloc(void** ptr, size_t size)      void free(void* ptr)           *
+ *   bool clear(void* ptr, size_t size, stream_t stream)                     *
+ *   bool read(void* host, const void* ptr, size_t size, stream_t stream)    *
+ *   void report(const char* function, bool is_input, const flags_t& flags)  *
+ * where clear zeros memory on the stream without waiting, and read copies   *
+ * memory to the host after the work on the stream, waiting for it.          *
+ *****************************************************************************/
+template <typename BACKEND>
+class rocblas_check_numerics_records
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    using stream_t = typename BACKEND::stream_t;
+    using flags_t  = typename BACKEND::flags_t;
+
+    explicit rocblas_check_numerics_records(BACKEND backend  = BACKEND(),
+                                            size_t  capacity = DEFAULT_CAPACITY)
+        : m_backend(std::move(backend))
+        , m_capacity(capacity ? capacity : 1)
+    {
+    }
+
+    rocblas_check_numerics_records(const rocblas_check_numerics_records&) = delete;
+    rocblas_check_numerics_records& operator=(const rocblas_check_numerics_records&) = delete;
+
+    // The handle reads its records before destroying them; the records of a ring which cannot
+    // be read are freed without being reported
+    ~rocblas_check_numerics_records()
+    {
+        if(m_ring)
+            m_backend.free(m_ring);
+    }
+
+    /*************************************************************************
+     * Take the next record of the ring for a check of the input or output   *
+     * of function on stream, returning the cleared device flags which the   *
+     * check kernel sets, or nullptr if the ring cannot be allocated or read *
+     *************************************************************************/
+    flags_t* record(const char* function, bool is_input, stream_t stream)
+    {
+        if(!m_ring)
+        {
+            void* ring;
+            if(!m_backend.alloc(&ring, m_capacity * sizeof(flags_t)))
+                return nullptr;
+            m_ring = static_cast<flags_t*>(ring);
+        }
+        else if((m_slots.size() == m_capacity || stream != m_stream) && !read())
+            return nullptr;
+
+        // The ring is cleared on the stream of the checks which take its records
+        if(m_slots.empty() && !m_backend.clear(m_ring, m_capacity * sizeof(flags_t), stream))
+            return nullptr;
+
+        m_stream = stream;
+        m_slots.emplace_back(function, is_input);
+        return m_ring + m_slots.size() - 1;
+    }
+
+    /*************************************************************************
+     * Read the records taken so far, waiting for their stream, and add them *
+     * to the aggregates, returning false if they cannot be read             *
+     *************************************************************************/
+    bool read()
+    {
+        if(m_slots.empty())
+            return true;
+
+        std::vector<flags_t> flags(m_slots.size());
+        if(!m_backend.read(flags.data(), m_ring, flags.size() * sizeof(flags_t), m_stream))
+            return false;
+        for(size_t i = 0; i < m_slots.size(); ++i)
+            add(m_slots[i].first, m_slots[i].second, flags[i]);
+        m_slots.clear();
+        return true;
+    }
+
+    // Report a check, and add it to the aggregate of its function and role
+    void add(const char* function, bool is_input, const flags_t& flags)
+    {
+        m_backend.report(function, is_input, flags);
+
+        auto key = std::make_pair(std::string(function), is_input);
+        auto it  = m_index.find(key);
+        if(it == m_index.end())
+        {
+            rocblas_check_numerics_record record{};
+            record.function = function;
+            record.is_input = is_input;
+            it              = m_index.emplace(key, m_records.size()).first;
+            m_records.push_back(record);
+        }
+
+        auto& record = m_records[it->second];
+        ++record.checks;
+        record.has_NaN += flags.has_NaN;
+        record.has_zero += flags.has_zero;
+        record.has_Inf += flags.has_Inf;
+    }
+
+    // Aggregates of the records read since they were last cleared
+    const std::vector<rocblas_check_numerics_record>& records() const
+    {
+        return m_records;
+    }
+
+    // Number of records taken which are not read yet
+    size_t pending() const
+    {
+        return m_slots.size();
+    }
+
+    // Forget the aggregates, but not the records which are not read yet
+    void clear()
+    {
+        m_records.clear();
+        m_index.clear();
+    }
+
+private:
+    BACKEND  m_backend;
+    size_t   m_capacity;
+    flags_t* m_ring = nullptr;
+    stream_t m_stream{};
+
+    // Function and role of each record taken since the ring was last read
+    std::vector<std::pair<const char*, bool>> m_slots;
+
+    std::vector<rocblas_check_numerics_record>     m_records;
+    std::map<std::pair<std::string, bool>, size_t> m_index;
+};
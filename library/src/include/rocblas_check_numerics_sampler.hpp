@@ -0,0 +1,109 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include <cstdint>
+#include <unordered_map>
+
+/************************************************************************************
+ * Sampling of the calls and elements which check_numerics checks
+ *
+ * Each handle has one sampler, which is only used by the thread using the handle.
+ * Each call begins with begin_call, when the function reads the check_numerics mode
+ * of the handle, and the first check of the call decides whether all the checks of
+ * the call are done: every Nth call of each function is checked, starting with its
+ * first. A function is identified by the address of the static string of its name,
+ * which is passed to each check. The checks which are done check every Sth element
+ * of each vector and every Sth column of each matrix.
+ *
+ * The sampler also counts the calls with checks, the calls checked, and the calls
+ * in which a check found a NaN or an Inf. With N and S of 1, every call and element
+ * is checked, and the calls are only counted.
+ ************************************************************************************/
+class rocblas_check_numerics_sampler
+{
+public:
+    // N of the sampled check_numerics mode when ROCBLAS_CHECK_NUMERICS_SAMPLE_EVERY is not set
+    static constexpr rocblas_int DEFAULT_EVERY = 100;
+
+    // Set N and S, which must be positive, and forget the calls seen of each function
+    void set(rocblas_int every, rocblas_int stride)
+    {
+        m_every  = every;
+        m_stride = stride;
+        m_countdowns.clear();
+    }
+
+    rocblas_int get_every() const
+    {
+        return m_every;
+    }
+
+    rocblas_int get_stride() const
+    {
+        return m_stride;
+    }
+
+    // Begin a call, whose checks are decided by its first check
+    void begin_call()
+    {
+        ++m_call;
+    }
+
+    // Whether to do a check of the current call of function
+    bool sample(const char* function)
+    {
+        if(m_decided != m_call)
+        {
+            m_decided = m_call;
+            m_sampled = m_every <= 1 || countdown(function);
+            ++m_stats.calls;
+            m_stats.checked_calls += m_sampled;
+        }
+        return m_sampled;
+    }
+
+    // Count the result of a check of the current call, which failed if it found a NaN or an Inf
+    void count(bool failed)
+    {
+        if(failed && m_failed != m_call)
+        {
+            m_failed = m_call;
+            ++m_stats.failed_calls;
+        }
+    }
+
+    const rocblas_check_numerics_sampling_stats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    rocblas_int m_every  = 1;
+    rocblas_int m_stride = 1;
+
+    // Calls of each function to skip before the next one checked
+    std::unordered_map<const char*, rocblas_int> m_countdowns;
+
+    uint64_t m_call    = 0;
+    uint64_t m_decided = UINT64_MAX; // call whose checks were last decided
+    uint64_t m_failed  = UINT64_MAX; // call which was last counted as failed
+    bool     m_sampled = true;
+
+    rocblas_check_numerics_sampling_stats m_stats{};
+
+    bool countdown(const char* function)
+    {
+        auto& skip = m_countdowns[function];
+        if(skip)
+        {
+            --skip;
+            return false;
+        }
+        skip = m_every - 1;
+        return true;
+    }
+};
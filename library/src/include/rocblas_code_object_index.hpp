@@ -0,0 +1,149 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <atomic>
+#include <fnmatch.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*****************************************************************************
+ * The code object index maps each kernel name to the code object file which *
+ * contains it. It is generated at build time by                             *
+ * library/src/tensile_code_object_index.py and installed next to the code   *
+ * objects:                                                                  *
+ *                                                                           *
+ *   # rocBLAS code object index v1                                          *
+ *   @ <code object file name>                                               *
+ *   <kernel name>                                                           *
+ *   ...                                                                     *
+ *                                                                           *
+ * Only files matching *<processor>*co are indexed for a given processor,    *
+ * the same files which would otherwise be loaded eagerly.                   *
+ *****************************************************************************/
+constexpr char ROCBLAS_CODE_OBJECT_INDEX_FILE[]   = "TensileCodeObjectIndex.txt";
+constexpr char ROCBLAS_CODE_OBJECT_INDEX_HEADER[] = "# rocBLAS code object index v1";
+
+class rocblas_code_object_index
+{
+    std::vector<std::string>             m_files;
+    std::unordered_set<std::string>      m_file_names;
+    std::unordered_map<std::string, int> m_kernels;
+
+public:
+    // Read the index in dir, keeping only code objects for processor.
+    // Returns false if there is no valid index.
+    bool read(const std::string& dir, const std::string& processor)
+    {
+        std::ifstream in(dir + "/" + ROCBLAS_CODE_OBJECT_INDEX_FILE);
+        std::string   line;
+        if(!std::getline(in, line) || line != ROCBLAS_CODE_OBJECT_INDEX_HEADER)
+            return false;
+
+        std::string pattern = "*" + processor + "*co";
+        int         file    = -1;
+        while(std::getline(in, line))
+        {
+            if(line.empty() || line[0] == '#')
+                continue;
+            if(line.compare(0, 2, "@ ") == 0)
+            {
+                std::string name = line.substr(2);
+                file             = -1;
+                if(!fnmatch(pattern.c_str(), name.c_str(), 0))
+                {
+                    file = int(m_files.size());
+                    m_files.push_back(dir + "/" + name);
+                    m_file_names.insert(name);
+                }
+            }
+            else if(file >= 0)
+                m_kernels.emplace(line, file);
+        }
+        return !m_files.empty();
+    }
+
+    size_t num_files() const
+    {
+        return m_files.size();
+    }
+
+    const std::string& file_path(int file) const
+    {
+        return m_files[file];
+    }
+
+    // Whether a code object file (name without directory) is covered by the index
+    bool contains_file(const std::string& name) const
+    {
+        return m_file_names.count(name) != 0;
+    }
+
+    // The code object containing a kernel, or -1 if the kernel is not indexed
+    int find_kernel(const std::string& kernel) const
+    {
+        auto it = m_kernels.find(kernel);
+        return it == m_kernels.end() ? -1 : it->second;
+    }
+};
+
+/*****************************************************************************
+ * Tracks which indexed code objects have been loaded for one device, and    *
+ * loads them on demand. load(path) is called at most once per file. Files   *
+ * are locked in stripes, so that a thread which needs one file does not     *
+ * wait for another thread loading an unrelated file.                        *
+ *****************************************************************************/
+class rocblas_code_object_residency
+{
+    static constexpr size_t STRIPES = 16;
+
+    std::unique_ptr<std::atomic<bool>[]> m_loaded;
+    size_t                               m_num_files = 0;
+    std::mutex                           m_mutex[STRIPES];
+
+    template <typename LOAD>
+    void load_file(const rocblas_code_object_index& index, int file, LOAD& load)
+    {
+        if(m_loaded[file].load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex[file % STRIPES]);
+        if(!m_loaded[file].load(std::memory_order_relaxed))
+        {
+            load(index.file_path(file));
+            m_loaded[file].store(true, std::memory_order_release);
+        }
+    }
+
+public:
+    void reset(size_t num_files)
+    {
+        m_loaded.reset(new std::atomic<bool>[num_files]());
+        m_num_files = num_files;
+    }
+
+    // Load the code object containing kernel. Unknown kernels load every file,
+    // so that a stale index degrades to eager loading rather than failing.
+    template <typename LOAD>
+    void require(const rocblas_code_object_index& index, const std::string& kernel, LOAD&& load)
+    {
+        int file = index.find_kernel(kernel);
+        if(file >= 0)
+            load_file(index, file, load);
+        else
+            require_all(index, load);
+    }
+
+    template <typename LOAD>
+    void require_all(const rocblas_code_object_index& index, LOAD&& load)
+    {
+        for(size_t file = 0; file < m_num_files; ++file)
+            load_file(index, int(file), load);
+    }
+};
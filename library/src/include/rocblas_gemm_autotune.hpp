@@ -0,0 +1,250 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas_solution_cache.hpp"
+#include "rocblas_solution_override.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+ * rocblas_gemm_autotuner selects gemm solutions by timing them. The first   *
+ * trials times a gemm signature is seen, each of its candidate solutions is *
+ * run and timed, and afterwards the fastest candidate is used. Candidates   *
+ * are ordered best first, so that the first candidate is the one which      *
+ * would have been selected without tuning.                                  *
+ *                                                                           *
+ * Winners are also published in a lock-free rocblas_solution_cache, so      *
+ * that calls of a tuned signature take no lock. A winner evicted from it is *
+ * found under the lock, and published again.                                *
+ *                                                                           *
+ * The solutions are enumerated and timed by callbacks, so that the tuner    *
+ * does not depend on Tensile or HIP and can be tested with a mock timer. T  *
+ * must have an int index member, which identifies the solution when the     *
+ * results are exported.                                                     *
+ *****************************************************************************/
+template <typename T, size_t N>
+class rocblas_gemm_autotuner
+{
+public:
+    using key_t = std::array<uint64_t, N>;
+
+    // Number of winners which can be found without the lock
+    static constexpr size_t PUBLISHED_WINNERS = 1024;
+
+    // Exploration limits
+    struct limits_t
+    {
+        size_t candidates     = 4; // number of best candidates timed for each signature
+        size_t trials         = 3; // number of calls for which the candidates are timed
+        size_t max_signatures = 256; // signatures seen after this many are not tuned
+    };
+
+    // The outcome of select()
+    struct selection_t
+    {
+        T*   solution = nullptr; // nullptr if the caller should select a solution itself
+        bool launched = false; // whether timing already computed the result of this call
+    };
+
+    explicit rocblas_gemm_autotuner(const limits_t& limits = {})
+        : m_limits(limits)
+        , m_winners(PUBLISHED_WINNERS)
+    {
+    }
+
+    rocblas_gemm_autotuner(const rocblas_gemm_autotuner&) = delete;
+    rocblas_gemm_autotuner& operator=(const rocblas_gemm_autotuner&) = delete;
+
+    limits_t get_limits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_limits;
+    }
+
+    // The winner of a tuned signature, or nullptr. Never blocks.
+    T* winner(const key_t& key)
+    {
+        return m_winners.find(key);
+    }
+
+    // New limits apply to signatures which are seen for the first time afterwards
+    void set_limits(const limits_t& limits)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limits = limits;
+    }
+
+    /*************************************************************************
+     * Select the solution for a call with signature key.                    *
+     *                                                                       *
+     *   enumerate()  returns std::vector<T*>, the candidates best first     *
+     *   describe()   returns a std::string describing the signature         *
+     *   time(T*)     runs a candidate on this call's arguments, and returns *
+     *                its time in ms, or a negative value if it failed       *
+     *                                                                       *
+     * enumerate() and describe() are called the first time the signature is *
+     * seen. While another thread is timing the same signature, the caller   *
+     * selects a solution itself. Running a candidate must not change the    *
+     * result of the call, e.g. the output must not alias an input.          *
+     *************************************************************************/
+    template <typename ENUMERATE, typename DESCRIBE, typename TIME>
+    selection_t select(const key_t& key, ENUMERATE&& enumerate, DESCRIBE&& describe, TIME&& time)
+    {
+        if(T* published = winner(key))
+            return {published, false};
+
+        state_t* state;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto                        it = m_states.find(key);
+            if(it == m_states.end())
+            {
+                if(m_states.size() >= m_limits.max_signatures)
+                    return {};
+                it = m_states.emplace(key, state_t{}).first;
+                it->second.limits = m_limits;
+            }
+            state = &it->second;
+            if(state->winner)
+                m_winners.insert(key, state->winner);
+            if(state->winner || state->busy || (state->enumerated && state->candidates.empty()))
+                return {state->winner, false};
+            state->busy = true;
+        }
+
+        // Enumerate the candidates the first time, without holding the lock
+        if(!state->enumerated)
+        {
+            auto candidates = enumerate();
+            if(candidates.size() > state->limits.candidates)
+                candidates.resize(state->limits.candidates);
+            state->candidates = std::move(candidates);
+            state->times.assign(state->candidates.size(), 0.0);
+            state->signature  = describe();
+            state->enumerated = true;
+        }
+
+        // A signature without candidates is never tuned
+        if(state->candidates.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            state->busy = false;
+            return {};
+        }
+
+        std::vector<double> times(state->candidates.size());
+        for(size_t i = 0; i < times.size(); ++i)
+            times[i] = time(state->candidates[i]);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(size_t i = 0; i < times.size(); ++i)
+            state->times[i] = times[i] < 0 || state->times[i] < 0 ? -1 : state->times[i] + times[i];
+        if(++state->trials >= state->limits.trials)
+        {
+            state->winner = fastest(*state);
+            m_winners.insert(key, state->winner);
+        }
+        state->busy = false;
+        return {state->candidates.back(), true};
+    }
+
+    // Forget all signatures
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto it = m_states.begin(); it != m_states.end();)
+            it = it->second.busy ? std::next(it) : m_states.erase(it);
+        m_winners.clear();
+    }
+
+    // Number of signatures seen, and of those, the number which are tuned
+    void get_counts(size_t& signatures, size_t& tuned) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        signatures = m_states.size();
+        tuned      = 0;
+        for(auto& s : m_states)
+            tuned += s.second.winner != nullptr;
+    }
+
+    /*************************************************************************
+     * Write the tuned signatures in the solution override table format of   *
+     * rocblas_solution_override.hpp. The limits and the time of every       *
+     * candidate are written as comments.                                    *
+     *************************************************************************/
+    bool export_results(const char* path) const
+    {
+        FILE* f = fopen(path, "w");
+        if(!f)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        fprintf(f,
+                "%s\n# rocBLAS gemm autotuning: candidates=%zu trials=%zu max_signatures=%zu\n",
+                ROCBLAS_SOLUTION_OVERRIDE_HEADER,
+                m_limits.candidates,
+                m_limits.trials,
+                m_limits.max_signatures);
+        for(auto& s : m_states)
+        {
+            auto& state = s.second;
+            if(!state.winner)
+                continue;
+            fprintf(f, "\n# mean ms per solution_index over %zu trials:", state.trials);
+            for(size_t i = 0; i < state.candidates.size(); ++i)
+            {
+                if(state.times[i] < 0)
+                    fprintf(f, " %d=failed", state.candidates[i]->index);
+                else
+                    fprintf(f,
+                            " %d=%.4g",
+                            state.candidates[i]->index,
+                            state.times[i] / state.trials);
+            }
+            fprintf(f, "\n%s solution_index=%d\n", state.signature.c_str(), state.winner->index);
+        }
+        return fclose(f) == 0;
+    }
+
+private:
+    struct state_t
+    {
+        limits_t            limits;
+        std::vector<T*>     candidates;
+        std::vector<double> times; // total time of each candidate, or -1 if it failed
+        std::string         signature;
+        size_t              trials     = 0;
+        T*                  winner     = nullptr;
+        bool                enumerated = false;
+        bool                busy       = false; // a thread is enumerating or timing candidates
+    };
+
+    // The candidate with the least total time, or the first if none could be timed
+    static T* fastest(const state_t& state)
+    {
+        size_t best = 0;
+        double time = std::numeric_limits<double>::infinity();
+        for(size_t i = 0; i < state.times.size(); ++i)
+            if(state.times[i] >= 0 && state.times[i] < time)
+            {
+                best = i;
+                time = state.times[i];
+            }
+        return state.candidates[best];
+    }
+
+    mutable std::mutex           m_mutex;
+    limits_t                     m_limits;
+    std::map<key_t, state_t>     m_states;
+    rocblas_solution_cache<T, N> m_winners;
+};
@@ -0,0 +1,107 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas_ostream.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <hip/hip_runtime.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/************************************************************************************
+ * Logging of scalars in device memory, such as alpha and beta in device pointer mode
+ *
+ * By default, trace and bench logging copy each such scalar to the host to log its
+ * value, which waits for the handle's stream. With ROCBLAS_LOG_DEVICE_SCALARS, they
+ * log the address of the scalar instead, or defer the line until the stream reaches
+ * the call.
+ ************************************************************************************/
+enum class rocblas_log_device_scalars_mode
+{
+    copy, // copy the scalar to the host, waiting for the stream
+    deferred, // capture the scalar asynchronously, and write the line from a stream callback
+    pointer, // log the address of the scalar
+};
+
+/************************************************************************************
+ * Deferred log lines of a handle
+ *
+ * Each scalar is captured by an asynchronous copy on the stream into a slot of pinned
+ * host memory, and the line holds a placeholder naming the slot. The line is written
+ * by a host callback on the stream, which runs once the copies have finished, and
+ * replaces the placeholders with the formatted values. Logging never waits for the
+ * device, but a deferred line can be written after the lines of later calls.
+ *
+ * Only the thread using the handle captures and writes lines; the callbacks only
+ * format, write and release slots. When no slot is free, because the stream is far
+ * behind, the scalar is not captured, and the caller logs its address instead.
+ * Scalars are only captured for the calls which the handle's log sampling selects,
+ * so the sampler never hashes a placeholder, whose slot differs from call to call.
+ ************************************************************************************/
+class rocblas_deferred_log_scalars
+{
+public:
+    // Format the value of a scalar, with its name for bench logging
+    using format_t = std::string (*)(const void* value, const char* name);
+
+    rocblas_deferred_log_scalars();
+
+    // Waits for the callbacks of the lines written
+    ~rocblas_deferred_log_scalars();
+
+    // Capture size bytes at value in device memory, at the current point of stream,
+    // returning the placeholder of the scalar, or an empty string if it is not captured
+    std::string capture(
+        hipStream_t stream, const void* value, size_t size, format_t format, const char* name);
+
+    // Whether scalars were captured since the last write
+    bool pending() const
+    {
+        return !m_pending.empty();
+    }
+
+    // Write line, which holds the placeholders captured since the last write, to os once
+    // the stream reaches this point
+    void write(hipStream_t stream, const rocblas_internal_ostream& os, std::string line);
+
+    rocblas_deferred_log_scalars(const rocblas_deferred_log_scalars&) = delete;
+    rocblas_deferred_log_scalars& operator=(const rocblas_deferred_log_scalars&) = delete;
+
+private:
+    static constexpr size_t num_slots  = 256;
+    static constexpr size_t slot_bytes = 16; // the largest scalar, rocblas_double_complex
+    static constexpr char   delimiter  = '\x1f'; // surrounds the slot number of a placeholder
+
+    struct slot_t
+    {
+        format_t          format = nullptr;
+        const char*       name   = nullptr;
+        std::atomic<bool> busy{false};
+    };
+
+    struct line_t
+    {
+        rocblas_deferred_log_scalars*             scalars;
+        std::vector<int>                          slots;
+        std::string                               text;
+        std::unique_ptr<rocblas_internal_ostream> os;
+    };
+
+    unsigned char*   m_values = nullptr; // pinned host memory of the slots
+    slot_t           m_slots[num_slots];
+    size_t           m_next = 0;
+    std::vector<int> m_pending;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    size_t                  m_outstanding = 0; // callbacks not yet run
+
+    static void callback(hipStream_t stream, hipError_t status, void* data);
+    void        finish(line_t* line);
+};
@@ -0,0 +1,246 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <time.h>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+/************************************************************************************
+ * Sampling of the calls which trace and bench logging log
+ *
+ * Each handle has one sampler for trace logging and one for bench logging, which are
+ * only used by the thread using the handle. The rate limit identifies a function by
+ * the addresses of the static strings which lead its arguments: its name for trace
+ * logging, and the rocblas-bench command and precisions for bench logging.
+ *
+ * When sampling is off, the decision is a single comparison, and every Nth call costs
+ * a countdown. The rate limit looks up the function in a small table indexed by its
+ * key, and refills its tokens on every decision from the coarse monotonic clock, which
+ * is several times cheaper than the precise clock and precise enough to refill tokens.
+ * Only the first K calls of each set of arguments needs a hash of the arguments and a
+ * hash table lookup.
+ ************************************************************************************/
+class rocblas_log_sampler
+{
+    // Whether T is a scalar argument which may be in device memory, whose host_value()
+    // returns a pointer to its value if it can be read on the host, or nullptr
+    template <typename T, typename = void>
+    struct has_host_value : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct has_host_value<T, decltype(void(std::declval<const T&>().host_value()))>
+        : std::true_type
+    {
+    };
+
+    // Hash of the value of one argument; pointers are ignored, since they differ from
+    // call to call, trivially copyable types are hashed by their bytes, scalars which
+    // may be in device memory by their value if it is on the host, and other types
+    // except strings are ignored
+    static size_t hash_bytes(const void* p, size_t size, size_t seed = 0xcbf29ce484222325)
+    {
+        for(const auto* s = static_cast<const unsigned char*>(p); size--; ++s)
+            seed = (seed ^ *s) * 0x100000001b3; // FNV-1a
+        return seed;
+    }
+
+    static size_t hash_arg(const char* s)
+    {
+        return hash_bytes(s, strlen(s));
+    }
+
+    static size_t hash_arg(const std::string& s)
+    {
+        return hash_bytes(s.data(), s.size());
+    }
+
+    template <typename T, std::enable_if_t<std::is_pointer<T>{}, int> = 0>
+    static size_t hash_arg(T)
+    {
+        return 0;
+    }
+
+    template <typename T,
+              std::enable_if_t<!std::is_pointer<T>{} && !std::is_array<T>{}
+                                   && std::is_trivially_copyable<T>{} && !has_host_value<T>{},
+                               int> = 0>
+    static size_t hash_arg(const T& x)
+    {
+        return hash_bytes(&x, sizeof(x));
+    }
+
+    template <typename T, std::enable_if_t<has_host_value<T>{}, int> = 0>
+    static size_t hash_arg(const T& x)
+    {
+        auto value = x.host_value();
+        return value ? hash_bytes(value, sizeof(*value)) : 0;
+    }
+
+    template <typename T,
+              std::enable_if_t<!std::is_trivially_copyable<T>{} && !std::is_array<T>{}
+                                   && !has_host_value<T>{},
+                               int> = 0>
+    static size_t hash_arg(const T&)
+    {
+        return 0;
+    }
+
+    template <typename... Ts>
+    static size_t hash_args(const Ts&... xs)
+    {
+        size_t seed = 0;
+        for(size_t h : {hash_arg(xs)...})
+            seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
+    // Key of a function, combining the addresses of the strings which lead its arguments
+    template <typename T>
+    using is_string = std::integral_constant<bool,
+                                             std::is_same<std::decay_t<T>, const char*>{}
+                                                 || std::is_same<std::decay_t<T>, char*>{}>;
+
+    static uintptr_t function_key(uintptr_t key)
+    {
+        return key;
+    }
+
+    template <typename H, typename... Ts, std::enable_if_t<is_string<H>{}, int> = 0>
+    static uintptr_t function_key(uintptr_t key, const H& head, const Ts&... xs)
+    {
+        return function_key(key * 31 + uintptr_t(static_cast<const char*>(head)), xs...);
+    }
+
+    template <typename H, typename... Ts, std::enable_if_t<!is_string<H>{}, int> = 0>
+    static uintptr_t function_key(uintptr_t key, const H&, const Ts&...)
+    {
+        return key;
+    }
+
+    // Token bucket of a function, for the rate limit
+    struct bucket
+    {
+        uintptr_t key    = 0;
+        double    tokens = 0;
+        int64_t   refill = 0; // time of the last refill, in nanoseconds
+    };
+
+    static int64_t now_ns()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return ts.tv_sec * int64_t(1000000000) + ts.tv_nsec;
+    }
+
+    static constexpr size_t num_buckets = 256;
+
+    rocblas_log_sampling_mode               mode      = rocblas_log_sampling_off;
+    rocblas_int                             value     = 0;
+    rocblas_int                             countdown = 1; // calls until the next Nth call
+    std::unordered_map<size_t, rocblas_int> signatures; // calls of each hash of arguments
+    std::unique_ptr<bucket[]>               buckets;
+
+    // Find the bucket of a function, sharing the bucket of its home slot if the table is full
+    bucket& find_bucket(uintptr_t key)
+    {
+        size_t home = (key * 0x9e3779b97f4a7c15) >> 56;
+        for(size_t i = 0; i < num_buckets; ++i)
+        {
+            auto& b = buckets[(home + i) % num_buckets];
+            if(b.key == key)
+                return b;
+            if(!b.key)
+            {
+                b.key    = key;
+                b.tokens = value;
+                b.refill = now_ns();
+                return b;
+            }
+        }
+        return buckets[home];
+    }
+
+    template <typename... Ts>
+    bool sample(const Ts&... xs)
+    {
+        switch(mode)
+        {
+        case rocblas_log_sampling_off:
+            return true;
+
+        case rocblas_log_sampling_every_nth:
+            if(--countdown)
+                return false;
+            countdown = value;
+            return true;
+
+        case rocblas_log_sampling_first_k:
+        {
+            auto& count = signatures[hash_args(xs...)];
+            if(count >= value)
+                return false;
+            ++count;
+            return true;
+        }
+
+        case rocblas_log_sampling_rate_limit:
+        {
+            // Refill on every decision, so that the time a full bucket was idle earns nothing
+            auto&   b   = find_bucket(function_key(1, xs...));
+            int64_t now = now_ns();
+            b.tokens    = std::min(double(value), b.tokens + (now - b.refill) * 1e-9 * value);
+            b.refill    = now;
+            if(b.tokens < 1)
+                return false;
+            b.tokens -= 1;
+            return true;
+        }
+        }
+        return true;
+    }
+
+public:
+    // Set the sampling mode and its value, which must be positive unless sampling is off,
+    // and forget the calls seen so far
+    void set(rocblas_log_sampling_mode new_mode, rocblas_int new_value)
+    {
+        mode      = new_mode;
+        value     = new_value;
+        countdown = 1;
+        signatures.clear();
+        if(mode == rocblas_log_sampling_rate_limit)
+            buckets = std::make_unique<bucket[]>(num_buckets);
+        else
+            buckets.reset();
+    }
+
+    rocblas_log_sampling_mode get_mode() const
+    {
+        return mode;
+    }
+
+    rocblas_int get_value() const
+    {
+        return value;
+    }
+
+    // Whether to log a call with the arguments xs
+    template <typename... Ts>
+    bool operator()(const Ts&... xs)
+    {
+        return mode == rocblas_log_sampling_off || sample(xs...);
+    }
+};
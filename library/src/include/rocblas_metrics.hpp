@@ -0,0 +1,140 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/************************************************************************************
+ * Metrics of the rocBLAS calls and events in the process
+ *
+ * The metrics are always counted, so counting must cost little more than the call's
+ * argument checks. Each thread counts in its own table, which only it writes, so a
+ * count is a relaxed load and store, with no locks or read-modify-write operations;
+ * the counters are atomic only so that readers can sum the tables of all threads at
+ * any time. When a thread exits, its counts are added to the totals of the exited
+ * threads.
+ *
+ * A call is counted under the address of its function's name, a static string, and
+ * its precision, in a small open addressing table. Its size, the product of its
+ * dimensions and batch count, is counted in a histogram whose buckets hold sizes up
+ * to successive powers of 4.
+ ************************************************************************************/
+class rocblas_metrics
+{
+public:
+    enum event_t
+    {
+        workspace_reallocation,
+        solution_not_found,
+        check_numerics_failure,
+        num_events
+    };
+
+    static constexpr int num_size_buckets = ROCBLAS_METRICS_SIZE_BUCKETS;
+
+    // Counters of the calls of one function with one precision, whose number is the sum of
+    // the histogram, so that readers always see a consistent histogram and count
+    struct function_counters
+    {
+        std::atomic<const char*> function{nullptr};
+        std::atomic<int>         precision{0};
+        std::atomic<double>      size_sum{0};
+        std::atomic<uint64_t>    sizes[num_size_buckets] = {};
+    };
+
+    struct thread_counters
+    {
+        static constexpr size_t capacity = 128; // a power of 2
+
+        function_counters     functions[capacity];
+        function_counters     other; // calls of functions which do not fit in the table
+        std::atomic<uint64_t> events[num_events] = {};
+    };
+
+    // Size of a call: the product of its dimensions, which are 0 if negative, saturating
+    static uint64_t call_size()
+    {
+        return 1;
+    }
+
+    template <typename T, typename... Ts>
+    static uint64_t call_size(T dim, Ts... dims)
+    {
+        uint64_t size;
+        if(dim <= 0)
+            return 0;
+        if(__builtin_mul_overflow(uint64_t(dim), call_size(dims...), &size))
+            return std::numeric_limits<uint64_t>::max();
+        return size;
+    }
+
+    // Bucket of a size: 0 for sizes up to 1, and i for sizes in (4^(i-1), 4^i]
+    static int size_bucket(uint64_t size)
+    {
+        if(size <= 1)
+            return 0;
+        int bits = 64 - __builtin_clzll(size - 1);
+        return std::min((bits + 1) / 2, num_size_buckets - 1);
+    }
+
+    // Count a call of function, whose name must be a static string
+    static void record_call(const char* function, rocblas_datatype precision, uint64_t size)
+    {
+        auto& c = find(counters(), function, precision);
+        increment(c.sizes[size_bucket(size)]);
+        c.size_sum.store(c.size_sum.load(std::memory_order_relaxed) + double(size),
+                         std::memory_order_relaxed);
+    }
+
+    static void record_event(event_t event)
+    {
+        increment(counters().events[event]);
+    }
+
+private:
+    // Counters of the calling thread, or nullptr before its first count
+    static thread_local thread_counters* t_counters;
+
+    // Register the counters of the calling thread
+    static thread_counters& register_thread();
+
+    static thread_counters& counters()
+    {
+        thread_counters* c = t_counters;
+        return c ? *c : register_thread();
+    }
+
+    // Only the owning thread writes the counters
+    static void increment(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static function_counters&
+        find(thread_counters& t, const char* function, rocblas_datatype precision)
+    {
+        size_t home = ((uintptr_t(function) ^ size_t(precision)) * 0x9e3779b97f4a7c15) >> 57;
+        for(size_t i = 0; i < thread_counters::capacity; ++i)
+        {
+            auto&       c = t.functions[(home + i) % thread_counters::capacity];
+            const char* f = c.function.load(std::memory_order_relaxed);
+            if(f == function && c.precision.load(std::memory_order_relaxed) == precision)
+                return c;
+            if(!f)
+            {
+                // Readers see the precision of any function they see
+                c.precision.store(precision, std::memory_order_relaxed);
+                c.function.store(function, std::memory_order_release);
+                return c;
+            }
+        }
+        return t.other;
+    }
+};
@@ -6,6 +6,8 @@
 
 #include "rocblas.h"
 #include "utility.hpp"
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <complex>
 #include <condition_variable>
@@ -18,13 +20,14 @@
 #include <memory>
 #include <mutex>
 #include <ostream>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <thread>
 #include <unistd.h>
 #include <utility>
+#include <vector>
 
 /*****************************************************************************
  * rocBLAS output streams                                                    *
@@ -42,76 +45,123 @@ class rocblas_internal_ostream
     /**************************************************************************
      * The worker class sets up a worker thread for writing to log files. Two *
      * files are considered the same if they have the same device ID / inode. *
+     *                                                                        *
+     * Senders push tasks onto a lock-free queue, and the worker writes all   *
+     * of the tasks queued with one writev() call. A sender only takes the    *
+     * worker's mutex to wake it when it is sleeping. If the environment      *
+     * variable ROCBLAS_LOG_FLUSH_INTERVAL_MS is set to a positive number of  *
+     * milliseconds when the worker is created, then no sender waits for its  *
+     * output to be written, and the worker writes what has been queued once  *
+     * per interval, except when a stream is closed or rocblas_abort() is     *
+     * called, which still write all of the queued output.                    *
      **************************************************************************/
     class worker
     {
-        // task_t represents a payload of data and a promise to finish
-        class task_t
+        // task_t represents a payload of data, and the promise of a sender waiting for it
+        struct task_t
         {
-            std::string        str;
-            std::promise<void> promise;
+            enum kind_t
+            {
+                write, // write the string payload
+                fence, // wait for the tasks before it, optionally syncing the file
+                exit, // wait for the tasks before it, and exit the worker thread
+            };
+
+            std::atomic<task_t*> next{nullptr};
+            std::string          str;
+            std::promise<void>*  promise = nullptr;
+            kind_t               kind    = write;
+            bool                 sync    = false; // whether a fence syncs the file
+        };
+
+        // Multiple-producer single-consumer intrusive queue of tasks. Senders push
+        // tasks with a single atomic exchange, and only the worker thread pops them.
+        class task_queue
+        {
+            std::atomic<task_t*> head; // last task pushed
+            task_t*              tail; // next task to pop, owned by the worker thread
+            task_t               stub; // placeholder which keeps the queue non-empty
 
         public:
-            // The task takes ownership of the string payload and promise
-            task_t(std::string&& str, std::promise<void>&& promise)
-                : str(std::move(str))
-                , promise(std::move(promise))
+            task_queue()
+                : head(&stub)
+                , tail(&stub)
             {
             }
 
-            // Notify the future to wake up
-            void set_value()
-            {
-                promise.set_value();
-            }
+            void push(task_t* task);
 
-            // Size of the string payload
-            size_t size() const
-            {
-                return str.size();
-            }
+            // Pop the next task, or return nullptr if the queue is empty, or if the
+            // next task is still being pushed
+            task_t* pop();
 
-            // Data of the string payload
-            const char* data() const
+            // Whether no task has been pushed which has not been popped
+            bool empty() const
             {
-                return str.data();
+                return head.load() == &stub;
             }
         };
 
-        // FILE is used for safety in the presence of signals
-        FILE* file = nullptr;
+        // File descriptor written to
+        int fd = -1;
+
+        // Interval between writes, or 0 to write each task as soon as it is sent
+        std::chrono::milliseconds flush_interval{0};
+
+        // Whether writing to the file has failed, after which output is discarded
+        bool failed = false;
 
         // This worker's thread
         std::thread thread;
 
-        // Condition variable for worker notification
+        // Condition variable and mutex for waking the worker thread
         std::condition_variable cond;
-
-        // Mutex for this thread's queue
-        std::mutex mutex;
+        std::mutex              mutex;
+        std::atomic<bool>       sleeping{false};
+        std::atomic<bool>       pending{false}; // whether a sender has asked to be woken
 
         // Queue of tasks
-        std::queue<task_t> queue;
+        task_queue queue;
 
-        // Worker thread which waits for and handles tasks sequentially
+        // Worker thread which waits for and handles tasks in batches
         void thread_function();
 
+        // Write the payloads of a batch of tasks, and complete the tasks; returns false
+        // after completing the task which tells the worker thread to exit
+        bool write_batch(std::vector<task_t*>& batch, std::vector<iovec>& iov);
+
+        // Sleep until woken, or in interval mode, until the interval has passed
+        void sleep();
+
+        // Wake the worker thread if it is sleeping
+        void wake();
+
+        // Push a task, waiting for it to be completed if wait is true
+        void push(task_t* task, bool wait);
+
     public:
         // Worker constructor creates a worker thread for a raw filehandle
         explicit worker(int fd);
 
-        // Send a string to be written
-        void send(std::string);
+        // Send a string to be written, waiting for it to be written unless wait is false
+        // or the worker writes at an interval
+        void send(std::string, bool wait = true);
+
+        // Wait for everything sent so far to be written, and with sync, to be synced to
+        // the file's storage device
+        void fence(bool sync);
 
         // Destroy a worker when all std::shared_ptr references to it are gone
         ~worker()
         {
-            // Tell worker thread to exit, by sending it an empty string
-            send({});
-
-            // Close the FILE
-            if(file)
-                fclose(file);
+            // Tell worker thread to exit, waiting for it to write everything queued
+            auto task  = new task_t;
+            task->kind = task_t::exit;
+            push(task, true);
+
+            // Close the file descriptor
+            if(fd != -1)
+                close(fd);
         }
     };
 
@@ -149,6 +199,10 @@ class rocblas_internal_ostream
         return map_mutex;
     }
 
+    // Wait for all workers to write everything sent to them, and with sync, to sync
+    // their files to storage; called at exit and by rocblas_abort()
+    static void fence_all(bool sync);
+
     // Output buffer for formatted IO
     std::ostringstream os;
 
@@ -217,6 +271,12 @@ public:
     // Flush the output
     void flush();
 
+    // Flush the output without waiting for the worker thread to write it
+    void flush_async();
+
+    // Wait for all of the output sent to this stream's file to be written
+    void fence();
+
     // Destroy the rocblas_internal_ostream
     virtual ~rocblas_internal_ostream()
     {
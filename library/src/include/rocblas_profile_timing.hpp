@@ -0,0 +1,172 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/************************************************************************************
+ * Latency histogram of the calls with one argument tuple, in nanoseconds
+ *
+ * Each power of 2 is divided into 8 buckets, so percentiles are within 1/8 of their
+ * true value. The buckets are allocated on the first time recorded, so an unused
+ * histogram takes no space beyond its totals.
+ ************************************************************************************/
+class rocblas_latency_histogram
+{
+    static constexpr int sub_bits    = 3;
+    static constexpr int sub_buckets = 1 << sub_bits;
+    static constexpr int max_log2    = 40; // Longer times are counted in the last bucket
+    static constexpr int num_buckets = (max_log2 - sub_bits + 2) * sub_buckets;
+
+    uint64_t              calls = 0;
+    uint64_t              total = 0;
+    uint64_t              min   = std::numeric_limits<uint64_t>::max();
+    uint64_t              max   = 0;
+    std::vector<uint64_t> buckets;
+
+    static int bucket(uint64_t ns)
+    {
+        ns = std::min(ns, (uint64_t(1) << (max_log2 + 1)) - 1);
+        if(ns < sub_buckets)
+            return int(ns);
+        int log2 = 63 - __builtin_clzll(ns);
+        return (log2 - sub_bits) * sub_buckets + int(ns >> (log2 - sub_bits));
+    }
+
+    // Smallest and largest time counted in bucket b
+    static uint64_t bucket_lower(int b)
+    {
+        if(b < sub_buckets)
+            return b;
+        return uint64_t(sub_buckets + b % sub_buckets) << (b / sub_buckets - 1);
+    }
+
+    static uint64_t bucket_upper(int b)
+    {
+        return b + 1 < num_buckets ? bucket_lower(b + 1) - 1
+                                   : std::numeric_limits<uint64_t>::max();
+    }
+
+public:
+    void record(uint64_t ns)
+    {
+        if(buckets.empty())
+            buckets.resize(num_buckets);
+        buckets[bucket(ns)]++;
+        calls++;
+        total += ns;
+        min = std::min(min, ns);
+        max = std::max(max, ns);
+    }
+
+    void merge(const rocblas_latency_histogram& other)
+    {
+        if(!other.calls)
+            return;
+        if(buckets.empty())
+            buckets.resize(num_buckets);
+        for(int b = 0; b < num_buckets; ++b)
+            buckets[b] += other.buckets[b];
+        calls += other.calls;
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    uint64_t count() const
+    {
+        return calls;
+    }
+
+    uint64_t total_ns() const
+    {
+        return total;
+    }
+
+    uint64_t min_ns() const
+    {
+        return calls ? min : 0;
+    }
+
+    uint64_t max_ns() const
+    {
+        return max;
+    }
+
+    // Time below which a fraction p of the calls took, estimated as the middle of its
+    // bucket, and kept within the times recorded
+    uint64_t percentile_ns(double p) const
+    {
+        if(!calls)
+            return 0;
+        uint64_t rank = std::max(uint64_t(1), uint64_t(std::ceil(p * calls)));
+        uint64_t seen = 0;
+        int      b    = 0;
+        while(b < num_buckets - 1 && (seen += buckets[b]) < rank)
+            ++b;
+        uint64_t lower = bucket_lower(b), upper = std::min(bucket_upper(b), max);
+        return std::max(min, std::min(max, lower + (upper - lower) / 2));
+    }
+};
+
+/************************************************************************************
+ * Profile of the calls with one argument tuple: the number of calls, and in timed
+ * profile mode, their host and device times
+ ************************************************************************************/
+struct argument_profile_entry
+{
+    size_t                    call_count = 0;
+    rocblas_latency_histogram host_time;
+    rocblas_latency_histogram device_time;
+
+    void merge(const argument_profile_entry& other)
+    {
+        call_count += other.call_count;
+        host_time.merge(other.host_time);
+        device_time.merge(other.device_time);
+    }
+};
+
+/************************************************************************************
+ * A call being timed by timed profile logging, which refers to the entry of its
+ * argument tuple in the table of the calling thread, and the mutex guarding it
+ ************************************************************************************/
+struct argument_profile_call
+{
+    std::mutex*                           mutex = nullptr;
+    argument_profile_entry*               entry = nullptr;
+    std::chrono::steady_clock::time_point start;
+    bool                                  device = false; // whether device time is recorded
+
+    // Record the times of the call in its entry
+    void record(uint64_t host_ns, const uint64_t* device_ns) const
+    {
+        std::lock_guard<std::mutex> lock(*mutex);
+        entry->host_time.record(host_ns);
+        if(device_ns)
+            entry->device_time.record(*device_ns);
+    }
+};
+
+/************************************************************************************
+ * Call being written to the timeline log
+ *
+ * log_trace writes the start of the call's event, which the rocblas_profile_timer of
+ * the function completes with the call's duration. Calls logged when no timer is
+ * active, such as those of the auxiliary functions, are written as instant events.
+ ************************************************************************************/
+struct rocblas_timeline_call
+{
+    std::string                           event; // event without its phase and duration
+    std::chrono::steady_clock::time_point start;
+    bool                                  scoped = false; // whether a timer is active
+};
@@ -0,0 +1,286 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/*****************************************************************************
+ * rocblas_solution_cache is a bounded, concurrent map from a fixed-size key *
+ * (an array of N 64-bit words) to a pointer whose lifetime is managed by    *
+ * somebody else (e.g. a Tensile solution owned by the solution library).    *
+ *                                                                           *
+ * The cache is set-associative with WAYS entries per set. Lookups are       *
+ * lock-free: every entry is protected by a sequence counter which writers   *
+ * make odd while they modify the entry, and readers retry or miss when the  *
+ * counter changes underneath them. Inserts take a per-set mutex and evict   *
+ * the least recently used entry of the set.                                 *
+ *****************************************************************************/
+template <typename T, size_t N, size_t WAYS = 4>
+class rocblas_solution_cache
+{
+public:
+    using key_t = std::array<uint64_t, N>;
+
+    // Snapshot of the cache counters
+    struct stats_t
+    {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        size_t entries;
+    };
+
+    explicit rocblas_solution_cache(size_t capacity)
+        : m_num_sets(round_up_pow2((capacity + WAYS - 1) / WAYS))
+        , m_sets(capacity ? new set_t[m_num_sets] : nullptr)
+        , m_enabled(capacity != 0)
+    {
+    }
+
+    rocblas_solution_cache(const rocblas_solution_cache&) = delete;
+    rocblas_solution_cache& operator=(const rocblas_solution_cache&) = delete;
+
+    // 64-bit mix of the key words; never 0, which marks empty entries
+    static uint64_t hash(const key_t& key)
+    {
+        uint64_t h = 0xcbf29ce484222325;
+        for(auto k : key)
+        {
+            h ^= k + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+            h *= 0x100000001b3;
+        }
+        h ^= h >> 29;
+        return h ? h : 1;
+    }
+
+    // Total number of entries the cache can hold
+    size_t capacity() const
+    {
+        return m_sets ? m_num_sets * WAYS : 0;
+    }
+
+    bool enabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Enabling a cache created with zero capacity has no effect
+    void set_enabled(bool enable)
+    {
+        m_enabled.store(enable && m_sets, std::memory_order_relaxed);
+    }
+
+    /***********************************************************
+     * Look up a key. Returns nullptr on a miss. Never blocks. *
+     ***********************************************************/
+    T* find(const key_t& key)
+    {
+        if(!enabled())
+            return nullptr;
+
+        uint64_t h   = hash(key);
+        set_t&   set = m_sets[h & (m_num_sets - 1)];
+
+        for(auto& e : set.entries)
+        {
+            // Cheap rejection before we look at the whole key
+            if(e.hash.load(std::memory_order_relaxed) != h)
+                continue;
+
+            for(;;)
+            {
+                uint64_t seq = e.seq.load(std::memory_order_acquire);
+                if(seq & 1)
+                    break; // A writer is modifying the entry; treat it as a miss
+
+                bool match = e.hash.load(std::memory_order_relaxed) == h;
+                for(size_t i = 0; match && i < N; ++i)
+                    match = e.key[i].load(std::memory_order_relaxed) == key[i];
+                T* value = e.value.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(e.seq.load(std::memory_order_relaxed) != seq)
+                    continue; // The entry changed while we were reading it
+
+                if(!match)
+                    break;
+
+                // Refresh the LRU tick only when it changed, to avoid bouncing the cache line
+                uint64_t tick = m_tick.load(std::memory_order_relaxed);
+                if(e.last_use.load(std::memory_order_relaxed) != tick)
+                    e.last_use.store(tick, std::memory_order_relaxed);
+
+                count(m_hits);
+                return value;
+            }
+        }
+
+        count(m_misses);
+        return nullptr;
+    }
+
+    /*********************************************************************
+     * Insert or replace a key. Evicts the least recently used entry of  *
+     * the set when the set is full.                                     *
+     *********************************************************************/
+    void insert(const key_t& key, T* value)
+    {
+        if(!enabled() || !value)
+            return;
+
+        uint64_t                    h   = hash(key);
+        set_t&                      set = m_sets[h & (m_num_sets - 1)];
+        std::lock_guard<std::mutex> lock(set.mutex);
+
+        // Prefer an entry with the same key, then an empty entry, then the least recently used
+        entry_t* victim = nullptr;
+        for(auto& e : set.entries)
+            if(e.hash.load(std::memory_order_relaxed) == h && key_equal(e, key))
+                victim = &e;
+        for(auto& e : set.entries)
+            if(!victim && !e.hash.load(std::memory_order_relaxed))
+                victim = &e;
+        if(!victim)
+        {
+            victim = &set.entries[0];
+            for(auto& e : set.entries)
+                if(e.last_use.load(std::memory_order_relaxed)
+                   < victim->last_use.load(std::memory_order_relaxed))
+                    victim = &e;
+        }
+
+        uint64_t old_hash = victim->hash.load(std::memory_order_relaxed);
+        if(!old_hash)
+            m_entries.fetch_add(1, std::memory_order_relaxed);
+        else if(old_hash != h || !key_equal(*victim, key))
+            count(m_evictions);
+
+        write_entry(*victim, h, &key, value);
+    }
+
+    // Remove all entries. Counters are not reset.
+    void clear()
+    {
+        for(size_t s = 0; m_sets && s < m_num_sets; ++s)
+        {
+            std::lock_guard<std::mutex> lock(m_sets[s].mutex);
+            for(auto& e : m_sets[s].entries)
+                if(e.hash.load(std::memory_order_relaxed))
+                {
+                    write_entry(e, 0, nullptr, nullptr);
+                    m_entries.fetch_sub(1, std::memory_order_relaxed);
+                }
+        }
+    }
+
+    // Call func(key, value) for every entry in the cache
+    template <typename FUNC>
+    void for_each(FUNC&& func)
+    {
+        for(size_t s = 0; m_sets && s < m_num_sets; ++s)
+        {
+            std::lock_guard<std::mutex> lock(m_sets[s].mutex);
+            for(auto& e : m_sets[s].entries)
+                if(e.hash.load(std::memory_order_relaxed))
+                {
+                    key_t key;
+                    for(size_t i = 0; i < N; ++i)
+                        key[i] = e.key[i].load(std::memory_order_relaxed);
+                    func(key, e.value.load(std::memory_order_relaxed));
+                }
+        }
+    }
+
+    stats_t get_stats() const
+    {
+        return {sum(m_hits), sum(m_misses), sum(m_evictions), m_entries.load()};
+    }
+
+private:
+    // Counters are striped across cache lines to avoid contention between threads
+    static constexpr size_t STRIPES = 16;
+
+    struct alignas(64) counter_t
+    {
+        std::atomic<size_t> value{0};
+    };
+
+    using counters_t = std::array<counter_t, STRIPES>;
+
+    struct entry_t
+    {
+        std::atomic<uint64_t>                seq{0};
+        std::atomic<uint64_t>                hash{0}; // 0 means the entry is empty
+        std::atomic<uint64_t>                last_use{0};
+        std::array<std::atomic<uint64_t>, N> key{};
+        std::atomic<T*>                      value{nullptr};
+    };
+
+    struct set_t
+    {
+        std::mutex                mutex;
+        std::array<entry_t, WAYS> entries;
+    };
+
+    const size_t             m_num_sets;
+    std::unique_ptr<set_t[]> m_sets;
+    std::atomic<bool>        m_enabled;
+    std::atomic<uint64_t>    m_tick{0};
+    std::atomic<size_t>      m_entries{0};
+    counters_t               m_hits, m_misses, m_evictions;
+
+    static size_t round_up_pow2(size_t n)
+    {
+        size_t p = 1;
+        while(p < n)
+            p <<= 1;
+        return p;
+    }
+
+    static bool key_equal(const entry_t& e, const key_t& key)
+    {
+        for(size_t i = 0; i < N; ++i)
+            if(e.key[i].load(std::memory_order_relaxed) != key[i])
+                return false;
+        return true;
+    }
+
+    // Called with the set's mutex held
+    void write_entry(entry_t& e, uint64_t h, const key_t* key, T* value)
+    {
+        uint64_t seq = e.seq.load(std::memory_order_relaxed);
+        e.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        e.hash.store(h, std::memory_order_relaxed);
+        for(size_t i = 0; i < N; ++i)
+            e.key[i].store(key ? (*key)[i] : 0, std::memory_order_relaxed);
+        e.value.store(value, std::memory_order_relaxed);
+        e.last_use.store(m_tick.fetch_add(1, std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+
+        e.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    static void count(counters_t& counters)
+    {
+        static std::atomic<size_t> next_stripe{0};
+        thread_local size_t        stripe = next_stripe++ % STRIPES;
+        counters[stripe].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t sum(const counters_t& counters)
+    {
+        size_t total = 0;
+        for(auto& c : counters)
+            total += c.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
@@ -0,0 +1,291 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+ * A solution override table pins the Tensile solution used for gemm         *
+ * problems matching a signature. It is a text file with one row per line:   *
+ *                                                                           *
+ *   # rocBLAS solution overrides v1                                         *
+ *   a_type=f32_r transA=N transB=T M=1024:4096 K=64: solution_index=1234    *
+ *                                                                           *
+ * A row is a list of name=value fields. Every row needs solution_index; any *
+ * other field which is omitted matches every problem. The fields are:       *
+ *                                                                           *
+ *   a_type c_type compute_type           datatype names, e.g. f16_r         *
+ *   transA transB                        N, T or C                          *
+ *   M N K batch_count                    integer or range                   *
+ *   lda ldb ldc ldd                      integer or range                   *
+ *   stride_a stride_b stride_c stride_d  integer or range                   *
+ *                                                                           *
+ * A range is lo:hi, inclusive, where either bound may be omitted. Rows are  *
+ * matched in file order, and the first matching row wins. Blank lines and   *
+ * lines starting with # are ignored. Override tables can be checked with    *
+ * scripts/utilities/solution-overrides.py.                                  *
+ *****************************************************************************/
+constexpr char ROCBLAS_SOLUTION_OVERRIDE_HEADER[] = "# rocBLAS solution overrides v1";
+
+// The signature of a gemm problem, as matched against override rows
+struct rocblas_override_problem
+{
+    const char* a_type;
+    const char* c_type;
+    const char* compute_type;
+    char        transA;
+    char        transB;
+    int64_t     M, N, K, batch_count;
+    int64_t     lda, ldb, ldc, ldd;
+    int64_t     stride_a, stride_b, stride_c, stride_d;
+};
+
+// The fields of a row matching exactly one problem signature, without solution_index
+inline std::string rocblas_override_row(const rocblas_override_problem& p)
+{
+    std::ostringstream row;
+    row << "a_type=" << p.a_type << " c_type=" << p.c_type << " compute_type=" << p.compute_type
+        << " transA=" << p.transA << " transB=" << p.transB << " M=" << p.M << " N=" << p.N
+        << " K=" << p.K << " batch_count=" << p.batch_count << " lda=" << p.lda
+        << " ldb=" << p.ldb << " ldc=" << p.ldc << " ldd=" << p.ldd << " stride_a=" << p.stride_a
+        << " stride_b=" << p.stride_b << " stride_c=" << p.stride_c << " stride_d=" << p.stride_d;
+    return row.str();
+}
+
+class rocblas_solution_override_table
+{
+public:
+    // Inclusive range of integers
+    struct range_t
+    {
+        int64_t lo = std::numeric_limits<int64_t>::min();
+        int64_t hi = std::numeric_limits<int64_t>::max();
+
+        bool contains(int64_t x) const
+        {
+            return lo <= x && x <= hi;
+        }
+    };
+
+    struct row_t
+    {
+        int         line = 0; // line number in the file
+        std::string text;     // the row as written
+        std::string a_type, c_type, compute_type;
+        char        transA = 0, transB = 0; // 0 matches any
+        range_t     M, N, K, batch_count;
+        range_t     lda, ldb, ldc, ldd;
+        range_t     stride_a, stride_b, stride_c, stride_d;
+        int         solution_index = -1;
+    };
+
+    /***************************************************************************
+     * Read the table at path. Returns false and describes the first error in  *
+     * error if the file cannot be read or is malformed.                       *
+     ***************************************************************************/
+    bool read(const char* path, std::string& error)
+    {
+        std::ifstream in(path);
+        std::string   line;
+        if(!std::getline(in, line) || line != ROCBLAS_SOLUTION_OVERRIDE_HEADER)
+        {
+            error = std::string(path) + ": missing header \"" + ROCBLAS_SOLUTION_OVERRIDE_HEADER
+                    + "\"";
+            return false;
+        }
+
+        std::vector<row_t> rows;
+        for(int line_number = 2; std::getline(in, line); ++line_number)
+        {
+            size_t start = line.find_first_not_of(" \t\r");
+            if(start == std::string::npos || line[start] == '#')
+                continue;
+
+            row_t       row;
+            std::string message;
+            if(!parse_row(line, row, message))
+            {
+                error = std::string(path) + ":" + std::to_string(line_number) + ": " + message;
+                return false;
+            }
+            row.line = line_number;
+            row.text = line.substr(start);
+            rows.push_back(std::move(row));
+        }
+
+        m_rows = std::move(rows);
+        m_fired.reset(new std::atomic<size_t>[m_rows.size()]());
+        m_rejected.reset(new std::atomic<size_t>[m_rows.size()]());
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_rows.empty();
+    }
+
+    const row_t& row(int i) const
+    {
+        return m_rows[i];
+    }
+
+    // Index of the first row matching a problem, or -1 if none matches
+    int match(const rocblas_override_problem& p) const
+    {
+        for(size_t i = 0; i < m_rows.size(); ++i)
+        {
+            auto& r = m_rows[i];
+            if(type_matches(r.a_type, p.a_type) && type_matches(r.c_type, p.c_type)
+               && type_matches(r.compute_type, p.compute_type)
+               && (!r.transA || r.transA == p.transA) && (!r.transB || r.transB == p.transB)
+               && r.M.contains(p.M) && r.N.contains(p.N) && r.K.contains(p.K)
+               && r.batch_count.contains(p.batch_count) && r.lda.contains(p.lda)
+               && r.ldb.contains(p.ldb) && r.ldc.contains(p.ldc) && r.ldd.contains(p.ldd)
+               && r.stride_a.contains(p.stride_a) && r.stride_b.contains(p.stride_b)
+               && r.stride_c.contains(p.stride_c) && r.stride_d.contains(p.stride_d))
+                return int(i);
+        }
+        return -1;
+    }
+
+    // Record that a row was used, or rejected because its solution does not apply
+    void record(int i, bool fired)
+    {
+        (fired ? m_fired : m_rejected)[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /***************************************************************************
+     * Write a report of how often each row fired or was rejected. Rows which  *
+     * never matched are listed too, so that stale overrides can be found.     *
+     ***************************************************************************/
+    bool write_report(const char* path) const
+    {
+        FILE* f = fopen(path, "w");
+        if(!f)
+            return false;
+        fprintf(f, "line,fired,rejected,solution_index,row\n");
+        for(size_t i = 0; i < m_rows.size(); ++i)
+            fprintf(f,
+                    "%d,%zu,%zu,%d,\"%s\"\n",
+                    m_rows[i].line,
+                    m_fired[i].load(std::memory_order_relaxed),
+                    m_rejected[i].load(std::memory_order_relaxed),
+                    m_rows[i].solution_index,
+                    m_rows[i].text.c_str());
+        return fclose(f) == 0;
+    }
+
+private:
+    std::vector<row_t>                     m_rows;
+    std::unique_ptr<std::atomic<size_t>[]> m_fired;
+    std::unique_ptr<std::atomic<size_t>[]> m_rejected;
+
+    static bool type_matches(const std::string& row, const char* type)
+    {
+        return row.empty() || row == type;
+    }
+
+    static bool parse_int(const std::string& s, int64_t& x)
+    {
+        if(s.empty())
+            return false;
+        char* end;
+        errno = 0;
+        x     = strtoll(s.c_str(), &end, 10);
+        return !*end && !errno;
+    }
+
+    static bool parse_range(const std::string& s, range_t& r)
+    {
+        size_t colon = s.find(':');
+        if(colon == std::string::npos)
+            return parse_int(s, r.lo) && parse_int(s, r.hi);
+
+        std::string lo = s.substr(0, colon), hi = s.substr(colon + 1);
+        return (lo.empty() || parse_int(lo, r.lo)) && (hi.empty() || parse_int(hi, r.hi))
+               && r.lo <= r.hi;
+    }
+
+    static bool parse_row(const std::string& line, row_t& row, std::string& message)
+    {
+        std::istringstream fields(line);
+        std::string        field;
+        while(fields >> field)
+        {
+            size_t eq = field.find('=');
+            if(eq == std::string::npos || eq == 0)
+            {
+                message = "expected name=value, found \"" + field + "\"";
+                return false;
+            }
+            std::string name = field.substr(0, eq), value = field.substr(eq + 1);
+
+            range_t* range = name == "M"             ? &row.M
+                             : name == "N"           ? &row.N
+                             : name == "K"           ? &row.K
+                             : name == "batch_count" ? &row.batch_count
+                             : name == "lda"         ? &row.lda
+                             : name == "ldb"         ? &row.ldb
+                             : name == "ldc"         ? &row.ldc
+                             : name == "ldd"         ? &row.ldd
+                             : name == "stride_a"    ? &row.stride_a
+                             : name == "stride_b"    ? &row.stride_b
+                             : name == "stride_c"    ? &row.stride_c
+                             : name == "stride_d"    ? &row.stride_d
+                                                     : nullptr;
+            bool ok = true;
+            if(range)
+                ok = parse_range(value, *range);
+            else if(name == "a_type")
+                row.a_type = value;
+            else if(name == "c_type")
+                row.c_type = value;
+            else if(name == "compute_type")
+                row.compute_type = value;
+            else if(name == "transA" || name == "transB")
+            {
+                char c = value.size() == 1 ? char(toupper(value[0])) : 0;
+                ok     = c == 'N' || c == 'T' || c == 'C';
+                (name == "transA" ? row.transA : row.transB) = c;
+            }
+            else if(name == "solution_index")
+            {
+                int64_t index;
+                ok = parse_int(value, index) && index >= 0 && index <= INT32_MAX;
+                row.solution_index = int(index);
+            }
+            else
+            {
+                message = "unknown field \"" + name + "\"";
+                return false;
+            }
+
+            if(!ok)
+            {
+                message = "invalid value for " + name + ": \"" + value + "\"";
+                return false;
+            }
+        }
+
+        if(row.solution_index < 0)
+        {
+            message = "missing solution_index";
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,218 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/*****************************************************************************
+ * A warm start file records the solution index selected for each problem    *
+ * signature, so that a later process can pre-seed its solution cache.       *
+ *                                                                           *
+ * Layout (native little-endian, no padding):                                *
+ *                                                                           *
+ *   header, 64 bytes                                                        *
+ *     char     magic[8]       "rbsolws" followed by a NUL                   *
+ *     uint32_t version        ROCBLAS_WARM_START_VERSION                    *
+ *     uint32_t key_words      number of 64-bit words in each key            *
+ *     uint64_t library_id     identity of the Tensile library file          *
+ *     char     arch[32]       architecture name, NUL-padded                 *
+ *     uint64_t count          number of entries                             *
+ *   entries, count * (key_words + 1) * 8 bytes                              *
+ *     uint64_t key[key_words] problem signature                             *
+ *     int64_t  index          solution index in the Tensile library         *
+ *                                                                           *
+ * A file whose version, key_words, library_id or arch do not match the      *
+ * running library is ignored. The library_id hashes the size, modification  *
+ * time, inode and device of the library file, which identify a build        *
+ * without reading the file. scripts/utilities/solution-warm-start.py can    *
+ * inspect and merge warm start files.                                       *
+ *****************************************************************************/
+constexpr uint32_t ROCBLAS_WARM_START_VERSION  = 2;
+constexpr char     ROCBLAS_WARM_START_MAGIC[8] = "rbsolws";
+
+struct rocblas_warm_start_header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t key_words;
+    uint64_t library_id;
+    char     arch[32];
+    uint64_t count;
+};
+
+static_assert(sizeof(rocblas_warm_start_header) == 64, "warm start header must be 64 bytes");
+
+/************************************************
+ * Read-only memory mapping of a whole file     *
+ ************************************************/
+class rocblas_mapped_file
+{
+    void*  m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    explicit rocblas_mapped_file(const char* path)
+    {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if(fd == -1)
+            return;
+        struct stat st;
+        if(!fstat(fd, &st) && st.st_size > 0)
+        {
+            void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED)
+            {
+                m_data = data;
+                m_size = size_t(st.st_size);
+            }
+        }
+        close(fd);
+    }
+
+    ~rocblas_mapped_file()
+    {
+        if(m_data)
+            munmap(m_data, m_size);
+    }
+
+    rocblas_mapped_file(const rocblas_mapped_file&) = delete;
+    rocblas_mapped_file& operator=(const rocblas_mapped_file&) = delete;
+
+    const void* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+};
+
+// 64-bit FNV-1a hash of a byte range
+inline uint64_t rocblas_warm_start_hash(const void* data, size_t size)
+{
+    uint64_t h = 0xcbf29ce484222325;
+    auto     p = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; ++i)
+        h = (h ^ p[i]) * 0x100000001b3;
+    return h;
+}
+
+// Identity of a file from its metadata, or 0 if the file cannot be found
+inline uint64_t rocblas_warm_start_file_id(const char* path)
+{
+    struct stat st;
+    if(stat(path, &st))
+        return 0;
+    const uint64_t fields[] = {uint64_t(st.st_size),
+                               uint64_t(st.st_mtim.tv_sec),
+                               uint64_t(st.st_mtim.tv_nsec),
+                               uint64_t(st.st_ino),
+                               uint64_t(st.st_dev)};
+    uint64_t       id       = rocblas_warm_start_hash(fields, sizeof(fields));
+    return id ? id : 1;
+}
+
+/*****************************************************************************
+ * Read the warm start file at path, calling func(key, index) for each entry *
+ * if the header matches arch and library_id. Returns the number of entries  *
+ * read, or -1 if the file is missing, truncated or does not match.          *
+ *****************************************************************************/
+template <size_t N, typename FUNC>
+int64_t rocblas_warm_start_read(const char*        path,
+                                const std::string& arch,
+                                uint64_t           library_id,
+                                FUNC&&             func)
+{
+    rocblas_mapped_file file(path);
+    if(!file.data() || file.size() < sizeof(rocblas_warm_start_header))
+        return -1;
+
+    rocblas_warm_start_header header;
+    memcpy(&header, file.data(), sizeof(header));
+    if(memcmp(header.magic, ROCBLAS_WARM_START_MAGIC, sizeof(header.magic))
+       || header.version != ROCBLAS_WARM_START_VERSION || header.key_words != N
+       || header.library_id != library_id
+       || strncmp(header.arch, arch.c_str(), sizeof(header.arch)))
+        return -1;
+
+    constexpr size_t entry_size = (N + 1) * sizeof(uint64_t);
+    if((file.size() - sizeof(header)) / entry_size < header.count)
+        return -1;
+
+    auto entries = static_cast<const char*>(file.data()) + sizeof(header);
+    for(uint64_t i = 0; i < header.count; ++i)
+    {
+        std::array<uint64_t, N> key;
+        int64_t                 index;
+        memcpy(key.data(), entries + i * entry_size, sizeof(key));
+        memcpy(&index, entries + i * entry_size + sizeof(key), sizeof(index));
+        func(key, index);
+    }
+    return int64_t(header.count);
+}
+
+/*****************************************************************************
+ * Write a warm start file, merged with the entries of the file already at   *
+ * path if its header matches; entries gives the selections which take       *
+ * precedence. The file is written under a temporary name and renamed, so    *
+ * that readers never see a partially written file. Processes writing at     *
+ * the same time may drop each other's newest entries, but not corrupt the   *
+ * file.                                                                     *
+ *****************************************************************************/
+template <size_t N>
+bool rocblas_warm_start_write(
+    const char*                                                     path,
+    const std::string&                                              arch,
+    uint64_t                                                        library_id,
+    const std::vector<std::pair<std::array<uint64_t, N>, int64_t>>& entries)
+{
+    std::map<std::array<uint64_t, N>, int64_t> merged;
+    rocblas_warm_start_read<N>(path, arch, library_id, [&](const auto& key, int64_t index) {
+        merged[key] = index;
+    });
+    for(auto& e : entries)
+        merged[e.first] = e.second;
+
+    rocblas_warm_start_header header{};
+    memcpy(header.magic, ROCBLAS_WARM_START_MAGIC, sizeof(header.magic));
+    header.version    = ROCBLAS_WARM_START_VERSION;
+    header.key_words  = N;
+    header.library_id = library_id;
+    strncpy(header.arch, arch.c_str(), sizeof(header.arch) - 1);
+    header.count = merged.size();
+
+    std::string tmp = std::string(path) + ".tmp." + std::to_string(getpid());
+    FILE*       fp  = fopen(tmp.c_str(), "wb");
+    if(!fp)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    for(auto& e : merged)
+    {
+        ok = ok && fwrite(e.first.data(), sizeof(e.first), 1, fp) == 1;
+        ok = ok && fwrite(&e.second, sizeof(e.second), 1, fp) == 1;
+    }
+    ok = !fclose(fp) && ok;
+
+    if(ok)
+        ok = !rename(tmp.c_str(), path);
+    if(!ok)
+        remove(tmp.c_str());
+    return ok;
+}
@@ -0,0 +1,249 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*****************************************************************************
+ * rocblas_workspace_allocator sub-allocates blocks of a handle's workspace  *
+ * region, which may be released in any order. Only offsets are managed; the *
+ * region itself is never accessed, so that it may be device memory, and the *
+ * allocator can be tested over a host buffer.                               *
+ *                                                                           *
+ * Blocks are kept in a list ordered by offset, so that a released block is  *
+ * coalesced with its free neighbours. Free blocks are also kept in lists by *
+ * size class, where class c holds sizes in [2^c, 2^(c+1)). An allocation    *
+ * takes the first fitting block of its own class, or else a block of the    *
+ * smallest larger class, and splits off the remainder.                      *
+ *                                                                           *
+ * Block descriptors are recycled, so that once the allocator has seen its   *
+ * peak number of blocks, allocating and releasing do not allocate memory.   *
+ *****************************************************************************/
+class rocblas_workspace_allocator
+{
+public:
+    static constexpr size_t GRANULARITY = 64; // sizes and offsets are multiples of this
+    static constexpr int    NUM_CLASSES = 64;
+
+    // A summary of the allocator's state, e.g. to report fragmentation
+    struct stats_t
+    {
+        size_t capacity         = 0; // size of the region
+        size_t in_use           = 0; // bytes in allocated blocks
+        size_t peak_in_use      = 0; // highest in_use since the region was reset
+        size_t allocated_blocks = 0;
+        size_t free_blocks      = 0;
+        size_t largest_free     = 0; // size of the largest free block
+
+        // Fraction of the free bytes which are not in the largest free block
+        double fragmentation() const
+        {
+            size_t free_bytes = capacity - in_use;
+            return free_bytes ? 1.0 - double(largest_free) / double(free_bytes) : 0.0;
+        }
+    };
+
+    explicit rocblas_workspace_allocator(size_t capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    // Manage a new region of capacity bytes. All blocks must have been released.
+    void reset(size_t capacity)
+    {
+        m_nodes.clear();
+        m_unused.clear();
+        for(auto& c : m_classes)
+            c = NIL;
+        m_capacity = capacity / GRANULARITY * GRANULARITY;
+        m_in_use = m_peak_in_use = m_allocated = 0;
+        if(m_capacity)
+            insert_free(new_node(0, m_capacity, NIL, NIL));
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    size_t in_use() const
+    {
+        return m_in_use;
+    }
+
+    /*************************************************************************
+     * Allocate a block of at least size bytes. Returns an id identifying    *
+     * the block to release(), and its offset in the region, or returns -1   *
+     * if no free block is large enough. size must be nonzero.               *
+     *************************************************************************/
+    int allocate(size_t size, size_t& offset)
+    {
+        size = (size + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+
+        int id = NIL;
+        for(int c = size_class(size); c < NUM_CLASSES && id == NIL; ++c)
+            for(int i = m_classes[c]; i != NIL; i = m_nodes[i].free_next)
+                if(m_nodes[i].size >= size)
+                {
+                    id = i;
+                    break;
+                }
+        if(id == NIL)
+            return -1;
+
+        remove_free(id);
+
+        // Split off the remainder as a free block following the allocated block
+        if(m_nodes[id].size > size)
+        {
+            node& n    = m_nodes[id];
+            int   rest = new_node(n.offset + size, n.size - size, id, n.next);
+            node& a    = m_nodes[id]; // new_node() may have moved the nodes
+            if(a.next != NIL)
+                m_nodes[a.next].prev = rest;
+            a.next = rest;
+            a.size = size;
+            insert_free(rest);
+        }
+
+        m_in_use += size;
+        if(m_in_use > m_peak_in_use)
+            m_peak_in_use = m_in_use;
+        ++m_allocated;
+        offset = m_nodes[id].offset;
+        return id;
+    }
+
+    // Release a block returned by allocate(), coalescing it with free neighbours
+    void release(int id)
+    {
+        m_in_use -= m_nodes[id].size;
+        --m_allocated;
+
+        int next = m_nodes[id].next;
+        if(next != NIL && m_nodes[next].free)
+        {
+            remove_free(next);
+            merge_into(id, next);
+        }
+
+        int prev = m_nodes[id].prev;
+        if(prev != NIL && m_nodes[prev].free)
+        {
+            remove_free(prev);
+            merge_into(prev, id);
+            id = prev;
+        }
+
+        insert_free(id);
+    }
+
+    // Size of the largest free block, which is the largest allocation which can succeed
+    size_t largest_free() const
+    {
+        for(int c = NUM_CLASSES - 1; c >= 0; --c)
+            if(m_classes[c] != NIL)
+            {
+                size_t largest = 0;
+                for(int i = m_classes[c]; i != NIL; i = m_nodes[i].free_next)
+                    if(m_nodes[i].size > largest)
+                        largest = m_nodes[i].size;
+                return largest;
+            }
+        return 0;
+    }
+
+    stats_t stats() const
+    {
+        stats_t s;
+        s.capacity         = m_capacity;
+        s.in_use           = m_in_use;
+        s.peak_in_use      = m_peak_in_use;
+        s.allocated_blocks = m_allocated;
+        for(auto head : m_classes)
+            for(int i = head; i != NIL; i = m_nodes[i].free_next)
+                ++s.free_blocks;
+        s.largest_free = largest_free();
+        return s;
+    }
+
+private:
+    static constexpr int NIL = -1;
+
+    struct node
+    {
+        size_t offset;
+        size_t size;
+        int    prev, next; // neighbours in offset order
+        int    free_prev, free_next; // neighbours in the free list of the size class
+        bool   free;
+    };
+
+    std::vector<node> m_nodes;
+    std::vector<int>  m_unused; // ids of recycled nodes
+    int               m_classes[NUM_CLASSES]; // heads of the free lists
+    size_t            m_capacity    = 0;
+    size_t            m_in_use      = 0;
+    size_t            m_peak_in_use = 0;
+    size_t            m_allocated   = 0;
+
+    static int size_class(size_t size)
+    {
+        int c = 0;
+        while(size >>= 1)
+            ++c;
+        return c;
+    }
+
+    int new_node(size_t offset, size_t size, int prev, int next)
+    {
+        node n{offset, size, prev, next, NIL, NIL, false};
+        if(m_unused.empty())
+        {
+            m_nodes.push_back(n);
+            return int(m_nodes.size() - 1);
+        }
+        int id = m_unused.back();
+        m_unused.pop_back();
+        m_nodes[id] = n;
+        return id;
+    }
+
+    void insert_free(int id)
+    {
+        node& n     = m_nodes[id];
+        int&  head  = m_classes[size_class(n.size)];
+        n.free      = true;
+        n.free_prev = NIL;
+        n.free_next = head;
+        if(head != NIL)
+            m_nodes[head].free_prev = id;
+        head = id;
+    }
+
+    void remove_free(int id)
+    {
+        node& n = m_nodes[id];
+        if(n.free_prev != NIL)
+            m_nodes[n.free_prev].free_next = n.free_next;
+        else
+            m_classes[size_class(n.size)] = n.free_next;
+        if(n.free_next != NIL)
+            m_nodes[n.free_next].free_prev = n.free_prev;
+        n.free = false;
+    }
+
+    // Merge block b into the block a which precedes it, and recycle b's node
+    void merge_into(int a, int b)
+    {
+        m_nodes[a].size += m_nodes[b].size;
+        m_nodes[a].next = m_nodes[b].next;
+        if(m_nodes[b].next != NIL)
+            m_nodes[m_nodes[b].next].prev = a;
+        m_unused.push_back(b);
+    }
+};
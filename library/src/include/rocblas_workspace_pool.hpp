@@ -0,0 +1,246 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*****************************************************************************
+ * rocblas_workspace_pool holds workspace memory of one device which handles *
+ * in shared workspace mode lease while they use it, instead of each handle  *
+ * keeping its own. A lease is exclusive until it is released, so concurrent *
+ * handles never alias memory.                                               *
+ *                                                                           *
+ * Work enqueued on the leasing stream may still use the memory after it is  *
+ * released, so each slab remembers the stream which owned it last, and an   *
+ * event recorded there on release. A lease on the same stream reuses the    *
+ * slab directly, by stream order; a lease on another stream first makes     *
+ * that stream wait for the event, without blocking the host. Slabs owned by *
+ * the leasing stream are preferred, then the smallest slab which fits.      *
+ * New slabs are rounded up to a power of two, so that a growing workload    *
+ * replaces slabs only a logarithmic number of times.                        *
+ *                                                                           *
+ * Slabs are allocated with the allocator of the lease which needed them,    *
+ * e.g. the device memory functions of a handle, are only leased again with  *
+ * an equal allocator, and are freed with it. A slab replaced or trimmed for *
+ * a stream is freed on that stream, after it waits for the slab's event.    *
+ *                                                                           *
+ * Device operations go through BACKEND, so that the pool can be tested      *
+ * without a GPU. BACKEND provides the types stream_t, event_t and the       *
+ * equality comparable allocator_t, whose default is the device's default    *
+ * allocator, and:                                                           *
+ *   bool alloc(void** ptr, size_t size, const allocator_t&, stream_t)       *
+ *   void free(void* ptr, size_t size, const allocator_t&, stream_t)         *
+ *   event_t create_event()                   void destroy_event(event_t)    *
+ *   void record(event_t, stream_t)           void wait(stream_t, event_t)   *
+ *****************************************************************************/
+template <typename BACKEND>
+class rocblas_workspace_pool
+{
+public:
+    static constexpr size_t MIN_SLAB_SIZE = 64 * 1024;
+
+    using stream_t    = typename BACKEND::stream_t;
+    using event_t     = typename BACKEND::event_t;
+    using allocator_t = typename BACKEND::allocator_t;
+
+    struct lease_t
+    {
+        int    slab = -1; // -1 if the lease failed
+        void*  ptr  = nullptr;
+        size_t size = 0;
+    };
+
+    struct stats_t
+    {
+        size_t pool_bytes        = 0; // bytes of device memory held by the pool
+        size_t leased_bytes      = 0; // bytes currently leased
+        size_t peak_leased_bytes = 0; // high-water mark of leased_bytes
+        size_t leases            = 0; // successful leases
+        size_t contentions       = 0; // leases and releases which waited for another thread
+        size_t stream_waits      = 0; // leases which waited for work on another stream
+    };
+
+    explicit rocblas_workspace_pool(BACKEND backend = BACKEND())
+        : m_backend(std::move(backend))
+    {
+    }
+
+    rocblas_workspace_pool(const rocblas_workspace_pool&) = delete;
+    rocblas_workspace_pool& operator=(const rocblas_workspace_pool&) = delete;
+
+    ~rocblas_workspace_pool()
+    {
+        for(auto& s : m_slabs)
+            if(s.ptr)
+            {
+                m_backend.destroy_event(s.event);
+                m_backend.free(s.ptr, s.size, s.allocator, s.owner);
+            }
+    }
+
+    /*************************************************************************
+     * Lease a slab of at least size bytes for use on stream, among the      *
+     * slabs of allocator. If no free slab fits, the largest free slab is    *
+     * replaced by a new slab, or a new slab is added if every slab is       *
+     * leased. Returns a lease with slab -1 if the new slab cannot be        *
+     * allocated.                                                            *
+     *************************************************************************/
+    lease_t lease(size_t size, stream_t stream, const allocator_t& allocator = allocator_t())
+    {
+        auto lock = acquire();
+
+        int best = -1, smallest = -1, largest = -1;
+        for(int i = 0; i < int(m_slabs.size()); ++i)
+        {
+            const slab_s& s = m_slabs[i];
+            if(!s.ptr || s.leased || !(s.allocator == allocator))
+                continue;
+            if(largest < 0 || s.size > m_slabs[largest].size)
+                largest = i;
+            if(s.size < size)
+                continue;
+            if(s.owner == stream && (best < 0 || s.size < m_slabs[best].size))
+                best = i;
+            if(smallest < 0 || s.size < m_slabs[smallest].size)
+                smallest = i;
+        }
+
+        lease_t lease;
+        int     i = best >= 0 ? best : smallest;
+        if(i >= 0)
+        {
+            slab_s& s = m_slabs[i];
+            if(s.owner != stream)
+            {
+                m_backend.wait(stream, s.event);
+                ++m_stats.stream_waits;
+            }
+        }
+        else
+        {
+            // Replace the largest free slab, which is too small, rather than adding to it
+            if(largest >= 0)
+                remove(largest, stream);
+            size = slab_size(size);
+            void* ptr;
+            if(!m_backend.alloc(&ptr, size, allocator, stream))
+                return lease;
+            i = largest >= 0 ? largest : add_slot();
+            m_slabs[i].ptr       = ptr;
+            m_slabs[i].size      = size;
+            m_slabs[i].allocator = allocator;
+            m_slabs[i].event     = m_backend.create_event();
+            m_stats.pool_bytes += size;
+        }
+
+        slab_s& s = m_slabs[i];
+        s.leased  = true;
+        s.owner   = stream;
+        m_stats.leased_bytes += s.size;
+        if(m_stats.leased_bytes > m_stats.peak_leased_bytes)
+            m_stats.peak_leased_bytes = m_stats.leased_bytes;
+        ++m_stats.leases;
+
+        lease.slab = i;
+        lease.ptr  = s.ptr;
+        lease.size = s.size;
+        return lease;
+    }
+
+    // Release a lease, after all work using it has been enqueued on stream
+    void release(const lease_t& lease, stream_t stream)
+    {
+        auto    lock = acquire();
+        slab_s& s    = m_slabs[lease.slab];
+        m_backend.record(s.event, stream);
+        s.owner  = stream;
+        s.leased = false;
+        m_stats.leased_bytes -= s.size;
+    }
+
+    // Free the slabs which are not leased, each on the stream which owned it last
+    void trim()
+    {
+        auto lock = acquire();
+        for(int i = 0; i < int(m_slabs.size()); ++i)
+            if(m_slabs[i].ptr && !m_slabs[i].leased)
+                remove(i, m_slabs[i].owner);
+    }
+
+    // Free the slabs of allocator which are not leased on stream, e.g. before allocator goes away
+    void trim(const allocator_t& allocator, stream_t stream)
+    {
+        auto lock = acquire();
+        for(int i = 0; i < int(m_slabs.size()); ++i)
+            if(m_slabs[i].ptr && !m_slabs[i].leased && m_slabs[i].allocator == allocator)
+                remove(i, stream);
+    }
+
+    stats_t stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct slab_s
+    {
+        void*       ptr    = nullptr; // nullptr if the slot is unused
+        size_t      size   = 0;
+        bool        leased = false;
+        stream_t    owner{};
+        event_t     event{};
+        allocator_t allocator{};
+    };
+
+    BACKEND             m_backend;
+    mutable std::mutex  m_mutex;
+    std::vector<slab_s> m_slabs;
+    stats_t             m_stats;
+
+    // Lock the pool, counting whether another thread held it
+    std::unique_lock<std::mutex> acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if(!lock.owns_lock())
+        {
+            lock.lock();
+            ++m_stats.contentions;
+        }
+        return lock;
+    }
+
+    static size_t slab_size(size_t size)
+    {
+        size_t slab = MIN_SLAB_SIZE;
+        while(slab < size)
+            slab *= 2;
+        return slab;
+    }
+
+    int add_slot()
+    {
+        for(int i = 0; i < int(m_slabs.size()); ++i)
+            if(!m_slabs[i].ptr)
+                return i;
+        m_slabs.emplace_back();
+        return int(m_slabs.size() - 1);
+    }
+
+    // Free a slab, which must not be leased, on stream, leaving its slot unused
+    void remove(int i, stream_t stream)
+    {
+        slab_s& s = m_slabs[i];
+        if(s.owner != stream)
+            m_backend.wait(stream, s.event);
+        m_backend.destroy_event(s.event);
+        m_backend.free(s.ptr, s.size, s.allocator, stream);
+        m_stats.pool_bytes -= s.size;
+        s = slab_s();
+    }
+};
@@ -0,0 +1,167 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+ * A workspace profile records the peak device memory workspace needed by    *
+ * each rocBLAS function, so that a handle can be created with a workspace   *
+ * large enough that it never has to be reallocated. It is a text file with  *
+ * one line per function, giving the peak bytes in use when the function     *
+ * requested workspace:                                                      *
+ *                                                                           *
+ *   # rocBLAS workspace profile v1                                          *
+ *   rocblas_internal_trsm_template_mem 25165824                             *
+ *                                                                           *
+ * Functions are the internal functions which request workspace. The bytes   *
+ * are the last field, and a name may contain spaces. Blank lines and lines  *
+ * starting with # are ignored.                                              *
+ *****************************************************************************/
+constexpr char ROCBLAS_WORKSPACE_PROFILE_HEADER[] = "# rocBLAS workspace profile v1";
+
+class rocblas_workspace_profile
+{
+public:
+    struct entry_t
+    {
+        std::string name;
+        size_t      peak_bytes;
+        const char* key; // string literal of the name, for comparison by address, or nullptr
+    };
+
+    /*************************************************************************
+     * Record that function needed bytes of workspace. Returns whether this  *
+     * is a new peak for the function. function must be a string literal,    *
+     * such as __func__, so that it can be compared by address, and a        *
+     * function seen before is recorded without allocating memory.           *
+     *************************************************************************/
+    bool record(const char* function, size_t bytes)
+    {
+        return update(function, bytes, function);
+    }
+
+    // Record the peaks of another profile
+    void merge(const rocblas_workspace_profile& other)
+    {
+        for(auto& e : other.m_entries)
+            update(e.name.c_str(), e.peak_bytes, nullptr);
+    }
+
+    const std::vector<entry_t>& entries() const
+    {
+        return m_entries;
+    }
+
+    // The largest peak of any function, which is the workspace size that avoids reallocation
+    size_t peak_bytes() const
+    {
+        size_t peak = 0;
+        for(auto& e : m_entries)
+            if(e.peak_bytes > peak)
+                peak = e.peak_bytes;
+        return peak;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+    }
+
+    /*************************************************************************
+     * Read the profile at path, merging it with the recorded peaks. Returns *
+     * false and describes the first error in error if the file cannot be    *
+     * read or is malformed, leaving the recorded peaks unchanged.           *
+     *************************************************************************/
+    bool read(const char* path, std::string& error)
+    {
+        std::ifstream in(path);
+        std::string   line;
+        if(!std::getline(in, line) || line != ROCBLAS_WORKSPACE_PROFILE_HEADER)
+        {
+            error = std::string(path) + ": missing header \"" + ROCBLAS_WORKSPACE_PROFILE_HEADER
+                    + "\"";
+            return false;
+        }
+
+        rocblas_workspace_profile profile;
+        for(int line_number = 2; std::getline(in, line); ++line_number)
+        {
+            size_t start = line.find_first_not_of(" \t\r");
+            if(start == std::string::npos || line[start] == '#')
+                continue;
+
+            // The number of bytes is the last field, and the name may contain spaces
+            size_t end   = line.find_last_not_of(" \t\r") + 1;
+            size_t space = line.find_last_of(" \t", end - 1);
+            size_t name_end
+                = space == std::string::npos ? space : line.find_last_not_of(" \t", space);
+            std::string bytes = space == std::string::npos || name_end < start
+                                    ? std::string()
+                                    : line.substr(space + 1, end - space - 1);
+            if(bytes.empty() || bytes.find_first_not_of("0123456789") != std::string::npos)
+            {
+                error = std::string(path) + ":" + std::to_string(line_number)
+                        + ": expected a function name and a number of bytes";
+                return false;
+            }
+            std::string name = line.substr(start, name_end + 1 - start);
+            profile.update(name.c_str(), strtoull(bytes.c_str(), nullptr, 10), nullptr);
+        }
+
+        merge(profile);
+        return true;
+    }
+
+    // Write the profile to path, with the functions in the order they were first recorded
+    bool write(const char* path) const
+    {
+        FILE* f = fopen(path, "w");
+        if(!f)
+            return false;
+        fprintf(f, "%s\n", ROCBLAS_WORKSPACE_PROFILE_HEADER);
+        for(auto& e : m_entries)
+            fprintf(f, "%s %zu\n", e.name.c_str(), e.peak_bytes);
+        return fclose(f) == 0;
+    }
+
+private:
+    std::vector<entry_t> m_entries;
+
+    // Record a peak of the function named name, whose string literal is key, or nullptr
+    bool update(const char* name, size_t bytes, const char* key)
+    {
+        entry_t* e = nullptr;
+        for(auto& x : m_entries)
+            if(key && x.key == key)
+            {
+                e = &x;
+                break;
+            }
+        if(!e)
+            for(auto& x : m_entries)
+                if(x.name == name)
+                {
+                    e = &x;
+                    if(key)
+                        e->key = key;
+                    break;
+                }
+
+        if(!e)
+        {
+            m_entries.push_back({name, bytes, key});
+            return true;
+        }
+        if(bytes <= e->peak_bytes)
+            return false;
+        e->peak_bytes = bytes;
+        return true;
+    }
+};
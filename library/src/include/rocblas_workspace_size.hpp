@@ -0,0 +1,347 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#pragma once
+
+#include "rocblas-types.h"
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+
+/*****************************************************************************
+ * Sizes of the device memory workspace requested by rocBLAS functions. They *
+ * depend only on the arguments and on the sizes of the data types, so they *
+ * are computed on the host, without a handle or a device, both by the       *
+ * functions themselves and by rocblas_plan_device_memory_size().            *
+ *****************************************************************************/
+
+// Round up size to the nearest MIN_CHUNK_SIZE
+constexpr size_t roundup_device_memory_size(size_t size)
+{
+    size_t MIN_CHUNK_SIZE = 64;
+    return ((size + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE) * MIN_CHUNK_SIZE;
+}
+
+// Total device memory for a request of sizes, each rounded up to MIN_CHUNK_SIZE
+inline size_t rocblas_total_device_memory_size(std::initializer_list<size_t> sizes)
+{
+    size_t total = 0;
+    for(size_t size : sizes)
+        total += roundup_device_memory_size(size);
+    return total;
+}
+
+// Block sizes which determine the workspace of the functions below
+constexpr rocblas_int ROCBLAS_REDUCTION_NB   = 512; // dot, asum, nrm2, dot_ex, nrm2_ex
+constexpr rocblas_int ROCBLAS_IAMAX_IAMIN_NB = 1024;
+constexpr rocblas_int ROCBLAS_TRSV_BLOCK     = 128;
+constexpr rocblas_int ROCBLAS_TRSM_BLOCK     = 128;
+constexpr rocblas_int ROCBLAS_TRTRI_NB       = 16;
+
+/*****************************************************************************
+ * Reductions                                                                *
+ *****************************************************************************/
+inline size_t rocblas_reduction_kernel_block_count(rocblas_int n, rocblas_int NB)
+{
+    if(n <= 0)
+        n = 1; // avoid sign loss issues
+    return size_t(n - 1) / NB + 1;
+}
+
+// Work area for reduction must be at least work_bytes * (blocks + 1) * batch_count, where
+// work_bytes is the size of the type of the partial results
+inline size_t rocblas_reduction_workspace_size(rocblas_int n,
+                                               rocblas_int batch_count,
+                                               rocblas_int NB,
+                                               size_t      work_bytes)
+{
+    if(n <= 0)
+        n = 1; // allow for return value of empty set
+    if(batch_count <= 0)
+        batch_count = 1;
+    auto blocks = rocblas_reduction_kernel_block_count(n, NB);
+    return work_bytes * (blocks + 1) * batch_count;
+}
+
+// work item number (WIN) of elements of nb bytes which dot processes per thread
+constexpr int rocblas_dot_WIN(size_t nb)
+{
+    int n = 8;
+    if(nb >= 8)
+        n = 2;
+    else if(nb >= 4)
+        n = 4;
+
+    return n;
+}
+
+/*****************************************************************************
+ * gemv: gemvt_sn is skinny n matrix optimizations                           *
+ *****************************************************************************/
+constexpr int rocblas_gemvt_sn_WIN()
+{
+    return 4;
+}
+
+constexpr int rocblas_gemvt_sn_NB()
+{
+    return 256;
+}
+
+inline size_t rocblas_gemvt_sn_kernel_block_count(rocblas_int m)
+{
+    if(m <= 0)
+        m = 1; // avoid sign loss issues
+    return size_t(m - 1) / (rocblas_gemvt_sn_NB() * rocblas_gemvt_sn_WIN()) + 1;
+}
+
+// gemvt_sn_crossover is n threshold to crossover back to normal (non-skinny) algorithm
+inline size_t rocblas_gemvt_sn_crossover(rocblas_datatype type)
+{
+    switch(type)
+    {
+    case rocblas_datatype_f64_r:
+        return 128;
+    case rocblas_datatype_f32_c:
+        return 64;
+    case rocblas_datatype_f64_c:
+        return 16;
+    default:
+        return 256;
+    }
+}
+
+inline bool rocblas_gemvt_skinny_n(rocblas_datatype  type,
+                                   rocblas_operation transA,
+                                   rocblas_int       m,
+                                   rocblas_int       n)
+{
+    size_t    cross_over_n    = rocblas_gemvt_sn_crossover(type);
+    const int skinny_constant = 2048;
+    return transA != rocblas_operation_none && size_t(n) < cross_over_n
+           && m >= skinny_constant * n;
+}
+
+// Only transpose/conj skinny n matrices use workspace memory, so usually returns 0
+// Work buffer for column reductions: number of blocks * cols * batch_count
+inline size_t rocblas_gemv_kernel_workspace_size(rocblas_datatype  type,
+                                                 size_t            type_bytes,
+                                                 rocblas_operation transA,
+                                                 rocblas_int       m,
+                                                 rocblas_int       n,
+                                                 rocblas_int       batch_count)
+{
+    if(m <= 0 || n <= 0 || batch_count <= 0)
+        return 0;
+
+    if(!rocblas_gemvt_skinny_n(type, transA, m, n))
+        return 0; // workspace only used for skinny n kernel transpose/conj. transpose
+
+    auto blocks = rocblas_gemvt_sn_kernel_block_count(m);
+    return type_bytes * blocks * n * batch_count;
+}
+
+/*****************************************************************************
+ * gemm_ex computing f16 or bf16 matrices in f32 (HPA) may split the sum     *
+ * over k (GSU), accumulating partial sums of D in f32 in workspace. The     *
+ * workspace depends on the Tensile solution selected on the device, and is  *
+ * at most ROCBLAS_HPA_GSU_BYTES_PER_ELEMENT per element of D, the largest   *
+ * WorkspaceSizePerElemC of the HPA solutions: 4 bytes for each of up to 120 *
+ * buffers of partial sums. It is allocated in multiples of 256 bytes.       *
+ *****************************************************************************/
+constexpr size_t ROCBLAS_HPA_GSU_BYTES_PER_ELEMENT = 480;
+constexpr size_t ROCBLAS_HPA_GSU_GRANULARITY       = 256;
+
+inline size_t rocblas_gemm_ex_hpa_workspace_bound(rocblas_int m,
+                                                  rocblas_int n,
+                                                  rocblas_int batch_count)
+{
+    if(m <= 0 || n <= 0 || batch_count <= 0)
+        return 0;
+    size_t bytes = size_t(m) * n * batch_count * ROCBLAS_HPA_GSU_BYTES_PER_ELEMENT;
+    return (bytes + ROCBLAS_HPA_GSU_GRANULARITY - 1) / ROCBLAS_HPA_GSU_GRANULARITY
+           * ROCBLAS_HPA_GSU_GRANULARITY;
+}
+
+/*****************************************************************************
+ * trtri: elements of the temporary matrices used to invert the parts of A   *
+ * which are not a power of 2 multiple of 2 * NB                             *
+ *****************************************************************************/
+inline size_t rocblas_trtri_temp_elements(rocblas_int NB, rocblas_int n, rocblas_int batch_count)
+{
+    auto is_po2       = [](rocblas_int x) { return x && !(x & (x - 1)); };
+    auto previous_po2 = [](rocblas_int x) {
+        return x ? rocblas_int(1) << (8 * sizeof(x) - 1 - __builtin_clz(x)) : 0;
+    };
+
+    rocblas_int IB   = NB * 2;
+    size_t      size = 0;
+    if(n > IB && batch_count > 0)
+    {
+        rocblas_int current_n = IB;
+        while(current_n * 2 <= n)
+            current_n *= 2;
+        rocblas_int remainder = (n / IB) * IB - current_n;
+        if(!is_po2(remainder))
+            remainder = previous_po2(remainder);
+        rocblas_int oddRemainder = n - current_n - remainder;
+
+        size_t sizeRemainder = remainder ? remainder * current_n : 0;
+        size_t sizeOdd       = 0;
+
+        while(oddRemainder)
+        {
+            current_n         = n - oddRemainder;
+            size_t curSizeOdd = oddRemainder * (n - oddRemainder);
+            sizeOdd           = sizeOdd > curSizeOdd ? sizeOdd : curSizeOdd;
+
+            if(!is_po2(oddRemainder) && oddRemainder > IB)
+            {
+                oddRemainder = previous_po2(oddRemainder);
+                oddRemainder = n - current_n - oddRemainder;
+            }
+            else
+            {
+                oddRemainder = 0;
+            }
+        }
+
+        if(sizeRemainder || sizeOdd)
+            size = (sizeRemainder > sizeOdd ? sizeRemainder : sizeOdd) * batch_count;
+    }
+    return size;
+}
+
+/*****************************************************************************
+ * trsv and trsm: the temporary solution X and the temporary C of trtri      *
+ * share space, and invA holds the inverted diagonal blocks of A, unless the *
+ * caller supplies it. The batched functions also need arrays of pointers.   *
+ *****************************************************************************/
+struct rocblas_triangular_solve_workspace
+{
+    size_t x_c_temp_bytes = 0;
+    size_t xarr_bytes     = 0;
+    size_t invA_bytes     = 0;
+    size_t arr_bytes      = 0;
+
+    size_t total() const
+    {
+        return rocblas_total_device_memory_size(
+            {x_c_temp_bytes, xarr_bytes, invA_bytes, arr_bytes});
+    }
+};
+
+template <rocblas_int BLOCK, bool BATCHED>
+rocblas_triangular_solve_workspace rocblas_trsv_workspace_size(size_t      type_bytes,
+                                                               rocblas_int m,
+                                                               rocblas_int batch_count,
+                                                               bool        invA_supplied)
+{
+    // Whether size is an exact multiple of blocksize
+    const bool exact_blocks = (m % BLOCK) == 0;
+
+    rocblas_triangular_solve_workspace w;
+    size_t                             c_temp_bytes = 0;
+
+    if(!invA_supplied)
+    {
+        w.invA_bytes = type_bytes * BLOCK * m * batch_count;
+
+        // When m < BLOCK, C is unnecessary for trtri
+        c_temp_bytes = (m / BLOCK) * (type_bytes * (BLOCK / 2) * (BLOCK / 2)) * batch_count;
+
+        // For the TRTRI last diagonal block we need remainder space if m % BLOCK != 0
+        if(!exact_blocks)
+        {
+            // TODO: Make this more accurate -- right now it's much larger than necessary
+            size_t remainder_bytes = type_bytes * ROCBLAS_TRTRI_NB * BLOCK * 2 * batch_count;
+
+            // C is the maximum of the temporary space needed for TRTRI
+            c_temp_bytes = std::max(c_temp_bytes, remainder_bytes);
+        }
+    }
+
+    // Temporary solution vector
+    // If the special solver can be used, then only BLOCK words are needed instead of m words
+    size_t x_temp_bytes
+        = exact_blocks ? type_bytes * BLOCK * batch_count : type_bytes * m * batch_count;
+
+    // X and C temporaries can share space, so the maximum size is allocated
+    w.x_c_temp_bytes = std::max(x_temp_bytes, c_temp_bytes);
+    w.arr_bytes      = BATCHED ? sizeof(void*) * batch_count : 0;
+    w.xarr_bytes     = BATCHED ? sizeof(void*) * batch_count : 0;
+    return w;
+}
+
+// Small trsm problems are solved by substitution, without workspace
+constexpr bool rocblas_trsm_is_small(rocblas_int m, rocblas_int n)
+{
+    return m <= 64 && n <= 64;
+}
+
+/*****************************************************************************
+ * Workspace of trsm, which is not used by small problems. If chunked, it is *
+ * the smaller workspace needed to solve an exact multiple of BLOCK one      *
+ * column of B at a time, which is the fallback when the optimal workspace   *
+ * cannot be allocated.                                                      *
+ *****************************************************************************/
+template <rocblas_int BLOCK, bool BATCHED>
+rocblas_triangular_solve_workspace rocblas_trsm_workspace_size(size_t       type_bytes,
+                                                               rocblas_side side,
+                                                               rocblas_int  m,
+                                                               rocblas_int  n,
+                                                               rocblas_int  batch_count,
+                                                               bool         invA_supplied,
+                                                               bool         chunked = false)
+{
+    rocblas_int k = side == rocblas_side_left ? m : n;
+
+    // Whether size is an exact multiple of blocksize
+    const bool exact_blocks = (k % BLOCK) == 0;
+
+    rocblas_triangular_solve_workspace w;
+    size_t                             c_temp_bytes = 0;
+
+    if(!invA_supplied)
+    {
+        w.invA_bytes = BLOCK * size_t(k) * type_bytes * batch_count;
+
+        // When k < BLOCK, C is unnecessary for trtri
+        size_t c_temp_els = (k / BLOCK) * ((BLOCK / 2) * (BLOCK / 2));
+
+        // For the TRTRI last diagonal block we need remainder space if k % BLOCK != 0
+        if(!exact_blocks)
+        {
+            // TODO: Make this more accurate -- right now it's much larger than necessary
+            size_t remainder_els = ROCBLAS_TRTRI_NB * BLOCK * 2;
+
+            // C is the maximum of the temporary space needed for TRTRI
+            c_temp_els = std::max(c_temp_els, remainder_els);
+        }
+        c_temp_bytes = c_temp_els * type_bytes;
+    }
+
+    // Temporary solution matrix
+    size_t x_temp_els;
+    if(exact_blocks)
+    {
+        // Optimal B_chunk_size is the orthogonal dimension to k
+        size_t B_chunk_size = chunked ? 1 : size_t(m) + size_t(n) - size_t(k);
+
+        // When k % BLOCK == 0, we only need BLOCK * B_chunk_size space
+        x_temp_els = BLOCK * B_chunk_size;
+    }
+    else
+    {
+        // When k % BLOCK != 0, we need m * n space
+        x_temp_els = size_t(m) * n;
+    }
+    size_t x_temp_bytes = x_temp_els * type_bytes * batch_count;
+
+    // X and C temporaries can share space, so the maximum size is allocated
+    w.x_c_temp_bytes = std::max(x_temp_bytes, c_temp_bytes);
+    w.arr_bytes      = BATCHED ? sizeof(void*) * batch_count : 0;
+    w.xarr_bytes     = BATCHED ? sizeof(void*) * batch_count : 0;
+    return w;
+}
@@ -8,7 +8,9 @@
 #include <cctype>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 /* ============================================================================================ */
 
@@ -102,6 +104,195 @@ catch(...)
     return exception_to_rocblas_status();
 }
 
+/*******************************************************************************
+ * ! \brief get gemm autotune mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_gemm_autotune_mode(rocblas_handle              handle,
+                                                         rocblas_gemm_autotune_mode* mode)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!mode)
+        return rocblas_status_invalid_pointer;
+    *mode = handle->gemm_autotune;
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_get_gemm_autotune_mode", *mode);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief set gemm autotune mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_set_gemm_autotune_mode(rocblas_handle             handle,
+                                                         rocblas_gemm_autotune_mode mode)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(mode != rocblas_gemm_autotune_off && mode != rocblas_gemm_autotune_on)
+        return rocblas_status_invalid_value;
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_set_gemm_autotune_mode", mode);
+
+    // Candidates are timed with the handle's start/stop events
+    if(mode == rocblas_gemm_autotune_on && (!handle->startEvent || !handle->stopEvent))
+    {
+        auto       saved_device_id = handle->push_device_id();
+        hipEvent_t start, stop;
+        if(hipEventCreate(&start) != hipSuccess)
+            return rocblas_status_internal_error;
+        if(hipEventCreate(&stop) != hipSuccess)
+        {
+            (hipEventDestroy)(start);
+            return rocblas_status_internal_error;
+        }
+        handle->destroy_start_stop_events();
+        handle->startEvent             = start;
+        handle->stopEvent              = stop;
+        handle->owns_start_stop_events = true;
+    }
+
+    // Kernels are launched with the handle's events while they are set, so the events created
+    // for autotuning are destroyed when it is turned off
+    if(mode == rocblas_gemm_autotune_off && handle->owns_start_stop_events)
+    {
+        auto saved_device_id = handle->push_device_id();
+        handle->destroy_start_stop_events();
+    }
+    handle->gemm_autotune = mode;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief set log sampling mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_set_log_sampling(rocblas_handle            handle,
+                                                   rocblas_log_sampling_mode mode,
+                                                   rocblas_int               value)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(mode != rocblas_log_sampling_off && mode != rocblas_log_sampling_every_nth
+       && mode != rocblas_log_sampling_first_k && mode != rocblas_log_sampling_rate_limit)
+        return rocblas_status_invalid_value;
+    if(mode != rocblas_log_sampling_off && value <= 0)
+        return rocblas_status_invalid_value;
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_set_log_sampling", mode, value);
+    handle->log_trace_sampler.set(mode, value);
+    handle->log_bench_sampler.set(mode, value);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief get log sampling mode
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_log_sampling(rocblas_handle             handle,
+                                                   rocblas_log_sampling_mode* mode,
+                                                   rocblas_int*               value)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!mode || !value)
+        return rocblas_status_invalid_pointer;
+    *mode  = handle->log_trace_sampler.get_mode();
+    *value = handle->log_trace_sampler.get_value();
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_get_log_sampling", *mode, *value);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief set check_numerics sampling
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_set_check_numerics_sampling(rocblas_handle handle,
+                                                              rocblas_int    every,
+                                                              rocblas_int    stride)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(every <= 0 || stride <= 0)
+        return rocblas_status_invalid_value;
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_set_check_numerics_sampling", every, stride);
+    handle->check_numerics_sampler.set(every, stride);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief get check_numerics sampling
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_check_numerics_sampling(rocblas_handle handle,
+                                                              rocblas_int*   every,
+                                                              rocblas_int*   stride)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!every || !stride)
+        return rocblas_status_invalid_pointer;
+    *every  = handle->check_numerics_sampler.get_every();
+    *stride = handle->check_numerics_sampler.get_stride();
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_get_check_numerics_sampling", *every, *stride);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * ! \brief get the counts of the calls checked by check_numerics
+ ******************************************************************************/
+extern "C" rocblas_status
+    rocblas_get_check_numerics_sampling_stats(rocblas_handle                         handle,
+                                              rocblas_check_numerics_sampling_stats* stats)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(!stats)
+        return rocblas_status_invalid_pointer;
+    *stats = handle->check_numerics_sampler.stats();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
 /*******************************************************************************
  * ! \brief query the preferable supported int8 input layout for gemm by device
  ******************************************************************************/
@@ -156,9 +347,230 @@ try
         return rocblas_status_invalid_handle;
     if(handle->layer_mode & rocblas_layer_mode_log_trace)
         log_trace(handle, "rocblas_destroy_handle");
+
+    // The checks of asynchronous check_numerics mode which are not read yet are reported
+    // before the ring holding them is freed; the handle is destroyed even if they cannot be
+    bool records_read = !handle->check_numerics_records || handle->check_numerics_records->read();
+
     // call destructor
     delete handle;
 
+    return records_read ? rocblas_status_success : rocblas_status_internal_error;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * idle handles of each device, kept initialized for rocblas_acquire_handle. The
+ * pools are intentionally never destroyed, so that handles can be released
+ * during static destruction.
+ ******************************************************************************/
+struct rocblas_handle_pool
+{
+    std::mutex                  mutex;
+    std::vector<rocblas_handle> idle;
+    size_t                      created = 0;
+    size_t                      reused  = 0;
+};
+
+static rocblas_handle_pool* handle_pool(int device)
+{
+    static auto* pools = [] {
+        int count = 0;
+        if(hipGetDeviceCount(&count) != hipSuccess)
+            count = 0;
+        return new std::vector<rocblas_handle_pool>(count);
+    }();
+    return device >= 0 && size_t(device) < pools->size() ? &(*pools)[device] : nullptr;
+}
+
+/*******************************************************************************
+ *! \brief acquire a handle for the current device from the handle pool, or
+ * create one if none is idle, and bind it to stream
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_acquire_handle(rocblas_handle* handle, hipStream_t stream)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+
+    int device;
+    if(hipGetDevice(&device) != hipSuccess)
+        return rocblas_status_internal_error;
+    auto* pool = handle_pool(device);
+    if(!pool)
+        return rocblas_status_internal_error;
+
+    // The stream must be valid
+    if(stream != 0 && hipStreamQuery(stream) == hipErrorInvalidResourceHandle)
+        return rocblas_status_invalid_value;
+
+    rocblas_handle h = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if(!pool->idle.empty())
+        {
+            h = pool->idle.back();
+            pool->idle.pop_back();
+            ++pool->reused;
+        }
+    }
+
+    if(!h)
+    {
+        h = new _rocblas_handle;
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        ++pool->created;
+    }
+    else if(h->pool_release_event && h->stream != stream)
+    {
+        // Work enqueued on the stream of the last user may still be using the workspace
+        if(hipStreamWaitEvent(stream, h->pool_release_event, 0) != hipSuccess)
+            hipEventSynchronize(h->pool_release_event);
+    }
+
+    h->stream = stream;
+    *handle   = h;
+
+    if(h->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(h, "rocblas_acquire_handle", stream);
+
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ *! \brief return a handle to the handle pool, restoring its default settings.
+ * Its workspace is kept for the next user.
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_release_handle(rocblas_handle handle)
+try
+{
+    // if handle not valid
+    if(!handle)
+        return rocblas_status_invalid_handle;
+    if(handle->layer_mode & rocblas_layer_mode_log_trace)
+        log_trace(handle, "rocblas_release_handle");
+
+    // A handle cannot be released while a device_malloc object is using its memory
+    if(handle->workspace.in_use())
+        return rocblas_status_internal_error;
+
+    // The checks of asynchronous check_numerics mode which are not read yet are reported to
+    // the user releasing the handle, and its aggregates are not passed on to the next user
+    if(handle->check_numerics_records)
+    {
+        if(!handle->check_numerics_records->read())
+            return rocblas_status_internal_error;
+        handle->check_numerics_records->clear();
+    }
+
+    // A handle whose device memory was reconfigured is destroyed, so that every acquired
+    // handle has the default device memory setup
+    auto* pool = handle_pool(handle->getDevice());
+    if(!pool || handle->device_memory_reconfigured)
+    {
+        delete handle;
+        return rocblas_status_success;
+    }
+
+    // Restore the settings of a new handle
+    handle->pointer_mode             = rocblas_pointer_mode_host;
+    handle->atomics_mode             = rocblas_atomics_allowed;
+    handle->gemm_autotune            = rocblas_gemm_autotune_off;
+    handle->performance_metric       = rocblas_default_performance_metric;
+    handle->solution_fitness_query   = nullptr;
+    handle->device_memory_size_query = false;
+    handle->init_log_sampling();
+    handle->init_check_numerics_sampling();
+    if(handle->owns_start_stop_events)
+    {
+        auto saved_device_id = handle->push_device_id();
+        handle->destroy_start_stop_events();
+    }
+    handle->startEvent = nullptr;
+    handle->stopEvent  = nullptr;
+
+    // Record when the work enqueued so far is done with the workspace, so that the next user
+    // on another stream can wait for it
+    if(handle->device_memory)
+    {
+        auto saved_device_id = handle->push_device_id();
+        if(!handle->pool_release_event
+           && hipEventCreateWithFlags(&handle->pool_release_event, hipEventDisableTiming)
+                  != hipSuccess)
+        {
+            handle->pool_release_event = nullptr;
+            delete handle;
+            return rocblas_status_success;
+        }
+        THROW_IF_HIP_ERROR(hipEventRecord(handle->pool_release_event, handle->stream));
+    }
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->idle.push_back(handle);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ *! \brief destroy the idle handles in the handle pool of a device
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_trim_handle_pool(int device)
+try
+{
+    auto* pool = handle_pool(device);
+    if(!pool)
+        return rocblas_status_invalid_value;
+
+    std::vector<rocblas_handle> idle;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        idle.swap(pool->idle);
+    }
+
+    // Temporarily change the thread's default device ID to the device
+    int saved_device;
+    THROW_IF_HIP_ERROR(hipGetDevice(&saved_device));
+    if(saved_device != device)
+        THROW_IF_HIP_ERROR(hipSetDevice(device));
+    for(auto h : idle)
+        delete h;
+    if(saved_device != device)
+        THROW_IF_HIP_ERROR(hipSetDevice(saved_device));
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ *! \brief get statistics of the handle pool of a device
+ ******************************************************************************/
+extern "C" rocblas_status
+    rocblas_get_handle_pool_stats(int device, size_t* idle, size_t* created, size_t* reused)
+try
+{
+    auto* pool = handle_pool(device);
+    if(!pool)
+        return rocblas_status_invalid_value;
+    if(!idle || !created || !reused)
+        return rocblas_status_invalid_pointer;
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    *idle    = pool->idle.size();
+    *created = pool->created;
+    *reused  = pool->reused;
     return rocblas_status_success;
 }
 catch(...)
@@ -1065,6 +1477,7 @@ extern "C" rocblas_status rocblas_set_start_stop_events(rocblas_handle handle,
 {
     if(!handle)
         return rocblas_status_invalid_handle;
+    handle->destroy_start_stop_events();
     handle->startEvent = startEvent;
     handle->stopEvent  = stopEvent;
     return rocblas_status_success;
@@ -1111,6 +1524,12 @@ std::string rocblas_internal_get_arch_name()
 {
     int deviceId;
     hipGetDevice(&deviceId);
+    return rocblas_internal_get_arch_name(deviceId);
+}
+
+// exported. Get architecture name of a device
+std::string rocblas_internal_get_arch_name(int deviceId)
+{
     hipDeviceProp_t deviceProperties;
     hipGetDeviceProperties(&deviceProperties, deviceId);
     return ArchName<hipDeviceProp_t>{}(deviceProperties);
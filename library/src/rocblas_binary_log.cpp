@@ -0,0 +1,198 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_binary_log.hpp"
+#include "rocblas_ostream.hpp"
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <unistd.h>
+
+namespace
+{
+    /*************************************************************************
+     * The writer owns the log file and the rings of all threads which have *
+     * logged. Its thread drains the rings into the file, polling less often *
+     * while they are empty, so that threads which log never wait for it.   *
+     *************************************************************************/
+    class binary_log_writer
+    {
+        // The mutex is held by whichever thread drains the rings, and to register a ring
+        std::mutex                                            mutex;
+        std::condition_variable                               cond;
+        std::vector<std::shared_ptr<rocblas_binary_log_ring>> rings;
+        uint32_t                                              next_thread = 0;
+        int                                                   fd          = -1;
+        bool                                                  stop        = false;
+        std::thread                                           thread;
+
+        // Write all of a buffer, returning false on error
+        bool write_all(const char* p, size_t n)
+        {
+            while(n)
+            {
+                ssize_t written = write(fd, p, n);
+                if(written < 0)
+                {
+                    if(errno == EINTR)
+                        continue;
+                    return false;
+                }
+                p += written;
+                n -= written;
+            }
+            return true;
+        }
+
+        // Drain all of the rings into the file, with the mutex held. Returns whether anything
+        // was written. Rings of threads which have exited are removed once they are empty.
+        bool drain_locked()
+        {
+            bool wrote = false;
+            for(auto it = rings.begin(); it != rings.end();)
+            {
+                auto& ring    = **it;
+                bool  retired = ring.retired.load(std::memory_order_acquire);
+                ring.drain([&](const char* p, size_t n) {
+                    uint32_t chunk[2] = {ring.thread(), uint32_t(n)};
+                    if(fd >= 0
+                       && !(write_all((const char*)chunk, sizeof(chunk)) && write_all(p, n)))
+                    {
+                        rocblas_cerr << "Error writing binary log file: " << strerror(errno)
+                                     << std::endl;
+                        close(fd);
+                        fd = -1;
+                    }
+                    wrote = true;
+                });
+                it = retired ? rings.erase(it) : it + 1;
+            }
+            return wrote;
+        }
+
+        void thread_function()
+        {
+            // The polling interval doubles while nothing is written, up to the maximum
+            const std::chrono::microseconds min_interval(100), max_interval(10000);
+            std::chrono::microseconds       interval = min_interval;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while(!stop)
+            {
+                interval = drain_locked() ? min_interval : std::min(interval * 2, max_interval);
+                cond.wait_for(lock, interval);
+            }
+            drain_locked();
+        }
+
+    public:
+        // Whether a log file was opened, which rocblas_abort reads without the mutex
+        std::atomic<bool> started{false};
+
+        bool start(const char* path)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(thread.joinable())
+                return true;
+
+            fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if(fd < 0)
+            {
+                rocblas_cerr << "Cannot open binary log file " << path << ": " << strerror(errno)
+                             << std::endl;
+                return false;
+            }
+
+            char header[16];
+            memcpy(header, ROCBLAS_BINARY_LOG_MAGIC, 8);
+            uint32_t version[2] = {ROCBLAS_BINARY_LOG_VERSION, 0};
+            memcpy(header + 8, version, 8);
+            if(!write_all(header, sizeof(header)))
+            {
+                rocblas_cerr << "Cannot write binary log file " << path << ": " << strerror(errno)
+                             << std::endl;
+                close(fd);
+                fd = -1;
+                return false;
+            }
+
+            thread = std::thread([this] { thread_function(); });
+            started.store(true, std::memory_order_release);
+            at_quick_exit([] { rocblas_binary_log::flush(); });
+            return true;
+        }
+
+        std::shared_ptr<rocblas_binary_log_ring> add_ring()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto ring = std::make_shared<rocblas_binary_log_ring>(next_thread++);
+            rings.push_back(ring);
+            return ring;
+        }
+
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            drain_locked();
+        }
+
+        // Stop the writer thread at exit, after it has drained the rings
+        ~binary_log_writer()
+        {
+            if(thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stop = true;
+                    cond.notify_one();
+                }
+                thread.join();
+            }
+            if(fd >= 0)
+                close(fd);
+        }
+    };
+
+    // Implemented as singleton to avoid the static initialization order fiasco
+    binary_log_writer& writer()
+    {
+        static binary_log_writer writer;
+        return writer;
+    }
+
+    // Holds the ring of a thread, and retires it when the thread exits
+    struct ring_holder
+    {
+        std::shared_ptr<rocblas_binary_log_ring> ring;
+
+        ~ring_holder()
+        {
+            if(ring)
+                ring->retired.store(true, std::memory_order_release);
+        }
+    };
+} // namespace
+
+bool rocblas_binary_log::start(const char* path)
+{
+    return writer().start(path);
+}
+
+rocblas_binary_log_ring& rocblas_binary_log::ring()
+{
+    thread_local ring_holder holder;
+    if(!holder.ring)
+        holder.ring = writer().add_ring();
+    return *holder.ring;
+}
+
+void rocblas_binary_log::flush()
+{
+    auto& w = writer();
+    if(w.started.load(std::memory_order_acquire))
+        w.flush();
+}
@@ -0,0 +1,124 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_log_device_scalars.hpp"
+#include <cstdlib>
+
+rocblas_deferred_log_scalars::rocblas_deferred_log_scalars()
+{
+    // Without pinned memory, no scalar is captured, and their addresses are logged
+    void* values = nullptr;
+    if(hipHostMalloc(&values, num_slots * slot_bytes, hipHostMallocDefault) == hipSuccess)
+        m_values = static_cast<unsigned char*>(values);
+}
+
+rocblas_deferred_log_scalars::~rocblas_deferred_log_scalars()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [&] { return !m_outstanding; });
+
+    if(m_values)
+        hipHostFree(m_values);
+}
+
+/*******************************************************************************
+ * Capture a scalar in the next free slot, with an asynchronous copy on stream
+ ******************************************************************************/
+std::string rocblas_deferred_log_scalars::capture(
+    hipStream_t stream, const void* value, size_t size, format_t format, const char* name)
+{
+    if(!m_values || size > slot_bytes)
+        return {};
+
+    for(size_t i = 0; i < num_slots; ++i)
+    {
+        size_t slot = (m_next + i) % num_slots;
+        if(m_slots[slot].busy.load(std::memory_order_acquire))
+            continue;
+
+        void* host = m_values + slot * slot_bytes;
+        if(hipMemcpyAsync(host, value, size, hipMemcpyDeviceToHost, stream) != hipSuccess)
+            return {};
+
+        m_slots[slot].format = format;
+        m_slots[slot].name   = name;
+        m_slots[slot].busy.store(true, std::memory_order_relaxed);
+        m_pending.push_back(int(slot));
+        m_next = slot + 1;
+        return delimiter + std::to_string(slot) + delimiter;
+    }
+    return {};
+}
+
+/*******************************************************************************
+ * Write the line from a host callback on stream, after the copies of its scalars
+ ******************************************************************************/
+void rocblas_deferred_log_scalars::write(hipStream_t                     stream,
+                                         const rocblas_internal_ostream& os,
+                                         std::string                     line)
+{
+    auto* deferred = new line_t{this,
+                                std::move(m_pending),
+                                std::move(line),
+                                std::make_unique<rocblas_internal_ostream>(os.dup())};
+    m_pending.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_outstanding;
+    }
+
+    // If the callback cannot be added, the line is written once the stream is idle
+    if(hipStreamAddCallback(stream, callback, deferred, 0) != hipSuccess)
+    {
+        hipStreamSynchronize(stream);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_outstanding;
+        }
+        finish(deferred);
+    }
+}
+
+void rocblas_deferred_log_scalars::callback(hipStream_t, hipError_t, void* data)
+{
+    auto* line    = static_cast<line_t*>(data);
+    auto* scalars = line->scalars;
+    scalars->finish(line);
+
+    // The handle may be destroyed as soon as the count reaches 0
+    std::lock_guard<std::mutex> lock(scalars->m_mutex);
+    if(!--scalars->m_outstanding)
+        scalars->m_cond.notify_all();
+}
+
+/*******************************************************************************
+ * Replace the placeholders of the line with the values of its scalars, write
+ * the line without waiting for it to be written, and release the scalars
+ ******************************************************************************/
+void rocblas_deferred_log_scalars::finish(line_t* line)
+{
+    const std::string& text = line->text;
+    std::string        resolved;
+    size_t             pos = 0, start;
+    while((start = text.find(delimiter, pos)) != std::string::npos)
+    {
+        size_t end = text.find(delimiter, start + 1);
+        if(end == std::string::npos)
+            break;
+        size_t slot = strtoul(text.c_str() + start + 1, nullptr, 10);
+        resolved.append(text, pos, start - pos);
+        if(slot < num_slots)
+            resolved += m_slots[slot].format(m_values + slot * slot_bytes, m_slots[slot].name);
+        pos = end + 1;
+    }
+    resolved.append(text, pos, std::string::npos);
+
+    *line->os << resolved;
+    line->os->flush_async();
+
+    for(int slot : line->slots)
+        m_slots[slot].busy.store(false, std::memory_order_release);
+    delete line;
+}
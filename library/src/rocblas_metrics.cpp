@@ -0,0 +1,327 @@
+/* ************************************************************************
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * ************************************************************************ */
+
+#include "rocblas_metrics.hpp"
+#include "rocblas-auxiliary.h"
+#include "utility.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+thread_local rocblas_metrics::thread_counters* rocblas_metrics::t_counters = nullptr;
+
+namespace
+{
+    using thread_counters = rocblas_metrics::thread_counters;
+
+    constexpr char other_function[] = "other";
+
+    // Metrics summed over threads, by function name and precision, since a function's name
+    // may be a different string in each file which calls it
+    struct metrics_snapshot
+    {
+        std::map<std::pair<std::string, int>, rocblas_function_metrics> functions;
+        size_t events[rocblas_metrics::num_events] = {};
+
+        void add(const rocblas_metrics::function_counters& c, const char* function)
+        {
+            size_t sizes[rocblas_metrics::num_size_buckets], calls = 0;
+            for(int i = 0; i < rocblas_metrics::num_size_buckets; ++i)
+                calls += sizes[i] = c.sizes[i].load(std::memory_order_relaxed);
+            if(!calls)
+                return;
+
+            int   precision = c.precision.load(std::memory_order_relaxed);
+            auto& m         = functions[{function, precision}];
+            if(!m.function)
+            {
+                m.function  = function;
+                m.precision = rocblas_datatype(precision);
+            }
+            m.calls += calls;
+            m.size_sum += c.size_sum.load(std::memory_order_relaxed);
+            for(int i = 0; i < rocblas_metrics::num_size_buckets; ++i)
+                m.size_buckets[i] += sizes[i];
+        }
+
+        void add(const thread_counters& t)
+        {
+            for(auto& c : t.functions)
+            {
+                const char* function = c.function.load(std::memory_order_acquire);
+                if(function)
+                    add(c, function);
+            }
+            add(t.other, other_function);
+            for(int e = 0; e < rocblas_metrics::num_events; ++e)
+                events[e] += t.events[e].load(std::memory_order_relaxed);
+        }
+    };
+
+    /*******************************************************************************
+     * counters of the live threads, and totals of the exited threads
+     ******************************************************************************/
+    class metrics_registry
+    {
+        std::mutex                    m_mutex;
+        std::vector<thread_counters*> m_threads;
+        metrics_snapshot              m_exited;
+
+        // Counters of the threads which count after their own counters were retired, while
+        // their thread_local objects are destroyed; they may lose counts, since they are
+        // shared, but such counts are rare
+        thread_counters m_late;
+
+    public:
+        metrics_registry()
+        {
+            m_threads.push_back(&m_late);
+        }
+
+        void add(thread_counters* counters)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threads.push_back(counters);
+        }
+
+        void retire(thread_counters* counters)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exited.add(*counters);
+            m_threads.erase(std::find(m_threads.begin(), m_threads.end(), counters));
+        }
+
+        thread_counters& late_counters()
+        {
+            return m_late;
+        }
+
+        metrics_snapshot snapshot()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            metrics_snapshot            snapshot = m_exited;
+            for(auto* counters : m_threads)
+                snapshot.add(*counters);
+            return snapshot;
+        }
+    };
+
+    bool write_metrics(const char* path);
+
+    // Writes the metrics at exit to the file named by ROCBLAS_METRICS_EXPORT, if it is set
+    class metrics_exporter
+    {
+        const char* m_path = getenv("ROCBLAS_METRICS_EXPORT");
+
+    public:
+        ~metrics_exporter()
+        {
+            // rocblas_cerr may already have been destroyed at exit
+            if(m_path && *m_path && !write_metrics(m_path))
+                fprintf(stderr, "\nrocBLAS warning: Could not write %s\n", m_path);
+        }
+    };
+
+    // The registry is never destroyed, since threads may exit after static destructors run
+    metrics_registry& registry()
+    {
+        static metrics_registry* registry = new metrics_registry;
+        static metrics_exporter  exporter;
+        return *registry;
+    }
+
+    // Registration of the counters of a thread, which retires them when the thread exits
+    class thread_registration
+    {
+        thread_counters*& m_counters;
+        bool&             m_exited;
+
+    public:
+        thread_registration(thread_counters*& counters, bool& exited)
+            : m_counters(counters)
+            , m_exited(exited)
+        {
+            auto* c = new thread_counters;
+            registry().add(c);
+            m_counters = c;
+        }
+
+        ~thread_registration()
+        {
+            thread_counters* c = m_counters;
+            m_counters         = nullptr;
+            m_exited           = true;
+            registry().retire(c);
+            delete c;
+        }
+
+        thread_registration(const thread_registration&) = delete;
+        thread_registration& operator=(const thread_registration&) = delete;
+    };
+
+    /*******************************************************************************
+     * Write the metrics in the Prometheus text format, to a temporary file which is
+     * renamed to path, so that readers never see a partial file
+     ******************************************************************************/
+    bool write_metrics(const char* path)
+    {
+        metrics_snapshot snapshot = registry().snapshot();
+        std::string      temp     = std::string(path) + ".tmp";
+        FILE*            f        = fopen(temp.c_str(), "w");
+        if(!f)
+            return false;
+
+        fputs("# HELP rocblas_calls_total Calls of each rocBLAS function and precision\n"
+              "# TYPE rocblas_calls_total counter\n",
+              f);
+        for(auto& entry : snapshot.functions)
+        {
+            auto& m = entry.second;
+            fprintf(f,
+                    "rocblas_calls_total{function=\"%s\",precision=\"%s\"} %zu\n",
+                    m.function,
+                    rocblas_datatype_string(m.precision),
+                    m.calls);
+        }
+
+        fputs("# HELP rocblas_call_size Sizes of the calls, the products of their dimensions "
+              "and batch count\n"
+              "# TYPE rocblas_call_size histogram\n",
+              f);
+        for(auto& entry : snapshot.functions)
+        {
+            auto&       m         = entry.second;
+            const char* precision = rocblas_datatype_string(m.precision);
+            size_t      count     = 0;
+            for(int i = 0; i < rocblas_metrics::num_size_buckets; ++i)
+            {
+                count += m.size_buckets[i];
+                char le[24] = "+Inf";
+                if(i < rocblas_metrics::num_size_buckets - 1)
+                    snprintf(le, sizeof(le), "%" PRIu64, uint64_t(1) << (2 * i));
+                fprintf(f,
+                        "rocblas_call_size_bucket{function=\"%s\",precision=\"%s\",le=\"%s\"} "
+                        "%zu\n",
+                        m.function,
+                        precision,
+                        le,
+                        count);
+            }
+            fprintf(f,
+                    "rocblas_call_size_sum{function=\"%s\",precision=\"%s\"} %.17g\n"
+                    "rocblas_call_size_count{function=\"%s\",precision=\"%s\"} %zu\n",
+                    m.function,
+                    precision,
+                    m.size_sum,
+                    m.function,
+                    precision,
+                    m.calls);
+        }
+
+        static constexpr const char* events[][2] = {
+            {"rocblas_workspace_reallocations_total",
+             "Reallocations of the device memory workspace of handles"},
+            {"rocblas_solutions_not_found_total",
+             "Gemm problems for which no Tensile solution was found"},
+            {"rocblas_check_numerics_failures_total",
+             "Vectors and matrices in which check_numerics found a NaN or an Inf"},
+        };
+        for(int e = 0; e < rocblas_metrics::num_events; ++e)
+            fprintf(f,
+                    "# HELP %s %s\n# TYPE %s counter\n%s %zu\n",
+                    events[e][0],
+                    events[e][1],
+                    events[e][0],
+                    events[e][0],
+                    snapshot.events[e]);
+
+        if(fclose(f) || rename(temp.c_str(), path))
+        {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+/*******************************************************************************
+ * register the counters of the calling thread when it first counts
+ ******************************************************************************/
+rocblas_metrics::thread_counters& rocblas_metrics::register_thread()
+{
+    thread_local bool exited = false;
+    if(exited)
+        return registry().late_counters();
+    thread_local thread_registration registration(t_counters, exited);
+    return *t_counters;
+}
+
+/*******************************************************************************
+ * Get the event counters of the metrics
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_metrics(size_t* workspace_reallocations,
+                                              size_t* solutions_not_found,
+                                              size_t* check_numerics_failures)
+try
+{
+    metrics_snapshot snapshot = registry().snapshot();
+    if(workspace_reallocations)
+        *workspace_reallocations = snapshot.events[rocblas_metrics::workspace_reallocation];
+    if(solutions_not_found)
+        *solutions_not_found = snapshot.events[rocblas_metrics::solution_not_found];
+    if(check_numerics_failures)
+        *check_numerics_failures = snapshot.events[rocblas_metrics::check_numerics_failure];
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Get the call counters of each function and precision
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_get_function_metrics(size_t*                   count,
+                                                       rocblas_function_metrics* metrics)
+try
+{
+    if(!count)
+        return rocblas_status_invalid_pointer;
+
+    metrics_snapshot snapshot = registry().snapshot();
+    if(metrics)
+    {
+        size_t i = 0;
+        for(auto it = snapshot.functions.begin(); i < *count && it != snapshot.functions.end();
+            ++it)
+            metrics[i++] = it->second;
+    }
+    *count = snapshot.functions.size();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************************
+ * Write the metrics to a file in the Prometheus text format
+ ******************************************************************************/
+extern "C" rocblas_status rocblas_export_metrics(const char* path)
+try
+{
+    if(!path)
+        return rocblas_status_invalid_pointer;
+    return write_metrics(path) ? rocblas_status_success : rocblas_status_internal_error;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
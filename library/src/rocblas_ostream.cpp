@@ -5,8 +5,12 @@
 // Predeclare rocblas_abort_once() for friend declaration in rocblas_ostream.hpp
 static void rocblas_abort_once [[noreturn]] ();
 
+#include "rocblas_binary_log.hpp"
 #include "rocblas_ostream.hpp"
+#include <cerrno>
+#include <climits>
 #include <csignal>
+#include <cstring>
 #include <fcntl.h>
 #include <type_traits>
 
@@ -31,9 +35,16 @@ static void rocblas_abort_once()
     // Timeout in case of deadlock
     alarm(5);
 
+    // Write the records of the binary log, whose writer thread is not fenced below, and which
+    // may report errors through the workers
+    rocblas_binary_log::flush();
+
     // Obtain the map lock
     rocblas_internal_ostream::map_mutex().lock();
 
+    // Write all of the output queued for each worker, and sync the files to storage
+    rocblas_internal_ostream::fence_all(true);
+
     // Clear the map, stopping all workers
     rocblas_internal_ostream::map().clear();
 
@@ -91,6 +102,10 @@ std::shared_ptr<rocblas_internal_ostream::worker> rocblas_internal_ostream::get_
     if(!worker_ptr)
         worker_ptr = std::make_shared<worker>(fd);
 
+    // Write the output which workers writing at an interval have queued at exit, even for
+    // streams which are never closed
+    static int fence_at_exit = atexit([] { fence_all(false); });
+
     // Return the existing or new worker matching the file
     return worker_ptr;
 }
@@ -128,7 +143,7 @@ ROCBLAS_INTERNAL_EXPORT void rocblas_internal_ostream::flush()
         // The contents of the string buffer
         auto str = os.str();
 
-        // Empty string buffers kill the worker thread, so they are not flushed here
+        // Empty string buffers are not sent to the worker thread
         if(str.size())
             worker_ptr->send(std::move(str));
 
@@ -137,6 +152,27 @@ ROCBLAS_INTERNAL_EXPORT void rocblas_internal_ostream::flush()
     }
 }
 
+// Flush the output without waiting for it to be written; the writes of a stream
+// are still written in order, and before any later flush() returns
+ROCBLAS_INTERNAL_EXPORT void rocblas_internal_ostream::flush_async()
+{
+    if(worker_ptr)
+    {
+        auto str = os.str();
+        if(str.size())
+            worker_ptr->send(std::move(str), false);
+        clear();
+    }
+}
+
+// Wait for the output sent to the file so far, by any stream, to be written
+ROCBLAS_INTERNAL_EXPORT void rocblas_internal_ostream::fence()
+{
+    flush_async();
+    if(worker_ptr)
+        worker_ptr->fence(false);
+}
+
 /***********************************************************************
  * Formatted Output                                                    *
  ***********************************************************************/
@@ -248,80 +284,197 @@ ROCBLAS_INTERNAL_EXPORT rocblas_internal_ostream& operator<<(rocblas_internal_os
  * rocblas_internal_ostream::worker functions handle logging in a single thread *
  ***********************************************************************/
 
-// Send a string to the worker thread for this stream's device/inode
-// Empty strings tell the worker thread to exit
-void rocblas_internal_ostream::worker::send(std::string str)
+// Push a task onto the queue; the task is visible to the worker thread once the
+// previous head is linked to it
+void rocblas_internal_ostream::worker::task_queue::push(task_t* task)
 {
-    // Create a promise to wait for the operation to complete
-    std::promise<void> promise;
-
-    // The future indicating when the operation has completed
-    auto future = promise.get_future();
+    task->next.store(nullptr, std::memory_order_relaxed);
+    task_t* prev = head.exchange(task);
+    prev->next.store(task, std::memory_order_release);
+}
 
-    // task_t consists of string and promise
-    // std::move transfers ownership of str and promise to task
-    task_t worker_task(std::move(str), std::move(promise));
+// Pop a task from the queue, moving the stub to the back when the last task is popped
+auto rocblas_internal_ostream::worker::task_queue::pop() -> task_t*
+{
+    task_t* task = tail;
+    task_t* next = task->next.load(std::memory_order_acquire);
+    if(task == &stub)
+    {
+        if(!next)
+            return nullptr;
+        tail = task = next;
+        next = task->next.load(std::memory_order_acquire);
+    }
+    if(!next)
+    {
+        // The task is not the last one pushed, but the next one is still being pushed
+        if(task != head.load())
+            return nullptr;
+        push(&stub);
+        next = task->next.load(std::memory_order_acquire);
+        if(!next)
+            return nullptr;
+    }
+    tail = next;
+    return task;
+}
 
-    // Submit the task to the worker assigned to this device/inode
-    // Hold mutex for as short as possible, to reduce contention
-    // TODO: Consider whether notification should be done with lock held or released
+// Push a task to the worker thread for this stream's device/inode
+void rocblas_internal_ostream::worker::push(task_t* task, bool wait)
+{
+    if(!wait)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        queue.push(std::move(worker_task));
-        cond.notify_one();
+        // In interval mode, tasks which are not waited for are written at the next interval
+        queue.push(task);
+        if(!flush_interval.count())
+            wake();
+        return;
     }
 
+    // Create a promise to wait for the task to complete
+    std::promise<void> promise;
+    auto               future = promise.get_future();
+    task->promise             = &promise;
+
+    queue.push(task);
+    wake();
+
     // Wait for the task to be completed, to ensure flushed IO
     future.get();
 }
 
-// Worker thread which serializes data to be written to a device/inode
-void rocblas_internal_ostream::worker::thread_function()
+// Send a string to the worker thread for this stream's device/inode
+void rocblas_internal_ostream::worker::send(std::string str, bool wait)
 {
-    // Clear any errors in the FILE
-    clearerr(file);
+    auto task = new task_t;
+    task->str = std::move(str);
+    push(task, wait && !flush_interval.count());
+}
 
-    // Lock the mutex in preparation for cond.wait
-    std::unique_lock<std::mutex> lock(mutex);
+// Wait for the tasks sent before to be written, and with sync, for the file to be synced
+void rocblas_internal_ostream::worker::fence(bool sync)
+{
+    auto task  = new task_t;
+    task->kind = task_t::fence;
+    task->sync = sync;
+    push(task, true);
+}
 
-    while(true)
+// Wake the worker thread. The pending and sleeping flags are sequentially consistent,
+// so either the worker sees the pending task before it sleeps, or the sender sees the
+// worker sleeping and notifies it.
+void rocblas_internal_ostream::worker::wake()
+{
+    pending.store(true);
+    if(sleeping.exchange(false))
     {
-        // Wait for any data, ignoring spurious wakeups
-        cond.wait(lock, [&] { return !queue.empty(); });
+        std::lock_guard<std::mutex> lock(mutex);
+        cond.notify_one();
+    }
+}
 
-        // With the mutex locked, get and pop data from the front of queue
-        task_t task = std::move(queue.front());
-        queue.pop();
+void rocblas_internal_ostream::worker::sleep()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    sleeping.store(true);
+    if(!pending.exchange(false))
+    {
+        if(flush_interval.count())
+            cond.wait_for(lock, flush_interval, [&] { return !sleeping.load(); });
+        else
+            cond.wait(lock, [&] { return !sleeping.load(); });
+    }
+    sleeping.store(false);
+}
 
-        // Temporarily unlock queue mutex, unblocking other threads
-        lock.unlock();
+// Write the payloads of a batch of tasks, with as few system calls as possible
+bool rocblas_internal_ostream::worker::write_batch(std::vector<task_t*>& batch,
+                                                   std::vector<iovec>&   iov)
+{
+    iov.clear();
+    for(task_t* task : batch)
+        if(task->kind == task_t::write)
+            iov.push_back({const_cast<char*>(task->str.data()), task->str.size()});
 
-        // An empty message indicates the closing of the stream
-        if(!task.size())
+    for(size_t i = 0; i < iov.size() && !failed;)
+    {
+        ssize_t n = writev(fd, &iov[i], int(std::min(iov.size() - i, size_t(IOV_MAX))));
+        if(n < 0)
         {
-            // Tell future to wake up
-            task.set_value();
+            if(errno == EINTR)
+                continue;
+
+            // Discard later output, but keep completing tasks so that no sender hangs
+            perror("Error writing log file");
+            failed = true;
             break;
         }
 
-        // Write the data
-        fwrite(task.data(), 1, task.size(), file);
+        // Skip the buffers which were written, and the written part of a partial buffer
+        for(; i < iov.size() && size_t(n) >= iov[i].iov_len; ++i)
+            n -= iov[i].iov_len;
+        if(n)
+        {
+            iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + n;
+            iov[i].iov_len -= n;
+        }
+    }
+
+    // Complete the tasks; after the exit task is completed, the worker may be destroyed
+    std::promise<void>* exit_promise = nullptr;
+    for(task_t* task : batch)
+    {
+        if(task->kind == task_t::fence && task->sync && !failed)
+            fsync(fd);
+        if(task->kind == task_t::exit)
+            exit_promise = task->promise;
+        else if(task->promise)
+            task->promise->set_value();
+        delete task;
+    }
+
+    if(exit_promise)
+    {
+        exit_promise->set_value();
+        return false;
+    }
+    return true;
+}
+
+// Worker thread which serializes data to be written to a device/inode
+void rocblas_internal_ostream::worker::thread_function()
+{
+    std::vector<task_t*> batch;
+    std::vector<iovec>   iov;
 
-        // Detect any error and flush the C FILE stream
-        if(ferror(file) || fflush(file))
+    while(true)
+    {
+        // Take all of the tasks queued, up to the most buffers a single write can take
+        batch.clear();
+        while(batch.size() < size_t(IOV_MAX))
         {
-            perror("Error writing log file");
+            task_t* task = queue.pop();
+            if(!task)
+                break;
+            batch.push_back(task);
+        }
 
-            // Tell future to wake up
-            task.set_value();
-            break;
+        if(batch.empty())
+        {
+            // A task is still being pushed
+            if(!queue.empty() && !flush_interval.count())
+                std::this_thread::yield();
+            else
+                sleep();
+            continue;
         }
 
-        // Promise that the data has been written
-        task.set_value();
+        if(!write_batch(batch, iov))
+            break;
 
-        // Re-lock the mutex in preparation for cond.wait
-        lock.lock();
+        // In interval mode, wait for more output unless the batch was full
+        if(flush_interval.count() && batch.size() < size_t(IOV_MAX))
+            sleep();
     }
 }
 
@@ -329,18 +482,32 @@ void rocblas_internal_ostream::worker::thread_function()
 rocblas_internal_ostream::worker::worker(int fd)
 {
     // The worker duplicates the file descriptor (RAII)
-    fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    this->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
 
-    // If the dup fails or fdopen fails, print error and abort
-    if(fd == -1 || !(file = fdopen(fd, "a")))
+    // If the dup fails, print error and abort
+    if(this->fd == -1)
     {
-        perror("fdopen() error");
+        perror("fcntl() error");
         rocblas_abort();
     }
 
+    // Optional interval between writes, set when the worker is created
+    const char* interval = getenv("ROCBLAS_LOG_FLUSH_INTERVAL_MS");
+    if(interval && strtol(interval, nullptr, 0) > 0)
+        flush_interval = std::chrono::milliseconds(strtol(interval, nullptr, 0));
+
     // Create a worker thread, capturing *this
     thread = std::thread([=] { thread_function(); });
 
     // Detatch from the worker thread
     thread.detach();
 }
+
+// Wait for every worker to write everything sent to it
+void rocblas_internal_ostream::fence_all(bool sync)
+{
+    std::lock_guard<std::recursive_mutex> lock(map_mutex());
+    for(auto& entry : map())
+        if(entry.second)
+            entry.second->fence(sync);
+}
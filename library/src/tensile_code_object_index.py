@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Generate the index of kernels in the Tensile code objects.
+
+For every directory under LIBRARY_DIR containing code objects (*.co, *.hsaco),
+write TensileCodeObjectIndex.txt listing the kernels defined by each code object.
+TensileHost uses the index to load a code object only when one of its kernels is
+first launched. The format is described in library/src/include/rocblas_code_object_index.hpp.
+
+Usage: tensile_code_object_index.py LIBRARY_DIR
+"""
+
+import os
+import struct
+import sys
+
+INDEX_FILE = "TensileCodeObjectIndex.txt"
+INDEX_HEADER = "# rocBLAS code object index v1"
+BUNDLE_MAGIC = b"__CLANG_OFFLOAD_BUNDLE__"
+
+SHT_SYMTAB, SHT_DYNSYM = 2, 11
+STB_GLOBAL = 1
+STT_FUNC, STT_AMDGPU_HSA_KERNEL = 2, 10
+
+
+def elf_images(data):
+    """Yield the ELF images in a code object, which may be a clang offload bundle."""
+    if data.startswith(BUNDLE_MAGIC):
+        offset = len(BUNDLE_MAGIC)
+        (count,) = struct.unpack_from("<Q", data, offset)
+        offset += 8
+        for _ in range(count):
+            start, size, id_size = struct.unpack_from("<QQQ", data, offset)
+            offset += 24
+            target = data[offset:offset + id_size].decode(errors="replace")
+            offset += id_size
+            if "amdgcn" in target and size:
+                yield data[start:start + size]
+    elif data.startswith(b"\x7fELF"):
+        yield data
+
+
+def elf_kernels(elf):
+    """Return the kernel names defined by a 64-bit little-endian ELF image."""
+    if elf[4] != 2 or elf[5] != 1:
+        raise ValueError("not a 64-bit little-endian ELF file")
+    shoff, = struct.unpack_from("<Q", elf, 0x28)
+    shentsize, shnum = struct.unpack_from("<HH", elf, 0x3A)
+    sections = [struct.unpack_from("<IIQQQQIIQQ", elf, shoff + i * shentsize) for i in range(shnum)]
+
+    descriptors, functions = set(), set()
+    for sh_name, sh_type, _, _, sh_offset, sh_size, sh_link, _, _, sh_entsize in sections:
+        if sh_type not in (SHT_SYMTAB, SHT_DYNSYM) or not sh_entsize:
+            continue
+        strtab = sections[sh_link]
+        str_offset = strtab[4]
+        for i in range(sh_size // sh_entsize):
+            st_name, st_info = struct.unpack_from("<IB", elf, sh_offset + i * sh_entsize)
+            if not st_name or st_info >> 4 != STB_GLOBAL:
+                continue
+            end = elf.index(b"\0", str_offset + st_name)
+            name = elf[str_offset + st_name:end].decode()
+            if name.endswith(".kd"):
+                descriptors.add(name[:-3])  # code object v3 kernel descriptor
+            elif st_info & 0xF in (STT_FUNC, STT_AMDGPU_HSA_KERNEL):
+                functions.add(name)
+    return descriptors or functions
+
+
+def index_directory(directory, files):
+    lines = [INDEX_HEADER]
+    for name in sorted(files):
+        with open(os.path.join(directory, name), "rb") as f:
+            data = f.read()
+        kernels = set()
+        try:
+            for elf in elf_images(data):
+                kernels |= elf_kernels(elf)
+        except (ValueError, struct.error, IndexError) as e:
+            print(f"{name}: cannot be indexed ({e}); it will be loaded eagerly", file=sys.stderr)
+            continue
+        if not kernels:
+            print(f"{name}: no kernels found; it will be loaded eagerly", file=sys.stderr)
+            continue
+        lines.append("@ " + name)
+        lines.extend(sorted(kernels))
+
+    path = os.path.join(directory, INDEX_FILE)
+    with open(path + ".tmp", "w") as f:
+        f.write("\n".join(lines) + "\n")
+    os.replace(path + ".tmp", path)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    for directory, _, names in os.walk(sys.argv[1]):
+        files = [n for n in names if n.endswith("co")]
+        if files:
+            index_directory(directory, files)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,6 +11,80 @@
 // In the old Tensile client, rocblas_initialize() is a no-op
 extern "C" void rocblas_initialize() {}
 
+// In the old Tensile client, there is nothing to initialize in the background
+extern "C" rocblas_status rocblas_initialize_async()
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_initialize_wait()
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_initialize_query(bool* complete)
+{
+    if(!complete)
+        return rocblas_status_invalid_pointer;
+    *complete = true;
+    return rocblas_status_success;
+}
+
+// The old Tensile client does not cache solution selections
+extern "C" rocblas_status rocblas_get_solution_cache_stats(size_t* hits,
+                                                           size_t* misses,
+                                                           size_t* evictions,
+                                                           size_t* entries)
+{
+    for(auto* p : {hits, misses, evictions, entries})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_get_tensile_library_load_info(double* load_us,
+                                                               size_t* resident_bytes,
+                                                               size_t* file_bytes)
+{
+    if(load_us)
+        *load_us = 0;
+    for(auto* p : {resident_bytes, file_bytes})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_set_solution_cache_enabled(bool enabled)
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_clear_solution_cache()
+{
+    return rocblas_status_success;
+}
+
+// The old Tensile client does not autotune gemm
+extern "C" rocblas_status
+    rocblas_set_gemm_autotune_limits(size_t candidates, size_t trials, size_t max_signatures)
+{
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status
+    rocblas_get_gemm_autotune_limits(size_t* candidates, size_t* trials, size_t* max_signatures)
+{
+    for(auto* p : {candidates, trials, max_signatures})
+        if(p)
+            *p = 0;
+    return rocblas_status_success;
+}
+
+extern "C" rocblas_status rocblas_export_gemm_autotune_results(const char* path)
+{
+    return rocblas_status_not_implemented;
+}
+
 #else
 
 /*****************************************************************************
@@ -19,6 +93,13 @@ extern "C" void rocblas_initialize() {}
  *****************************************************************************/
 
 #include "tensile_host.hpp"
+#include "rocblas_arch_registry.hpp"
+#include "rocblas_code_object_index.hpp"
+#include "rocblas_gemm_autotune.hpp"
+#include "rocblas_metrics.hpp"
+#include "rocblas_solution_cache.hpp"
+#include "rocblas_solution_override.hpp"
+#include "rocblas_solution_warm_start.hpp"
 //#include <Tensile/AMDGPU.hpp>
 #include <Tensile/Contractions.hpp>
 #include <Tensile/EmbeddedLibrary.hpp>
@@ -29,16 +110,22 @@ extern "C" void rocblas_initialize() {}
 #include <Tensile/hip/HipHardware.hpp>
 #include <Tensile/hip/HipSolutionAdapter.hpp>
 #include <Tensile/hip/HipUtils.hpp>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <complex>
 #include <dlfcn.h>
 #include <exception>
+#include <functional>
+#include <future>
 #include <glob.h>
 #include <iomanip>
 #include <libgen.h>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <sys/stat.h>
 #include <type_traits>
 #include <unistd.h>
 #include <vector>
@@ -127,7 +214,7 @@ namespace
 
     // The workspace sizes for Tensile are rounded to multiples of HPA_GSU_WORKSPACE_SIZE_GRANULARITY
     // to reduce fragmentation in the Tensile Solution cache
-    constexpr size_t HPA_GSU_WORKSPACE_SIZE_GRANULARITY = 256;
+    constexpr size_t HPA_GSU_WORKSPACE_SIZE_GRANULARITY = ROCBLAS_HPA_GSU_GRANULARITY;
 
     Tensile::PerformanceMetric performanceMetricMap(rocblas_performance_metric metric)
     {
@@ -353,6 +440,209 @@ namespace
         return tensileProblem;
     }
 
+    /**************************************************************************
+     * The solution cache maps a problem signature to the ContractionSolution *
+     * which findBestSolution() selected for it. Solutions are owned by the   *
+     * MasterSolutionLibrary, which lives until the process exits, so the     *
+     * cache only stores raw pointers.                                        *
+     **************************************************************************/
+    constexpr size_t SOLUTION_CACHE_KEY_WORDS    = 24;
+    constexpr size_t SOLUTION_CACHE_DEFAULT_SIZE = 1024;
+    using solution_cache_t
+        = rocblas_solution_cache<Tensile::ContractionSolution, SOLUTION_CACHE_KEY_WORDS>;
+
+    solution_cache_t& tensile_solution_cache()
+    {
+        static solution_cache_t cache{[] {
+            const char* env = getenv("ROCBLAS_TENSILE_SOLUTION_CACHE_SIZE");
+            return env ? size_t(strtoul(env, nullptr, 0)) : SOLUTION_CACHE_DEFAULT_SIZE;
+        }()};
+        return cache;
+    }
+
+    /*****************************************************************************
+     * The solution override table named by ROCBLAS_TENSILE_SOLUTION_OVERRIDES   *
+     * pins the solutions used for matching problems. At exit, a report of how   *
+     * often each row fired is written to the file named by                      *
+     * ROCBLAS_TENSILE_SOLUTION_OVERRIDE_REPORT.                                 *
+     *****************************************************************************/
+    class tensile_override_table : public rocblas_solution_override_table
+    {
+    public:
+        tensile_override_table()
+        {
+            const char* path = getenv("ROCBLAS_TENSILE_SOLUTION_OVERRIDES");
+            std::string error;
+            if(path && *path && !read(path, error))
+                rocblas_cerr << "\nrocBLAS warning: Ignoring solution overrides: " << error
+                             << std::endl;
+        }
+
+        ~tensile_override_table()
+        {
+            // rocblas_cerr may already have been destroyed at exit
+            const char* path = getenv("ROCBLAS_TENSILE_SOLUTION_OVERRIDE_REPORT");
+            if(path && *path && !empty() && !write_report(path))
+                fprintf(stderr, "\nrocBLAS warning: Could not write %s\n", path);
+        }
+    };
+
+    tensile_override_table& tensile_solution_overrides()
+    {
+        static tensile_override_table table;
+        return table;
+    }
+
+    // The signature of a RocblasContractionProblem which override rows are matched against
+    template <typename Ti, typename To, typename Tc>
+    rocblas_override_problem
+        ConstructOverrideProblem(const RocblasContractionProblem<Ti, To, Tc>& prob)
+    {
+        // rocblas_int8x4 is passed to gemm_ex as i8_r
+        return {std::is_same<Ti, rocblas_int8x4>{} ? "i8_r" : rocblas_precision_string<Ti>,
+                rocblas_precision_string<To>,
+                rocblas_precision_string<Tc>,
+                rocblas_transpose_letter(prob.trans_a),
+                rocblas_transpose_letter(prob.trans_b),
+                int64_t(prob.m),
+                int64_t(prob.n),
+                int64_t(prob.k),
+                int64_t(prob.batch_count),
+                int64_t(prob.col_stride_a),
+                int64_t(prob.col_stride_b),
+                int64_t(prob.col_stride_c),
+                int64_t(prob.col_stride_d),
+                int64_t(prob.batch_stride_a),
+                int64_t(prob.batch_stride_b),
+                int64_t(prob.batch_stride_c),
+                int64_t(prob.batch_stride_d)};
+    }
+
+    /*****************************************************************************
+     * Statistics of loading TensileLibrary.dat, reported by                     *
+     * rocblas_get_tensile_library_load_info(). One library is loaded for each   *
+     * architecture, and the statistics are summed over the libraries loaded.    *
+     *****************************************************************************/
+    struct library_load_info
+    {
+        std::mutex mutex;
+        double     load_us        = 0;
+        size_t     file_bytes     = 0;
+        size_t     resident_bytes = 0;
+    };
+
+    library_load_info& tensile_library_load_info()
+    {
+        static library_load_info info;
+        return info;
+    }
+
+    // Resident set size of the process in bytes, or 0 if it cannot be read
+    size_t resident_set_size()
+    {
+        size_t pages = 0, resident = 0;
+        FILE*  statm = fopen("/proc/self/statm", "r");
+        if(statm)
+        {
+            if(fscanf(statm, "%zu %zu", &pages, &resident) != 2)
+                resident = 0;
+            fclose(statm);
+        }
+        return resident * size_t(sysconf(_SC_PAGESIZE));
+    }
+
+    // Encode the result of value_category() in 2 bits
+    template <typename T>
+    constexpr uint64_t scalar_category(const T& x)
+    {
+        return uint64_t(value_category(x) + 1.0);
+    }
+
+    /*****************************************************************************
+     * Construct a solution cache key from a RocblasContractionProblem. The key  *
+     * must contain everything which ConstructTensileProblem() passes to Tensile *
+     * for a given Ti, To and Tc, since it also identifies the reused problems   *
+     * in GetTensileProblem().                                                   *
+     *                                                                           *
+     * Keys are stored in warm start files. If the layout changes, bump          *
+     * ROCBLAS_WARM_START_VERSION and update scripts/utilities/                  *
+     * solution-warm-start.py.                                                   *
+     *****************************************************************************/
+    template <typename Ti, typename To, typename Tc>
+    auto ConstructSolutionCacheKey(const RocblasContractionProblem<Ti, To, Tc>& prob)
+    {
+        // Same as in ConstructTensileProblem()
+        auto k = prob.k && *prob.alpha ? prob.k : 0;
+
+        size_t workspace_size
+            = prob.handle->is_device_memory_size_query()
+                  ? ~size_t{0}
+                  : (prob.handle->gsu_workspace_size / HPA_GSU_WORKSPACE_SIZE_GRANULARITY)
+                        * HPA_GSU_WORKSPACE_SIZE_GRANULARITY;
+
+        rocblas_performance_metric metric;
+        rocblas_get_performance_metric(prob.handle, &metric);
+
+        // Types, transposes, modes and scalar categories are packed into one word
+        uint64_t packed = uint64_t(tensile_datatype<Ti>) | uint64_t(tensile_datatype<To>) << 8
+                          | uint64_t(tensile_datatype<Tc>) << 16
+                          | uint64_t(prob.trans_a & 0xff) << 24
+                          | uint64_t(prob.trans_b & 0xff) << 32 | uint64_t(metric & 0xff) << 40
+                          | uint64_t(prob.handle->atomics_mode & 1) << 48
+                          | uint64_t(prob.strided_batch) << 49 | uint64_t(prob.C == prob.D) << 50
+                          | scalar_category(*prob.beta) << 51
+                          | (k ? scalar_category(*prob.alpha) : 1) << 53;
+
+        // clang-format off
+        return solution_cache_t::key_t{{
+            uint64_t(prob.m),              uint64_t(prob.n),
+            uint64_t(k),                   uint64_t(prob.batch_count),
+            uint64_t(prob.row_stride_a),   uint64_t(prob.col_stride_a),   uint64_t(prob.batch_stride_a),
+            uint64_t(prob.row_stride_b),   uint64_t(prob.col_stride_b),   uint64_t(prob.batch_stride_b),
+            uint64_t(prob.row_stride_c),   uint64_t(prob.col_stride_c),   uint64_t(prob.batch_stride_c),
+            uint64_t(prob.row_stride_d),   uint64_t(prob.col_stride_d),   uint64_t(prob.batch_stride_d),
+            uint64_t(prob.buffer_offset_a), uint64_t(prob.buffer_offset_b),
+            uint64_t(prob.buffer_offset_c), uint64_t(prob.buffer_offset_d),
+            packed,
+            uint64_t(prob.flags),
+            uint64_t(workspace_size),
+            uint64_t(prob.handle->getArch()),
+        }};
+        // clang-format on
+    }
+
+    /*****************************************************************************
+     * Each thread keeps the Tensile problems it constructed most recently in a  *
+     * small direct-mapped table per Ti, To and Tc, indexed by the solution      *
+     * cache key. A problem whose key matches is reused, so that repeated calls  *
+     * with the same signature do not construct TensorDescriptors or index       *
+     * vectors, which allocate memory.                                           *
+     *****************************************************************************/
+    constexpr size_t TENSILE_PROBLEM_TABLE_SIZE = 8;
+
+    struct tensile_problem_entry
+    {
+        solution_cache_t::key_t                      key;
+        std::unique_ptr<Tensile::ContractionProblem> problem;
+    };
+
+    template <typename Ti, typename To, typename Tc>
+    const Tensile::ContractionProblem&
+        GetTensileProblem(const RocblasContractionProblem<Ti, To, Tc>& prob,
+                          const solution_cache_t::key_t&               key)
+    {
+        static thread_local std::array<tensile_problem_entry, TENSILE_PROBLEM_TABLE_SIZE> table;
+
+        auto& e = table[solution_cache_t::hash(key) % TENSILE_PROBLEM_TABLE_SIZE];
+        if(!e.problem || e.key != key)
+        {
+            e.problem
+                = std::make_unique<Tensile::ContractionProblem>(ConstructTensileProblem(prob));
+            e.key = key;
+        }
+        return *e.problem;
+    }
+
     /***************************************************************
      * Construct the inputs to a Tensile ContractionProblem        *
      ***************************************************************/
@@ -413,25 +703,52 @@ namespace
      **************************************************/
     class TensileHost
     {
-        // The library object
-        std::shared_ptr<Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>> m_library;
-        std::shared_ptr<hipDeviceProp_t>                                             m_deviceProp;
+        using MSL = Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>;
 
+    public:
+        // The library and code objects shared by all devices of one architecture
+        struct arch_library_s
+        {
+            std::string               processor; // architecture name, e.g. gfx908
+            std::string               directory; // directory of the library and code objects
+            std::string               library_path;
+            std::shared_ptr<MSL>      library;
+            rocblas_code_object_index code_object_index; // code objects loaded on demand
+            bool                      lazy_loading = false;
+            uint64_t                  library_id   = 0; // identifies warm start files
+        };
+
+    private:
         // The adapter object. mutable is used to allow adapters to be modified
         // even when they are stored in a const vector which is immutable in size
         struct adapter_s
         {
             mutable std::atomic<Tensile::hip::SolutionAdapter*> adapter{nullptr};
             mutable std::mutex                                  mutex;
+            mutable rocblas_code_object_residency               residency;
+            mutable std::shared_ptr<Tensile::Hardware>          hardware;
+            mutable const arch_library_s*                       arch = nullptr;
         };
 
         // Each device contains an adapter
         std::vector<adapter_s> const m_adapters;
 
+        // Devices of the same architecture share one library
+        rocblas_arch_registry<arch_library_s> m_archs;
+
+        // The architecture whose solution selections are kept in the warm start file
+        std::atomic<arch_library_s*> m_warm_start_arch{nullptr};
+
     public:
         TensileHost()
             : m_adapters(GetDeviceCount())
+            , m_archs(int(m_adapters.size()),
+                      [](int device) { return rocblas_internal_get_arch_name(device); })
         {
+            // Construct the solution cache before TensileHost, so that it is destroyed after
+            // TensileHost and can be saved to the warm start file in ~TensileHost()
+            tensile_solution_cache();
+
             // We mark TensileHost as initialized. This is so that CI tests can
             // verify that the initialization occurs in the "multiheaded" tests
             rocblas_internal_tensile_is_initialized() = true;
@@ -457,23 +774,56 @@ namespace
 
         ~TensileHost()
         {
+            save_warm_start();
             for(auto& a : m_adapters)
                 delete a.adapter;
         }
 
-        auto& get_library() const
+        auto& get_adapters() const
         {
-            return m_library;
+            return m_adapters;
         }
 
-        auto& get_device_property() const
+        // The library of a device's architecture, which is loaded by the first device
+        // of that architecture
+        const arch_library_s& get_arch_library(int device)
         {
-            return m_deviceProp;
+            return m_archs.get(device, [this](const std::string& processor) {
+                return load_arch_library(processor);
+            });
         }
 
-        auto& get_adapters() const
+        // Function which loads a code object file into a device's adapter
+        static auto code_object_loader(const adapter_s& a)
         {
-            return m_adapters;
+            return [&a](const std::string& file) {
+                HIP_CHECK_EXC(a.adapter.load(std::memory_order_acquire)->loadCodeObjectFile(file));
+            };
+        }
+
+        /***************************************************************************
+         * Load the code objects containing the kernels about to be launched on a  *
+         * device. This is a no-op unless code objects are loaded lazily.          *
+         ***************************************************************************/
+        void load_code_objects(const std::vector<Tensile::KernelInvocation>& kernels,
+                               int                                           device) const
+        {
+            auto& a = m_adapters.at(device);
+            if(!a.arch->lazy_loading)
+                return;
+
+            for(auto& k : kernels)
+                a.residency.require(a.arch->code_object_index, k.kernelName, code_object_loader(a));
+        }
+
+        // Load all of the code objects for a device, e.g. in the background
+        void preload_code_objects(int device) const
+        {
+            auto& a = m_adapters.at(device);
+            if(!a.arch->lazy_loading)
+                return;
+
+            a.residency.require_all(a.arch->code_object_index, code_object_loader(a));
         }
 
         /*******************************************************
@@ -484,18 +834,76 @@ namespace
             return access(path.c_str(), R_OK) == 0;
         }
 
-        /*********************************************************************
-         * Initialize adapter and library according to environment variables *
-         * and default paths based on librocblas.so location and GPU         *
-         *********************************************************************/
-        void initialize(Tensile::hip::SolutionAdapter& adapter, rocblas_int deviceId)
+        /**********************************************************************
+         * The warm start file named by ROCBLAS_TENSILE_SOLUTION_WARM_START   *
+         * pre-seeds the solution cache when the library is loaded, and the   *
+         * contents of the solution cache are merged into it at exit. It      *
+         * holds the selections of one architecture: the one it was written   *
+         * for, or else the first architecture whose library is loaded.       *
+         **********************************************************************/
+        static const char* warm_start_path()
+        {
+            static const char* path = getenv("ROCBLAS_TENSILE_SOLUTION_WARM_START");
+            return path && *path ? path : nullptr;
+        }
+
+        void load_warm_start(arch_library_s& arch)
+        {
+            auto&       cache = tensile_solution_cache();
+            const char* file  = warm_start_path();
+            if(!file || !cache.enabled())
+                return;
+
+            if(!arch.library_id)
+                arch.library_id = rocblas_warm_start_file_id(arch.library_path.c_str());
+
+            // Entries whose solution index is not in the library are skipped
+            auto& solutions = arch.library->solutions;
+            auto  read      = rocblas_warm_start_read<SOLUTION_CACHE_KEY_WORDS>(
+                file, arch.processor, arch.library_id, [&](const auto& key, int64_t index) {
+                    auto it = solutions.find(int(index));
+                    if(it != solutions.end())
+                        cache.insert(key, it->second.get());
+                });
+
+            arch_library_s* none = nullptr;
+            if(read >= 0)
+                m_warm_start_arch.store(&arch);
+            else
+                m_warm_start_arch.compare_exchange_strong(none, &arch);
+        }
+
+        void save_warm_start()
+        {
+            const char* file = warm_start_path();
+            auto*       arch = m_warm_start_arch.load();
+            if(!file || !arch || !arch->library_id)
+                return;
+
+            // Only the selections of solutions in this architecture's library are saved
+            std::vector<std::pair<solution_cache_t::key_t, int64_t>> entries;
+            auto& solutions = arch->library->solutions;
+            tensile_solution_cache().for_each([&](const auto& key, auto* solution) {
+                auto it = solutions.find(solution->index);
+                if(it != solutions.end() && it->second.get() == solution)
+                    entries.emplace_back(key, solution->index);
+            });
+
+            // rocblas_cerr may already have been destroyed at exit
+            if(!entries.empty()
+               && !rocblas_warm_start_write(file, arch->processor, arch->library_id, entries))
+                fprintf(stderr, "\nrocBLAS warning: Could not write %s\n", file);
+        }
+
+        /****************************************************************
+         * Directory of the Tensile library for a processor, according  *
+         * to environment variables and the librocblas.so location      *
+         ****************************************************************/
+        static std::string library_directory(const std::string& processor)
         {
             std::string path;
             path.reserve(PATH_MAX);
 
-            // The name of the current GPU platform
-            std::string processor = rocblas_internal_get_arch_name();
-
             const char* env = getenv("ROCBLAS_TENSILE_LIBPATH");
             if(env)
             {
@@ -533,15 +941,114 @@ namespace
                     path += "/" + processor;
             }
 
-            // only load modules for the current architecture
-            auto dir = path + "/*" + processor + "*co";
+            return path;
+        }
+
+        /****************************************************************
+         * Load TensileLibrary.dat for an architecture. The registry    *
+         * calls this once per architecture; other devices of the same  *
+         * architecture wait for it to complete.                        *
+         ****************************************************************/
+        void load_library(arch_library_s& arch)
+        {
+#ifdef TENSILE_YAML
+            std::string path = arch.directory + "/TensileLibrary.yaml";
+#else
+            std::string path = arch.directory + "/TensileLibrary.dat";
+#endif
+            if(!TestPath(path))
+            {
+                rocblas_cerr << "\nrocBLAS error: Cannot read " << path << ": " << strerror(errno)
+                             << std::endl;
+                rocblas_abort();
+            }
+
+            auto   resident = resident_set_size();
+            auto   start    = std::chrono::steady_clock::now();
+            size_t bytes    = 0;
+
+            auto lib = Tensile::LoadLibraryFile<Tensile::ContractionProblem>(path);
+            struct stat st;
+            if(!stat(path.c_str(), &st))
+                bytes = size_t(st.st_size);
+
+            auto load_us = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+            auto grown = resident_set_size();
+            {
+                auto&                       info = tensile_library_load_info();
+                std::lock_guard<std::mutex> lock(info.mutex);
+                info.load_us += load_us;
+                info.file_bytes += bytes;
+                info.resident_bytes += grown > resident ? grown - resident : 0;
+            }
+
+            if(lib)
+                arch.library = std::dynamic_pointer_cast<MSL>(lib);
+
+            if(!arch.library)
+            {
+                rocblas_cerr << "\nrocBLAS error: Could not load " << path << std::endl;
+                rocblas_cerr << "\nrocBLAS error: Could not initialize Tensile library"
+                             << std::endl;
+                rocblas_abort();
+            }
+
+            arch.library_path = path;
+            load_warm_start(arch);
+        }
+
+        /*********************************************************************
+         * Find the library of an architecture according to environment      *
+         * variables and default paths based on librocblas.so location, and  *
+         * load it                                                           *
+         *********************************************************************/
+        std::unique_ptr<arch_library_s> load_arch_library(const std::string& processor)
+        {
+            auto arch       = std::make_unique<arch_library_s>();
+            arch->processor = processor;
+            arch->directory = library_directory(processor);
+
+            // If there is a code object index, the indexed code objects are loaded when their
+            // first kernel is launched, unless ROCBLAS_TENSILE_LAZY_LOADING=0
+            const char* lazy = getenv("ROCBLAS_TENSILE_LAZY_LOADING");
+            if(!lazy || strtol(lazy, nullptr, 0))
+                arch->lazy_loading = arch->code_object_index.read(arch->directory, processor);
+
+            load_library(*arch);
+            return arch;
+        }
+
+        // Load the library for the current device without initializing an adapter
+        void initialize_library()
+        {
+            int device;
+            THROW_IF_HIP_ERROR(hipGetDevice(&device));
+            get_arch_library(device);
+        }
+
+        /*********************************************************************
+         * Initialize an adapter for the current device with the code        *
+         * objects of the device's architecture                              *
+         *********************************************************************/
+        void initialize(Tensile::hip::SolutionAdapter& adapter, const arch_library_s& arch)
+        {
+            // only load modules for the device's architecture
+            auto dir = arch.directory + "/*" + arch.processor + "*co";
 
             glob_t glob_result{};
             int    g = glob(dir.c_str(), GLOB_NOSORT, nullptr, &glob_result);
             if(!g)
             {
+                // Code objects which are not indexed are always loaded eagerly
                 for(size_t i = 0; i < glob_result.gl_pathc; ++i)
-                    adapter.loadCodeObjectFile(glob_result.gl_pathv[i]);
+                {
+                    std::string file = glob_result.gl_pathv[i];
+                    if(!arch.lazy_loading
+                       || !arch.code_object_index.contains_file(file.substr(file.rfind('/') + 1)))
+                        adapter.loadCodeObjectFile(file);
+                }
             }
             else if(g == GLOB_NOMATCH)
             {
@@ -562,59 +1069,25 @@ namespace
                 // clang-format on
             }
             globfree(&glob_result);
-
-            // We initialize a local static variable with a lambda function call to avoid
-            // race conditions when multiple threads with different device IDs try to
-            // initialize library. This ensures that only one thread initializes library,
-            // and other threads trying to initialize library wait for it to complete.
-            static int once = [&] {
-#ifdef TENSILE_YAML
-                path += "/TensileLibrary.yaml";
-#else
-                path += "/TensileLibrary.dat";
-#endif
-                if(!TestPath(path))
-                {
-                    rocblas_cerr << "\nrocBLAS error: Cannot read " << path << ": "
-                                 << strerror(errno) << std::endl;
-                    rocblas_abort();
-                }
-
-                auto lib = Tensile::LoadLibraryFile<Tensile::ContractionProblem>(path);
-                if(!lib)
-                    rocblas_cerr << "\nrocBLAS error: Could not load " << path << std::endl;
-                else
-                {
-                    using MSL = Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>;
-                    m_library = std::dynamic_pointer_cast<MSL>(lib);
-                }
-                return 0;
-            }();
-
-            if(!m_library)
-            {
-                rocblas_cerr << "\nrocBLAS error: Could not initialize Tensile library"
-                             << std::endl;
-                rocblas_abort();
-            }
-
-            hipDeviceProp_t prop;
-            HIP_CHECK_EXC(hipGetDeviceProperties(&prop, deviceId));
-
-            m_deviceProp = std::make_shared<hipDeviceProp_t>(prop);
         }
     };
 
-    // Return the library and adapter for the current HIP device
+    // TensileHost is initialized on the first call
+    TensileHost& get_tensile_host()
+    {
+        static TensileHost host;
+        return host;
+    }
+
+    // Return the library, hardware and adapter for the current HIP device. The library and
+    // hardware are returned by raw pointer, since they live until TensileHost is destroyed.
     auto& get_library_and_adapter(
-        std::shared_ptr<Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>>* library
-        = nullptr,
-        std::shared_ptr<hipDeviceProp_t>* deviceProp = nullptr,
-        int                               device     = -1)
+        const Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>** library = nullptr,
+        const Tensile::Hardware**                                           hardware = nullptr,
+        int                                                                 device   = -1)
     try
     {
-        // TensileHost is initialized on the first call
-        static TensileHost host;
+        auto& host = get_tensile_host();
 
         if(device == -1)
             hipGetDevice(&device);
@@ -632,22 +1105,34 @@ namespace
             adapter = a.adapter.load(std::memory_order_relaxed);
             if(!adapter)
             {
+                // The library of this device's architecture, loaded by its first device
+                auto& arch = host.get_arch_library(device);
+
                 // Allocate a new adapter using the current HIP device
                 adapter = new Tensile::hip::SolutionAdapter;
 
-                // Initialize the adapter and possibly the library
-                host.initialize(*adapter, device);
+                // Initialize the adapter with the code objects of the architecture
+                host.initialize(*adapter, arch);
+
+                // No indexed code objects have been loaded for this device yet
+                a.residency.reset(arch.code_object_index.num_files());
+
+                // The Tensile hardware description of this device is created once
+                hipDeviceProp_t prop;
+                HIP_CHECK_EXC(hipGetDeviceProperties(&prop, device));
+                a.hardware = Tensile::hip::GetDevice(prop);
+                a.arch     = &arch;
 
                 // Atomically change the adapter stored for this device ID
                 a.adapter.store(adapter, std::memory_order_release);
             }
         }
 
-        // If an adapter is found, it is assumed that the library is initialized
+        // If an adapter is found, the library of its architecture is initialized
         if(library)
-            *library = host.get_library();
-        if(deviceProp)
-            *deviceProp = host.get_device_property();
+            *library = a.arch->library.get();
+        if(hardware)
+            *hardware = a.hardware.get();
 
         return *adapter;
     }
@@ -666,7 +1151,7 @@ namespace
     }
 
     /**************************************************************************
-    * We normally print error messages only once, to avoid excessive logging *
+    * We normally print error messages only once, to avoid excessive logging  *
     **************************************************************************/
     void print_once(rocblas_internal_ostream& msg)
     {
@@ -685,6 +1170,231 @@ namespace
             rocblas_cerr << msg << std::endl;
     }
 
+    /*****************************************************************************
+     * Return the solution which the override table pins for a problem, or       *
+     * nullptr if no row matches. A pinned solution whose predicates reject the  *
+     * problem or the hardware is not used, and solution selection proceeds.     *
+     *****************************************************************************/
+    template <typename Ti, typename To, typename Tc>
+    Tensile::ContractionSolution* FindOverrideSolution(
+        const RocblasContractionProblem<Ti, To, Tc>&                       prob,
+        const Tensile::ContractionProblem&                                 tensile_prob,
+        const Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>& library,
+        const Tensile::Hardware&                                           hardware)
+    {
+        auto& overrides = tensile_solution_overrides();
+        int   row       = overrides.match(ConstructOverrideProblem(prob));
+        if(row < 0)
+            return nullptr;
+
+        auto it = library.solutions.find(overrides.row(row).solution_index);
+        if(it != library.solutions.end() && (*it->second->hardwarePredicate)(hardware)
+           && (*it->second->problemPredicate)(tensile_prob))
+        {
+            overrides.record(row, true);
+            return it->second.get();
+        }
+
+        overrides.record(row, false);
+        rocblas_internal_ostream msg;
+        print_once(msg << "\nrocBLAS warning: Solution override on line " << overrides.row(row).line
+                       << " does not apply to " << prob);
+        return nullptr;
+    }
+
+    /*****************************************************************************
+     * Online gemm autotuning. Candidates are the solution which Tensile selects *
+     * followed by the other applicable solutions, ranked by Tensile's projected *
+     * performance. The results are exported at exit to the file named by        *
+     * ROCBLAS_GEMM_AUTOTUNE_EXPORT.                                             *
+     *****************************************************************************/
+    using gemm_autotuner_t
+        = rocblas_gemm_autotuner<Tensile::ContractionSolution, SOLUTION_CACHE_KEY_WORDS>;
+
+    class tensile_gemm_autotuner : public gemm_autotuner_t
+    {
+    public:
+        // Constructing TensileHost first ensures that the solutions outlive the tuner
+        tensile_gemm_autotuner()
+        {
+            get_tensile_host();
+        }
+
+        ~tensile_gemm_autotuner()
+        {
+            // rocblas_cerr may already have been destroyed at exit
+            const char* path = getenv("ROCBLAS_GEMM_AUTOTUNE_EXPORT");
+            if(path && *path && !export_results(path))
+                fprintf(stderr, "\nrocBLAS warning: Could not write %s\n", path);
+        }
+    };
+
+    tensile_gemm_autotuner& tensile_gemm_autotune()
+    {
+        static tensile_gemm_autotuner tuner;
+        return tuner;
+    }
+
+    // Whether running a problem more than once leaves the same result. The C and D pointers of
+    // batched problems are arrays in device memory, whose matrices may be the same even if the
+    // arrays differ, so they are rerunnable only when beta is zero
+    template <typename Ti, typename To, typename Tc>
+    bool IsRerunnable(const RocblasContractionProblem<Ti, To, Tc>& prob)
+    {
+        return value_category(*prob.beta) == 0 || (prob.strided_batch && prob.C != prob.D);
+    }
+
+    template <typename Ti, typename To, typename Tc>
+    gemm_autotuner_t::selection_t TuneSolution(
+        const RocblasContractionProblem<Ti, To, Tc>&                       prob,
+        const solution_cache_t::key_t&                                     key,
+        const Tensile::ContractionProblem&                                 tensile_prob,
+        const Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>& library,
+        const Tensile::Hardware&                                           hardware,
+        Tensile::hip::SolutionAdapter&                                     adapter)
+    {
+        auto enumerate = [&] {
+            std::vector<Tensile::ContractionSolution*> candidates;
+            auto best = library.findBestSolution(tensile_prob, hardware);
+            if(best)
+                candidates.push_back(best.get());
+
+            std::vector<std::pair<double, Tensile::ContractionSolution*>> ranked;
+            for(auto& solution : library.findAllSolutions(tensile_prob, hardware))
+                if(solution != best)
+                    ranked.emplace_back(
+                        solution->projectedPerformance(tensile_prob, hardware).speedGFlops,
+                        solution.get());
+            std::stable_sort(ranked.begin(), ranked.end(), [](auto& a, auto& b) {
+                return a.first > b.first;
+            });
+            for(auto& r : ranked)
+                candidates.push_back(r.second);
+            return candidates;
+        };
+
+        auto describe = [&] { return rocblas_override_row(ConstructOverrideProblem(prob)); };
+
+        // Run a candidate between the handle's events, and return its time in ms
+        auto handle = prob.handle;
+        auto time   = [&](Tensile::ContractionSolution* candidate) -> double {
+            try
+            {
+                auto kernels = candidate->solve(tensile_prob, GetTensileInputs(prob), hardware);
+                get_tensile_host().load_code_objects(kernels, handle->getDevice());
+                float ms;
+                if(adapter.launchKernels(
+                       kernels, handle->get_stream(), handle->startEvent, handle->stopEvent)
+                       != hipSuccess
+                   || hipEventSynchronize(handle->stopEvent) != hipSuccess
+                   || hipEventElapsedTime(&ms, handle->startEvent, handle->stopEvent)
+                          != hipSuccess)
+                    return -1;
+                return ms;
+            }
+            catch(...)
+            {
+                return -1;
+            }
+        };
+
+        return tensile_gemm_autotune().select(key, enumerate, describe, time);
+    }
+
+    /*****************************************************************************
+     * Background initialization started by rocblas_initialize_async(). Loading  *
+     * the library and initializing each device are independent tasks, run by    *
+     * a small pool of threads. A gemm issued meanwhile only waits for the       *
+     * tasks it needs, because the library, each device's adapter, and each      *
+     * lazily loaded code object are initialized under their own locks.          *
+     *****************************************************************************/
+    class TensileAsyncInitializer
+    {
+        static constexpr size_t MAX_WORKERS = 4;
+
+        std::mutex                         m_mutex;
+        std::vector<std::function<void()>> m_tasks;
+        std::vector<std::future<void>>     m_workers;
+        std::atomic<bool>                  m_started{false};
+        std::atomic<bool>                  m_failed{false};
+        std::atomic<size_t>                m_next{0};
+        std::atomic<size_t>                m_remaining{0};
+
+        void run()
+        {
+            for(size_t i; (i = m_next++) < m_tasks.size(); --m_remaining)
+            {
+                try
+                {
+                    m_tasks[i]();
+                }
+                catch(...)
+                {
+                    m_failed = true;
+                }
+            }
+        }
+
+    public:
+        // Constructing TensileHost first ensures that it outlives the worker threads
+        TensileAsyncInitializer()
+        {
+            get_tensile_host();
+        }
+
+        ~TensileAsyncInitializer()
+        {
+            wait();
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_started)
+                return;
+
+            int current;
+            THROW_IF_HIP_ERROR(hipGetDevice(&current));
+
+            m_tasks.push_back([current] {
+                THROW_IF_HIP_ERROR(hipSetDevice(current));
+                get_tensile_host().initialize_library();
+            });
+
+            int count = int(get_tensile_host().get_adapters().size());
+            for(int device = 0; device < count; ++device)
+                m_tasks.push_back([device] {
+                    THROW_IF_HIP_ERROR(hipSetDevice(device));
+                    get_library_and_adapter(nullptr, nullptr, device);
+                    get_tensile_host().preload_code_objects(device);
+                });
+
+            m_remaining = m_tasks.size();
+            m_started   = true;
+            for(size_t i = 0; i < std::min(m_tasks.size(), MAX_WORKERS); ++i)
+                m_workers.push_back(std::async(std::launch::async, [this] { run(); }));
+        }
+
+        bool wait()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for(auto& w : m_workers)
+                w.wait();
+            return !m_failed;
+        }
+
+        bool complete() const
+        {
+            return m_started && !m_remaining;
+        }
+    };
+
+    TensileAsyncInitializer& get_tensile_async_initializer()
+    {
+        static TensileAsyncInitializer initializer;
+        return initializer;
+    }
+
 } // namespace
 
 /******************************************************************************
@@ -694,33 +1404,65 @@ namespace
 template <typename Ti, typename To, typename Tc>
 rocblas_status runContractionProblem(const RocblasContractionProblem<Ti, To, Tc>& prob)
 {
-    rocblas_status                                status = rocblas_status_internal_error;
-    std::shared_ptr<Tensile::ContractionSolution> solution;
+    rocblas_status                status   = rocblas_status_internal_error;
+    Tensile::ContractionSolution* solution = nullptr;
 
     try
     {
-        std::shared_ptr<Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>> library;
-        std::shared_ptr<hipDeviceProp_t>                                             deviceProp;
-        std::shared_ptr<Tensile::Hardware>                                           hardware;
+        const Tensile::MasterSolutionLibrary<Tensile::ContractionProblem>* library;
+        const Tensile::Hardware*                                           hardware;
 
-        auto& adapter = get_library_and_adapter(&library, &deviceProp, prob.handle->getDevice());
+        auto& adapter = get_library_and_adapter(&library, &hardware, prob.handle->getDevice());
 
-        hardware            = Tensile::hip::GetDevice(*deviceProp);
-        auto  tensile_prob  = ConstructTensileProblem(prob);
+        auto  key           = ConstructSolutionCacheKey(prob);
+        auto& tensile_prob  = GetTensileProblem(prob, key);
         auto  handle        = prob.handle;
         auto* fitness_query = handle->get_solution_fitness_query();
 
-        solution = library->findBestSolution(tensile_prob, *hardware, fitness_query);
+        // Fitness queries always go through findBestSolution()
+        auto& cache     = tensile_solution_cache();
+        bool  use_cache = !fitness_query && cache.enabled();
+
+        // Solution overrides take precedence over the cache and solution selection
+        auto& overrides = tensile_solution_overrides();
+        if(!fitness_query && !overrides.empty())
+            solution = FindOverrideSolution(prob, tensile_prob, *library, *hardware);
+
+        // Autotuning may already have computed the result while timing the candidates
+        bool launched = false;
+        if(!solution && !fitness_query && handle->gemm_autotune == rocblas_gemm_autotune_on
+           && handle->startEvent && handle->stopEvent && !handle->is_device_memory_size_query()
+           && IsRerunnable(prob))
+        {
+            auto selection = TuneSolution(prob, key, tensile_prob, *library, *hardware, adapter);
+            solution       = selection.solution;
+            launched       = selection.launched;
+        }
+
+        if(!solution && use_cache)
+            solution = cache.find(key);
+
+        // The library owns the solution; best only keeps it alive for this call
+        std::shared_ptr<Tensile::ContractionSolution> best;
+        if(!solution)
+        {
+            best     = library->findBestSolution(tensile_prob, *hardware, fitness_query);
+            solution = best.get();
+            if(use_cache)
+                cache.insert(key, solution);
+        }
 
         if(!solution)
         {
             rocblas_internal_ostream msg;
             print_once(msg << "\nrocBLAS error: No Tensile solution found for " << prob);
+            if(!handle->is_device_memory_size_query())
+                rocblas_metrics::record_event(rocblas_metrics::solution_not_found);
             status = rocblas_status_not_implemented;
         }
         else
         {
-            if(fitness_query)
+            if(fitness_query || launched)
                 status = rocblas_status_success;
             else if(handle->is_device_memory_size_query())
             {
@@ -732,11 +1474,10 @@ rocblas_status runContractionProblem(const RocblasContractionProblem<Ti, To, Tc>
             }
             else
             {
+                auto kernels = solution->solve(tensile_prob, GetTensileInputs(prob), *hardware);
+                get_tensile_host().load_code_objects(kernels, handle->getDevice());
                 adapter.launchKernels(
-                    solution->solve(tensile_prob, GetTensileInputs(prob), *hardware),
-                    handle->get_stream(),
-                    handle->startEvent,
-                    handle->stopEvent);
+                    kernels, handle->get_stream(), handle->startEvent, handle->stopEvent);
                 status = rocblas_status_success;
             }
         }
@@ -766,6 +1507,160 @@ extern "C" void rocblas_initialize()
     get_library_and_adapter();
 }
 
+/**********************************************************************
+ * Initialize rocBLAS on all HIP devices on background threads, wait  *
+ * for the initialization to finish, or query whether it finished     *
+ **********************************************************************/
+extern "C" rocblas_status rocblas_initialize_async()
+try
+{
+    get_tensile_async_initializer().start();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_initialize_wait()
+try
+{
+    return get_tensile_async_initializer().wait() ? rocblas_status_success
+                                                  : rocblas_status_internal_error;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_initialize_query(bool* complete)
+try
+{
+    if(!complete)
+        return rocblas_status_invalid_pointer;
+    *complete = get_tensile_async_initializer().complete();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************
+ * Query, enable/disable, and clear the Tensile solution cache     *
+ *******************************************************************/
+extern "C" rocblas_status rocblas_get_solution_cache_stats(size_t* hits,
+                                                           size_t* misses,
+                                                           size_t* evictions,
+                                                           size_t* entries)
+try
+{
+    auto stats = tensile_solution_cache().get_stats();
+    if(hits)
+        *hits = stats.hits;
+    if(misses)
+        *misses = stats.misses;
+    if(evictions)
+        *evictions = stats.evictions;
+    if(entries)
+        *entries = stats.entries;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_get_tensile_library_load_info(double* load_us,
+                                                               size_t* resident_bytes,
+                                                               size_t* file_bytes)
+try
+{
+    auto&                       info = tensile_library_load_info();
+    std::lock_guard<std::mutex> lock(info.mutex);
+    if(load_us)
+        *load_us = info.load_us;
+    if(resident_bytes)
+        *resident_bytes = info.resident_bytes;
+    if(file_bytes)
+        *file_bytes = info.file_bytes;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_set_solution_cache_enabled(bool enabled)
+try
+{
+    tensile_solution_cache().set_enabled(enabled);
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_clear_solution_cache()
+try
+{
+    tensile_solution_cache().clear();
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+/*******************************************************************
+ * Set and query the gemm autotuning limits, and export results    *
+ *******************************************************************/
+extern "C" rocblas_status
+    rocblas_set_gemm_autotune_limits(size_t candidates, size_t trials, size_t max_signatures)
+try
+{
+    if(!candidates || !trials)
+        return rocblas_status_invalid_value;
+    tensile_gemm_autotune().set_limits({candidates, trials, max_signatures});
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status
+    rocblas_get_gemm_autotune_limits(size_t* candidates, size_t* trials, size_t* max_signatures)
+try
+{
+    auto limits = tensile_gemm_autotune().get_limits();
+    if(candidates)
+        *candidates = limits.candidates;
+    if(trials)
+        *trials = limits.trials;
+    if(max_signatures)
+        *max_signatures = limits.max_signatures;
+    return rocblas_status_success;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
+extern "C" rocblas_status rocblas_export_gemm_autotune_results(const char* path)
+try
+{
+    if(!path)
+        return rocblas_status_invalid_pointer;
+    return tensile_gemm_autotune().export_results(path) ? rocblas_status_success
+                                                        : rocblas_status_internal_error;
+}
+catch(...)
+{
+    return exception_to_rocblas_status();
+}
+
 /******************************************************************************
  * Intantiate the cases of runContractionProblem which are needed to satisfy  *
  * rocBLAS dependencies. This file's template functions are not defined in a  *
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""Decode a rocBLAS binary log into trace, bench and profile logs.
+
+rocBLAS writes a binary log when ROCBLAS_LAYER includes 8, to the file
+named by ROCBLAS_LOG_BINARY_PATH or ROCBLAS_LOG_PATH. The file holds a record
+for each call which would have been logged by the other bits of ROCBLAS_LAYER.
+The layout is documented in library/src/include/rocblas_binary_log.hpp.
+
+Usage:
+    decode-binary-log.py [-t TRACE] [-b BENCH] [-p PROFILE] FILE
+
+The output is the same as the text logs. Trace and bench lines are written in
+the order of the calls, across all threads. The profile counts the calls with
+each set of arguments. Logs without an output file are written to stdout, the
+trace and bench logs interleaved, followed by the profile.
+"""
+
+import argparse
+import collections
+import math
+import struct
+import sys
+
+MAGIC = b"RBBINLOG"
+VERSION = 1
+FILE_HEADER = struct.Struct("<8sII")
+CHUNK_HEADER = struct.Struct("<II")
+RECORD_HEADER = struct.Struct("<IBBHQ")
+
+# Kinds of records
+PADDING, TRACE, BENCH, PROFILE, DEFINE = 0, 1, 2, 3, 4
+
+# Tags of arguments
+I32, U32, I64, U64, F32, F64, C32, C64, BOOL, CHAR, POINTER, STRING, TEXT, FORMATTED = range(1, 15)
+
+SCALARS = {
+    I32: struct.Struct("<i"),
+    U32: struct.Struct("<I"),
+    I64: struct.Struct("<q"),
+    U64: struct.Struct("<Q"),
+    F32: struct.Struct("<f"),
+    F64: struct.Struct("<d"),
+    C32: struct.Struct("<ff"),
+    C64: struct.Struct("<dd"),
+    BOOL: struct.Struct("<B"),
+    CHAR: struct.Struct("<B"),
+    POINTER: struct.Struct("<Q"),
+    STRING: struct.Struct("<I"),
+}
+LENGTH = struct.Struct("<I")
+
+
+def quoted(s, delim='"'):
+    """Quote a string like std::quoted"""
+    escaped = s.replace("\\", "\\\\").replace(delim, "\\" + delim)
+    return delim + escaped + delim
+
+
+def format_general(x):
+    """Format a floating-point value like std::ostream"""
+    return "%g" % x
+
+
+def format_exact(x):
+    """Format a double exactly, like rocblas_internal_ostream in YAML mode"""
+    if math.isnan(x):
+        return ".nan"
+    if math.isinf(x):
+        return "-.inf" if x < 0 else ".inf"
+    s = "%.17g" % x
+    if not any(c in s for c in ".eE"):
+        s += ".0"
+    return s
+
+
+def format_argument(tag, value, yaml):
+    """Format an argument like rocblas_internal_ostream, in YAML mode or not"""
+    if tag in (I32, U32, I64, U64):
+        return str(value)
+    if tag == F32:
+        return format_general(value)
+    if tag == F64:
+        return format_exact(value) if yaml else format_general(value)
+    if tag in (C32, C64):
+        s = "(%s,%s)" % (format_general(value[0]), format_general(value[1]))
+        return "'" + s + "'" if yaml else s
+    if tag == BOOL:
+        return ("true" if value else "false") if yaml else str(int(bool(value)))
+    if tag == CHAR:
+        return quoted(value, "'") if yaml else value
+    if tag == POINTER:
+        return hex(value) if value else "0"
+    if tag in (STRING, TEXT):
+        return quoted(value) if yaml else value
+    return value
+
+
+class Record:
+    def __init__(self, kind, time, order, arguments):
+        self.kind = kind
+        self.time = time
+        self.order = order
+        self.arguments = arguments  # list of (tag, value)
+
+    def line(self, sep):
+        return sep.join(format_argument(tag, value, False) for tag, value in self.arguments)
+
+    def profile_key(self):
+        # Arguments alternate between names, which are not quoted, and values
+        args = self.arguments
+        return tuple(
+            (format_argument(*args[i], False), format_argument(*args[i + 1], True))
+            for i in range(0, len(args) - 1, 2)
+        )
+
+
+def decode_arguments(data, offset, end, count, strings, path):
+    arguments = []
+    for _ in range(count):
+        tag = data[offset]
+        offset += 1
+        if tag in SCALARS:
+            s = SCALARS[tag]
+            value = s.unpack_from(data, offset)
+            offset += s.size
+            value = value if len(value) == 2 else value[0]
+            if tag == CHAR:
+                value = chr(value)
+            elif tag == STRING:
+                if value not in strings:
+                    raise ValueError(f"{path}: string {value} is used before it is defined")
+                value = strings[value]
+        elif tag in (TEXT, FORMATTED):
+            (length,) = LENGTH.unpack_from(data, offset)
+            offset += LENGTH.size
+            value = data[offset : offset + length].decode("utf-8", "replace")
+            offset += length
+        else:
+            raise ValueError(f"{path}: unknown argument tag {tag}")
+        if offset > end:
+            raise ValueError(f"{path}: argument overruns its record")
+        arguments.append((tag, value))
+    return arguments
+
+
+def read_file(path):
+    """Returns the trace, bench and profile records in the file"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < FILE_HEADER.size:
+        raise ValueError(f"{path}: file is too short")
+    magic, version, _ = FILE_HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError(f"{path}: not a rocBLAS binary log")
+    if version != VERSION:
+        raise ValueError(f"{path}: unsupported version {version}")
+
+    records = []
+    strings = collections.defaultdict(dict)  # strings defined by each thread
+    offset = FILE_HEADER.size
+    while offset + CHUNK_HEADER.size <= len(data):
+        thread, chunk_bytes = CHUNK_HEADER.unpack_from(data, offset)
+        offset += CHUNK_HEADER.size
+        chunk_end = offset + chunk_bytes
+        if chunk_end > len(data):
+            print(f"{path}: file is truncated", file=sys.stderr)
+            break
+        while offset < chunk_end:
+            (size,) = LENGTH.unpack_from(data, offset)
+            kind = data[offset + 4]
+            if size < 8 or offset + size > chunk_end:
+                raise ValueError(f"{path}: bad record size {size} at offset {offset}")
+            if kind != PADDING:
+                _, kind, count, _, time = RECORD_HEADER.unpack_from(data, offset)
+                start = offset + RECORD_HEADER.size
+                if kind == DEFINE:
+                    id, length = CHUNK_HEADER.unpack_from(data, start)
+                    start += CHUNK_HEADER.size
+                    strings[thread][id] = data[start : start + length].decode("utf-8", "replace")
+                elif kind in (TRACE, BENCH, PROFILE):
+                    arguments = decode_arguments(
+                        data, start, offset + size, count, strings[thread], path
+                    )
+                    records.append(Record(kind, time, len(records), arguments))
+            offset += size
+    records.sort(key=lambda r: (r.time, r.order))
+    return records
+
+
+def write_profile(f, records):
+    counts = collections.Counter(r.profile_key() for r in records if r.kind == PROFILE)
+    for key, count in counts.items():
+        pairs = [f"{name}: {value}" for name, value in key] + [f"call_count: {count}"]
+        f.write("- { " + ", ".join(pairs) + " }\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("file", help="binary log written by rocBLAS")
+    parser.add_argument("-t", "--trace", help="trace log to write")
+    parser.add_argument("-b", "--bench", help="bench log to write")
+    parser.add_argument("-p", "--profile", help="profile log to write")
+    args = parser.parse_args()
+
+    try:
+        records = read_file(args.file)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+
+    paths = {TRACE: args.trace, BENCH: args.bench, PROFILE: args.profile}
+    outputs = {kind: open(path, "w") if path else sys.stdout for kind, path in paths.items()}
+    for r in records:
+        if r.kind == TRACE:
+            outputs[TRACE].write(r.line(",") + "\n")
+        elif r.kind == BENCH:
+            outputs[BENCH].write(r.line(" ") + "\n")
+    write_profile(outputs[PROFILE], records)
+
+    for f in outputs.values():
+        if f is not sys.stdout:
+            f.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Validate rocBLAS solution override tables.
+
+rocBLAS reads the override table named by ROCBLAS_TENSILE_SOLUTION_OVERRIDES,
+and uses the pinned Tensile solution for every gemm problem matching a row.
+The format is documented in library/src/include/rocblas_solution_override.hpp.
+At exit, rocBLAS writes a CSV report of how often each row fired to the file
+named by ROCBLAS_TENSILE_SOLUTION_OVERRIDE_REPORT.
+
+Usage:
+    solution-overrides.py [--library TensileLibrary.yaml|.dat] FILE [FILE ...]
+
+Every error is reported with its line number, and rows which can never match
+because an earlier row matches all of their problems are reported as warnings.
+With --library, solution indices which are not in the library are errors;
+reading a .dat library requires the msgpack module.
+The exit status is 1 if any file has errors.
+"""
+
+import argparse
+import sys
+
+HEADER = "# rocBLAS solution overrides v1"
+
+TYPES = {"f16_r", "f32_r", "f64_r", "f16_c", "f32_c", "f64_c", "i8_r", "u8_r", "i32_r",
+         "u32_r", "i8_c", "u8_c", "i32_c", "u32_c", "bf16_r", "bf16_c"}
+TYPE_FIELDS = ("a_type", "c_type", "compute_type")
+TRANS_FIELDS = ("transA", "transB")
+RANGE_FIELDS = ("M", "N", "K", "batch_count", "lda", "ldb", "ldc", "ldd",
+                "stride_a", "stride_b", "stride_c", "stride_d")
+
+INT64_MIN, INT64_MAX = -2**63, 2**63 - 1
+
+
+def parse_range(value):
+    lo, sep, hi = value.partition(":")
+    if not sep:
+        lo = hi = int(value)
+        return lo, hi
+    lo = int(lo) if lo else INT64_MIN
+    hi = int(hi) if hi else INT64_MAX
+    if lo > hi:
+        raise ValueError
+    return lo, hi
+
+
+def parse_row(line):
+    """Parse one row into a dict of field constraints. Raises ValueError."""
+    row = {}
+    for field in line.split():
+        name, sep, value = field.partition("=")
+        if not sep or not name:
+            raise ValueError(f'expected name=value, found "{field}"')
+        try:
+            if name in RANGE_FIELDS:
+                row[name] = parse_range(value)
+            elif name in TYPE_FIELDS:
+                if value not in TYPES:
+                    raise ValueError
+                row[name] = value
+            elif name in TRANS_FIELDS:
+                if value.upper() not in ("N", "T", "C"):
+                    raise ValueError
+                row[name] = value.upper()
+            elif name == "solution_index":
+                row[name] = int(value)
+                if not 0 <= row[name] < 2**31:
+                    raise ValueError
+            else:
+                raise KeyError
+        except KeyError:
+            raise ValueError(f'unknown field "{name}"')
+        except ValueError:
+            raise ValueError(f'invalid value for {name}: "{value}"')
+    if "solution_index" not in row:
+        raise ValueError("missing solution_index")
+    return row
+
+
+def covers(earlier, later):
+    """Whether every problem matching the later row also matches the earlier row."""
+    for name in TYPE_FIELDS + TRANS_FIELDS:
+        if name in earlier and earlier[name] != later.get(name):
+            return False
+    for name in RANGE_FIELDS:
+        lo, hi = earlier.get(name, (INT64_MIN, INT64_MAX))
+        later_lo, later_hi = later.get(name, (INT64_MIN, INT64_MAX))
+        if later_lo < lo or later_hi > hi:
+            return False
+    return True
+
+
+def library_solution_indices(path):
+    if path.endswith(".yaml"):
+        import yaml
+        with open(path) as f:
+            library = yaml.load(f, Loader=getattr(yaml, "CSafeLoader", yaml.SafeLoader))
+    else:
+        import msgpack
+        with open(path, "rb") as f:
+            library = msgpack.unpack(f, raw=False, strict_map_key=False)
+    return {s["index"] for s in library["solutions"]}
+
+
+def validate(path, solutions):
+    errors = 0
+    rows = []
+    with open(path) as f:
+        lines = f.read().splitlines()
+    if not lines or lines[0] != HEADER:
+        print(f'{path}: error: missing header "{HEADER}"')
+        return 1
+
+    for number, line in enumerate(lines[1:], start=2):
+        text = line.strip()
+        if not text or text.startswith("#"):
+            continue
+        try:
+            row = parse_row(text)
+        except ValueError as e:
+            print(f"{path}:{number}: error: {e}")
+            errors += 1
+            continue
+        if solutions is not None and row["solution_index"] not in solutions:
+            print(f"{path}:{number}: error: solution_index {row['solution_index']} "
+                  "is not in the library")
+            errors += 1
+        for earlier_number, earlier in rows:
+            if covers(earlier, row):
+                print(f"{path}:{number}: warning: row never matches, because line "
+                      f"{earlier_number} matches all of its problems")
+                break
+        rows.append((number, row))
+
+    print(f"{path}: {len(rows)} rows, {errors} errors")
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--library", help="Tensile library to check solution indices against")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    try:
+        solutions = library_solution_indices(args.library) if args.library else None
+        errors = sum(validate(path, solutions) for path in args.files)
+    except (OSError, ImportError, KeyError, TypeError) as e:
+        sys.exit(f"error: {e}")
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
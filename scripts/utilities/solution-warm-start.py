@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Inspect and merge rocBLAS solution warm start files.
+
+rocBLAS writes a warm start file at exit when ROCBLAS_TENSILE_SOLUTION_WARM_START
+names a path. The file maps gemm problem signatures to Tensile solution indices,
+and is read on the next start to pre-seed the solution cache. The layout is
+documented in library/src/include/rocblas_solution_warm_start.hpp.
+
+Usage:
+    solution-warm-start.py inspect FILE [FILE ...]
+    solution-warm-start.py merge -o OUTPUT FILE [FILE ...]
+
+merge combines files written by many workers with the same architecture and the
+same Tensile library file, identified by its size, modification time, inode and
+device, e.g. on a shared installation. Files whose header does not match the
+first file are skipped.
+When files disagree on the solution for a problem, the most frequent choice wins.
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+MAGIC = b"rbsolws\0"
+VERSION = 2
+HEADER = struct.Struct("<8sIIQ32sQ")
+
+# Word offsets in the key built by ConstructSolutionCacheKey() in tensile_host.cpp
+KEY_M, KEY_N, KEY_K, KEY_BATCH = 0, 1, 2, 3
+KEY_PACKED, KEY_FLAGS, KEY_WORKSPACE, KEY_ARCH = 20, 21, 22, 23
+
+TRANSPOSE = {111: "N", 112: "T", 113: "C"}
+
+
+class WarmStartFile:
+    def __init__(self, version, key_words, library_id, arch, entries):
+        self.version = version
+        self.key_words = key_words
+        self.library_id = library_id
+        self.arch = arch
+        self.entries = entries  # list of (key tuple, solution index)
+
+    def header(self):
+        return (self.version, self.key_words, self.library_id, self.arch)
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError(f"{path}: file is too short")
+    magic, version, key_words, library_id, arch, count = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError(f"{path}: not a rocBLAS warm start file")
+    if version != VERSION:
+        raise ValueError(f"{path}: unsupported version {version}")
+    entry = struct.Struct(f"<{key_words}Qq")
+    if len(data) < HEADER.size + count * entry.size:
+        raise ValueError(f"{path}: file is truncated")
+    entries = []
+    for i in range(count):
+        fields = entry.unpack_from(data, HEADER.size + i * entry.size)
+        entries.append((tuple(fields[:-1]), fields[-1]))
+    return WarmStartFile(version, key_words, library_id, arch.rstrip(b"\0").decode(), entries)
+
+
+def write_file(path, ws):
+    entry = struct.Struct(f"<{ws.key_words}Qq")
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, ws.version, ws.key_words, ws.library_id,
+                            ws.arch.encode(), len(ws.entries)))
+        for key, index in ws.entries:
+            f.write(entry.pack(*key, index))
+
+
+def describe(key):
+    if len(key) <= KEY_ARCH:
+        return " ".join(str(k) for k in key)
+    packed = key[KEY_PACKED]
+    trans_a = TRANSPOSE.get((packed >> 24) & 0xff, "?")
+    trans_b = TRANSPOSE.get((packed >> 32) & 0xff, "?")
+    workspace = key[KEY_WORKSPACE]
+    workspace = "query" if workspace == 2**64 - 1 else str(workspace)
+    return (f"trans={trans_a}{trans_b} M={key[KEY_M]} N={key[KEY_N]} K={key[KEY_K]} "
+            f"batch={key[KEY_BATCH]} types={packed & 0xffffff:06x} flags={key[KEY_FLAGS]} "
+            f"workspace={workspace}")
+
+
+def inspect(paths):
+    for path in paths:
+        ws = read_file(path)
+        print(f"{path}: version {ws.version}, arch {ws.arch}, library id {ws.library_id:016x}, "
+              f"{ws.key_words} key words, {len(ws.entries)} entries")
+        for key, index in ws.entries:
+            print(f"  solution {index:6d}  {describe(key)}")
+
+
+def merge(output, paths):
+    merged = None
+    votes = collections.defaultdict(collections.Counter)
+    for path in paths:
+        ws = read_file(path)
+        if merged is None:
+            merged = ws
+        elif ws.header() != merged.header():
+            print(f"{path}: skipped, header does not match {paths[0]}", file=sys.stderr)
+            continue
+        for key, index in ws.entries:
+            votes[key][index] += 1
+
+    conflicts = sum(1 for v in votes.values() if len(v) > 1)
+    merged.entries = [(key, v.most_common(1)[0][0]) for key, v in sorted(votes.items())]
+    write_file(output, merged)
+    print(f"{output}: {len(merged.entries)} entries, {conflicts} conflicting problems")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("inspect", help="print the header and entries of warm start files")
+    p.add_argument("files", nargs="+")
+    p = sub.add_parser("merge", help="merge warm start files from many workers")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    try:
+        if args.command == "inspect":
+            inspect(args.files)
+        else:
+            merge(args.output, args.files)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+
+
+if __name__ == "__main__":
+    main()